@@ -7,6 +7,10 @@
 #include "mbc_master.h"        // for master interface define
 #include "esp_modbus_master.h" // for public interface defines
 
+#if (CONFIG_FMB_COMM_MODE_TCP_EN)
+#include "port_tcp_master.h"   // for the pipelined raw requests
+#endif
+
 // Helper macro to set custom command
 #define GET_CMD(mode, access, rd_cmd, wr_cmd) (((mode == MB_PARAM_WRITE) && (access & PAR_PERMS_WRITE)) ? wr_cmd : \
                                                ((mode == MB_PARAM_READ) && (access & PAR_PERMS_READ)) ? rd_cmd : 0)
@@ -172,6 +176,195 @@ esp_err_t mbc_master_send_request(void *ctx, mb_param_request_t *request, void *
     return ESP_OK;
 }
 
+/**
+ * Send the raw request PDU to the slave and get its response PDU (gateway forwarding)
+ */
+// Get the registers changed by the write request PDU to invalidate the cached reads
+static bool mbc_master_get_raw_write_range(uint8_t slave_addr, const uint8_t *pdu, uint16_t pdu_len,
+                                            mb_param_request_t *request)
+{
+    request->slave_addr = slave_addr;
+    request->command = pdu[0];
+    switch (pdu[0]) {
+        case MB_FUNC_WRITE_SINGLE_COIL:
+        case MB_FUNC_WRITE_REGISTER:
+            MB_RETURN_ON_FALSE((pdu_len >= 3), false, TAG, "incorrect write request length.");
+            request->reg_start = (uint16_t)((pdu[1] << 8) | pdu[2]);
+            request->reg_size = 1;
+            return true;
+        case MB_FUNC_WRITE_MULTIPLE_COILS:
+        case MB_FUNC_WRITE_MULTIPLE_REGISTERS:
+            MB_RETURN_ON_FALSE((pdu_len >= 5), false, TAG, "incorrect write request length.");
+            request->reg_start = (uint16_t)((pdu[1] << 8) | pdu[2]);
+            request->reg_size = (uint16_t)((pdu[3] << 8) | pdu[4]);
+            return true;
+        case MB_FUNC_READWRITE_MULTIPLE_REGISTERS:
+            MB_RETURN_ON_FALSE((pdu_len >= 9), false, TAG, "incorrect write request length.");
+            request->reg_start = (uint16_t)((pdu[5] << 8) | pdu[6]);
+            request->reg_size = (uint16_t)((pdu[7] << 8) | pdu[8]);
+            return true;
+        default:
+            return false;
+    }
+}
+
+esp_err_t mbc_master_send_raw_request(void *ctx, uint8_t slave_addr, const uint8_t *pdu, uint16_t pdu_len,
+                                        uint8_t *rsp_buf, uint16_t rsp_size, uint16_t *rsp_len)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    MB_RETURN_ON_FALSE((pdu && pdu_len && rsp_buf && rsp_len), ESP_ERR_INVALID_ARG, TAG,
+                       "Master raw request incorrect arguments.");
+    mbm_controller_iface_t *mbm_controller = MB_MASTER_GET_IFACE(ctx);
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    MB_RETURN_ON_FALSE((mbm_controller->mb_base && mbm_controller->is_active),
+                       ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly configured.");
+    mb_err_enum_t mb_error = MB_EBUSY;
+    if (mbm_opts->sched) {
+        // The request to the offline slave is rejected without the bus access
+        esp_err_t err = mbc_master_timing_check(mbm_opts->timing, slave_addr);
+        if (err != ESP_OK) {
+            return err;
+        }
+        err = mbc_master_sched_enter(mbm_opts->sched, mbc_master_is_write_command(pdu[0]),
+                                               pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+        if (err != ESP_OK) {
+            return err;
+        }
+        // The write is parsed before the request buffer is overwritten by the response
+        mb_param_request_t request = {0};
+        bool is_write = mbc_master_get_raw_write_range(slave_addr, pdu, pdu_len, &request);
+        mbc_master_timing_begin(mbm_opts->timing, mbm_controller->mb_base->port_obj, slave_addr);
+        mb_error = mbm_rq_raw(mbm_controller->mb_base, slave_addr, pdu, pdu_len,
+                                rsp_buf, rsp_size, rsp_len, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+        mbc_master_timing_end(mbm_opts->timing, mbm_controller->mb_base->port_obj, slave_addr, mb_error);
+        if (is_write) {
+            mbc_master_cache_invalidate(mbm_opts->cache, &request);
+        }
+        mbc_master_sched_leave(mbm_opts->sched);
+#if (CONFIG_FMB_COMM_MODE_TCP_EN && MB_TCP_MASTER_PIPELINE_ENABLED)
+    } else if (mbm_opts->port_type == MB_PORT_TCP_MASTER) {
+        // The raw requests of the concurrent callers are sent without waiting for each other,
+        // the port matches the responses by TID
+        mb_error = mbm_port_tcp_send_raw(mbm_controller->mb_base->port_obj, slave_addr, pdu, pdu_len,
+                                            rsp_buf, rsp_size, rsp_len, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+        if (mb_error == MB_EBUSY) {
+            // The window of the slave is full, the same as the busy bus of serial master
+            return ESP_ERR_NOT_FINISHED;
+        }
+#endif
+    } else if (xSemaphoreTake(mbm_opts->mbm_sema, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS)) == pdTRUE) {
+        mb_error = mbm_rq_raw(mbm_controller->mb_base, slave_addr, pdu, pdu_len,
+                                rsp_buf, rsp_size, rsp_len, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+        (void)xSemaphoreGive(mbm_opts->mbm_sema);
+    } else {
+        ESP_LOGD(TAG, "%s:MBC semaphore take fail.", __func__);
+    }
+    return MB_ERR_TO_ESP_ERR(mb_error);
+}
+
+/**
+ * Get statistics of the request scheduler
+ */
+esp_err_t mbc_master_get_sched_stats(void *ctx, mb_master_sched_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    MB_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Master incorrect stats pointer.");
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    return mbc_master_sched_get_stats(mbm_opts->sched, stats);
+}
+
+/**
+ * Set the TTL of the read cache for the address range
+ */
+esp_err_t mbc_master_set_cache_range(void *ctx, const mb_cache_range_t *range)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    return mbc_master_cache_set_range(mbm_opts->cache, range);
+}
+
+/**
+ * Drop the cached read responses
+ */
+esp_err_t mbc_master_clear_cache(void *ctx)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    MB_RETURN_ON_FALSE(mbm_opts->cache, ESP_ERR_NOT_SUPPORTED, TAG,
+                       "Master read cache is not used.");
+    mbc_master_cache_clear(mbm_opts->cache);
+    return ESP_OK;
+}
+
+/**
+ * Get statistics of the read cache
+ */
+esp_err_t mbc_master_get_cache_stats(void *ctx, mb_master_cache_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    MB_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "Master incorrect stats pointer.");
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    return mbc_master_cache_get_stats(mbm_opts->cache, stats);
+}
+
+esp_err_t mbc_master_get_slave_timing(void *ctx, uint8_t slave_addr, mb_slave_timing_t *timing)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                       "Master interface is not correctly initialized.");
+    MB_RETURN_ON_FALSE(timing, ESP_ERR_INVALID_ARG, TAG, "Master incorrect timing pointer.");
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    return mbc_master_timing_get(mbm_opts->timing, slave_addr, timing);
+}
+
+// Replace the scratch buffers of the parameter data with the ones sized for the largest parameter of the table,
+// the buffers still used by the pending calls are released with the previous pool
+static esp_err_t mbc_master_param_pool_set(mb_master_options_t *mbm_opts, const mb_parameter_descriptor_t *descriptor,
+                                            const uint16_t num_elements)
+{
+    size_t buf_size = 0;
+    for (uint16_t idx = 0; idx < num_elements; idx++) {
+        if (((size_t)descriptor[idx].mb_size << 1) > buf_size) {
+            buf_size = ((size_t)descriptor[idx].mb_size << 1);
+        }
+    }
+    buf_size = (buf_size > MB_MASTER_PARAM_BUF_SIZE_MAX) ? MB_MASTER_PARAM_BUF_SIZE_MAX : buf_size;
+    frame_pool_t *pool = frame_pool_create(MB_MASTER_PARAM_BUF_SLOTS, (uint16_t)buf_size);
+    MB_RETURN_ON_FALSE(pool, ESP_ERR_NO_MEM, TAG, "mb parameter buffers allocation fail.");
+    // The pending calls take the buffers under the lock, so the previous pool is not deleted between
+    // the read of the pointer and the allocation
+    CRITICAL_SECTION(mbm_opts->param_lock) {
+        frame_pool_t *prev_pool = mbm_opts->param_pool;
+        mbm_opts->param_pool = pool;
+        frame_pool_delete(prev_pool);
+    }
+    ESP_LOGD(TAG, "mb parameter buffers: %u x %u bytes.", (unsigned)MB_MASTER_PARAM_BUF_SLOTS, (unsigned)buf_size);
+    return ESP_OK;
+}
+
+uint8_t *mbc_master_param_buf_alloc(mb_master_options_t *mbm_opts, uint16_t mb_size, frame_pool_t **pool)
+{
+    size_t len = ((size_t)mb_size << 1);
+    uint8_t *buf = NULL;
+    *pool = NULL;
+    CRITICAL_SECTION(mbm_opts->param_lock) {
+        buf = frame_buf_alloc(mbm_opts->param_pool, len);
+        // The heap buffer is released without the pool, the replaced pool can be destroyed before
+        if (frame_buf_is_pooled(mbm_opts->param_pool, buf)) {
+            *pool = mbm_opts->param_pool;
+        }
+    }
+    if (buf) {
+        memset(buf, 0, len);
+    }
+    return buf;
+}
+
 /**
  * Set Modbus parameter description table
  */
@@ -189,7 +382,7 @@ esp_err_t mbc_master_set_descriptor(void *ctx, const mb_parameter_descriptor_t *
     MB_RETURN_ON_FALSE((error == ESP_OK), error, TAG,
                        "Master set descriptor failure, error=(0x%x) (%s).",
                        (uint16_t)error, esp_err_to_name(error));
-    return ESP_OK;
+    return mbc_master_param_pool_set(&mbm_controller->opts, descriptor, num_elements);
 }
 
 /**
@@ -269,18 +462,13 @@ mb_err_enum_t mbc_reg_input_master_cb(mb_base_t *inst, uint8_t *reg_buffer, uint
     // Number of input registers to be transferred
     uint16_t num_input_regs = mbm_opts->reg_buffer_size;
     uint8_t *input_reg_buf = mbm_opts->reg_buffer_ptr; // Get instance address
-    uint16_t regs_cnt = num_regs;
     mb_err_enum_t status = MB_ENOERR;
     // If input or configuration parameters are incorrect then return an error to stack layer
-    if ((input_reg_buf) && (num_regs >= 1) && (num_input_regs == regs_cnt))
+    if ((input_reg_buf) && (num_regs >= 1) && (num_input_regs == num_regs))
     {
         CRITICAL_SECTION(inst->lock)
         {
-            while (regs_cnt > 0)
-            {
-                _XFER_2_RD(input_reg_buf, reg_buffer);
-                regs_cnt -= 1;
-            }
+            mb_util_copy_regs(input_reg_buf, reg_buffer, num_regs);
         }
     }
     else
@@ -312,7 +500,6 @@ mb_err_enum_t mbc_reg_holding_master_cb(mb_base_t *inst, uint8_t *reg_buffer, ui
     uint16_t num_hold_regs = mbm_opts->reg_buffer_size;
     uint8_t *holding_buf = mbm_opts->reg_buffer_ptr;
     mb_err_enum_t status = MB_ENOERR;
-    uint16_t regs_cnt = num_regs;
     // Check input and configuration parameters for correctness
     if ((holding_buf) && (num_hold_regs == num_regs) && (num_regs >= 1))
     {
@@ -321,22 +508,13 @@ mb_err_enum_t mbc_reg_holding_master_cb(mb_base_t *inst, uint8_t *reg_buffer, ui
         case MB_REG_WRITE:
             CRITICAL_SECTION(inst->lock)
             {
-                while (regs_cnt > 0)
-                {
-                    _XFER_2_RD(reg_buffer, holding_buf);
-                    regs_cnt -= 1;
-                }
+                mb_util_copy_regs(reg_buffer, holding_buf, num_regs);
             }
             break;
         case MB_REG_READ:
             CRITICAL_SECTION(inst->lock)
             {
-                while (regs_cnt > 0)
-                {
-                    _XFER_2_WR(holding_buf, reg_buffer);
-                    holding_buf += 2;
-                    regs_cnt -= 1;
-                }
+                mb_util_copy_regs(holding_buf, reg_buffer, num_regs);
             }
             break;
         }
@@ -367,36 +545,20 @@ mb_err_enum_t mbc_reg_coils_master_cb(mb_base_t *inst, uint8_t *reg_buffer, uint
     uint16_t num_coil_regs = mbm_opts->reg_buffer_size;
     uint8_t *coils_buf = mbm_opts->reg_buffer_ptr;
     mb_err_enum_t status = MB_ENOERR;
-    uint16_t reg_index;
-    uint16_t coils_cnt = ncoils;
-    reg_addr--; // The address is already + 1
     if ((num_coil_regs >= 1) && (coils_buf) && (ncoils == num_coil_regs))
     {
-        reg_index = (reg_addr % 8);
         switch (mode)
         {
         case MB_REG_WRITE:
             CRITICAL_SECTION(inst->lock)
             {
-                while (coils_cnt > 0)
-                {
-                    uint8_t result = mb_util_get_bits(coils_buf, reg_index - (reg_addr % 8), 1);
-                    mb_util_set_bits(reg_buffer, reg_index - (reg_addr % 8), 1, result);
-                    reg_index++;
-                    coils_cnt--;
-                }
+                mb_util_copy_bits(reg_buffer, 0, coils_buf, 0, ncoils);
             }
             break;
         case MB_REG_READ:
             CRITICAL_SECTION(inst->lock)
             {
-                while (coils_cnt > 0)
-                {
-                    uint8_t result = mb_util_get_bits(reg_buffer, reg_index - (reg_addr % 8), 1);
-                    mb_util_set_bits(coils_buf, reg_index - (reg_addr % 8), 1, result);
-                    reg_index++;
-                    coils_cnt--;
-                }
+                mb_util_copy_bits(coils_buf, 0, reg_buffer, 0, ncoils);
             }
             break;
         } // switch ( mode )
@@ -429,24 +591,11 @@ mb_err_enum_t mbc_reg_discrete_master_cb(mb_base_t *inst, uint8_t *reg_buffer, u
     uint16_t num_discr_regs = mbm_opts->reg_buffer_size;
     uint8_t *discr_buf = mbm_opts->reg_buffer_ptr;
     mb_err_enum_t status = MB_ENOERR;
-    uint16_t bit_index, num_reg;
-    uint8_t *temp_discr_buf;
-    num_reg = n_discrete;
-    temp_discr_buf = discr_buf;
-    // It is already plus one in Modbus function method.
-    reg_addr--;
     if ((num_discr_regs >= 1) && (discr_buf) && (n_discrete >= 1) && (n_discrete == num_discr_regs))
     {
-        bit_index = (reg_addr) % 8; // Get bit index
         CRITICAL_SECTION(inst->lock)
         {
-            while (num_reg > 0)
-            {
-                uint8_t result = mb_util_get_bits(reg_buffer, bit_index - (reg_addr % 8), 1);
-                mb_util_set_bits(temp_discr_buf, bit_index - (reg_addr % 8), 1, result);
-                bit_index++;
-                num_reg--;
-            }
+            mb_util_copy_bits(discr_buf, 0, reg_buffer, 0, n_discrete);
         }
     }
     else
@@ -33,14 +33,150 @@ static uint8_t mb_slave_id[] = { MB_ID_BYTE0(MB_CONTROLLER_SLAVE_ID),
 
 static const char TAG[] __attribute__((unused)) = "MB_CONTROLLER_SLAVE";
 
+#define MB_DESCR_INDEX_MIN_CAPACITY (8)
+#define MB_DIRTY_MAP_WORDS(regs) (((regs) + 31) >> 5)
+
+// Returns the register range of the area descriptor, false if the area is not accessible
+static bool mbc_slave_get_descr_range(mb_descr_entry_t *descr, uint32_t *start, uint32_t *end)
+{
+    uint32_t reg_size = REG_SIZE(descr->type, descr->size);
+    if (!descr->p_data || (reg_size < 1)) {
+        return false;
+    }
+    *start = descr->start_offset;
+    *end = (uint32_t)descr->start_offset + reg_size;
+    return true;
+}
+
+// Updates the maximum end of areas in the index starting from the item with defined position
+static void mbc_slave_index_update_max_end(mb_descr_index_t *index, uint32_t pos)
+{
+    uint32_t max_end = (pos > 0) ? index->items[pos - 1].max_end : 0;
+    for (uint32_t i = pos; i < index->count; i++) {
+        max_end = (index->items[i].end > max_end) ? index->items[i].end : max_end;
+        index->items[i].max_end = max_end;
+    }
+}
+
+static bool mbc_slave_index_reserve(mb_descr_index_t *index, uint32_t count)
+{
+    if (count <= index->capacity) {
+        return true;
+    }
+    uint32_t capacity = (index->capacity) ? index->capacity : MB_DESCR_INDEX_MIN_CAPACITY;
+    while (capacity < count) {
+        capacity <<= 1;
+    }
+    mb_descr_index_item_t *items = heap_caps_realloc(index->items, capacity * sizeof(mb_descr_index_item_t),
+                                                        MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
+    if (!items) {
+        return false;
+    }
+    index->items = items;
+    index->capacity = capacity;
+    return true;
+}
+
+// Returns the position of the first item with the start register greater than start
+static uint32_t mbc_slave_index_upper_bound(mb_descr_index_t *index, uint32_t start)
+{
+    uint32_t low = 0;
+    uint32_t high = index->count;
+    while (low < high) {
+        uint32_t mid = low + ((high - low) >> 1);
+        if (index->items[mid].start <= start) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Inserts the area descriptor into the sorted index, the index is invalidated on failure
+static void mbc_slave_index_insert(mb_descr_index_t *index, mb_descr_entry_t *descr)
+{
+    uint32_t start = 0;
+    uint32_t end = 0;
+    if (!index->is_valid || !mbc_slave_get_descr_range(descr, &start, &end)) {
+        return;
+    }
+    if (!mbc_slave_index_reserve(index, index->count + 1)) {
+        ESP_LOGW(TAG, "mb can not allocate area index, use linear search.");
+        index->is_valid = false;
+        return;
+    }
+    uint32_t pos = mbc_slave_index_upper_bound(index, start);
+    memmove(&index->items[pos + 1], &index->items[pos], (index->count - pos) * sizeof(mb_descr_index_item_t));
+    index->items[pos].start = start;
+    index->items[pos].end = end;
+    index->items[pos].descr = descr;
+    index->count++;
+    mbc_slave_index_update_max_end(index, pos);
+}
+
+static int mbc_slave_index_compare(const void *item1, const void *item2)
+{
+    const mb_descr_index_item_t *it1 = (const mb_descr_index_item_t *)item1;
+    const mb_descr_index_item_t *it2 = (const mb_descr_index_item_t *)item2;
+    return (it1->start > it2->start) - (it1->start < it2->start);
+}
+
+// Builds the lookup index of area descriptors from the descriptor list
+static void mbc_slave_index_build(void *ctx, mb_param_type_t type)
+{
+    mb_slave_options_t *mbs_opts = MB_SLAVE_GET_OPTS(ctx);
+    mb_descr_index_t *index = &mbs_opts->area_index[type];
+    mb_descr_entry_t *it;
+    uint32_t count = 0;
+
+    LIST_FOREACH(it, &mbs_opts->area_descriptors[type], entries) {
+        count++;
+    }
+    index->count = 0;
+    index->is_valid = false;
+    if (!mbc_slave_index_reserve(index, count)) {
+        ESP_LOGW(TAG, "mb can not allocate area index, use linear search.");
+        return;
+    }
+    LIST_FOREACH(it, &mbs_opts->area_descriptors[type], entries) {
+        mb_descr_index_item_t *item = &index->items[index->count];
+        if (mbc_slave_get_descr_range(it, &item->start, &item->end)) {
+            item->descr = it;
+            index->count++;
+        }
+    }
+    if (index->count) {
+        qsort(index->items, index->count, sizeof(mb_descr_index_item_t), mbc_slave_index_compare);
+    }
+    mbc_slave_index_update_max_end(index, 0);
+    index->is_valid = true;
+}
+
 // Searches the register in the area specified by type, returns descriptor if found, else NULL
-static mb_descr_entry_t *mbc_slave_find_reg_descriptor(void *ctx, mb_param_type_t type, uint16_t addr, size_t regs)
+mb_descr_entry_t *mbc_slave_find_reg_descriptor(void *ctx, mb_param_type_t type, uint16_t addr, size_t regs)
 {
     mb_descr_entry_t *it;
     uint16_t reg_size = 0;
     mb_slave_options_t *mbs_opts = MB_SLAVE_GET_OPTS(ctx);
+    mb_descr_index_t *index = &mbs_opts->area_index[type];
 
-    if (LIST_EMPTY(&mbs_opts->area_descriptors[type])) {
+    if (LIST_EMPTY(&mbs_opts->area_descriptors[type]) || (regs < 1)) {
+        return NULL;
+    }
+    if (index->is_valid) {
+        uint32_t end = (uint32_t)addr + regs;
+        // Check the areas starting at or below the address, the closest one first,
+        // stop when none of the remaining areas reaches the end of the request
+        for (uint32_t pos = mbc_slave_index_upper_bound(index, addr); pos > 0; pos--) {
+            mb_descr_index_item_t *item = &index->items[pos - 1];
+            if (item->max_end < end) {
+                break;
+            }
+            if (item->end >= end) {
+                return item->descr;
+            }
+        }
         return NULL;
     }
     // search for the register in each area
@@ -65,8 +201,14 @@ static void mbc_slave_free_descriptors(void *ctx)
     for (int descr_type = 0; descr_type < MB_PARAM_COUNT; descr_type++) {
         while ((it = LIST_FIRST(&mbs_opts->area_descriptors[descr_type]))) {
             LIST_REMOVE(it, entries);
+            free(it->dirty_map);
             free(it);
         }
+        free(mbs_opts->area_index[descr_type].items);
+        mbs_opts->area_index[descr_type].items = NULL;
+        mbs_opts->area_index[descr_type].count = 0;
+        mbs_opts->area_index[descr_type].capacity = 0;
+        mbs_opts->area_index[descr_type].is_valid = true;
     }
 }
 
@@ -79,6 +221,81 @@ void mbc_slave_init_iface(void *ctx)
     LIST_INIT(&mbs_opts->area_descriptors[MB_PARAM_HOLDING]);
     LIST_INIT(&mbs_opts->area_descriptors[MB_PARAM_COIL]);
     LIST_INIT(&mbs_opts->area_descriptors[MB_PARAM_DISCRETE]);
+    // The lookup index is maintained while the descriptors are defined
+    for (int descr_type = 0; descr_type < MB_PARAM_COUNT; descr_type++) {
+        mbs_opts->area_index[descr_type] = (mb_descr_index_t){.items = NULL, .count = 0, .capacity = 0, .is_valid = true};
+    }
+    memset(&mbs_opts->change_stats, 0, sizeof(mbs_opts->change_stats));
+}
+
+// Sets or clears the range of bits in the dirty bitmap
+static void mbc_slave_dirty_map_update(uint32_t *map, uint32_t first, uint32_t count, bool set)
+{
+    uint32_t *word = &map[first >> 5];
+    uint32_t bit = first & 31;
+    while (count > 0) {
+        uint32_t n = ((32 - bit) < count) ? (32 - bit) : count;
+        uint32_t mask = ((n == 32) ? UINT32_MAX : ((1UL << n) - 1)) << bit;
+        *word = set ? (*word | mask) : (*word & ~mask);
+        word++;
+        count -= n;
+        bit = 0;
+    }
+}
+
+// Returns the position of the first bit equal to the value starting from the position, the number of bits if not found
+static uint32_t mbc_slave_dirty_map_find(const uint32_t *map, uint32_t bits, uint32_t pos, bool value)
+{
+    uint32_t words = MB_DIRTY_MAP_WORDS(bits);
+    uint32_t idx = pos >> 5;
+    if (pos >= bits) {
+        return bits;
+    }
+    uint32_t word = (value ? map[idx] : ~map[idx]) & (UINT32_MAX << (pos & 31));
+    while (!word && (++idx < words)) {
+        word = value ? map[idx] : ~map[idx];
+    }
+    if (!word) {
+        return bits;
+    }
+    pos = (idx << 5) + (uint32_t)__builtin_ctz(word);
+    return (pos < bits) ? pos : bits;
+}
+
+// Marks the written registers (coils) in the change log of the area, the caller holds the stack lock
+static void mbc_slave_mark_changed(mb_slave_options_t *mbs_opts, mb_descr_entry_t *descr, uint32_t first, uint32_t count)
+{
+    if (!descr->dirty_map || !count) {
+        return;
+    }
+    mbs_opts->change_stats.accesses++;
+    if (descr->is_dirty) {
+        mbs_opts->change_stats.coalesced++;
+    }
+    mbc_slave_dirty_map_update(descr->dirty_map, first, count, true);
+    descr->is_dirty = true;
+}
+
+// Moves the changed ranges of the area into the array, returns false if the array is full
+static bool mbc_slave_collect_changes(mb_descr_entry_t *descr, mb_param_change_t *changes, size_t max_count, size_t *count)
+{
+    uint32_t bits = REG_SIZE(descr->type, descr->size);
+    uint32_t pos = mbc_slave_dirty_map_find(descr->dirty_map, bits, 0, true);
+    while (pos < bits) {
+        if (*count >= max_count) {
+            return false;
+        }
+        uint32_t end = mbc_slave_dirty_map_find(descr->dirty_map, bits, pos, false);
+        mb_param_change_t *change = &changes[(*count)++];
+        change->type = descr->type;
+        change->mb_offset = (uint16_t)(descr->start_offset + pos);
+        change->address = (uint8_t *)descr->p_data + ((descr->type == MB_PARAM_HOLDING) ? (pos << 1) : (pos >> 3));
+        change->size = end - pos;
+        mbc_slave_dirty_map_update(descr->dirty_map, pos, end - pos, false);
+        pos = mbc_slave_dirty_map_find(descr->dirty_map, bits, end, true);
+    }
+    descr->is_dirty = false;
+    return true;
 }
 
 /**
@@ -186,6 +403,12 @@ esp_err_t mbc_slave_start(void *ctx)
     error = mbc_set_slave_id(mbs_controller, slave_uid, true, (uint8_t *)mb_slave_id, sizeof(mb_slave_id));
     MB_RETURN_ON_FALSE((error == ESP_OK), ESP_ERR_INVALID_STATE, TAG, "mb stack set slave ID failure.");
 #endif
+    // Rebuild the lookup index if the areas were defined while the controller was active
+    for (int descr_type = 0; descr_type < MB_PARAM_COUNT; descr_type++) {
+        if (!mbs_controller->opts.area_index[descr_type].is_valid) {
+            mbc_slave_index_build(ctx, descr_type);
+        }
+    }
     error = mbs_controller->start(ctx);
     MB_RETURN_ON_FALSE((error == ESP_OK), ESP_ERR_INVALID_STATE, TAG,
                     "Slave start failure error=(0x%x).", (uint16_t)error);
@@ -227,6 +450,18 @@ mb_event_group_t mbc_slave_check_event(void *ctx, mb_event_group_t group)
     return event;
 }
 
+/**
+ * Function to set the task notified about parameter access events
+ */
+esp_err_t mbc_slave_set_event_notify(void *ctx, TaskHandle_t task)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mb_slave_options_t *mbs_opts = MB_SLAVE_GET_OPTS(ctx);
+    mbs_opts->notify_task_handle = task;
+    return ESP_OK;
+}
+
 /**
  * Function to get notification about parameter change from application task
  */
@@ -241,6 +476,48 @@ esp_err_t mbc_slave_get_param_info(void *ctx, mb_param_info_t *reg_info, uint32_
     return mbs_controller->get_param_info(ctx, reg_info, timeout);
 }
 
+/**
+ * Function to set the handler forwarding the requests for other units (gateway)
+ */
+esp_err_t mbc_slave_set_forward_handler(void *ctx, mb_fwd_handler_fp handler, void *arg)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mbs_controller_iface_t *mbs_controller = MB_SLAVE_GET_IFACE(ctx);
+    MB_RETURN_ON_FALSE(mbs_controller->mb_base, ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mb_err_enum_t ret = mbs_set_forward_handler(mbs_controller->mb_base, handler, arg);
+    return MB_ERR_TO_ESP_ERR(ret);
+}
+
+/**
+ * Function to get transaction timing statistics of the slave
+ */
+esp_err_t mbc_slave_get_trans_stats(void *ctx, mb_trans_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((ctx && stats), ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mbs_controller_iface_t *mbs_controller = MB_SLAVE_GET_IFACE(ctx);
+    MB_RETURN_ON_FALSE(mbs_controller->mb_base, ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mb_err_enum_t ret = mbs_get_trans_stats(mbs_controller->mb_base, stats);
+    return MB_ERR_TO_ESP_ERR(ret);
+}
+
+/**
+ * Function to reset transaction timing statistics of the slave
+ */
+esp_err_t mbc_slave_reset_trans_stats(void *ctx)
+{
+    MB_RETURN_ON_FALSE(ctx, ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mbs_controller_iface_t *mbs_controller = MB_SLAVE_GET_IFACE(ctx);
+    MB_RETURN_ON_FALSE(mbs_controller->mb_base, ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mb_err_enum_t ret = mbs_reset_trans_stats(mbs_controller->mb_base);
+    return MB_ERR_TO_ESP_ERR(ret);
+}
+
 /**
  * Function to set area descriptors for modbus parameters
  */
@@ -280,12 +557,156 @@ esp_err_t mbc_slave_set_descriptor(void *ctx, mb_register_area_descriptor_t desc
         new_descr->p_data = descr_data.address;
         new_descr->size = descr_data.size;
         new_descr->access = descr_data.access;
+        new_descr->image = NULL;
+        new_descr->dirty_map = NULL;
+        new_descr->is_dirty = false;
+        if (((descr_data.type == MB_PARAM_HOLDING) || (descr_data.type == MB_PARAM_COIL))
+                && (descr_data.access != MB_ACCESS_RO)) {
+            // The change log of writable area, one bit per register (coil)
+            uint32_t map_bits = REG_SIZE(descr_data.type, descr_data.size);
+            new_descr->dirty_map = (uint32_t *)heap_caps_calloc(MB_DIRTY_MAP_WORDS(map_bits), sizeof(uint32_t),
+                                                                MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
+            if (!new_descr->dirty_map) {
+                free(new_descr);
+                ESP_LOGE(TAG, "mb can not allocate memory for change log.");
+                return ESP_ERR_NO_MEM;
+            }
+        }
         LIST_INSERT_HEAD(&mbs_opts->area_descriptors[descr_data.type], new_descr, entries);
+        if (!mbs_controller->is_active) {
+            mbc_slave_index_insert(&mbs_opts->area_index[descr_data.type], new_descr);
+        } else {
+            // The stack can search the index concurrently, so it is rebuilt on next start
+            mbs_opts->area_index[descr_data.type].is_valid = false;
+        }
         error = ESP_OK;
     }
     return error;
 }
 
+/**
+ * Function to get the ranges of parameters changed by the master
+ */
+esp_err_t mbc_slave_get_changes(void *ctx, mb_param_change_t *changes, size_t max_count, size_t *count)
+{
+    MB_RETURN_ON_FALSE((ctx && changes && max_count && count), ESP_ERR_INVALID_ARG, TAG,
+                    "mb incorrect change log arguments.");
+    mbs_controller_iface_t *mbs_controller = MB_SLAVE_GET_IFACE(ctx);
+    mb_slave_options_t *mbs_opts = &mbs_controller->opts;
+    mb_base_t *mb_obj = mbs_controller->mb_base;
+    MB_RETURN_ON_FALSE((mb_obj && mb_obj->lock), ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    static const mb_param_type_t change_types[] = {MB_PARAM_HOLDING, MB_PARAM_COIL};
+    mb_descr_entry_t *it = NULL;
+    bool is_full = false;
+    *count = 0;
+    CRITICAL_SECTION_LOCK(mb_obj->lock);
+    for (int i = 0; (i < (int)(sizeof(change_types) / sizeof(change_types[0]))) && !is_full; i++) {
+        LIST_FOREACH(it, &mbs_opts->area_descriptors[change_types[i]], entries) {
+            if (it->is_dirty && !mbc_slave_collect_changes(it, changes, max_count, count)) {
+                is_full = true;
+                break;
+            }
+        }
+    }
+    mbs_opts->change_stats.ranges += *count;
+    CRITICAL_SECTION_UNLOCK(mb_obj->lock);
+    return ESP_OK;
+}
+
+/**
+ * Function to get the parameter change log statistics
+ */
+esp_err_t mbc_slave_get_change_stats(void *ctx, mb_change_log_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((ctx && stats), ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    mbs_controller_iface_t *mbs_controller = MB_SLAVE_GET_IFACE(ctx);
+    mb_base_t *mb_obj = mbs_controller->mb_base;
+    MB_RETURN_ON_FALSE((mb_obj && mb_obj->lock), ESP_ERR_INVALID_STATE, TAG,
+                    "Slave interface is not correctly initialized.");
+    CRITICAL_SECTION(mb_obj->lock)
+    {
+        *stats = mbs_controller->opts.change_stats;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mbc_slave_reg_image_init(mb_reg_image_t *image, void *front, void *back, size_t size)
+{
+    MB_RETURN_ON_FALSE((image && front && back && (front != back) && size), ESP_ERR_INVALID_ARG, TAG,
+                            "mb incorrect register image arguments.");
+    image->buf[0] = front;
+    image->buf[1] = back;
+    image->size = size;
+    memcpy(back, front, size);
+    atomic_init(&image->generation, 0);
+    return ESP_OK;
+}
+
+void *mbc_slave_reg_image_begin(mb_reg_image_t *image)
+{
+    MB_RETURN_ON_FALSE((image && image->buf[0] && image->buf[1]), NULL, TAG,
+                            "mb incorrect register image arguments.");
+    // Only the producer changes the generation, so the front buffer is stable here
+    uint32_t gen = atomic_load_explicit(&image->generation, memory_order_relaxed);
+    // The readers of the previous image have to see the new generation before the buffer is changed
+    atomic_thread_fence(memory_order_seq_cst);
+    memcpy(image->buf[(gen + 1) & 1], image->buf[gen & 1], image->size);
+    return image->buf[(gen + 1) & 1];
+}
+
+esp_err_t mbc_slave_reg_image_publish(mb_reg_image_t *image)
+{
+    MB_RETURN_ON_FALSE((image && image->buf[0] && image->buf[1]), ESP_ERR_INVALID_ARG, TAG,
+                            "mb incorrect register image arguments.");
+    (void)atomic_fetch_add_explicit(&image->generation, 1, memory_order_release);
+    return ESP_OK;
+}
+
+// Copies the registers from the front buffer of the image, repeats the copy if the image is published meanwhile
+static void mbc_slave_reg_image_copy(mb_reg_image_t *image, size_t offset, uint8_t *dst, size_t length, bool swap)
+{
+    uint32_t gen = 0;
+    do {
+        gen = atomic_load_explicit(&image->generation, memory_order_acquire);
+        uint8_t *src = (uint8_t *)image->buf[gen & 1] + offset;
+        if (swap) {
+            mb_util_copy_regs(dst, src, (uint16_t)(length >> 1));
+        } else {
+            memcpy(dst, src, length);
+        }
+        atomic_thread_fence(memory_order_acquire);
+    } while (gen != atomic_load_explicit(&image->generation, memory_order_relaxed));
+}
+
+esp_err_t mbc_slave_reg_image_read(mb_reg_image_t *image, size_t offset, void *data, size_t length)
+{
+    MB_RETURN_ON_FALSE((image && image->buf[0] && image->buf[1] && data && ((offset + length) <= image->size)),
+                            ESP_ERR_INVALID_ARG, TAG, "mb incorrect register image arguments.");
+    mbc_slave_reg_image_copy(image, offset, (uint8_t *)data, length, false);
+    return ESP_OK;
+}
+
+esp_err_t mbc_slave_set_reg_image(void *ctx, mb_param_type_t type, uint16_t start_offset, mb_reg_image_t *image)
+{
+    MB_RETURN_ON_FALSE((ctx && image && image->buf[0] && image->buf[1]), ESP_ERR_INVALID_ARG, TAG,
+                            "mb incorrect register image arguments.");
+    MB_RETURN_ON_FALSE((type == MB_PARAM_INPUT), ESP_ERR_NOT_SUPPORTED, TAG,
+                            "mb register image is not supported for area type %d.", (int)type);
+    mb_slave_options_t *mbs_opts = MB_SLAVE_GET_OPTS(ctx);
+    mb_descr_entry_t *it = NULL;
+    LIST_FOREACH(it, &mbs_opts->area_descriptors[type], entries) {
+        if (it->start_offset == start_offset) {
+            break;
+        }
+    }
+    MB_RETURN_ON_FALSE((it && (it->size == image->size)), ESP_ERR_INVALID_ARG, TAG,
+                            "mb area for register image is not found or has different size.");
+    it->image = image;
+    return ESP_OK;
+}
+
 // The helper function to get time stamp in microseconds
 static uint64_t mbc_slave_get_time_stamp(void)
 {
@@ -314,6 +735,8 @@ static esp_err_t mbc_slave_send_param_info(void *ctx, mb_event_group_t par_type,
                         (int)par_type, (uint32_t)par_address, (int)par_size);
         error = ESP_OK;
     } else if (errQUEUE_FULL == status) {
+        // The writes are kept in the change log, see mbc_slave_get_changes()
+        mbs_opts->change_stats.queue_overflows++;
         ESP_LOGD(TAG, "Parameter queue is overflowed.");
     }
     return error;
@@ -331,6 +754,10 @@ static esp_err_t mbc_slave_send_param_access_notification(void *ctx, mb_event_gr
         ESP_LOGD(TAG, "The MB_REG_CHANGE_EVENT = 0x%.2x is set.", (int)event);
         err = ESP_OK;
     }
+    TaskHandle_t notify_task = mbs_opts->notify_task_handle;
+    if (notify_task) {
+        (void)xTaskNotify(notify_task, (uint32_t)event, eSetBits);
+    }
     return err;
 }
 
@@ -350,19 +777,21 @@ mb_err_enum_t mbc_reg_input_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint1
     if (it) {
         uint16_t input_reg_start = it->start_offset; // Get Modbus start address
         uint8_t *input_buffer = (uint8_t *)it->p_data; // Get instance address
-        uint16_t regs = n_regs;
         uint16_t reg_index;
         // If input or configuration parameters are incorrect then return an error to stack layer
         reg_index = (uint16_t)(address - input_reg_start);
         reg_index <<= 1; // register Address to byte address
         input_buffer += reg_index;
         uint8_t *buffer_start = input_buffer;
-        CRITICAL_SECTION(inst->lock)
-        {
-            while (regs > 0) {
-                _XFER_2_RD(reg_buffer, input_buffer);
-                reg_index += 2;
-                regs -= 1;
+        if (it->image) {
+            // Lock free read of the published image, the producer is not blocked
+            mbc_slave_reg_image_copy(it->image, reg_index, reg_buffer, ((size_t)n_regs << 1), true);
+            uint32_t gen = atomic_load_explicit(&it->image->generation, memory_order_relaxed);
+            buffer_start = (uint8_t *)it->image->buf[gen & 1] + reg_index;
+        } else {
+            CRITICAL_SECTION(inst->lock)
+            {
+                mb_util_copy_regs(reg_buffer, input_buffer, n_regs);
             }
         }
         // Send access notification
@@ -388,7 +817,6 @@ mb_err_enum_t mbc_reg_holding_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uin
     if (it) {
         uint16_t reg_holding_start = it->start_offset; // Get Modbus start address
         uint8_t *holding_buffer = it->p_data; // Get instance address
-        uint16_t regs = n_regs;
         reg_index = (uint16_t) (address - reg_holding_start);
         reg_index <<= 1; // register Address to byte address
         holding_buffer += reg_index;
@@ -398,11 +826,7 @@ mb_err_enum_t mbc_reg_holding_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uin
                 if (it->access != MB_ACCESS_WO) {
                     CRITICAL_SECTION(inst->lock)
                     {
-                        while (regs > 0) {
-                            _XFER_2_RD(reg_buffer, holding_buffer);
-                            reg_index += 2;
-                            regs -= 1;
-                        };
+                        mb_util_copy_regs(reg_buffer, holding_buffer, n_regs);
                     }
                     // Send access notification
                     (void)mbc_slave_send_param_access_notification(ctx, MB_EVENT_HOLDING_REG_RD);
@@ -416,12 +840,8 @@ mb_err_enum_t mbc_reg_holding_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uin
                 if (it->access != MB_ACCESS_RO) {
                     CRITICAL_SECTION(inst->lock)
                     {
-                        while (regs > 0) {
-                            _XFER_2_WR(holding_buffer, reg_buffer);
-                            holding_buffer += 2;
-                            reg_index += 2;
-                            regs -= 1;
-                        };
+                        mb_util_copy_regs(holding_buffer, reg_buffer, n_regs);
+                        mbc_slave_mark_changed(MB_SLAVE_GET_OPTS(ctx), it, (uint32_t)(address - reg_holding_start), n_regs);
                     }
                     // Send access notification
                     (void)mbc_slave_send_param_access_notification(ctx, MB_EVENT_HOLDING_REG_WR);
@@ -459,12 +879,7 @@ mb_err_enum_t mbc_reg_coils_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint1
                 if (it->access != MB_ACCESS_WO) {
                     CRITICAL_SECTION(inst->lock)
                     {
-                        while (coils > 0) {
-                            uint8_t result = mb_util_get_bits(reg_coils_buf, reg_index, 1);
-                            mb_util_set_bits(reg_buffer, reg_index - (address - reg_coils_start), 1, result);
-                            reg_index++;
-                            coils--;
-                        }
+                        mb_util_copy_bits(reg_buffer, 0, reg_coils_buf, reg_index, coils);
                     }
                     // Send an event to notify application task about event
                     (void)mbc_slave_send_param_access_notification(ctx, MB_EVENT_COILS_RD);
@@ -478,13 +893,8 @@ mb_err_enum_t mbc_reg_coils_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, uint1
                 if (it->access != MB_ACCESS_RO) {
                     CRITICAL_SECTION(inst->lock)
                     {
-                        while (coils > 0) {
-                            uint8_t result = mb_util_get_bits(reg_buffer,
-                                    reg_index - (address - reg_coils_start), 1);
-                            mb_util_set_bits(reg_coils_buf, reg_index, 1, result);
-                            reg_index++;
-                            coils--;
-                        }
+                        mb_util_copy_bits(reg_coils_buf, reg_index, reg_buffer, 0, coils);
+                        mbc_slave_mark_changed(MB_SLAVE_GET_OPTS(ctx), it, (uint32_t)(address - reg_coils_start), n_coils);
                     }
                     // Send an event to notify application task about event
                     (void)mbc_slave_send_param_access_notification(ctx, MB_EVENT_COILS_WR);
@@ -509,32 +919,22 @@ mb_err_enum_t mbc_reg_discrete_slave_cb(mb_base_t *inst, uint8_t *reg_buffer, ui
     MB_RETURN_ON_FALSE(reg_buffer, MB_EINVAL, TAG, "Slave stack call failed.");
     mb_err_enum_t status = MB_ENOERR;
     uint16_t reg_index;
-    uint16_t reg_bit_index;
-    uint16_t n_reg;
     uint8_t *discrete_input_buf;
     // It already plus one in modbus function method.
     address--;
     mb_descr_entry_t *it = mbc_slave_find_reg_descriptor(ctx, MB_PARAM_DISCRETE, address, n_discrete);
     if (it) {
-        uint16_t reg_discrete_start = it->start_offset; // MB offset of registers
-        n_reg = (n_discrete >> 3) + 1;
         discrete_input_buf = (uint8_t *)it->p_data; // the storage address
-        reg_index = (uint16_t) (address - reg_discrete_start) / 8; // Get register index in the buffer for bit number
-        reg_bit_index = (uint16_t)(address - reg_discrete_start) % 8; // Get bit index
-        uint8_t *temp_buf = &discrete_input_buf[reg_index];
+        reg_index = (uint16_t)(address - it->start_offset); // Get bit number in the buffer
+        uint8_t *temp_buf = &discrete_input_buf[reg_index >> 3];
         CRITICAL_SECTION(inst->lock)
         {
-            while (n_reg > 0) {
-                *reg_buffer++ = mb_util_get_bits(&discrete_input_buf[reg_index++], reg_bit_index, 8);
-                n_reg--;
-            }
+            mb_util_copy_bits(reg_buffer, 0, discrete_input_buf, reg_index, n_discrete);
+        }
+        // Filling zero to high bits of the last discrete byte
+        if (n_discrete % 8) {
+            reg_buffer[n_discrete >> 3] &= (uint8_t)((1U << (n_discrete % 8)) - 1);
         }
-        reg_buffer--;
-        // Last discrete
-        n_discrete = n_discrete % 8;
-        // Filling zero to high bit
-        *reg_buffer = *reg_buffer << (8 - n_discrete);
-        *reg_buffer = *reg_buffer >> (8 - n_discrete);
         // Send an event to notify application task about event
         (void)mbc_slave_send_param_access_notification(ctx, MB_EVENT_DISCRETE_RD);
         (void)mbc_slave_send_param_info(ctx, MB_EVENT_DISCRETE_RD, address, temp_buf, n_discrete);
@@ -185,6 +185,66 @@ typedef struct {
     uint16_t reg_size;              /*!< Modbus number of registers */
 } mb_param_request_t;
 
+/**
+ * @brief Statistics of the request scheduler of serial master
+ */
+typedef struct {
+    uint32_t requests;              /*!< Requests passed to the scheduler */
+    uint32_t queued;                /*!< Requests which waited for the bus */
+    uint32_t rejected;              /*!< Requests rejected because the queue was full */
+    uint32_t timeouts;              /*!< Requests which did not get the bus during the timeout */
+    uint16_t depth;                 /*!< Current number of waiting requests */
+    uint16_t depth_max;             /*!< Maximum number of waiting requests */
+    uint32_t wait_last_us;          /*!< Wait time of the last granted request */
+    uint32_t wait_max_us;           /*!< Maximum wait time of the granted requests */
+    uint64_t wait_total_us;         /*!< Sum of wait times of the granted requests */
+} mb_master_sched_stats_t;
+
+/**
+ * @brief Address range of the read cache of serial master with the time the response data is valid
+ */
+typedef struct {
+    uint8_t slave_addr;             /*!< Slave address, 0 - the range is used for all slaves */
+    mb_param_type_t param_type;     /*!< Register area: holding, input, coil or discrete */
+    uint16_t reg_start;             /*!< Start register of the range */
+    uint16_t reg_size;              /*!< Number of registers in the range */
+    uint32_t ttl_ms;                /*!< Time to live of the cached data, 0 - remove the range */
+} mb_cache_range_t;
+
+/**
+ * @brief Statistics of the read cache of serial master
+ */
+typedef struct {
+    uint32_t hits;                  /*!< Reads answered from the cache */
+    uint32_t misses;                /*!< Cached reads sent to the slave (no data or expired) */
+    uint32_t invalidations;         /*!< Entries dropped because of the write to overlapped range */
+    uint32_t evictions;             /*!< Entries replaced because the cache was full */
+} mb_master_cache_stats_t;
+
+// The number of bins of the timing histograms: < 0.5, 1, 2, 4, 8, 16, 32 ms and longer
+#define MB_TIMING_HIST_BINS (8)
+
+/**
+ * @brief Response timing of the slave measured by the serial master
+ */
+typedef struct {
+    uint32_t responses;                         /*!< Answered requests */
+    uint32_t timeouts;                          /*!< Requests without response */
+    uint32_t rejects;                           /*!< Requests rejected while the slave is offline */
+    uint32_t srtt_us;                           /*!< Smoothed round trip time of the request */
+    uint32_t rttvar_us;                         /*!< Mean deviation of the round trip time */
+    uint32_t response_tout_ms;                  /*!< Response timeout used for the last request */
+    uint16_t fail_count;                        /*!< Timeouts in a row */
+    bool is_offline;                            /*!< The slave is offline, only probe requests are sent */
+    uint32_t backoff_ms;                        /*!< Probe interval of the offline slave */
+    uint32_t latency_last_us;                   /*!< From the end of request to the first byte of the last response (RTU) */
+    uint32_t tx_done_last_us;                   /*!< Delay of the TX done notification after the last stop bit of the last request (RS-485 half duplex) */
+    uint32_t latency_max_us;                    /*!< Recent maximum of the latency, decays to the current values (RTU) */
+    uint32_t gap_max_us;                        /*!< Recent maximum of the silent gap inside the response (RTU) */
+    uint32_t latency_hist[MB_TIMING_HIST_BINS]; /*!< Histogram of the latency (RTU) */
+    uint32_t gap_hist[MB_TIMING_HIST_BINS];     /*!< Histogram of the longest gap of the response (RTU) */
+} mb_slave_timing_t;
+
 /**
  * @brief Initialize Modbus controller and stack for TCP port
  *
@@ -297,11 +357,114 @@ esp_err_t mbc_master_set_descriptor(void *ctx, const mb_parameter_descriptor_t *
  *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
  *     - esp_err_t ESP_ERR_INVALID_RESPONSE - an invalid response from slave
  *     - esp_err_t ESP_ERR_TIMEOUT - operation timeout or no response from slave
+ *     - esp_err_t ESP_ERR_NOT_FINISHED - the bus of serial master is busy (Slave Device Busy)
  *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the request command is not supported by slave
  *     - esp_err_t ESP_FAIL - slave returned an exception or other failure
  */
 esp_err_t mbc_master_send_request(void *ctx, mb_param_request_t *request, void *data_ptr);
 
+/**
+ * @brief Send the request PDU to the slave as is and return the response PDU of the slave.
+ *        The function is used to forward the requests received by the gateway to the slaves of the segment.
+ *        The exception response of the slave is returned as is and is not considered as an error.
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] slave_addr slave address (1 - 247), the broadcast request is not supported
+ * @param[in] pdu pointer to request PDU started from function code
+ * @param[in] pdu_len length of the request PDU
+ * @param[out] rsp_buf buffer to place the response PDU (can be the same as request PDU buffer)
+ * @param[in] rsp_size size of the response buffer
+ * @param[out] rsp_len length of the received response PDU
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the response is received
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master is not started
+ *     - esp_err_t ESP_ERR_NOT_FINISHED - the bus of serial master is busy or the TID window of TCP slave is full (Slave Device Busy)
+ *     - esp_err_t ESP_ERR_TIMEOUT - operation timeout or no response from slave
+ *     - esp_err_t ESP_FAIL - incorrect response or other failure
+ */
+esp_err_t mbc_master_send_raw_request(void *ctx, uint8_t slave_addr, const uint8_t *pdu, uint16_t pdu_len,
+                                        uint8_t *rsp_buf, uint16_t rsp_size, uint16_t *rsp_len);
+
+/**
+ * @brief Get statistics of the request scheduler of serial master.
+ *        The requests of several tasks are queued in front of the bus, the write requests are sent first
+ *        and the tasks are served in turn. The request is rejected with ESP_ERR_NOT_FINISHED if the queue is full.
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[out] stats pointer to store the statistics
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the statistics are returned
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master is not initialized
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the controller does not use the scheduler (TCP master)
+ */
+esp_err_t mbc_master_get_sched_stats(void *ctx, mb_master_sched_stats_t *stats);
+
+/**
+ * @brief Set the time to live of the cached read responses for the address range.
+ *        The reads (FC01 - FC04) which are completely included into the range are answered from the cache
+ *        of serial master while the data is not expired. The write to the overlapped registers of the slave
+ *        drops the cached data. The range with the same slave, area, start and size is updated,
+ *        the zero ttl_ms removes it. The cached data is dropped when the ranges are changed.
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] range pointer to the range description
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the range is set
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master is not initialized
+ *     - esp_err_t ESP_ERR_NO_MEM - no free range in the table
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the cache is disabled (CONFIG_FMB_MASTER_READ_CACHE_SIZE = 0) or TCP master
+ */
+esp_err_t mbc_master_set_cache_range(void *ctx, const mb_cache_range_t *range);
+
+/**
+ * @brief Drop all cached read responses of serial master
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the cache is cleared
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master is not initialized
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the cache is not used by the controller
+ */
+esp_err_t mbc_master_clear_cache(void *ctx);
+
+/**
+ * @brief Get hit and miss counters of the read cache of serial master
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[out] stats pointer to store the statistics
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the statistics are returned
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master is not initialized
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the cache is not used by the controller
+ */
+esp_err_t mbc_master_get_cache_stats(void *ctx, mb_master_cache_stats_t *stats);
+
+/**
+ * @brief Get the response timing and the offline state of the slave (serial master with
+ *        CONFIG_FMB_MASTER_ADAPTIVE_TIMEOUT or CONFIG_FMB_SERIAL_MEASURED_TIMING)
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] slave_addr address of the slave
+ * @param[out] timing pointer to store the timing of the slave
+ *
+ * @return
+ *     - esp_err_t ESP_OK - the timing is returned
+ *     - esp_err_t ESP_ERR_INVALID_ARG - invalid argument of function
+ *     - esp_err_t ESP_ERR_INVALID_STATE - the master is not initialized
+ *     - esp_err_t ESP_ERR_NOT_FOUND - the slave is not polled recently
+ *     - esp_err_t ESP_ERR_NOT_SUPPORTED - the timing is not measured by the controller
+ */
+esp_err_t mbc_master_get_slave_timing(void *ctx, uint8_t slave_addr, mb_slave_timing_t *timing);
+
 /**
  * @brief Get information about supported characteristic defined as cid. Uses parameter description table to get
  *        this information. The function will check if characteristic defined as a cid parameter is supported
@@ -9,6 +9,7 @@
 // Public interface header for slave
 #include <stdint.h>                 // for standard int types definition
 #include <stddef.h>                 // for NULL and std defines
+#include <stdatomic.h>              // for atomic generation counter
 #include "soc/soc.h"                // for BITN definitions
 #include "freertos/FreeRTOS.h"      // for task creation and queues access
 #include "freertos/event_groups.h"  // for event groups
@@ -55,6 +56,29 @@ typedef struct {
     size_t size;                            /*!< Modbus event register size (number of registers)*/
 } mb_param_info_t;
 
+/**
+ * @brief Changed parameter range information type
+ *
+ * The range of registers (coils) written by the master since the previous call of mbc_slave_get_changes().
+ * The overlapped and adjacent writes into the same area are merged into one range.
+ */
+typedef struct {
+    mb_param_type_t type;                   /*!< Type of the changed area (MB_PARAM_HOLDING or MB_PARAM_COIL) */
+    uint16_t mb_offset;                     /*!< Modbus offset of the first changed register (coil) */
+    uint8_t *address;                       /*!< Storage address of the first changed register (the byte of the first coil) */
+    size_t size;                            /*!< Number of changed registers (coils) */
+} mb_param_change_t;
+
+/**
+ * @brief Parameter change log statistics
+ */
+typedef struct {
+    uint32_t accesses;                      /*!< Number of write accesses recorded in the change log */
+    uint32_t coalesced;                     /*!< Number of write accesses merged with the changes not read yet */
+    uint32_t ranges;                        /*!< Number of changed ranges read by the application */
+    uint32_t queue_overflows;               /*!< Number of parameter info items dropped by the full notification queue */
+} mb_change_log_stats_t;
+
 /**
  * @brief Area access type modificator
  */
@@ -75,6 +99,20 @@ typedef struct {
     size_t size;                            /*!< Instance size for area descriptor (bytes) */
 } mb_register_area_descriptor_t;
 
+/**
+ * @brief Double buffered register image
+ *
+ * The producer task updates the back buffer and publishes it with one atomic increment of the generation.
+ * The stack reads the registers from the front buffer without lock and repeats the read
+ * if the image is published meanwhile, so the producer is never blocked by the readers.
+ * Only one producer task is allowed for the image.
+ */
+typedef struct {
+    void *buf[2];                           /*!< The image buffers, the front one is buf[generation & 1] */
+    size_t size;                            /*!< Size of each buffer (bytes) */
+    _Atomic(uint32_t) generation;           /*!< Number of published images */
+} mb_reg_image_t;
+
 /**
  * @brief Initialize Modbus Slave controller and stack for TCP port
  *
@@ -174,6 +212,22 @@ esp_err_t mbc_slave_stop(void *ctx);
  */
 mb_event_group_t mbc_slave_check_event(void *ctx, mb_event_group_t group);
 
+/**
+ * @brief Set the task to notify about parameter access events
+ *
+ * The bits of the access event (mb_event_group_t) are set in the notification value of the task (eSetBits)
+ * in addition to the event group checked by mbc_slave_check_event(). This allows the application task to wait
+ * for the access events and its own notifications at once with xTaskNotifyWait().
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] task handle of the task to notify, NULL to disable the notification
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Slave interface is not correctly initialized
+ */
+esp_err_t mbc_slave_set_event_notify(void *ctx, TaskHandle_t task);
+
 /**
  * @brief Get parameter information
  *
@@ -189,6 +243,82 @@ mb_event_group_t mbc_slave_check_event(void *ctx, mb_event_group_t group);
  */
 esp_err_t mbc_slave_get_param_info(void *ctx, mb_param_info_t *reg_info, uint32_t timeout);
 
+/**
+ * @brief Get the ranges of parameters changed by the master
+ *
+ * Each write into holding registers or coils marks the written registers in the change log of the area,
+ * so the changes are never lost even if the parameter notification queue is full. The function returns
+ * all ranges changed since the previous call and clears them. If the array is too small, the rest of
+ * ranges is kept in the log and returned on the next call.
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[out] changes array to store the changed ranges
+ * @param[in] max_count number of items in the array
+ * @param[out] count number of ranges stored into the array, zero if nothing is changed
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG The argument is incorrect
+ *     - ESP_ERR_INVALID_STATE Slave interface is not correctly initialized
+ */
+esp_err_t mbc_slave_get_changes(void *ctx, mb_param_change_t *changes, size_t max_count, size_t *count);
+
+/**
+ * @brief Get the parameter change log statistics
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[out] stats pointer to the structure to store the statistics
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Slave interface is not correctly initialized
+ */
+esp_err_t mbc_slave_get_change_stats(void *ctx, mb_change_log_stats_t *stats);
+
+/**
+ * @brief Set the handler to forward the requests addressed to other units (gateway mode)
+ *
+ * When the handler is set, the slave accepts the requests with any unit identifier (1 - 247) and
+ * the requests for the units other than the slave address are passed to the handler instead of
+ * the register callbacks. The handler gets the request PDU in the frame buffer, places the response
+ * PDU into the same buffer and returns the exception (MB_EX_GATEWAY_PATH_FAILED, MB_EX_GATEWAY_TGT_FAILED)
+ * if the target unit can not respond. The response keeps the MBAP header of the request (transaction ID).
+ * The handler is called from the Modbus task and blocks the processing of following requests until it returns.
+ * The TCP slave requires the unit identifier support (CONFIG_FMB_TCP_UID_ENABLED) to get the target unit.
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] handler forward handler, NULL to disable the forwarding
+ * @param[in] arg argument passed to the handler
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Slave interface is not correctly initialized
+ */
+esp_err_t mbc_slave_set_forward_handler(void *ctx, mb_fwd_handler_fp handler, void *arg);
+
+/**
+ * @brief Get transaction timing statistics of the slave
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[out] stats pointer to the structure to store the statistics
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Slave interface is not correctly initialized
+ */
+esp_err_t mbc_slave_get_trans_stats(void *ctx, mb_trans_stats_t *stats);
+
+/**
+ * @brief Reset transaction timing statistics of the slave
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Slave interface is not correctly initialized
+ */
+esp_err_t mbc_slave_reset_trans_stats(void *ctx);
+
 /**
  * @brief Set Modbus area descriptor
  *
@@ -201,6 +331,75 @@ esp_err_t mbc_slave_get_param_info(void *ctx, mb_param_info_t *reg_info, uint32_
  */
 esp_err_t mbc_slave_set_descriptor(void *ctx, mb_register_area_descriptor_t descr_data);
 
+/**
+ * @brief Initialize the double buffered register image
+ *
+ * @param[out] image pointer to the image structure
+ * @param[in] front buffer with the initial register values, the first front buffer
+ * @param[in] back second buffer of the same size, the first back buffer
+ * @param[in] size size of each buffer (bytes)
+ *
+ * @return
+ *     - ESP_OK: The image is initialized
+ *     - ESP_ERR_INVALID_ARG: The argument is incorrect
+ */
+esp_err_t mbc_slave_reg_image_init(mb_reg_image_t *image, void *front, void *back, size_t size);
+
+/**
+ * @brief Start the update of the register image
+ *
+ * The back buffer is synchronized with the front buffer and returned to the producer to update the values.
+ *
+ * @param[in] image pointer to the initialized image
+ *
+ * @return
+ *     - pointer to the back buffer to update, NULL if the argument is incorrect
+ */
+void *mbc_slave_reg_image_begin(mb_reg_image_t *image);
+
+/**
+ * @brief Publish the updated back buffer of the register image
+ *
+ * @param[in] image pointer to the initialized image
+ *
+ * @return
+ *     - ESP_OK: The back buffer becomes the front buffer
+ *     - ESP_ERR_INVALID_ARG: The argument is incorrect
+ */
+esp_err_t mbc_slave_reg_image_publish(mb_reg_image_t *image);
+
+/**
+ * @brief Read the consistent copy of the published register image
+ *
+ * @param[in] image pointer to the initialized image
+ * @param[in] offset offset of data in the image (bytes)
+ * @param[out] data pointer to the buffer to store the data
+ * @param[in] length length of data to read (bytes)
+ *
+ * @return
+ *     - ESP_OK: The data is read
+ *     - ESP_ERR_INVALID_ARG: The argument is incorrect
+ */
+esp_err_t mbc_slave_reg_image_read(mb_reg_image_t *image, size_t offset, void *data, size_t length);
+
+/**
+ * @brief Attach the double buffered image to the input register area
+ *
+ * The area has to be set by mbc_slave_set_descriptor() before with the same start offset and size as the image.
+ * The stack reads the registers of the area from the front buffer of the image instead of the area address.
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] type type of the area (MB_PARAM_INPUT is supported)
+ * @param[in] start_offset Modbus start address of the area
+ * @param[in] image pointer to the initialized image
+ *
+ * @return
+ *     - ESP_OK: The image is attached to the area
+ *     - ESP_ERR_INVALID_ARG: The argument is incorrect or the area is not found
+ *     - ESP_ERR_NOT_SUPPORTED: The area type is not supported
+ */
+esp_err_t mbc_slave_set_reg_image(void *ctx, mb_param_type_t type, uint16_t start_offset, mb_reg_image_t *image);
+
 // The support of <0x11 - Report Slave ID> command is intentionally included for TCP slave as well!
 #if CONFIG_FMB_CONTROLLER_SLAVE_ID_SUPPORT
 /**
@@ -33,6 +33,71 @@ extern "C" {
 // will be dependent on response time set by timer + convertion time if the command is received
 #define MB_MAX_RESP_DELAY_MS (3000)
 
+// The maximum number of requests waiting for the bus in the request scheduler
+#define MB_MASTER_SCHED_QUEUE_SIZE (CONFIG_FMB_MASTER_REQUEST_QUEUE_SIZE)
+
+typedef struct mb_master_sched_s mb_master_sched_t;
+
+// The number of cached read requests of the serial master, 0 - the cache is not used
+#define MB_MASTER_CACHE_ENTRIES (CONFIG_FMB_MASTER_READ_CACHE_SIZE)
+
+// The maximum number of address ranges with configured cache TTL
+#define MB_MASTER_CACHE_RANGES_MAX (8)
+
+typedef struct mb_master_cache_s mb_master_cache_t;
+
+// Merge the overlapped FC03/FC04 reads of the concurrent callers into one request
+#define MB_MASTER_READ_COALESCING_ENABLED (CONFIG_FMB_MASTER_READ_COALESCING)
+
+// The time the first read of the merged request waits for other callers before it takes the bus
+#define MB_MASTER_READ_COALESCE_WINDOW_MS (CONFIG_FMB_MASTER_READ_COALESCE_WINDOW_MS)
+
+// The maximum number of registers of the merged read request (FC03/FC04 limit)
+#define MB_MASTER_READ_GROUP_REGS_MAX (125)
+
+typedef struct mb_read_coalesce_s mb_read_coalesce_t;
+
+// The number of slaves with measured response timing (serial master)
+#define MB_MASTER_TIMING_SLAVES_MAX (16)
+
+// Per-slave response timeout derived from the round trip time, the offline slaves are probed with back-off
+#define MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED (CONFIG_FMB_MASTER_ADAPTIVE_TIMEOUT)
+
+#if (MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED)
+#define MB_MASTER_OFFLINE_TIMEOUTS (CONFIG_FMB_MASTER_OFFLINE_TIMEOUTS)
+#define MB_MASTER_OFFLINE_BACKOFF_MS (CONFIG_FMB_MASTER_OFFLINE_BACKOFF_MS)
+#define MB_MASTER_OFFLINE_BACKOFF_MAX_MS (CONFIG_FMB_MASTER_OFFLINE_BACKOFF_MAX_MS)
+#endif
+
+// The round trip samples of the slave before its response timeout is adapted
+#define MB_MASTER_TIMING_SAMPLES_MIN (4)
+
+// Limits of the adapted response timeout, the configured timeout is the upper limit
+#define MB_MASTER_TIMING_TOUT_MARGIN_MS (5)
+#define MB_MASTER_TIMING_TOUT_MIN_MS (10)
+
+// The adapted timeout is doubled after each timeout of the slave up to this shift
+#define MB_MASTER_TIMING_BACKOFF_SHIFT_MAX (6)
+
+typedef struct mb_master_timing_s mb_master_timing_t;
+
+/**
+ * @brief Timing of one polled slave
+ */
+typedef struct {
+    uint8_t slave_addr;         /*!< Slave address, 0 - the entry is free */
+    uint16_t samples;           /*!< Round trip samples */
+    uint16_t rto_shift;         /*!< The adapted timeout is doubled after each timeout */
+    uint32_t last_use;          /*!< Access counter value of the last use to find the replacement candidate */
+    int64_t probe_ts;           /*!< Time stamp of the next probe of the offline slave (us) */
+    mb_slave_timing_t info;
+} mb_master_timing_entry_t;
+
+// The scratch buffers of the parameter data for the concurrent get/set parameter calls,
+// the callers above this number and the parameters longer than the PDU use the heap
+#define MB_MASTER_PARAM_BUF_SLOTS (MB_MASTER_SCHED_QUEUE_SIZE + 1)
+#define MB_MASTER_PARAM_BUF_SIZE_MAX (MB_PDU_SIZE_MAX)
+
 /**
  * @brief Modbus controller handler structure
  */
@@ -44,6 +109,12 @@ typedef struct {
     TaskHandle_t task_handle;                           /*!< Modbus task handle */
     EventGroupHandle_t event_group_handle;              /*!< Modbus controller event group */
     SemaphoreHandle_t mbm_sema;                         /*!< Modbus controller semaphore */
+    mb_master_sched_t *sched;                           /*!< Request scheduler (serial master only) */
+    mb_master_cache_t *cache;                           /*!< Read response cache (serial master only) */
+    mb_read_coalesce_t *coalesce;                       /*!< Groups of merged reads (serial master only) */
+    mb_master_timing_t *timing;                         /*!< Response timing of the slaves (serial master only) */
+    frame_pool_t *param_pool;                           /*!< Scratch buffers of the parameter data sized from the descriptor table */
+    _lock_t param_lock;                                 /*!< Lock of the parameter pool replaced by the set descriptor */
     const mb_parameter_descriptor_t *param_descriptor_table; /*!< Modbus controller parameter description table */
     size_t mbm_param_descriptor_size;                   /*!< Modbus controller parameter description table size */
 } mb_master_options_t;
@@ -79,6 +150,147 @@ typedef struct {
     iface_set_parameter_with_fp set_parameter_with; /*!< Interface set_parameter_with method */
 } mbm_controller_iface_t;
 
+/**
+ * @brief Request scheduler of the bus shared by several tasks
+ *
+ * The requests are granted in the order: writes first, then the task which has been served least recently,
+ * then the arrival order. If MB_MASTER_SCHED_QUEUE_SIZE requests already wait for the bus,
+ * the request is rejected immediately.
+ */
+esp_err_t mbc_master_sched_create(mb_master_sched_t **sched);
+void mbc_master_sched_delete(mb_master_sched_t *sched);
+
+/**
+ * @brief Take the bus for one request, ESP_ERR_NOT_FINISHED is returned if the queue is full
+ *        or the bus is not granted during the timeout (Slave Device Busy)
+ */
+esp_err_t mbc_master_sched_enter(mb_master_sched_t *sched, bool is_write, TickType_t timeout);
+
+/**
+ * @brief Release the bus and pass it to the next waiting request
+ */
+void mbc_master_sched_leave(mb_master_sched_t *sched);
+esp_err_t mbc_master_sched_get_stats(mb_master_sched_t *sched, mb_master_sched_stats_t *stats);
+
+/**
+ * @brief Check if the function code changes data of the slave, such requests have priority in the scheduler
+ */
+bool mbc_master_is_write_command(uint8_t command);
+
+/**
+ * @brief Read-through cache of the responses, the entry is keyed by (slave, command, start, size)
+ *
+ * Only the reads (FC01 - FC04) included into the range configured with mbc_master_cache_set_range() are cached.
+ * The write to the overlapped range of the slave invalidates the cached entries.
+ */
+esp_err_t mbc_master_cache_create(mb_master_cache_t **cache, uint16_t entries_num);
+void mbc_master_cache_delete(mb_master_cache_t *cache);
+esp_err_t mbc_master_cache_set_range(mb_master_cache_t *cache, const mb_cache_range_t *range);
+
+/**
+ * @brief Copy the cached data of the request into data_ptr, returns false if the data is not cached or expired
+ */
+bool mbc_master_cache_read(mb_master_cache_t *cache, const mb_param_request_t *request, void *data_ptr);
+
+/**
+ * @brief Keep the response data of the read request if the request is included into the configured range
+ */
+void mbc_master_cache_store(mb_master_cache_t *cache, const mb_param_request_t *request, const void *data_ptr);
+
+/**
+ * @brief Drop the cached entries overlapped by the write request
+ */
+void mbc_master_cache_invalidate(mb_master_cache_t *cache, const mb_param_request_t *request);
+void mbc_master_cache_clear(mb_master_cache_t *cache);
+esp_err_t mbc_master_cache_get_stats(mb_master_cache_t *cache, mb_master_cache_stats_t *stats);
+
+/**
+ * @brief Groups of the concurrent reads of the same slave sent as one request
+ *
+ * The first caller (leader) of the group sends the merged request when it gets the bus, the FC03/FC04 reads
+ * of the same slave with the overlapped or adjacent ranges join the group in the meantime while the merged
+ * range fits MB_MASTER_READ_GROUP_REGS_MAX registers. Each caller gets its part of the response and the result
+ * of the merged request.
+ */
+esp_err_t mbc_master_coalesce_create(mb_read_coalesce_t **coalesce);
+void mbc_master_coalesce_delete(mb_read_coalesce_t *coalesce);
+bool mbc_master_coalesce_is_mergeable(const mb_param_request_t *request);
+
+/**
+ * @brief Join the suitable group or start the new one, is_leader is set for the first caller of the group
+ *
+ * @return index of the group, -1 if the request can not be merged or all groups are taken
+ */
+int mbc_master_coalesce_join(mb_read_coalesce_t *coalesce, const mb_param_request_t *request, bool *is_leader);
+
+/**
+ * @brief Close the group for joining before the merged request is sent (leader),
+ *        returns the buffer of MB_MASTER_READ_GROUP_REGS_MAX registers for the response data
+ */
+uint16_t *mbc_master_coalesce_activate(mb_read_coalesce_t *coalesce, int idx, mb_param_request_t *merged);
+
+/**
+ * @brief Set the result of the merged request and release the callers of the group (leader)
+ */
+void mbc_master_coalesce_complete(mb_read_coalesce_t *coalesce, int idx, esp_err_t result);
+
+/**
+ * @brief Wait for the result of the group during timeout, copy the data of the request and leave the group
+ */
+esp_err_t mbc_master_coalesce_leave(mb_read_coalesce_t *coalesce, int idx, const mb_param_request_t *request,
+                                    void *data_ptr, TickType_t timeout);
+
+/**
+ * @brief Response timing of the recently polled slaves
+ *
+ * The controller measures the round trip time of each request and keeps its smoothed value and deviation
+ * per slave. With MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED the response timeout of the slave is srtt + 4 * rttvar
+ * (limited by the configured timeout) and the slave is marked offline after MB_MASTER_OFFLINE_TIMEOUTS timeouts
+ * in a row. The port measured latency and gaps of the RTU responses are added to the histograms when available.
+ */
+esp_err_t mbc_master_timing_create(mb_master_timing_t **timing, uint32_t response_tout_ms);
+void mbc_master_timing_delete(mb_master_timing_t *timing);
+
+/**
+ * @brief Check the slave before the request takes the bus, ESP_ERR_TIMEOUT is returned for the offline slave
+ *        until its probe interval expires, then one probe request is passed
+ */
+esp_err_t mbc_master_timing_check(mb_master_timing_t *timing, uint8_t slave_addr);
+
+/**
+ * @brief Set the response timeout of the slave, called while the bus is owned before the request is sent
+ */
+void mbc_master_timing_begin(mb_master_timing_t *timing, mb_port_base_t *port_obj, uint8_t slave_addr);
+
+/**
+ * @brief Account the round trip time of the response (data or exception) or the timeout of the request
+ *        and restore the configured timeout, the request failed without response is not accounted
+ */
+void mbc_master_timing_end(mb_master_timing_t *timing, mb_port_base_t *port_obj,
+                            uint8_t slave_addr, mb_err_enum_t mb_error);
+esp_err_t mbc_master_timing_get(mb_master_timing_t *timing, uint8_t slave_addr, mb_slave_timing_t *info);
+
+/**
+ * @brief The estimator of the slave timing entry used by the timing table
+ *
+ * mbc_master_timing_rtt_update() adds the round trip sample to the smoothed time and its deviation (RFC 6298),
+ * mbc_master_timing_get_tout() returns the response timeout of the slave limited by base_tout_ms,
+ * mbc_master_timing_fail() accounts the timeout and mbc_master_timing_alive() the received response of the slave.
+ */
+void mbc_master_timing_rtt_update(mb_master_timing_entry_t *entry, uint32_t rtt_us);
+uint32_t mbc_master_timing_get_tout(const mb_master_timing_entry_t *entry, uint32_t base_tout_ms);
+void mbc_master_timing_fail(mb_master_timing_entry_t *entry, int64_t now_ts);
+void mbc_master_timing_alive(mb_master_timing_entry_t *entry);
+
+/**
+ * @brief Scratch buffer of the parameter data (mb_size registers), the buffer is cleared and taken from
+ *        the parameter pool of the controller or from the heap if the pool is not set or exhausted.
+ *        The pool of the buffer is returned in pool (NULL for the heap buffer), the buffer is returned
+ *        with frame_buf_free() into this pool, which is kept until its buffers are returned
+ *        even if the descriptor table is replaced meanwhile.
+ */
+uint8_t *mbc_master_param_buf_alloc(mb_master_options_t *mbm_opts, uint16_t mb_size, frame_pool_t **pool);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,291 @@
+/*
+ * SPDX-FileCopyrightText: 2016-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// mbc_master_cache.c
+// Read-through cache of the Modbus master controller, answers the repeated reads without bus access
+
+#include <string.h>                 // for memcpy
+#include "esp_timer.h"              // for esp_timer_get_time()
+#include "mbc_master.h"             // for master private type definitions
+#include "mb_common.h"              // for critical section macros
+
+static const char *TAG = "mbc_master.cache";
+
+/**
+ * @brief Cached response data of one read request
+ */
+typedef struct {
+    bool used;
+    uint8_t slave_addr;
+    uint8_t command;
+    uint16_t reg_start;
+    uint16_t reg_size;
+    uint16_t data_len;          /*!< Length of the cached data */
+    uint16_t data_size;         /*!< Size of the allocated data buffer */
+    uint8_t *data;
+    int64_t expire_ts;          /*!< The data is not used after this time stamp (us) */
+    uint32_t last_use;          /*!< Access counter value of the last use to find the eviction candidate */
+} mb_cache_entry_t;
+
+struct mb_master_cache_s {
+    _lock_t lock;
+    uint32_t access;
+    uint16_t entries_num;
+    mb_cache_range_t ranges[MB_MASTER_CACHE_RANGES_MAX];
+    mb_master_cache_stats_t stats;
+    mb_cache_entry_t entries[];
+};
+
+// Area of the read command, MB_PARAM_UNKNOWN if the command is not cached
+static mb_param_type_t mbc_cache_read_area(uint8_t command)
+{
+    switch (command) {
+        case MB_FUNC_READ_HOLDING_REGISTER:
+            return MB_PARAM_HOLDING;
+        case MB_FUNC_READ_INPUT_REGISTER:
+            return MB_PARAM_INPUT;
+        case MB_FUNC_READ_COILS:
+            return MB_PARAM_COIL;
+        case MB_FUNC_READ_DISCRETE_INPUTS:
+            return MB_PARAM_DISCRETE;
+        default:
+            return MB_PARAM_UNKNOWN;
+    }
+}
+
+// Area changed by the write command, MB_PARAM_UNKNOWN if the command does not change the cached areas
+static mb_param_type_t mbc_cache_write_area(uint8_t command)
+{
+    switch (command) {
+        case MB_FUNC_WRITE_REGISTER:
+        case MB_FUNC_WRITE_MULTIPLE_REGISTERS:
+        case MB_FUNC_READWRITE_MULTIPLE_REGISTERS:
+            return MB_PARAM_HOLDING;
+        case MB_FUNC_WRITE_SINGLE_COIL:
+        case MB_FUNC_WRITE_MULTIPLE_COILS:
+            return MB_PARAM_COIL;
+        default:
+            return MB_PARAM_UNKNOWN;
+    }
+}
+
+static uint16_t mbc_cache_data_len(mb_param_type_t area, uint16_t reg_size)
+{
+    if ((area == MB_PARAM_COIL) || (area == MB_PARAM_DISCRETE)) {
+        return (uint16_t)((reg_size + 7) >> 3);
+    }
+    return (uint16_t)(reg_size << 1);
+}
+
+static bool mbc_cache_is_overlapped(uint16_t start1, uint16_t size1, uint16_t start2, uint16_t size2)
+{
+    return ((uint32_t)start1 < ((uint32_t)start2 + size2)) && ((uint32_t)start2 < ((uint32_t)start1 + size1));
+}
+
+// Returns the TTL of the configured range which includes the request, 0 if the request is not cached
+static uint32_t mbc_cache_get_ttl(mb_master_cache_t *cache, const mb_param_request_t *request, mb_param_type_t area)
+{
+    for (int i = 0; i < MB_MASTER_CACHE_RANGES_MAX; i++) {
+        mb_cache_range_t *range = &cache->ranges[i];
+        if (range->ttl_ms
+            && (range->param_type == area)
+            && (!range->slave_addr || (range->slave_addr == request->slave_addr))
+            && (request->reg_start >= range->reg_start)
+            && (((uint32_t)request->reg_start + request->reg_size) <= ((uint32_t)range->reg_start + range->reg_size))) {
+            return range->ttl_ms;
+        }
+    }
+    return 0;
+}
+
+static mb_cache_entry_t *mbc_cache_find(mb_master_cache_t *cache, const mb_param_request_t *request)
+{
+    for (int i = 0; i < cache->entries_num; i++) {
+        mb_cache_entry_t *entry = &cache->entries[i];
+        if (entry->used
+            && (entry->slave_addr == request->slave_addr)
+            && (entry->command == request->command)
+            && (entry->reg_start == request->reg_start)
+            && (entry->reg_size == request->reg_size)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t mbc_master_cache_create(mb_master_cache_t **cache, uint16_t entries_num)
+{
+    MB_RETURN_ON_FALSE((cache && entries_num), ESP_ERR_INVALID_ARG, TAG, "incorrect cache arguments.");
+    mb_master_cache_t *pcache = calloc(1, sizeof(mb_master_cache_t) + (entries_num * sizeof(mb_cache_entry_t)));
+    MB_RETURN_ON_FALSE((pcache), ESP_ERR_NO_MEM, TAG, "cache allocation fail.");
+    pcache->entries_num = entries_num;
+    CRITICAL_SECTION_INIT(pcache->lock);
+    *cache = pcache;
+    return ESP_OK;
+}
+
+void mbc_master_cache_delete(mb_master_cache_t *cache)
+{
+    if (cache) {
+        for (int i = 0; i < cache->entries_num; i++) {
+            free(cache->entries[i].data);
+        }
+        CRITICAL_SECTION_CLOSE(cache->lock);
+        free(cache);
+    }
+}
+
+esp_err_t mbc_master_cache_set_range(mb_master_cache_t *cache, const mb_cache_range_t *range)
+{
+    MB_RETURN_ON_FALSE((cache), ESP_ERR_NOT_SUPPORTED, TAG, "cache is not used by the controller.");
+    MB_RETURN_ON_FALSE((range && range->reg_size && (range->param_type < MB_PARAM_COUNT)),
+                       ESP_ERR_INVALID_ARG, TAG, "incorrect cache range.");
+    esp_err_t err = ESP_ERR_NO_MEM;
+    CRITICAL_SECTION(cache->lock) {
+        mb_cache_range_t *free_range = NULL;
+        mb_cache_range_t *found = NULL;
+        for (int i = 0; i < MB_MASTER_CACHE_RANGES_MAX; i++) {
+            mb_cache_range_t *item = &cache->ranges[i];
+            if (!item->ttl_ms) {
+                free_range = free_range ? free_range : item;
+            } else if ((item->slave_addr == range->slave_addr) && (item->param_type == range->param_type)
+                        && (item->reg_start == range->reg_start) && (item->reg_size == range->reg_size)) {
+                found = item;
+            }
+        }
+        // The range with zero TTL removes the existing range
+        found = found ? found : (range->ttl_ms ? free_range : NULL);
+        if (found) {
+            *found = *range;
+            err = ESP_OK;
+        } else if (!range->ttl_ms) {
+            err = ESP_OK;
+        }
+    }
+    MB_RETURN_ON_FALSE((err == ESP_OK), err, TAG, "no free cache range, max = %d.", MB_MASTER_CACHE_RANGES_MAX);
+    // The data cached with the old TTL is not used anymore
+    mbc_master_cache_clear(cache);
+    return ESP_OK;
+}
+
+bool mbc_master_cache_read(mb_master_cache_t *cache, const mb_param_request_t *request, void *data_ptr)
+{
+    mb_param_type_t area = mbc_cache_read_area(request->command);
+    bool is_hit = false;
+    if (!cache || (area == MB_PARAM_UNKNOWN) || !request->slave_addr) {
+        return false;
+    }
+    CRITICAL_SECTION(cache->lock) {
+        if (mbc_cache_get_ttl(cache, request, area)) {
+            mb_cache_entry_t *entry = mbc_cache_find(cache, request);
+            if (entry && (esp_timer_get_time() < entry->expire_ts)) {
+                memcpy(data_ptr, entry->data, entry->data_len);
+                entry->last_use = ++cache->access;
+                cache->stats.hits++;
+                is_hit = true;
+            } else {
+                cache->stats.misses++;
+            }
+        }
+    }
+    return is_hit;
+}
+
+void mbc_master_cache_store(mb_master_cache_t *cache, const mb_param_request_t *request, const void *data_ptr)
+{
+    mb_param_type_t area = mbc_cache_read_area(request->command);
+    if (!cache || (area == MB_PARAM_UNKNOWN) || !request->slave_addr) {
+        return;
+    }
+    uint16_t data_len = mbc_cache_data_len(area, request->reg_size);
+    CRITICAL_SECTION(cache->lock) {
+        uint32_t ttl_ms = mbc_cache_get_ttl(cache, request, area);
+        mb_cache_entry_t *entry = ttl_ms ? mbc_cache_find(cache, request) : NULL;
+        if (ttl_ms && !entry) {
+            // Take the free entry or evict the least recently used one
+            entry = &cache->entries[0];
+            for (int i = 0; i < cache->entries_num; i++) {
+                if (!cache->entries[i].used) {
+                    entry = &cache->entries[i];
+                    break;
+                }
+                if (cache->entries[i].last_use < entry->last_use) {
+                    entry = &cache->entries[i];
+                }
+            }
+            if (entry->used) {
+                cache->stats.evictions++;
+                entry->used = false;
+            }
+        }
+        if (entry && (entry->data_size < data_len)) {
+            uint8_t *data = realloc(entry->data, data_len);
+            if (data) {
+                entry->data = data;
+                entry->data_size = data_len;
+            } else {
+                ESP_LOGD(TAG, "%s: cache data allocation fail.", __func__);
+                entry->used = false;
+                entry = NULL;
+            }
+        }
+        if (entry) {
+            memcpy(entry->data, data_ptr, data_len);
+            entry->data_len = data_len;
+            entry->slave_addr = request->slave_addr;
+            entry->command = request->command;
+            entry->reg_start = request->reg_start;
+            entry->reg_size = request->reg_size;
+            entry->expire_ts = esp_timer_get_time() + ((int64_t)ttl_ms * 1000);
+            entry->last_use = ++cache->access;
+            entry->used = true;
+        }
+    }
+}
+
+void mbc_master_cache_invalidate(mb_master_cache_t *cache, const mb_param_request_t *request)
+{
+    mb_param_type_t area = mbc_cache_write_area(request->command);
+    if (!cache || (area == MB_PARAM_UNKNOWN)) {
+        return;
+    }
+    CRITICAL_SECTION(cache->lock) {
+        for (int i = 0; i < cache->entries_num; i++) {
+            mb_cache_entry_t *entry = &cache->entries[i];
+            // The broadcast write changes the data of all slaves
+            if (entry->used
+                && (!request->slave_addr || (entry->slave_addr == request->slave_addr))
+                && (mbc_cache_read_area(entry->command) == area)
+                && mbc_cache_is_overlapped(entry->reg_start, entry->reg_size,
+                                            request->reg_start, request->reg_size)) {
+                entry->used = false;
+                cache->stats.invalidations++;
+            }
+        }
+    }
+}
+
+void mbc_master_cache_clear(mb_master_cache_t *cache)
+{
+    if (!cache) {
+        return;
+    }
+    CRITICAL_SECTION(cache->lock) {
+        for (int i = 0; i < cache->entries_num; i++) {
+            cache->entries[i].used = false;
+        }
+    }
+}
+
+esp_err_t mbc_master_cache_get_stats(mb_master_cache_t *cache, mb_master_cache_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((cache), ESP_ERR_NOT_SUPPORTED, TAG, "cache is not used by the controller.");
+    MB_RETURN_ON_FALSE((stats), ESP_ERR_INVALID_ARG, TAG, "incorrect stats pointer.");
+    CRITICAL_SECTION(cache->lock) {
+        *stats = cache->stats;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,175 @@
+/*
+ * SPDX-FileCopyrightText: 2016-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// mbc_master_coalesce.c
+// Groups of the concurrent register reads of the same slave which are sent as one request
+
+#include <string.h>                 // for memcpy
+#include <sys/param.h>              // for MIN/MAX
+#include "mbc_master.h"             // for master private type definitions
+#include "mb_common.h"              // for critical section macros
+
+static const char *TAG = "mbc_master.coalesce";
+
+#define MB_READ_GROUPS_MAX (MB_MASTER_SCHED_QUEUE_SIZE)
+#define MB_READ_GROUP_BIT(idx) ((EventBits_t)1 << (idx))
+
+typedef enum {
+    MB_READ_GROUP_FREE = 0,
+    MB_READ_GROUP_COLLECT,      /*!< The leader waits for the bus, other reads can join the group */
+    MB_READ_GROUP_ACTIVE,       /*!< The merged request is sent */
+    MB_READ_GROUP_DONE          /*!< The response data is ready */
+} mb_read_group_state_t;
+
+/**
+ * @brief Concurrent reads of the same slave merged into one request
+ */
+typedef struct {
+    mb_read_group_state_t state;
+    mb_param_request_t request;                         /*!< Merged request */
+    uint16_t users;                                     /*!< The callers waiting for the group data */
+    esp_err_t error;                                    /*!< Result of the merged request */
+    uint16_t data[MB_MASTER_READ_GROUP_REGS_MAX];       /*!< Register values of the merged request */
+} mb_read_group_t;
+
+struct mb_read_coalesce_s {
+    _lock_t lock;
+    EventGroupHandle_t done_event;
+    mb_read_group_t groups[MB_READ_GROUPS_MAX];
+};
+
+void mbc_master_coalesce_delete(mb_read_coalesce_t *coalesce)
+{
+    if (coalesce) {
+        if (coalesce->done_event) {
+            vEventGroupDelete(coalesce->done_event);
+        }
+        CRITICAL_SECTION_CLOSE(coalesce->lock);
+        free(coalesce);
+    }
+}
+
+esp_err_t mbc_master_coalesce_create(mb_read_coalesce_t **coalesce)
+{
+    MB_RETURN_ON_FALSE((coalesce), ESP_ERR_INVALID_ARG, TAG, "mb read groups incorrect pointer.");
+    mb_read_coalesce_t *pcoalesce = calloc(1, sizeof(mb_read_coalesce_t));
+    MB_RETURN_ON_FALSE((pcoalesce), ESP_ERR_NO_MEM, TAG, "mb read groups allocation fail.");
+    CRITICAL_SECTION_INIT(pcoalesce->lock);
+    pcoalesce->done_event = xEventGroupCreate();
+    if (!pcoalesce->done_event) {
+        mbc_master_coalesce_delete(pcoalesce);
+        return ESP_ERR_NO_MEM;
+    }
+    *coalesce = pcoalesce;
+    return ESP_OK;
+}
+
+bool mbc_master_coalesce_is_mergeable(const mb_param_request_t *request)
+{
+    return (request && request->slave_addr
+            && ((request->command == MB_FUNC_READ_HOLDING_REGISTER) || (request->command == MB_FUNC_READ_INPUT_REGISTER))
+            && request->reg_size && (request->reg_size <= MB_MASTER_READ_GROUP_REGS_MAX));
+}
+
+// Extend the collecting group with the request, only the overlapped or adjacent ranges are merged
+// because the gap between them can contain the registers absent in the slave
+static bool mbc_coalesce_join_group(mb_read_group_t *group, const mb_param_request_t *request)
+{
+    uint32_t group_end = (uint32_t)group->request.reg_start + group->request.reg_size;
+    uint32_t req_end = (uint32_t)request->reg_start + request->reg_size;
+    if ((group->state != MB_READ_GROUP_COLLECT)
+        || (group->request.slave_addr != request->slave_addr)
+        || (group->request.command != request->command)
+        || (request->reg_start > group_end)
+        || (group->request.reg_start > req_end)) {
+        return false;
+    }
+    uint16_t start = MIN(group->request.reg_start, request->reg_start);
+    uint32_t end = MAX(group_end, req_end);
+    if ((end - start) > MB_MASTER_READ_GROUP_REGS_MAX) {
+        return false;
+    }
+    group->request.reg_start = start;
+    group->request.reg_size = (uint16_t)(end - start);
+    group->users++;
+    return true;
+}
+
+int mbc_master_coalesce_join(mb_read_coalesce_t *coalesce, const mb_param_request_t *request, bool *is_leader)
+{
+    if (!coalesce || !is_leader || !mbc_master_coalesce_is_mergeable(request)) {
+        return -1;
+    }
+    int idx = -1;
+    *is_leader = false;
+    CRITICAL_SECTION(coalesce->lock) {
+        for (int i = 0; (i < MB_READ_GROUPS_MAX) && (idx < 0); i++) {
+            if (mbc_coalesce_join_group(&coalesce->groups[i], request)) {
+                idx = i;
+            }
+        }
+        for (int i = 0; (i < MB_READ_GROUPS_MAX) && (idx < 0); i++) {
+            if (coalesce->groups[i].state == MB_READ_GROUP_FREE) {
+                coalesce->groups[i].state = MB_READ_GROUP_COLLECT;
+                coalesce->groups[i].request = *request;
+                coalesce->groups[i].users = 1;
+                coalesce->groups[i].error = ESP_ERR_INVALID_STATE;
+                (void)xEventGroupClearBits(coalesce->done_event, MB_READ_GROUP_BIT(i));
+                *is_leader = true;
+                idx = i;
+            }
+        }
+    }
+    return idx;
+}
+
+uint16_t *mbc_master_coalesce_activate(mb_read_coalesce_t *coalesce, int idx, mb_param_request_t *merged)
+{
+    MB_RETURN_ON_FALSE((coalesce && merged && (idx >= 0) && (idx < MB_READ_GROUPS_MAX)), NULL,
+                        TAG, "mb read group incorrect arguments.");
+    mb_read_group_t *group = &coalesce->groups[idx];
+    CRITICAL_SECTION(coalesce->lock) {
+        group->state = MB_READ_GROUP_ACTIVE;
+        *merged = group->request;
+    }
+    return group->data;
+}
+
+void mbc_master_coalesce_complete(mb_read_coalesce_t *coalesce, int idx, esp_err_t result)
+{
+    MB_RETURN_ON_FALSE((coalesce && (idx >= 0) && (idx < MB_READ_GROUPS_MAX)), ;,
+                        TAG, "mb read group incorrect arguments.");
+    mb_read_group_t *group = &coalesce->groups[idx];
+    CRITICAL_SECTION(coalesce->lock) {
+        group->error = result;
+        group->state = MB_READ_GROUP_DONE;
+    }
+    (void)xEventGroupSetBits(coalesce->done_event, MB_READ_GROUP_BIT(idx));
+}
+
+esp_err_t mbc_master_coalesce_leave(mb_read_coalesce_t *coalesce, int idx, const mb_param_request_t *request,
+                                    void *data_ptr, TickType_t timeout)
+{
+    MB_RETURN_ON_FALSE((coalesce && request && data_ptr && (idx >= 0) && (idx < MB_READ_GROUPS_MAX)),
+                        ESP_ERR_INVALID_ARG, TAG, "mb read group incorrect arguments.");
+    mb_read_group_t *group = &coalesce->groups[idx];
+    esp_err_t err = ESP_ERR_TIMEOUT;
+    (void)xEventGroupWaitBits(coalesce->done_event, MB_READ_GROUP_BIT(idx), pdFALSE, pdTRUE, timeout);
+    CRITICAL_SECTION(coalesce->lock) {
+        if (group->state == MB_READ_GROUP_DONE) {
+            err = group->error;
+            if (err == ESP_OK) {
+                memcpy(data_ptr, &group->data[request->reg_start - group->request.reg_start],
+                        (size_t)request->reg_size << 1);
+            }
+        }
+        // The last caller releases the group
+        if (--group->users == 0) {
+            group->state = MB_READ_GROUP_FREE;
+        }
+    }
+    return err;
+}
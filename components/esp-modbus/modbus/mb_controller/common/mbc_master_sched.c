@@ -0,0 +1,259 @@
+/*
+ * SPDX-FileCopyrightText: 2016-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// mbc_master_sched.c
+// Request scheduler of the Modbus master controller, shares one bus between the calling tasks
+
+#include "esp_timer.h"              // for esp_timer_get_time()
+#include "mbc_master.h"             // for master private type definitions
+#include "mb_common.h"              // for critical section macros
+
+static const char *TAG = "mbc_master.sched";
+
+#define MB_SCHED_SLOT_BIT(idx) ((EventBits_t)1 << (idx))
+
+typedef enum {
+    MB_SCHED_SLOT_FREE = 0,
+    MB_SCHED_SLOT_WAIT,
+    MB_SCHED_SLOT_GRANTED
+} mb_sched_slot_state_t;
+
+/**
+ * @brief Waiting request, the event group bit with the same index wakes the waiting task
+ */
+typedef struct {
+    mb_sched_slot_state_t state;    /*!< Slot state */
+    bool is_write;                  /*!< The request changes data of the slave */
+    TaskHandle_t task;              /*!< Calling task */
+    uint32_t seq;                   /*!< Arrival order of the request */
+    int64_t enqueue_ts;             /*!< Time stamp of the arrival (us) */
+} mb_sched_slot_t;
+
+/**
+ * @brief Calling task and the scheduler turn it has been served last
+ */
+typedef struct {
+    TaskHandle_t task;
+    uint32_t served;
+} mb_sched_client_t;
+
+struct mb_master_sched_s {
+    _lock_t lock;
+    EventGroupHandle_t grant_event;
+    bool busy;                                          /*!< The bus is owned by a request */
+    uint32_t seq;                                       /*!< Arrival counter */
+    uint32_t turn;                                      /*!< Grant counter */
+    mb_sched_slot_t slots[MB_MASTER_SCHED_QUEUE_SIZE];
+    mb_sched_client_t clients[MB_MASTER_SCHED_QUEUE_SIZE + 1];
+    mb_master_sched_stats_t stats;
+};
+
+// Returns the turn when the task has been served last, the unknown tasks are served first
+static uint32_t mbc_sched_get_served(mb_master_sched_t *sched, TaskHandle_t task)
+{
+    for (int i = 0; i < (MB_MASTER_SCHED_QUEUE_SIZE + 1); i++) {
+        if (sched->clients[i].task == task) {
+            return sched->clients[i].served;
+        }
+    }
+    return 0;
+}
+
+// Remember the turn of the task, the least recently served entry is replaced when the table is full
+static void mbc_sched_set_served(mb_master_sched_t *sched, TaskHandle_t task)
+{
+    mb_sched_client_t *entry = &sched->clients[0];
+    for (int i = 0; i < (MB_MASTER_SCHED_QUEUE_SIZE + 1); i++) {
+        if (sched->clients[i].task == task) {
+            entry = &sched->clients[i];
+            break;
+        }
+        if (sched->clients[i].served < entry->served) {
+            entry = &sched->clients[i];
+        }
+    }
+    entry->task = task;
+    entry->served = ++sched->turn;
+}
+
+static void mbc_sched_update_wait(mb_master_sched_t *sched, int64_t wait_us)
+{
+    uint32_t wait = (wait_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)wait_us;
+    sched->stats.wait_last_us = wait;
+    if (wait > sched->stats.wait_max_us) {
+        sched->stats.wait_max_us = wait;
+    }
+    sched->stats.wait_total_us += (uint64_t)wait;
+}
+
+// Select the next waiting request: writes first, then the task served least recently, then the arrival order
+static int mbc_sched_select(mb_master_sched_t *sched)
+{
+    int next = -1;
+    uint32_t next_served = 0;
+    for (int i = 0; i < MB_MASTER_SCHED_QUEUE_SIZE; i++) {
+        mb_sched_slot_t *slot = &sched->slots[i];
+        if (slot->state != MB_SCHED_SLOT_WAIT) {
+            continue;
+        }
+        uint32_t served = mbc_sched_get_served(sched, slot->task);
+        if (next < 0) {
+            next = i;
+            next_served = served;
+            continue;
+        }
+        mb_sched_slot_t *best = &sched->slots[next];
+        if (slot->is_write != best->is_write) {
+            if (slot->is_write) {
+                next = i;
+                next_served = served;
+            }
+        } else if ((served < next_served)
+                    || ((served == next_served) && ((int32_t)(slot->seq - best->seq) < 0))) {
+            next = i;
+            next_served = served;
+        }
+    }
+    return next;
+}
+
+bool mbc_master_is_write_command(uint8_t command)
+{
+    switch (command) {
+        case MB_FUNC_WRITE_SINGLE_COIL:
+        case MB_FUNC_WRITE_REGISTER:
+        case MB_FUNC_WRITE_MULTIPLE_COILS:
+        case MB_FUNC_WRITE_MULTIPLE_REGISTERS:
+        case MB_FUNC_READWRITE_MULTIPLE_REGISTERS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+esp_err_t mbc_master_sched_create(mb_master_sched_t **sched)
+{
+    MB_RETURN_ON_FALSE((sched), ESP_ERR_INVALID_ARG, TAG, "incorrect scheduler pointer.");
+    mb_master_sched_t *psched = calloc(1, sizeof(mb_master_sched_t));
+    MB_RETURN_ON_FALSE((psched), ESP_ERR_NO_MEM, TAG, "scheduler allocation fail.");
+    psched->grant_event = xEventGroupCreate();
+    if (!psched->grant_event) {
+        free(psched);
+        ESP_LOGE(TAG, "scheduler event group create fail.");
+        return ESP_ERR_NO_MEM;
+    }
+    CRITICAL_SECTION_INIT(psched->lock);
+    *sched = psched;
+    return ESP_OK;
+}
+
+void mbc_master_sched_delete(mb_master_sched_t *sched)
+{
+    if (sched) {
+        vEventGroupDelete(sched->grant_event);
+        CRITICAL_SECTION_CLOSE(sched->lock);
+        free(sched);
+    }
+}
+
+esp_err_t mbc_master_sched_enter(mb_master_sched_t *sched, bool is_write, TickType_t timeout)
+{
+    MB_RETURN_ON_FALSE((sched), ESP_ERR_INVALID_STATE, TAG, "scheduler is not initialized.");
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    int idx = -1;
+    esp_err_t err = ESP_OK;
+    int64_t start_ts = esp_timer_get_time();
+
+    CRITICAL_SECTION(sched->lock) {
+        sched->stats.requests++;
+        if (!sched->busy && (sched->stats.depth == 0)) {
+            // The bus is free, nobody waits for it
+            sched->busy = true;
+            mbc_sched_set_served(sched, task);
+            mbc_sched_update_wait(sched, 0);
+        } else {
+            for (int i = 0; i < MB_MASTER_SCHED_QUEUE_SIZE; i++) {
+                if (sched->slots[i].state == MB_SCHED_SLOT_FREE) {
+                    idx = i;
+                    break;
+                }
+            }
+            if (idx < 0) {
+                sched->stats.rejected++;
+                err = ESP_ERR_NOT_FINISHED;
+            } else {
+                mb_sched_slot_t *slot = &sched->slots[idx];
+                slot->state = MB_SCHED_SLOT_WAIT;
+                slot->is_write = is_write;
+                slot->task = task;
+                slot->seq = sched->seq++;
+                slot->enqueue_ts = start_ts;
+                (void)xEventGroupClearBits(sched->grant_event, MB_SCHED_SLOT_BIT(idx));
+                sched->stats.queued++;
+                sched->stats.depth++;
+                if (sched->stats.depth > sched->stats.depth_max) {
+                    sched->stats.depth_max = sched->stats.depth;
+                }
+            }
+        }
+    }
+
+    if (idx < 0) {
+        if (err != ESP_OK) {
+            ESP_LOGD(TAG, "%s: the request queue is full, bus busy.", __func__);
+        }
+        return err;
+    }
+
+    (void)xEventGroupWaitBits(sched->grant_event, MB_SCHED_SLOT_BIT(idx), pdTRUE, pdTRUE, timeout);
+
+    CRITICAL_SECTION(sched->lock) {
+        mb_sched_slot_t *slot = &sched->slots[idx];
+        // The grant can arrive right after the wait timeout, it is checked under the lock
+        if (slot->state == MB_SCHED_SLOT_GRANTED) {
+            mbc_sched_update_wait(sched, esp_timer_get_time() - slot->enqueue_ts);
+        } else {
+            sched->stats.depth--;
+            sched->stats.timeouts++;
+            err = ESP_ERR_NOT_FINISHED;
+        }
+        slot->state = MB_SCHED_SLOT_FREE;
+        slot->task = NULL;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGD(TAG, "%s: the bus is not granted in time.", __func__);
+    }
+    return err;
+}
+
+void mbc_master_sched_leave(mb_master_sched_t *sched)
+{
+    if (!sched) {
+        return;
+    }
+    CRITICAL_SECTION(sched->lock) {
+        int next = mbc_sched_select(sched);
+        if (next >= 0) {
+            // Pass the bus to the next request directly, the busy flag stays set
+            sched->slots[next].state = MB_SCHED_SLOT_GRANTED;
+            sched->stats.depth--;
+            mbc_sched_set_served(sched, sched->slots[next].task);
+            (void)xEventGroupSetBits(sched->grant_event, MB_SCHED_SLOT_BIT(next));
+        } else {
+            sched->busy = false;
+        }
+    }
+}
+
+esp_err_t mbc_master_sched_get_stats(mb_master_sched_t *sched, mb_master_sched_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((sched), ESP_ERR_NOT_SUPPORTED, TAG, "scheduler is not used by the controller.");
+    MB_RETURN_ON_FALSE((stats), ESP_ERR_INVALID_ARG, TAG, "incorrect stats pointer.");
+    CRITICAL_SECTION(sched->lock) {
+        *stats = sched->stats;
+    }
+    return ESP_OK;
+}
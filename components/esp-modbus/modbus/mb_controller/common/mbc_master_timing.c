@@ -0,0 +1,277 @@
+/*
+ * SPDX-FileCopyrightText: 2016-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// mbc_master_timing.c
+// Response timing of the polled slaves, adaptive response timeout and offline state of the slaves
+
+#include <string.h>                 // for memset
+#include <sys/param.h>              // for MIN/MAX
+#include "esp_timer.h"              // for esp_timer_get_time()
+#include "mbc_master.h"             // for master private type definitions
+#include "mb_common.h"              // for critical section macros
+#include "port_serial_common.h"     // for measured timing of the received frame
+
+static const char *TAG = "mbc_master.timing";
+
+// The upper limit of the first histogram bin, each next bin is twice wider
+#define MB_TIMING_HIST_BIN0_US      (500)
+
+struct mb_master_timing_s {
+    _lock_t lock;
+    uint32_t access;
+    uint32_t base_tout_ms;      /*!< Configured response timeout */
+    uint8_t slave_addr;         /*!< Slave of the request on the bus */
+    int64_t start_ts;           /*!< Time stamp of the request on the bus (us) */
+    mb_master_timing_entry_t entries[MB_MASTER_TIMING_SLAVES_MAX];
+};
+
+static int mbc_timing_hist_bin(uint32_t value_us)
+{
+    int bin = 0;
+    while ((bin < (MB_TIMING_HIST_BINS - 1)) && (value_us >= ((uint32_t)MB_TIMING_HIST_BIN0_US << bin))) {
+        bin++;
+    }
+    return bin;
+}
+
+// The maximum follows the new peaks immediately and decays slowly to the current values
+static uint32_t mbc_timing_decay_max(uint32_t max_us, uint32_t value_us)
+{
+    return (value_us >= max_us) ? value_us : (max_us - ((max_us - value_us) >> 4));
+}
+
+static mb_master_timing_entry_t *mbc_timing_find(mb_master_timing_t *timing, uint8_t slave_addr)
+{
+    for (int i = 0; i < MB_MASTER_TIMING_SLAVES_MAX; i++) {
+        if (timing->entries[i].slave_addr == slave_addr) {
+            return &timing->entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Take the entry of the slave, the free entry or the least recently used one
+static mb_master_timing_entry_t *mbc_timing_get_entry(mb_master_timing_t *timing, uint8_t slave_addr)
+{
+    mb_master_timing_entry_t *entry = mbc_timing_find(timing, slave_addr);
+    if (!entry) {
+        entry = &timing->entries[0];
+        for (int i = 0; i < MB_MASTER_TIMING_SLAVES_MAX; i++) {
+            if (!timing->entries[i].slave_addr) {
+                entry = &timing->entries[i];
+                break;
+            }
+            if (timing->entries[i].last_use < entry->last_use) {
+                entry = &timing->entries[i];
+            }
+        }
+        memset(entry, 0, sizeof(mb_master_timing_entry_t));
+        entry->slave_addr = slave_addr;
+    }
+    entry->last_use = ++timing->access;
+    return entry;
+}
+
+// Smoothed round trip time and its mean deviation with the gains 1/8 and 1/4 (RFC 6298)
+void mbc_master_timing_rtt_update(mb_master_timing_entry_t *entry, uint32_t rtt_us)
+{
+    if (!entry->samples) {
+        entry->info.srtt_us = rtt_us;
+        entry->info.rttvar_us = rtt_us >> 1;
+    } else {
+        uint32_t delta_us = (rtt_us > entry->info.srtt_us) ? (rtt_us - entry->info.srtt_us)
+                                                            : (entry->info.srtt_us - rtt_us);
+        entry->info.rttvar_us = entry->info.rttvar_us - (entry->info.rttvar_us >> 2) + (delta_us >> 2);
+        entry->info.srtt_us = entry->info.srtt_us - (entry->info.srtt_us >> 3) + (rtt_us >> 3);
+    }
+    if (entry->samples < UINT16_MAX) {
+        entry->samples++;
+    }
+}
+
+uint32_t mbc_master_timing_get_tout(const mb_master_timing_entry_t *entry, uint32_t base_tout_ms)
+{
+#if (MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED)
+    if (entry->samples >= MB_MASTER_TIMING_SAMPLES_MIN) {
+        uint32_t var_us = MAX((entry->info.rttvar_us << 2), (MB_MASTER_TIMING_TOUT_MARGIN_MS * 1000));
+        uint32_t tout_ms = (entry->info.srtt_us + var_us + 999) / 1000;
+        // The probe of the offline slave waits only the last estimated time
+        if (!entry->info.is_offline) {
+            tout_ms <<= entry->rto_shift;
+        }
+        tout_ms = MAX(tout_ms, MB_MASTER_TIMING_TOUT_MIN_MS);
+        return MIN(tout_ms, base_tout_ms);
+    }
+#endif
+    return base_tout_ms;
+}
+
+// The slave does not respond, after several timeouts in a row only the probe requests are sent
+void mbc_master_timing_fail(mb_master_timing_entry_t *entry, int64_t now_ts)
+{
+    entry->info.timeouts++;
+    if (entry->info.fail_count < UINT16_MAX) {
+        entry->info.fail_count++;
+    }
+    if (entry->rto_shift < MB_MASTER_TIMING_BACKOFF_SHIFT_MAX) {
+        entry->rto_shift++;
+    }
+#if (MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED)
+    if (entry->info.fail_count >= MB_MASTER_OFFLINE_TIMEOUTS) {
+        if (!entry->info.is_offline) {
+            entry->info.is_offline = true;
+            entry->info.backoff_ms = MB_MASTER_OFFLINE_BACKOFF_MS;
+            ESP_LOGW(TAG, "slave %u is offline after %u timeouts.",
+                        (unsigned)entry->slave_addr, (unsigned)entry->info.fail_count);
+        } else {
+            entry->info.backoff_ms = MIN((entry->info.backoff_ms << 1), MB_MASTER_OFFLINE_BACKOFF_MAX_MS);
+        }
+        entry->probe_ts = now_ts + ((int64_t)entry->info.backoff_ms * 1000);
+    }
+#endif
+}
+
+// Any response (including the exception) shows that the slave is alive
+void mbc_master_timing_alive(mb_master_timing_entry_t *entry)
+{
+    if (entry->info.is_offline) {
+        ESP_LOGI(TAG, "slave %u is online.", (unsigned)entry->slave_addr);
+    }
+    entry->info.responses++;
+    entry->info.fail_count = 0;
+    entry->info.is_offline = false;
+    entry->info.backoff_ms = 0;
+    entry->rto_shift = 0;
+}
+
+// The request is answered by the slave with the data or the exception, other errors are not accounted
+static bool mbc_timing_is_response(mb_err_enum_t mb_error)
+{
+    return ((mb_error == MB_ENOERR) || (mb_error == MB_EILLFUNC));
+}
+
+esp_err_t mbc_master_timing_create(mb_master_timing_t **timing, uint32_t response_tout_ms)
+{
+    MB_RETURN_ON_FALSE((timing && response_tout_ms), ESP_ERR_INVALID_ARG, TAG, "incorrect timing arguments.");
+    mb_master_timing_t *ptiming = calloc(1, sizeof(mb_master_timing_t));
+    MB_RETURN_ON_FALSE((ptiming), ESP_ERR_NO_MEM, TAG, "timing table allocation fail.");
+    ptiming->base_tout_ms = response_tout_ms;
+    CRITICAL_SECTION_INIT(ptiming->lock);
+    *timing = ptiming;
+    return ESP_OK;
+}
+
+void mbc_master_timing_delete(mb_master_timing_t *timing)
+{
+    if (timing) {
+        CRITICAL_SECTION_CLOSE(timing->lock);
+        free(timing);
+    }
+}
+
+esp_err_t mbc_master_timing_check(mb_master_timing_t *timing, uint8_t slave_addr)
+{
+    esp_err_t err = ESP_OK;
+    if (!timing || !slave_addr) {
+        return ESP_OK;
+    }
+    CRITICAL_SECTION(timing->lock) {
+        mb_master_timing_entry_t *entry = mbc_timing_find(timing, slave_addr);
+        if (entry && entry->info.is_offline) {
+            int64_t now_ts = esp_timer_get_time();
+            if (now_ts < entry->probe_ts) {
+                entry->info.rejects++;
+                err = ESP_ERR_TIMEOUT;
+            } else {
+                // Only one probe is passed during the interval, the next is scheduled by its result
+                entry->probe_ts = now_ts + ((int64_t)entry->info.backoff_ms * 1000);
+            }
+        }
+    }
+    return err;
+}
+
+void mbc_master_timing_begin(mb_master_timing_t *timing, mb_port_base_t *port_obj, uint8_t slave_addr)
+{
+    if (!timing || !port_obj || !slave_addr) {
+        return;
+    }
+    uint32_t tout_ms = timing->base_tout_ms;
+    CRITICAL_SECTION(timing->lock) {
+        mb_master_timing_entry_t *entry = mbc_timing_get_entry(timing, slave_addr);
+        tout_ms = mbc_master_timing_get_tout(entry, timing->base_tout_ms);
+        entry->info.response_tout_ms = tout_ms;
+        timing->slave_addr = slave_addr;
+        timing->start_ts = esp_timer_get_time();
+    }
+    if (tout_ms != timing->base_tout_ms) {
+        mb_port_timer_set_response_time(port_obj, tout_ms);
+    }
+}
+
+void mbc_master_timing_end(mb_master_timing_t *timing, mb_port_base_t *port_obj,
+                            uint8_t slave_addr, mb_err_enum_t mb_error)
+{
+    if (!timing || !port_obj || !slave_addr) {
+        return;
+    }
+    int64_t now_ts = esp_timer_get_time();
+    bool is_measured = false;
+    uint32_t latency_us = 0;
+    uint32_t gap_us = 0;
+    uint32_t tx_done_us = 0;
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+    mb_ser_rx_timing_t rx_timing;
+    if (mbc_timing_is_response(mb_error) && mb_port_ser_get_rx_timing(port_obj, &rx_timing)) {
+        latency_us = rx_timing.latency_us;
+        gap_us = rx_timing.gap_max_us;
+        tx_done_us = rx_timing.tx_done_us;
+        is_measured = true;
+    }
+#endif
+    uint32_t tout_ms = timing->base_tout_ms;
+    CRITICAL_SECTION(timing->lock) {
+        mb_master_timing_entry_t *entry = mbc_timing_find(timing, slave_addr);
+        if (entry && (mb_error == MB_ETIMEDOUT)) {
+            // The round trip time of the request without response is not sampled (Karn's algorithm)
+            mbc_master_timing_fail(entry, now_ts);
+        } else if (entry && mbc_timing_is_response(mb_error)) {
+            mbc_master_timing_alive(entry);
+            if (timing->slave_addr == slave_addr) {
+                mbc_master_timing_rtt_update(entry, (uint32_t)(now_ts - timing->start_ts));
+            }
+        }
+        if (entry && is_measured) {
+            entry->info.latency_last_us = latency_us;
+            entry->info.tx_done_last_us = tx_done_us;
+            entry->info.latency_max_us = mbc_timing_decay_max(entry->info.latency_max_us, latency_us);
+            entry->info.gap_max_us = mbc_timing_decay_max(entry->info.gap_max_us, gap_us);
+            entry->info.latency_hist[mbc_timing_hist_bin(latency_us)]++;
+            entry->info.gap_hist[mbc_timing_hist_bin(gap_us)]++;
+        }
+        tout_ms = entry ? entry->info.response_tout_ms : tout_ms;
+        timing->slave_addr = 0;
+    }
+    // Restore the configured timeout for the next request (broadcast or other slave)
+    if (tout_ms != timing->base_tout_ms) {
+        mb_port_timer_set_response_time(port_obj, timing->base_tout_ms);
+    }
+}
+
+esp_err_t mbc_master_timing_get(mb_master_timing_t *timing, uint8_t slave_addr, mb_slave_timing_t *info)
+{
+    MB_RETURN_ON_FALSE((timing), ESP_ERR_NOT_SUPPORTED, TAG, "timing is not measured by the controller.");
+    MB_RETURN_ON_FALSE((info && slave_addr), ESP_ERR_INVALID_ARG, TAG, "incorrect timing arguments.");
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    CRITICAL_SECTION(timing->lock) {
+        mb_master_timing_entry_t *entry = mbc_timing_find(timing, slave_addr);
+        if (entry) {
+            *info = entry->info;
+            err = ESP_OK;
+        }
+    }
+    return err;
+}
@@ -36,9 +36,32 @@ typedef struct mb_descr_entry_s {
     mb_param_access_t access;               /*!< Area access type */
     void *p_data;                           /*!< Instance address for storage area descriptor */
     size_t size;                            /*!< Instance size for area descriptor (bytes) */
+    mb_reg_image_t *image;                  /*!< Double buffered image of the area (NULL - read the area directly) */
+    uint32_t *dirty_map;                    /*!< Bitmap of registers (coils) written since the last read of changes */
+    bool is_dirty;                          /*!< The bitmap has changes not read by application */
     LIST_ENTRY(mb_descr_entry_s) entries;   /*!< The Modbus area descriptor entry */
 } mb_descr_entry_t;
 
+/**
+ * @brief Modbus area descriptor index item
+ */
+typedef struct {
+    uint32_t start;                         /*!< The first register of the area */
+    uint32_t end;                           /*!< The register next to the last register of the area */
+    uint32_t max_end;                       /*!< The maximum end of this and all previous areas in the index */
+    mb_descr_entry_t *descr;                /*!< The area descriptor */
+} mb_descr_index_item_t;
+
+/**
+ * @brief Modbus area descriptors index sorted by start register
+ */
+typedef struct {
+    mb_descr_index_item_t *items;           /*!< The index items sorted by start register */
+    uint32_t count;                         /*!< Number of items in the index */
+    uint32_t capacity;                      /*!< Number of allocated items */
+    bool is_valid;                          /*!< The index is in sync with the descriptor list */
+} mb_descr_index_t;
+
 /**
  * @brief Modbus controller handler structure
  */
@@ -48,7 +71,10 @@ typedef struct {
     TaskHandle_t task_handle;                           /*!< task handle */
     EventGroupHandle_t event_group_handle;              /*!< controller event group */
     QueueHandle_t notification_queue_handle;            /*!< controller notification queue */
+    TaskHandle_t notify_task_handle;                    /*!< task notified about parameter access events */
     LIST_HEAD(mbs_area_descriptors_, mb_descr_entry_s) area_descriptors[MB_PARAM_COUNT]; /*!< register area descriptors */
+    mb_descr_index_t area_index[MB_PARAM_COUNT];        /*!< register area descriptors lookup index */
+    mb_change_log_stats_t change_stats;                 /*!< parameter change log statistics */
 } mb_slave_options_t;
 
 typedef mb_event_group_t (*iface_check_event_fp)(void *, mb_event_group_t);          /*!< Interface method check_event */
@@ -74,6 +100,19 @@ typedef struct
     iface_mbs_set_descriptor_fp set_descriptor;     /*!< Interface method set_descriptor */
 } mbs_controller_iface_t;
 
+/**
+ * @brief Find the register area descriptor which contains the requested registers
+ *
+ * @param[in] ctx context pointer of the initialized modbus interface
+ * @param[in] type type of the register area
+ * @param[in] addr start register of the request (zero based)
+ * @param[in] regs number of registers (bits for coils and discrete inputs) in the request
+ *
+ * @return
+ *     - pointer to the area descriptor, NULL if the registers are not mapped
+ */
+mb_descr_entry_t *mbc_slave_find_reg_descriptor(void *ctx, mb_param_type_t type, uint16_t addr, size_t regs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -94,6 +94,62 @@ static esp_err_t mbc_serial_master_stop(void *ctx)
     return ESP_OK;
 }
 
+#if (MB_MASTER_READ_COALESCING_ENABLED)
+
+// Read the registers within the group of concurrent reads of the same slave.
+// The first caller (leader) sends the merged request when it gets the bus, the callers which
+// joined the group in the meantime get their part of the response. Returns false if no group is available.
+static bool mbc_serial_master_merged_read(void *ctx, mb_param_request_t *request, void *data_ptr, esp_err_t *err)
+{
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(ctx);
+    mbm_controller_iface_t *mbm_controller_iface = MB_MASTER_GET_IFACE(ctx);
+    mb_read_coalesce_t *coalesce = mbm_opts->coalesce;
+    bool is_leader = false;
+
+    int idx = mbc_master_coalesce_join(coalesce, request, &is_leader);
+    if (idx < 0) {
+        return false;
+    }
+
+    if (is_leader) {
+#if (MB_MASTER_READ_COALESCE_WINDOW_MS > 0)
+        // Give the concurrent callers the chance to join the group
+        vTaskDelay(pdMS_TO_TICKS(MB_MASTER_READ_COALESCE_WINDOW_MS));
+#endif
+        esp_err_t result = mbc_master_sched_enter(mbm_opts->sched, false, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+        mb_param_request_t merged;
+        uint16_t *data = mbc_master_coalesce_activate(coalesce, idx, &merged);
+        if (result == ESP_OK) {
+            mb_err_enum_t mb_error = MB_EBUSY;
+            mbm_opts->reg_buffer_ptr = (uint8_t *)data;
+            mbm_opts->reg_buffer_size = merged.reg_size;
+            mbc_master_timing_begin(mbm_opts->timing, mbm_controller_iface->mb_base->port_obj, merged.slave_addr);
+            if (merged.command == MB_FUNC_READ_HOLDING_REGISTER) {
+                mb_error = mbm_rq_read_holding_reg(mbm_controller_iface->mb_base, merged.slave_addr, merged.reg_start,
+                                                   merged.reg_size, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+            } else {
+                mb_error = mbm_rq_read_inp_reg(mbm_controller_iface->mb_base, merged.slave_addr, merged.reg_start,
+                                               merged.reg_size, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+            }
+            mbc_master_timing_end(mbm_opts->timing, mbm_controller_iface->mb_base->port_obj, merged.slave_addr, mb_error);
+            if (mb_error == MB_ENOERR) {
+                mbc_master_cache_store(mbm_opts->cache, &merged, data);
+            }
+            mbc_master_sched_leave(mbm_opts->sched);
+            result = MB_ERR_TO_ESP_ERR(mb_error);
+            ESP_LOGD(TAG, "%s: merged read (%u, %u), returns %s.", __func__,
+                        (unsigned)merged.reg_start, (unsigned)merged.reg_size, esp_err_to_name(result));
+        }
+        mbc_master_coalesce_complete(coalesce, idx, result);
+    }
+    // The leader always completes the group after its wait for the bus and the response,
+    // both are longer than any fixed timeout here, so the callers wait for it without deadline
+    *err = mbc_master_coalesce_leave(coalesce, idx, request, data_ptr, portMAX_DELAY);
+    return true;
+}
+
+#endif
+
 // Modbus controller destroy function
 static esp_err_t mbc_serial_master_delete(void *ctx)
 {
@@ -121,6 +177,19 @@ static esp_err_t mbc_serial_master_delete(void *ctx)
     mbm_opts->event_group_handle = NULL;
     vSemaphoreDelete(mbm_opts->mbm_sema);
     mbm_opts->mbm_sema = NULL;
+    mbc_master_sched_delete(mbm_opts->sched);
+    mbm_opts->sched = NULL;
+    mbc_master_cache_delete(mbm_opts->cache);
+    mbm_opts->cache = NULL;
+#if (MB_MASTER_READ_COALESCING_ENABLED)
+    mbc_master_coalesce_delete(mbm_opts->coalesce);
+#endif
+    mbm_opts->coalesce = NULL;
+    mbc_master_timing_delete(mbm_opts->timing);
+    mbm_opts->timing = NULL;
+    frame_pool_delete(mbm_opts->param_pool);
+    mbm_opts->param_pool = NULL;
+    CRITICAL_SECTION_CLOSE(mbm_opts->param_lock);
     // delete mb_base instance and all its allocations
     mb_error = mbm_iface->mb_base->delete(mbm_iface->mb_base);
     MB_RETURN_ON_FALSE((mb_error == MB_ENOERR), ESP_ERR_INVALID_STATE, TAG,
@@ -163,7 +232,32 @@ static esp_err_t mbc_serial_master_send_request(void *ctx, mb_param_request_t *r
 
     mb_err_enum_t mb_error = MB_EBUSY;
 
-    if (xSemaphoreTake(mbm_opts->mbm_sema, pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS)) == pdTRUE) {
+    // The repeated reads are answered from the cache without the bus access
+    if (mbc_master_cache_read(mbm_opts->cache, request, data_ptr)) {
+        ESP_LOGD(TAG, "%s: the request (%u) is answered from the cache.", __func__, (unsigned)request->command);
+        return ESP_OK;
+    }
+
+    // The offline slave does not take the bus until its probe interval expires
+    if (mbc_master_timing_check(mbm_opts->timing, request->slave_addr) != ESP_OK) {
+        ESP_LOGD(TAG, "%s: the slave %u is offline, request is not sent.", __func__, (unsigned)request->slave_addr);
+        return ESP_ERR_TIMEOUT;
+    }
+
+#if (MB_MASTER_READ_COALESCING_ENABLED)
+    // The overlapped reads of the concurrent callers are sent as one request
+    if (mbm_opts->coalesce && mbc_master_coalesce_is_mergeable(request)) {
+        esp_err_t err = ESP_ERR_INVALID_STATE;
+        if (mbc_serial_master_merged_read(ctx, request, data_ptr, &err)) {
+            return err;
+        }
+    }
+#endif
+
+    // The requests of several tasks share the bus, the busy bus is reported as ESP_ERR_NOT_FINISHED
+    esp_err_t err = mbc_master_sched_enter(mbm_opts->sched, mbc_master_is_write_command(request->command),
+                                           pdMS_TO_TICKS(MB_MAX_RESP_DELAY_MS));
+    if (err == ESP_OK) {
         uint8_t mb_slave_addr = request->slave_addr;
         uint8_t mb_command = request->command;
         uint16_t mb_offset = request->reg_start;
@@ -173,6 +267,9 @@ static esp_err_t mbc_serial_master_send_request(void *ctx, mb_param_request_t *r
         mbm_opts->reg_buffer_ptr = (uint8_t *)data_ptr;
         mbm_opts->reg_buffer_size = mb_size;
 
+        // The response timeout of the slave follows its round trip time
+        mbc_master_timing_begin(mbm_opts->timing, mbm_controller_iface->mb_base->port_obj, mb_slave_addr);
+
         // Calls appropriate request function to send request and waits response
         switch (mb_command)
         {
@@ -262,10 +359,17 @@ static esp_err_t mbc_serial_master_send_request(void *ctx, mb_param_request_t *r
             }
             break;
         }
+        mbc_master_timing_end(mbm_opts->timing, mbm_controller_iface->mb_base->port_obj, mb_slave_addr, mb_error);
+        // Update the cache while the bus is owned, so the concurrent write can not be missed
+        if (mb_error == MB_ENOERR) {
+            mbc_master_cache_store(mbm_opts->cache, request, data_ptr);
+        }
+        mbc_master_cache_invalidate(mbm_opts->cache, request);
+        mbc_master_sched_leave(mbm_opts->sched);
     } else {
-        ESP_LOGD(TAG, "%s:MBC semaphore take fail.", __func__);
+        ESP_LOGD(TAG, "%s: the bus is busy, request is not sent.", __func__);
+        return err;
     }
-    (void)xSemaphoreGive(mbm_opts->mbm_sema);
 
     // Propagate the Modbus errors to higher level
     return MB_ERR_TO_ESP_ERR(mb_error);
@@ -330,12 +434,12 @@ static esp_err_t mbc_serial_master_get_parameter(void *ctx, uint16_t cid, uint8_
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
 
     error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-        // alloc buffer to store parameter data
-        data_ptr = calloc(1, (reg_info.mb_size << 1));
+        // take the scratch buffer to store parameter data
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool);
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -357,7 +461,7 @@ static esp_err_t mbc_serial_master_get_parameter(void *ctx, uint16_t cid, uint8_
             ESP_LOGD(TAG, "%s: Bad response to get cid(%u) = %s",
                         __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     } else {
@@ -377,6 +481,7 @@ static esp_err_t mbc_serial_master_get_parameter_with(void *ctx, uint16_t cid, u
     mb_param_request_t request;
     mb_parameter_descriptor_t reg_info = {0};
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
 
     error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid))
@@ -387,9 +492,8 @@ static esp_err_t mbc_serial_master_get_parameter_with(void *ctx, uint16_t cid, u
                      __FUNCTION__, (int)request.slave_addr, (int)uid, (unsigned)reg_info.cid);
         }
         request.slave_addr = uid; // override the UID
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-        // alloc buffer to store parameter data
-        data_ptr = calloc(1, (reg_info.mb_size << 1));
+        // take the scratch buffer to store parameter data
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool);
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -415,7 +519,7 @@ static esp_err_t mbc_serial_master_get_parameter_with(void *ctx, uint16_t cid, u
             ESP_LOGD(TAG, "%s: Bad response to get cid(%u) = %s",
                      __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     }
@@ -437,11 +541,11 @@ static esp_err_t mbc_serial_master_set_parameter(void *ctx, uint16_t cid, uint8_
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
 
     error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-        data_ptr = calloc(1, (reg_info.mb_size << 1)); // alloc parameter buffer
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool); // take parameter buffer
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -450,7 +554,7 @@ static esp_err_t mbc_serial_master_set_parameter(void *ctx, uint16_t cid, uint8_
                                               reg_info.param_type, reg_info.param_size);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
-            free(data_ptr);
+            frame_buf_free(param_pool, data_ptr);
             return ESP_ERR_INVALID_STATE;
         }
         // Send request to write characteristic data
@@ -462,7 +566,7 @@ static esp_err_t mbc_serial_master_set_parameter(void *ctx, uint16_t cid, uint8_
             ESP_LOGD(TAG, "%s: Bad response to set cid(%u) = %s",
                                     __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     } else {
@@ -483,6 +587,7 @@ static esp_err_t mbc_serial_master_set_parameter_with(void *ctx, uint16_t cid, u
     mb_param_request_t request;
     mb_parameter_descriptor_t reg_info = {0};
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
     error = mbc_serial_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid))
     {
@@ -492,8 +597,7 @@ static esp_err_t mbc_serial_master_set_parameter_with(void *ctx, uint16_t cid, u
                      __FUNCTION__, (int)request.slave_addr, (int)uid, (unsigned)reg_info.cid);
         }
         request.slave_addr = uid; // override the UID
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-        data_ptr = calloc(1, (reg_info.mb_size << 1)); // alloc parameter buffer
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool); // take parameter buffer
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -502,7 +606,7 @@ static esp_err_t mbc_serial_master_set_parameter_with(void *ctx, uint16_t cid, u
                                               reg_info.param_type, reg_info.param_size);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
-            free(data_ptr);
+            frame_buf_free(param_pool, data_ptr);
             return ESP_ERR_INVALID_STATE;
         }
         // Send request to write characteristic data
@@ -517,7 +621,7 @@ static esp_err_t mbc_serial_master_set_parameter_with(void *ctx, uint16_t cid, u
             ESP_LOGD(TAG, "%s: Bad response to set cid(%u) = %s",
                      __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     }
@@ -545,6 +649,24 @@ static void mbc_serial_master_iface_free(void *ctx)
             vEventGroupDelete(mbm_iface->opts.event_group_handle);
             mbm_iface->opts.event_group_handle = NULL;
         }
+        if (mbm_iface->opts.mbm_sema)
+        {
+            vSemaphoreDelete(mbm_iface->opts.mbm_sema);
+            mbm_iface->opts.mbm_sema = NULL;
+        }
+        mbc_master_sched_delete(mbm_iface->opts.sched);
+        mbm_iface->opts.sched = NULL;
+        mbc_master_cache_delete(mbm_iface->opts.cache);
+        mbm_iface->opts.cache = NULL;
+#if (MB_MASTER_READ_COALESCING_ENABLED)
+        mbc_master_coalesce_delete(mbm_iface->opts.coalesce);
+#endif
+        mbm_iface->opts.coalesce = NULL;
+        mbc_master_timing_delete(mbm_iface->opts.timing);
+        mbm_iface->opts.timing = NULL;
+        frame_pool_delete(mbm_iface->opts.param_pool);
+        mbm_iface->opts.param_pool = NULL;
+        CRITICAL_SECTION_CLOSE(mbm_iface->opts.param_lock);
         free(mbm_iface); // free the memory allocated for interface
     }   
 }
@@ -565,6 +687,14 @@ static esp_err_t mbc_serial_master_controller_create(void **ctx)
     // Initialize interface properties
     mb_master_options_t *mbm_opts = &mbm_controller_iface->opts;
     mbm_opts->task_handle = NULL;
+    mbm_opts->event_group_handle = NULL;
+    mbm_opts->mbm_sema = NULL;
+    mbm_opts->sched = NULL;
+    mbm_opts->cache = NULL;
+    mbm_opts->coalesce = NULL;
+    mbm_opts->timing = NULL;
+    mbm_opts->param_pool = NULL;
+    CRITICAL_SECTION_INIT(mbm_opts->param_lock);
 
     // Initialization of active context of the modbus controller
     mbm_opts->event_group_handle = xEventGroupCreate();
@@ -572,6 +702,16 @@ static esp_err_t mbc_serial_master_controller_create(void **ctx)
     mbm_opts->mbm_sema = xSemaphoreCreateBinary();
     MB_GOTO_ON_FALSE((mbm_opts->mbm_sema != NULL), ESP_ERR_NO_MEM, error, TAG, "%s: mbm resource create error.", __func__);
     (void)xSemaphoreGive(mbm_opts->mbm_sema);
+    ret = mbc_master_sched_create(&mbm_opts->sched);
+    MB_GOTO_ON_FALSE((ret == ESP_OK), ret, error, TAG, "%s: mbm scheduler create error.", __func__);
+#if (MB_MASTER_CACHE_ENTRIES > 0)
+    ret = mbc_master_cache_create(&mbm_opts->cache, MB_MASTER_CACHE_ENTRIES);
+    MB_GOTO_ON_FALSE((ret == ESP_OK), ret, error, TAG, "%s: mbm read cache create error.", __func__);
+#endif
+#if (MB_MASTER_READ_COALESCING_ENABLED)
+    ret = mbc_master_coalesce_create(&mbm_opts->coalesce);
+    MB_GOTO_ON_FALSE((ret == ESP_OK), ret, error, TAG, "%s: mbm read groups create error.", __func__);
+#endif
 
     // Create modbus controller task
     status = xTaskCreatePinnedToCore((void *)&mbc_ser_master_task,
@@ -665,6 +805,18 @@ esp_err_t mbc_serial_master_create(mb_communication_info_t *config, void **ctx)
                      "mb object create returns (0x%x).", (int)err);
     mbm_controller_iface->mb_base = (mb_base_t *)inst;
 
+#if (MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED || MB_SERIAL_MEASURED_TIMING_ENABLED)
+    // The round trip time is measured in both modes, the port measures the timing of RTU frames only
+    bool is_timed = (pcomm_info->mode == MB_RTU);
+#if (MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED)
+    is_timed = true;
+#endif
+    if (is_timed) {
+        ret = mbc_master_timing_create(&mbm_opts->timing, mbm_opts->comm_opts.ser_opts.response_tout_ms);
+        MB_GOTO_ON_FALSE((ret == ESP_OK), ret, error, TAG, "%s: mbm timing table create error.", __func__);
+    }
+#endif
+
     const mb_rw_callbacks_t rw_cbs = {
         .reg_input_cb = mbc_reg_input_master_cb,
         .reg_holding_cb = mbc_reg_holding_master_cb,
@@ -325,6 +325,7 @@ static esp_err_t mbc_tcp_master_get_parameter(void *ctx, uint16_t cid, uint8_t *
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
 
     error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
@@ -334,9 +335,8 @@ static esp_err_t mbc_tcp_master_get_parameter(void *ctx, uint16_t cid, uint8_t *
             ESP_LOGW(TAG, "Try to send request for cid #%u with uid = %d, node is disconnected.",
                                 (unsigned)reg_info.cid, (int)request.slave_addr);
         }
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-        // alloc buffer to store parameter data
-        data_ptr = calloc(1, (reg_info.mb_size << 1));
+        // take the scratch buffer to store parameter data
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool);
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -358,7 +358,7 @@ static esp_err_t mbc_tcp_master_get_parameter(void *ctx, uint16_t cid, uint8_t *
             ESP_LOGD(TAG, "%s: Bad response to get cid(%u) = %s",
                         __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     } else {
@@ -379,6 +379,7 @@ static esp_err_t mbc_tcp_master_get_parameter_with(void *ctx, uint16_t cid, uint
     mb_param_request_t request;
     mb_parameter_descriptor_t reg_info = { 0 };
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
 
     error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_READ, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid)) {
@@ -394,9 +395,8 @@ static esp_err_t mbc_tcp_master_get_parameter_with(void *ctx, uint16_t cid, uint
                             __FUNCTION__, (int)request.slave_addr, (int)uid, (unsigned)reg_info.cid);
         }
         request.slave_addr = uid; // override the UID
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-        // alloc buffer to store parameter data
-        data_ptr = calloc(1, (reg_info.mb_size << 1));
+        // take the scratch buffer to store parameter data
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool);
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -418,7 +418,7 @@ static esp_err_t mbc_tcp_master_get_parameter_with(void *ctx, uint16_t cid, uint
             ESP_LOGD(TAG, "%s: Bad response to get cid(%u) = %s",
                         __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     } else {
@@ -439,6 +439,7 @@ static esp_err_t mbc_tcp_master_set_parameter(void *ctx, uint16_t cid, uint8_t *
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
 
     error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid) && (request.slave_addr != MB_SLAVE_ADDR_PLACEHOLDER)) {
@@ -448,8 +449,7 @@ static esp_err_t mbc_tcp_master_set_parameter(void *ctx, uint16_t cid, uint8_t *
             ESP_LOGW(TAG, "Try to send request for cid #%u with uid = %d, node is disconnected.",
                                 (unsigned)reg_info.cid, (int)request.slave_addr);
         }
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-        data_ptr = calloc(1, (reg_info.mb_size << 1)); // alloc parameter buffer
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool); // take parameter buffer
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -458,7 +458,7 @@ static esp_err_t mbc_tcp_master_set_parameter(void *ctx, uint16_t cid, uint8_t *
                                               reg_info.param_type, reg_info.param_size);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
-            free(data_ptr);
+            frame_buf_free(param_pool, data_ptr);
             return ESP_ERR_INVALID_STATE;
         }
         // Send request to write characteristic data
@@ -470,7 +470,7 @@ static esp_err_t mbc_tcp_master_set_parameter(void *ctx, uint16_t cid, uint8_t *
             ESP_LOGD(TAG, "%s: Bad response to set cid(%u) = %s",
                                     __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     } else {
@@ -491,6 +491,7 @@ static esp_err_t mbc_tcp_master_set_parameter_with(void *ctx, uint16_t cid, uint
     mb_param_request_t request ;
     mb_parameter_descriptor_t reg_info = { 0 };
     uint8_t *data_ptr = NULL;
+    frame_pool_t *param_pool = NULL;
 
     error = mbc_tcp_master_set_request(ctx, cid, MB_PARAM_WRITE, &request, &reg_info);
     if ((error == ESP_OK) && (cid == reg_info.cid)) {
@@ -506,9 +507,7 @@ static esp_err_t mbc_tcp_master_set_parameter_with(void *ctx, uint16_t cid, uint
                             __FUNCTION__, (int)request.slave_addr, (int)uid, (unsigned)reg_info.cid);
         }
         request.slave_addr = uid; // override the UID
-        MB_MASTER_ASSERT(xPortGetFreeHeapSize() > (reg_info.mb_size << 1));
-
-        data_ptr = calloc(1, (reg_info.mb_size << 1)); // alloc parameter buffer
+        data_ptr = mbc_master_param_buf_alloc(MB_MASTER_GET_OPTS(ctx), reg_info.mb_size, &param_pool); // take parameter buffer
         if (!data_ptr) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -517,7 +516,7 @@ static esp_err_t mbc_tcp_master_set_parameter_with(void *ctx, uint16_t cid, uint
                                               reg_info.param_type, reg_info.param_size);
         if (error != ESP_OK) {
             ESP_LOGE(TAG, "fail to set parameter data.");
-            free(data_ptr);
+            frame_buf_free(param_pool, data_ptr);
             return ESP_ERR_INVALID_STATE;
         }
         // Send request to write characteristic data
@@ -529,7 +528,7 @@ static esp_err_t mbc_tcp_master_set_parameter_with(void *ctx, uint16_t cid, uint
             ESP_LOGD(TAG, "%s: Bad response to set cid(%u) = %s",
                                     __FUNCTION__, (unsigned)reg_info.cid, (char *)esp_err_to_name(error));
         }
-        free(data_ptr);
+        frame_buf_free(param_pool, data_ptr);
         // Set the type of parameter found in the table
         *type = reg_info.param_type;
     } else {
@@ -565,6 +564,9 @@ static esp_err_t mbc_tcp_master_delete(void *ctx)
     mbm_opts->event_group_handle = NULL;
     vSemaphoreDelete(mbm_opts->mbm_sema);
     mbm_opts->mbm_sema = NULL;
+    frame_pool_delete(mbm_opts->param_pool);
+    mbm_opts->param_pool = NULL;
+    CRITICAL_SECTION_CLOSE(mbm_opts->param_lock);
     mb_error = mbm_iface->mb_base->delete(mbm_iface->mb_base);
     MB_RETURN_ON_FALSE((mb_error == MB_ENOERR), ESP_ERR_INVALID_STATE, TAG,
                         "mb stack delete failure, returned (0x%x).", (unsigned)mb_error);
@@ -587,6 +589,12 @@ esp_err_t mbc_tcp_master_controller_create(void ** ctx)
     // Initialize interface properties
     mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(mbm_controller_iface);
     mbm_opts->task_handle = NULL;
+    mbm_opts->sched = NULL;
+    mbm_opts->cache = NULL;
+    mbm_opts->coalesce = NULL;
+    mbm_opts->timing = NULL;
+    mbm_opts->param_pool = NULL;
+    CRITICAL_SECTION_INIT(mbm_opts->param_lock);
 
     // Initialization of active context of the modbus controller
     BaseType_t status = 0;
@@ -635,6 +643,7 @@ error:
             vEventGroupDelete(mbm_controller_iface->opts.event_group_handle);
             mbm_controller_iface->opts.event_group_handle = NULL;
         }
+        CRITICAL_SECTION_CLOSE(mbm_controller_iface->opts.param_lock);
     }
     free(mbm_controller_iface); // free the memory allocated
     ctx = NULL;
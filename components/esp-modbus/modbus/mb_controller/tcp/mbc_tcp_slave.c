@@ -154,6 +154,7 @@ esp_err_t mbc_tcp_slave_controller_create(void ** ctx)
     mb_slave_options_t *mbs_opts = &mbs_controller_iface->opts;
     mbs_opts->port_type = MB_PORT_TCP_SLAVE; // set interface port type
     mbs_opts->task_handle = NULL;
+    mbs_opts->notify_task_handle = NULL;
 
     // Initialization of active context of the Modbus controller
     BaseType_t status = 0;
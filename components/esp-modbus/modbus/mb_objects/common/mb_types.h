@@ -101,6 +101,10 @@ typedef enum mb_exception_enum
 
 typedef mb_exception_t (*mb_fn_handler_fp)(void *, uint8_t *frame_ptr, uint16_t *len_buf);
 
+// The handler to forward the request addressed to another unit (gateway), it gets the request PDU
+// in the frame buffer and must place the response PDU of up to MB_PDU_SIZE_MAX bytes into the same buffer
+typedef mb_exception_t (*mb_fwd_handler_fp)(void *arg, uint8_t uid, uint8_t *frame_ptr, uint16_t *len_buf);
+
 /*! \ingroup modbus
  * \brief Error event type
  */
@@ -122,6 +126,22 @@ typedef struct mb_event_s {
     uint64_t get_ts;            /*!< timestamp of event receved */
 } mb_event_t;
 
+/*! \ingroup modbus
+ * \brief Slave transaction timing statistics.
+ *
+ * The transaction time is measured from the moment the received frame is passed
+ * to the stack by the port until the transaction is completed (the response is sent).
+ */
+typedef struct mb_trans_stats_s {
+    uint32_t count;             /*!< number of completed transactions */
+    uint32_t errors;            /*!< number of transactions completed with error */
+    uint32_t last_us;           /*!< processing time of the last transaction, us */
+    uint32_t min_us;            /*!< minimal transaction processing time, us */
+    uint32_t max_us;            /*!< maximal transaction processing time, us */
+    uint64_t total_us;          /*!< sum of processing times of all transactions, us */
+    uint32_t wait_max_us;       /*!< maximal time the received frame waits in the event queue, us */
+} mb_trans_stats_t;
+
 /*! \ingroup modbus
  * \brief Errorcodes used by all function in the protocol stack.
  */
@@ -102,6 +102,140 @@ uint8_t mb_util_get_bits(uint8_t *byte_buf, uint16_t bit_offset, uint8_t but_num
     return (uint8_t) word_buf;
 }
 
+/* Read 32 bits starting at the bit offset. Only the bytes containing
+ * the bits are accessed. */
+static inline uint32_t mb_util_load_bits32(const uint8_t *byte_buf, uint32_t bit_offset)
+{
+    const uint8_t *byte_ptr = &byte_buf[bit_offset / BITS_uint8_t];
+    uint32_t pre_bits_num = bit_offset % BITS_uint8_t;
+    uint32_t value = (uint32_t)byte_ptr[0] | ((uint32_t)byte_ptr[1] << 8)
+                        | ((uint32_t)byte_ptr[2] << 16) | ((uint32_t)byte_ptr[3] << 24);
+    if (pre_bits_num) {
+        value = (value >> pre_bits_num) | ((uint32_t)byte_ptr[4] << (32 - pre_bits_num));
+    }
+    return value;
+}
+
+/* Read up to 8 bits starting at the bit offset. */
+static inline uint8_t mb_util_load_bits8(const uint8_t *byte_buf, uint32_t bit_offset, uint32_t but_num)
+{
+    const uint8_t *byte_ptr = &byte_buf[bit_offset / BITS_uint8_t];
+    uint32_t pre_bits_num = bit_offset % BITS_uint8_t;
+    uint32_t value = (uint32_t)byte_ptr[0] >> pre_bits_num;
+    if ((pre_bits_num + but_num) > BITS_uint8_t) {
+        value |= (uint32_t)byte_ptr[1] << (BITS_uint8_t - pre_bits_num);
+    }
+    return (uint8_t)(value & ((1U << but_num) - 1));
+}
+
+/* Write up to 8 bits starting at the bit offset, the other bits are kept. */
+static inline void mb_util_store_bits8(uint8_t *byte_buf, uint32_t bit_offset, uint32_t but_num, uint8_t value)
+{
+    uint8_t *byte_ptr = &byte_buf[bit_offset / BITS_uint8_t];
+    uint32_t pre_bits_num = bit_offset % BITS_uint8_t;
+    uint32_t msk = ((1U << but_num) - 1) << pre_bits_num;
+    uint32_t us_val = (uint32_t)value << pre_bits_num;
+    byte_ptr[0] = (uint8_t)((byte_ptr[0] & ~msk) | (us_val & msk));
+    if ((pre_bits_num + but_num) > BITS_uint8_t) {
+        byte_ptr[1] = (uint8_t)((byte_ptr[1] & ~(msk >> 8)) | ((us_val & msk) >> 8));
+    }
+}
+
+void mb_util_copy_bits(uint8_t *dst_buf, uint16_t dst_offset, const uint8_t *src_buf, uint16_t src_offset, uint16_t bit_num)
+{
+    uint32_t dst_bit = dst_offset;
+    uint32_t src_bit = src_offset;
+    uint32_t bits_left = bit_num;
+    uint32_t but_num;
+
+    /* Copy the head bits up to the byte boundary of destination. */
+    if (bits_left && (dst_bit % BITS_uint8_t)) {
+        but_num = BITS_uint8_t - (dst_bit % BITS_uint8_t);
+        but_num = (but_num < bits_left) ? but_num : bits_left;
+        mb_util_store_bits8(dst_buf, dst_bit, but_num, mb_util_load_bits8(src_buf, src_bit, but_num));
+        dst_bit += but_num;
+        src_bit += but_num;
+        bits_left -= but_num;
+    }
+
+    uint8_t *dst_ptr = &dst_buf[dst_bit / BITS_uint8_t];
+    if (!(src_bit % BITS_uint8_t)) {
+        /* Both buffers are byte aligned, copy the whole bytes. */
+        memcpy(dst_ptr, &src_buf[src_bit / BITS_uint8_t], bits_left / BITS_uint8_t);
+        dst_ptr += bits_left / BITS_uint8_t;
+        src_bit += bits_left & ~(BITS_uint8_t - 1);
+        bits_left %= BITS_uint8_t;
+    } else {
+        /* Shift and mask 32 bits at once into the aligned destination. */
+        for (; bits_left >= 32; bits_left -= 32, src_bit += 32) {
+            uint32_t value = mb_util_load_bits32(src_buf, src_bit);
+            *dst_ptr++ = (uint8_t)value;
+            *dst_ptr++ = (uint8_t)(value >> 8);
+            *dst_ptr++ = (uint8_t)(value >> 16);
+            *dst_ptr++ = (uint8_t)(value >> 24);
+        }
+        for (; bits_left >= BITS_uint8_t; bits_left -= BITS_uint8_t, src_bit += BITS_uint8_t) {
+            *dst_ptr++ = mb_util_load_bits8(src_buf, src_bit, BITS_uint8_t);
+        }
+    }
+
+    /* Copy the tail bits, the rest of the last destination byte is kept. */
+    if (bits_left) {
+        mb_util_store_bits8(dst_ptr, 0, bits_left, mb_util_load_bits8(src_buf, src_bit, bits_left));
+    }
+}
+
+typedef uint32_t __attribute__((__may_alias__)) mb_util_word_t;
+
+/* Swap the bytes in each 16 bit half of the word. */
+#define MB_UTIL_SWAP_REGS32(value) ((((value) & 0x00FF00FFUL) << 8) | (((value) >> 8) & 0x00FF00FFUL))
+
+void mb_util_copy_regs(uint8_t *dst_buf, const uint8_t *src_buf, uint16_t reg_num)
+{
+    /* The word copy is possible when both buffers have the same alignment,
+     * copy one register to align them if needed. */
+    if (reg_num && !(((uintptr_t)dst_buf ^ (uintptr_t)src_buf) & 3) && ((uintptr_t)dst_buf & 2)) {
+        dst_buf[0] = src_buf[1];
+        dst_buf[1] = src_buf[0];
+        dst_buf += 2;
+        src_buf += 2;
+        reg_num--;
+    }
+    if (!(((uintptr_t)dst_buf | (uintptr_t)src_buf) & 3)) {
+        mb_util_word_t *dst_word = (mb_util_word_t *)dst_buf;
+        const mb_util_word_t *src_word = (const mb_util_word_t *)src_buf;
+        for (; reg_num >= 4; reg_num -= 4) {
+            uint32_t value0 = *src_word++;
+            uint32_t value1 = *src_word++;
+            *dst_word++ = MB_UTIL_SWAP_REGS32(value0);
+            *dst_word++ = MB_UTIL_SWAP_REGS32(value1);
+        }
+        for (; reg_num >= 2; reg_num -= 2) {
+            uint32_t value = *src_word++;
+            *dst_word++ = MB_UTIL_SWAP_REGS32(value);
+        }
+        dst_buf = (uint8_t *)dst_word;
+        src_buf = (const uint8_t *)src_word;
+    } else {
+        for (; reg_num >= 2; reg_num -= 2) {
+            uint8_t byte0 = src_buf[0];
+            uint8_t byte1 = src_buf[1];
+            uint8_t byte2 = src_buf[2];
+            uint8_t byte3 = src_buf[3];
+            dst_buf[0] = byte1;
+            dst_buf[1] = byte0;
+            dst_buf[2] = byte3;
+            dst_buf[3] = byte2;
+            dst_buf += 4;
+            src_buf += 4;
+        }
+    }
+    if (reg_num) {
+        dst_buf[0] = src_buf[1];
+        dst_buf[1] = src_buf[0];
+    }
+}
+
 mb_exception_t mb_error_to_exception(mb_err_enum_t error_code)
 {
     mb_exception_t    status;
@@ -71,6 +71,34 @@ extern "C" {
  */
 #define MB_TCP_UID_ENABLED                      (CONFIG_FMB_TCP_UID_ENABLED)
 
+/*! \brief The option enables the slave to execute the request and send the response in one poll step.
+ */
+#define MB_SLAVE_FAST_PATH_ENABLED              (CONFIG_FMB_SLAVE_FAST_PATH_ENABLED)
+
+/*! \brief The number of bytes processed per step of the RTU CRC16 calculation.
+ *
+ * The value 1 uses two 256 byte tables, 4 and 8 use the slice tables of 2 and 4 Kbytes.
+ */
+#if CONFIG_FMB_SERIAL_CRC16_SLICES
+#define MB_CRC16_SLICES                         (CONFIG_FMB_SERIAL_CRC16_SLICES)
+#else
+#define MB_CRC16_SLICES                         (1)
+#endif
+
+/*! \brief The option enables the measured timing of the RTU frames.
+ *
+ * The serial port measures the response start and the gaps inside the received frames,
+ * tolerates the learned gaps and the serial master keeps the timing histograms per slave.
+ */
+#define MB_SERIAL_MEASURED_TIMING_ENABLED       (CONFIG_FMB_SERIAL_MEASURED_TIMING)
+
+/*! \brief The option enables the RS-485 half duplex transmit path of the serial port.
+ *
+ * The UART drives the DE pin of transceiver by hardware and the response timeout of the master
+ * is counted from the calculated end of the request.
+ */
+#define MB_SERIAL_RS485_HALF_DUPLEX_ENABLED     (CONFIG_FMB_SERIAL_RS485_HALF_DUPLEX)
+
 /*! \brief The option defines the queue size for event queue.
  */
 #define MB_EVENT_QUEUE_SIZE                     (CONFIG_FMB_QUEUE_LENGTH)
@@ -27,6 +27,15 @@ mb_err_enum_t mbs_delete_handler(mb_base_t *inst, uint8_t func_code);
 // The helper function to get count of handlers for slave
 mb_err_enum_t mbs_get_handler_count(mb_base_t *inst, uint16_t *count);
 
+// The helper function to set the handler forwarding the requests addressed to other units
+mb_err_enum_t mbs_set_forward_handler(mb_base_t *inst, mb_fwd_handler_fp handler, void *arg);
+
+// The helper function to get the transaction timing statistics of slave
+mb_err_enum_t mbs_get_trans_stats(mb_base_t *inst, mb_trans_stats_t *stats);
+
+// The helper function to reset the transaction timing statistics of slave
+mb_err_enum_t mbs_reset_trans_stats(mb_base_t *inst);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -100,6 +100,55 @@ void mb_util_set_bits(uint8_t *byte_buf, uint16_t bit_offset, uint8_t but_num, u
  */
 uint8_t mb_util_get_bits(uint8_t *byte_buf, uint16_t bit_offset, uint8_t but_num);
 
+/*! \brief Function to copy the block of bits between byte buffers.
+ *
+ * This function copies any number of bits from one bitfield to another
+ * one. The bits are copied by whole bytes when both bit offsets are
+ * aligned the same way and by 32 bit words (shift and mask) otherwise,
+ * only the partial bytes at the start and the end of the block are
+ * updated by read-modify-write. The bits of destination outside the block
+ * are not changed. Unlike mb_util_set_bits() the function never accesses
+ * the bytes which do not contain the copied bits.
+ *
+ * \param dst_buf A buffer where the bits are copied to.
+ * \param dst_offset The bit offset of the first bit in the destination.
+ * \param src_buf A buffer where the bits are copied from.
+ * \param src_offset The bit offset of the first bit in the source.
+ * \param bit_num Number of bits to copy. The buffers must not overlap.
+ *
+ * \code
+ * uint8_t ucCoils[250];
+ * uint8_t ucFrame[250];
+ *
+ * // Copy 2000 coils starting at the coil 3 into the frame.
+ * mb_util_copy_bits(ucFrame, 0, ucCoils, 3, 2000);
+ * \endcode
+ */
+void mb_util_copy_bits(uint8_t *dst_buf, uint16_t dst_offset, const uint8_t *src_buf, uint16_t src_offset, uint16_t bit_num);
+
+/*! \brief Function to copy the registers with swap of bytes.
+ *
+ * This function copies the 16 bit registers between the Modbus frame
+ * (big endian) and the register storage (little endian). The bytes of each
+ * register are swapped, so the same function is used for both directions.
+ * Two registers are swapped at once by 32 bit word operations when the
+ * buffers have the same alignment, the bytes are moved in pairs of
+ * registers otherwise.
+ *
+ * \param dst_buf A buffer where the registers are copied to.
+ * \param src_buf A buffer where the registers are copied from.
+ * \param reg_num Number of registers to copy. The buffers must not overlap.
+ *
+ * \code
+ * uint16_t usRegs[125];
+ * uint8_t ucFrame[250];
+ *
+ * // Copy 125 holding registers into the response frame.
+ * mb_util_copy_regs(ucFrame, (uint8_t *)usRegs, 125);
+ * \endcode
+ */
+void mb_util_copy_regs(uint8_t *dst_buf, const uint8_t *src_buf, uint16_t reg_num);
+
 #if MB_FUNC_OTHER_REP_SLAVEID_ENABLED
 /*! \brief Standard function to set slave ID in the modbus object.
  *
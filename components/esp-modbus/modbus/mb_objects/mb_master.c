@@ -40,6 +40,9 @@ typedef struct
     uint8_t master_dst_addr;
     uint64_t curr_trans_id;
     handler_descriptor_t handler_descriptor;
+    uint8_t *raw_rsp_buf;
+    uint16_t raw_rsp_size;
+    uint16_t *raw_rsp_len;
 } mbm_object_t;
 
 mb_err_enum_t mbm_tcp_create(mb_tcp_opts_t *tcp_opts, void **in_out_obj);
@@ -495,6 +498,31 @@ static uint8_t mbm_get_dest_addr(mb_base_t *inst)
     return mbm_obj->master_dst_addr;
 }
 
+// Sends the request PDU as is and returns the response PDU of the slave (normal or exception frame)
+mb_err_enum_t mbm_rq_raw(mb_base_t *inst, uint8_t snd_addr, const uint8_t *pdu, uint16_t pdu_len,
+                            uint8_t *rsp_buf, uint16_t rsp_size, uint16_t *rsp_len, uint32_t tout)
+{
+    MB_RETURN_ON_FALSE((inst && pdu && rsp_buf && rsp_len), MB_EINVAL, TAG, "raw request wrong arguments");
+    MB_RETURN_ON_FALSE((snd_addr && (snd_addr <= MB_ADDRESS_MAX) && pdu_len && (pdu_len <= MB_PDU_SIZE_MAX)),
+                        MB_EINVAL, TAG, "raw request incorrect address or length");
+    mbm_object_t *mbm_obj = MB_GET_OBJ_CTX(inst, mbm_object_t, base);
+    uint8_t *mb_frame_ptr = NULL;
+    if (!mb_port_event_res_take(inst->port_obj, tout)) {
+        return MB_EBUSY;
+    }
+    inst->get_send_buf(inst, &mb_frame_ptr);
+    inst->set_dest_addr(inst, snd_addr);
+    memcpy(&mb_frame_ptr[MB_PDU_FUNC_OFF], pdu, pdu_len);
+    inst->set_send_len(inst, pdu_len);
+    *rsp_len = 0;
+    // The response buffer is released by the poll before the request is finished
+    mbm_obj->raw_rsp_buf = rsp_buf;
+    mbm_obj->raw_rsp_size = rsp_size;
+    mbm_obj->raw_rsp_len = rsp_len;
+    (void)mb_port_event_post(inst->port_obj, EVENT(EV_FRAME_TRANSMIT | EV_TRANS_START));
+    return mb_port_event_wait_req_finish(inst->port_obj);
+}
+
 void mbm_error_cb_respond_timeout(mb_base_t *inst, uint8_t dest_addr, const uint8_t *pdu_data, uint16_t pdu_length)
 {
     mb_port_event_set_resp_flag(MB_BASE2PORT(inst), EV_ERROR_RESPOND_TIMEOUT);
@@ -620,6 +648,15 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                             mbm_set_dest_addr(inst, j);
                             exception = mbm_check_invoke_handler(inst, mbm_obj->func_code, mbm_obj->rcv_frame, &length);
                         }
+                    } else if (mbm_obj->raw_rsp_len) {
+                        // The raw request, return the response PDU to the caller without handling
+                        if (mbm_obj->pdu_rcv_len <= mbm_obj->raw_rsp_size) {
+                            memcpy(mbm_obj->raw_rsp_buf, mbm_obj->rcv_frame, mbm_obj->pdu_rcv_len);
+                            *mbm_obj->raw_rsp_len = mbm_obj->pdu_rcv_len;
+                            exception = MB_EX_NONE;
+                        } else {
+                            exception = MB_EX_SLAVE_DEVICE_FAILURE;
+                        }
                     } else {
                         ESP_LOGD(TAG, MB_OBJ_FMT": function (0x%x), invoke handler.", MB_OBJ_PARENT(inst), (int)mbm_obj->func_code);
                         exception = mbm_check_invoke_handler(inst, mbm_obj->func_code, mbm_obj->rcv_frame, &mbm_obj->pdu_rcv_len);
@@ -672,6 +709,9 @@ mb_err_enum_t mbm_poll(mb_base_t *inst)
                         break;
                 }
                 mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_INIT);
+                mbm_obj->raw_rsp_buf = NULL;
+                mbm_obj->raw_rsp_size = 0;
+                mbm_obj->raw_rsp_len = NULL;
                 uint64_t time_div_us = mbm_obj->curr_trans_id ? (event.get_ts - mbm_obj->curr_trans_id) : 0;
                 mbm_obj->curr_trans_id = 0;
                 ESP_LOGD(TAG, MB_OBJ_FMT", transaction processing time(us) = %" PRId64, MB_OBJ_PARENT(inst), time_div_us);
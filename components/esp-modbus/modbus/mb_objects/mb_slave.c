@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include "esp_timer.h"
 #include "mb_config.h"
 #include "mb_common.h"
 #include "mb_proto.h"
@@ -36,8 +37,12 @@ typedef struct
     uint8_t func_code;
     uint8_t rcv_addr;
     uint64_t curr_trans_id;
+    uint32_t trans_wait_us;
+    mb_trans_stats_t trans_stats;
     volatile uint16_t *pdu_snd_len;
     handler_descriptor_t handler_descriptor;
+    mb_fwd_handler_fp fwd_handler;
+    void *fwd_arg;
 } mbs_object_t;
 
 mb_err_enum_t mbs_delete(mb_base_t *inst);
@@ -89,6 +94,52 @@ mb_err_enum_t mbs_get_handler_count(mb_base_t *inst, uint16_t *count)
     return MB_ENOERR;
 }
 
+mb_err_enum_t mbs_get_trans_stats(mb_base_t *inst, mb_trans_stats_t *stats)
+{
+    MB_RETURN_ON_FALSE((stats && inst), MB_EINVAL, TAG, "get transaction stats wrong arguments");
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    CRITICAL_SECTION(inst->lock) {
+        *stats = mbs_obj->trans_stats;
+    }
+    return MB_ENOERR;
+}
+
+mb_err_enum_t mbs_reset_trans_stats(mb_base_t *inst)
+{
+    MB_RETURN_ON_FALSE(inst, MB_EINVAL, TAG, "reset transaction stats wrong arguments");
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    CRITICAL_SECTION(inst->lock) {
+        memset(&mbs_obj->trans_stats, 0, sizeof(mb_trans_stats_t));
+    }
+    return MB_ENOERR;
+}
+
+mb_err_enum_t mbs_set_forward_handler(mb_base_t *inst, mb_fwd_handler_fp handler, void *arg)
+{
+    MB_RETURN_ON_FALSE(inst, MB_EINVAL, TAG, "set forward handler wrong arguments");
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    CRITICAL_SECTION(inst->lock) {
+        mbs_obj->fwd_handler = handler;
+        mbs_obj->fwd_arg = handler ? arg : NULL;
+    }
+    return MB_ENOERR;
+}
+
+// Returns the forward handler if the request is addressed to another unit behind this slave (gateway)
+static mb_fwd_handler_fp mbs_get_forward_handler(mb_base_t *inst, uint8_t addr, void **arg)
+{
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    mb_fwd_handler_fp handler = NULL;
+    if ((addr == mbs_obj->mb_address) || (addr == MB_ADDRESS_BROADCAST) || (addr > MB_ADDRESS_MAX)) {
+        return NULL;
+    }
+    CRITICAL_SECTION(inst->lock) {
+        handler = mbs_obj->fwd_handler;
+        *arg = mbs_obj->fwd_arg;
+    }
+    return handler;
+}
+
 static mb_exception_t mbs_check_invoke_handler(mb_base_t *inst, uint8_t func_code, uint8_t *buf, uint16_t *len)
 {
     mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
@@ -447,15 +498,112 @@ void mbs_error_cb_request_success(mb_base_t *inst, uint8_t dest_address, const u
     ESP_LOG_BUFFER_HEX_LEVEL(__func__, (void *)pdu_data, pdu_length, ESP_LOG_DEBUG);
 }
 
+// Update the timing statistics on completion of the current transaction
+static void mbs_update_trans_stats(mb_base_t *inst, uint64_t end_ts, bool is_error)
+{
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    if (!mbs_obj->curr_trans_id) {
+        return;
+    }
+    uint64_t time_div_us = (end_ts > mbs_obj->curr_trans_id) ? (end_ts - mbs_obj->curr_trans_id) : 0;
+    uint32_t time_us = (time_div_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)time_div_us;
+    mbs_obj->curr_trans_id = 0;
+    CRITICAL_SECTION(inst->lock) {
+        mb_trans_stats_t *stats = &mbs_obj->trans_stats;
+        stats->count++;
+        stats->errors += is_error ? 1 : 0;
+        stats->last_us = time_us;
+        stats->min_us = ((stats->count == 1) || (time_us < stats->min_us)) ? time_us : stats->min_us;
+        stats->max_us = (time_us > stats->max_us) ? time_us : stats->max_us;
+        stats->total_us += time_us;
+        stats->wait_max_us = (mbs_obj->trans_wait_us > stats->wait_max_us) ? mbs_obj->trans_wait_us : stats->wait_max_us;
+    }
+    ESP_LOGD(TAG, MB_OBJ_FMT", transaction processing time(us) = %" PRIu32 ", wait time(us) = %" PRIu32,
+                MB_OBJ_PARENT(inst), time_us, mbs_obj->trans_wait_us);
+}
+
+// Execute the received request and send the response if it is required
+static mb_err_enum_t mbs_execute_request(mb_base_t *inst, bool *is_replied)
+{
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    mb_err_enum_t status = MB_ENOERR;
+    mb_exception_t exception;
+    void *fwd_arg = NULL;
+
+    *is_replied = false;
+    mbs_obj->func_code = mbs_obj->frame[MB_PDU_FUNC_OFF];
+    mb_fwd_handler_fp fwd_handler = mbs_get_forward_handler(inst, mbs_obj->rcv_addr, &fwd_arg);
+    if (fwd_handler) {
+        // The response of the target unit (including its exception frame) is returned as is
+        exception = fwd_handler(fwd_arg, mbs_obj->rcv_addr, mbs_obj->frame, &mbs_obj->length);
+        ESP_LOGD(TAG, MB_OBJ_FMT": function (0x%x), forwarded to unit %u.",
+                    MB_OBJ_PARENT(inst), (int)mbs_obj->func_code, (unsigned)mbs_obj->rcv_addr);
+    } else {
+        exception = mbs_check_invoke_handler(inst, mbs_obj->func_code, mbs_obj->frame, &mbs_obj->length);
+    }
+    // If the request was not sent to the broadcast address, return a reply.
+    if ((mbs_obj->rcv_addr != MB_ADDRESS_BROADCAST) || (mbs_obj->cur_mode == MB_TCP)) {
+        if (exception != MB_EX_NONE) {
+            // An exception occurred. Build an error frame.
+            mbs_obj->length = 0;
+            mbs_obj->frame[mbs_obj->length++] = (uint8_t)(mbs_obj->func_code | MB_FUNC_ERROR);
+            mbs_obj->frame[mbs_obj->length++] = exception;
+        }
+        if ((mbs_obj->cur_mode == MB_ASCII) && MB_ASCII_TIMEOUT_WAIT_BEFORE_SEND_MS) {
+            mb_port_timer_delay(MB_OBJ(inst->port_obj), MB_ASCII_TIMEOUT_WAIT_BEFORE_SEND_MS);
+        }
+        MB_PRT_BUF(inst->descr.parent_name, ":MB_SEND", (void *)mbs_obj->frame,
+                                        (uint16_t)mbs_obj->length, ESP_LOG_DEBUG);
+        status = MB_OBJ(inst->transp_obj)->frm_send(inst->transp_obj, mbs_obj->rcv_addr, mbs_obj->frame, mbs_obj->length);
+        if (status != MB_ENOERR) {
+            ESP_LOGE(TAG, MB_OBJ_FMT": frame send error: %d.", MB_OBJ_PARENT(inst), (int)status);
+        }
+        *is_replied = true;
+    }
+    return status;
+}
+
+// Stop the timer, execute the error process callback and complete the current transaction
+static void mbs_complete_transaction(mb_base_t *inst, uint64_t end_ts)
+{
+    mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);
+    mb_port_timer_disable(MB_OBJ(inst->port_obj));
+    mb_err_event_t error_type = mb_port_event_get_err_type(MB_OBJ(inst->port_obj));
+    switch (error_type)
+    {
+        case EV_ERROR_RESPOND_TIMEOUT:
+            mbs_error_cb_respond_timeout(inst, mbs_obj->rcv_addr,
+                                        mbs_obj->frame, mbs_obj->length);
+            break;
+        case EV_ERROR_RECEIVE_DATA:
+            mbs_error_cb_receive_data(inst, mbs_obj->rcv_addr,
+                                        mbs_obj->frame, mbs_obj->length);
+            break;
+        case EV_ERROR_EXECUTE_FUNCTION:
+            mbs_error_cb_execute_function(inst, mbs_obj->rcv_addr,
+                                        mbs_obj->frame, mbs_obj->length);
+            break;
+        case EV_ERROR_OK:
+            mbs_error_cb_request_success(inst, mbs_obj->rcv_addr,
+                                        mbs_obj->frame, mbs_obj->length);
+            break;
+        default:
+            ESP_LOGE(TAG, MB_OBJ_FMT", incorrect error type = %d.", MB_OBJ_PARENT(inst), (int)error_type);
+            break;
+    }
+    mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_INIT);
+    mbs_update_trans_stats(inst, end_ts, (error_type != EV_ERROR_OK));
+    mb_port_event_res_release(MB_OBJ(inst->port_obj));
+}
+
 mb_err_enum_t mbs_poll(mb_base_t *inst)
 {
     mbs_object_t *mbs_obj = MB_GET_OBJ_CTX(inst, mbs_object_t, base);;
 
-    mb_exception_t exception;
     mb_err_enum_t status = MB_ENOERR;
     mb_event_t event;
     mb_err_event_t error_type = EV_ERROR_INIT;
-    uint64_t time_div_us = 0;
+    bool is_replied = false;
 
     /* Check if the protocol stack is ready. */
     if (mbs_obj->cur_state != STATE_ENABLED) {
@@ -472,48 +620,57 @@ mb_err_enum_t mbs_poll(mb_base_t *inst)
                 
             case EV_FRAME_RECEIVED:
                 ESP_LOGD(TAG, MB_OBJ_FMT":EV_FRAME_RECEIVED", MB_OBJ_PARENT(inst));
+                // The transaction time is counted from the moment the frame is passed by the port
+                mbs_obj->curr_trans_id = event.post_ts;
+                mbs_obj->trans_wait_us = (uint32_t)(event.get_ts - event.post_ts);
                 mbs_obj->length = event.length;
                 status = MB_OBJ(inst->transp_obj)->frm_rcv(inst->transp_obj, &mbs_obj->rcv_addr, &mbs_obj->frame, &mbs_obj->length);
                 // Check if the frame is for us. If not ,send an error process event.
                 if (status == MB_ENOERR) {
                     // Check if the frame is for us. If not ignore the frame.
+                    // The frames for other units are accepted only when the forward handler is set (gateway)
                     if((mbs_obj->rcv_addr == mbs_obj->mb_address) || (mbs_obj->rcv_addr == MB_ADDRESS_BROADCAST)
-                            || (mbs_obj->rcv_addr == MB_TCP_PSEUDO_ADDRESS)) {
-                        mbs_obj->curr_trans_id = event.get_ts;
-                        (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_EXECUTE | EV_TRANS_START));
+                            || (mbs_obj->rcv_addr == MB_TCP_PSEUDO_ADDRESS)
+                            || (mbs_obj->fwd_handler && (mbs_obj->rcv_addr <= MB_ADDRESS_MAX))) {
                         MB_PRT_BUF(inst->descr.parent_name, ":MB_RECV",
                                     &mbs_obj->frame[MB_PDU_FUNC_OFF], mbs_obj->length, ESP_LOG_DEBUG);
+#if MB_SLAVE_FAST_PATH_ENABLED
+                        // Execute the request, send the response and complete the transaction in one step
+                        status = mbs_execute_request(inst, &is_replied);
+                        if (!is_replied) {
+                            // No response for broadcast request
+                            mbs_update_trans_stats(inst, esp_timer_get_time(), false);
+                        } else if (mb_port_event_get_err_type(MB_OBJ(inst->port_obj)) == EV_ERROR_INIT) {
+                            mb_port_event_set_err_type(MB_OBJ(inst->port_obj),
+                                                        (status == MB_ENOERR) ? EV_ERROR_OK : EV_ERROR_RESPOND_TIMEOUT);
+                            mbs_complete_transaction(inst, esp_timer_get_time());
+                        } else {
+                            // The error is already set by the port, it posts the error process event itself
+                            ESP_LOGD(TAG, MB_OBJ_FMT", incorrect initial error type.", MB_OBJ_PARENT(inst));
+                        }
+#else
+                        (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_EXECUTE | EV_TRANS_START));
+#endif
                     }
                 } else {
                     ESP_LOGE(TAG, MB_OBJ_FMT":frame receive error. %d", MB_OBJ_PARENT(inst), (int)status);
                     // If the frame was not received correctly, post an error event.
                     mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_RECEIVE_DATA);
-                    (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
                     mbs_obj->length = 0; // Reset length to avoid processing junk data.
+#if MB_SLAVE_FAST_PATH_ENABLED
+                    mbs_complete_transaction(inst, esp_timer_get_time());
+#else
+                    (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
+#endif
                 }
                 break;
 
             case EV_EXECUTE:
                 MB_RETURN_ON_FALSE(mbs_obj->frame, MB_EILLSTATE, TAG, "receive buffer fail.");
                 ESP_LOGD(TAG, MB_OBJ_FMT":EV_EXECUTE", MB_OBJ_PARENT(inst));
-                mbs_obj->func_code = mbs_obj->frame[MB_PDU_FUNC_OFF];
-                exception = mbs_check_invoke_handler(inst, mbs_obj->func_code, mbs_obj->frame, &mbs_obj->length);
-                // If the request was not sent to the broadcast address, return a reply.
-                if ((mbs_obj->rcv_addr != MB_ADDRESS_BROADCAST) || (mbs_obj->cur_mode == MB_TCP)) {
-                    if (exception != MB_EX_NONE) {
-                        // An exception occurred. Build an error frame.
-                        mbs_obj->length = 0;
-                        mbs_obj->frame[mbs_obj->length++] = (uint8_t)(mbs_obj->func_code | MB_FUNC_ERROR);
-                        mbs_obj->frame[mbs_obj->length++] = exception;
-                    }
-                    if ((mbs_obj->cur_mode == MB_ASCII) && MB_ASCII_TIMEOUT_WAIT_BEFORE_SEND_MS) {
-                        mb_port_timer_delay(MB_OBJ(inst->port_obj), MB_ASCII_TIMEOUT_WAIT_BEFORE_SEND_MS);
-                    }
-                    MB_PRT_BUF(inst->descr.parent_name, ":MB_SEND", (void *)mbs_obj->frame,
-                                                    (uint16_t)mbs_obj->length, ESP_LOG_DEBUG);
-                    status = MB_OBJ(inst->transp_obj)->frm_send(inst->transp_obj, mbs_obj->rcv_addr, mbs_obj->frame, mbs_obj->length);
+                status = mbs_execute_request(inst, &is_replied);
+                if (is_replied) {
                     if (status != MB_ENOERR) {
-                        ESP_LOGE(TAG, MB_OBJ_FMT": frame send error: %d.", MB_OBJ_PARENT(inst), (int)status);
                         mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_RESPOND_TIMEOUT);
                         (void)mb_port_event_post(MB_OBJ(inst->port_obj), EVENT(EV_ERROR_PROCESS));
                     } else {
@@ -541,35 +698,7 @@ mb_err_enum_t mbs_poll(mb_base_t *inst)
             case EV_ERROR_PROCESS:
                 ESP_LOGD(TAG, MB_OBJ_FMT":EV_ERROR_PROCESS", MB_OBJ_PARENT(inst));
                 // stop timer and execute specified error process callback function.
-                mb_port_timer_disable(MB_OBJ(inst->port_obj));
-                error_type = mb_port_event_get_err_type(MB_OBJ(inst->port_obj));
-                switch (error_type)
-                {
-                    case EV_ERROR_RESPOND_TIMEOUT:
-                        mbs_error_cb_respond_timeout(inst, mbs_obj->rcv_addr,
-                                                    mbs_obj->frame, mbs_obj->length);
-                        break;
-                    case EV_ERROR_RECEIVE_DATA:
-                        mbs_error_cb_receive_data(inst, mbs_obj->rcv_addr,
-                                                    mbs_obj->frame, mbs_obj->length);
-                        break;
-                    case EV_ERROR_EXECUTE_FUNCTION:
-                        mbs_error_cb_execute_function(inst, mbs_obj->rcv_addr,
-                                                    mbs_obj->frame, mbs_obj->length);
-                        break;
-                    case EV_ERROR_OK:
-                        mbs_error_cb_request_success(inst, mbs_obj->rcv_addr,
-                                                    mbs_obj->frame, mbs_obj->length);
-                        break;
-                    default:
-                        ESP_LOGE(TAG, MB_OBJ_FMT", incorrect error type = %d.", MB_OBJ_PARENT(inst), (int)error_type);
-                        break;
-                }
-                mb_port_event_set_err_type(MB_OBJ(inst->port_obj), EV_ERROR_INIT);
-                time_div_us = mbs_obj->curr_trans_id ? (event.get_ts - mbs_obj->curr_trans_id) : 0;
-                mbs_obj->curr_trans_id = 0;
-                ESP_LOGD(TAG, MB_OBJ_FMT", transaction processing time(us) = %" PRId64, MB_OBJ_PARENT(inst), time_div_us);
-                mb_port_event_res_release(MB_OBJ(inst->port_obj));
+                mbs_complete_transaction(inst, event.get_ts);
                 break;
 
             default:
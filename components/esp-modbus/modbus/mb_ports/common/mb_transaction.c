@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdatomic.h>
@@ -9,6 +10,9 @@
 
 static const char *TAG = "mb_transaction";
 
+#define TRANSACTION_INDEX_EMPTY (0xFFFF)
+#define TRANSACTION_WHEEL_MASK (TRANSACTION_WHEEL_SLOTS - 1)
+
 /**
  * @brief transaction list item
  */
@@ -18,41 +22,192 @@ typedef struct transaction_item {
     int node_id;
     uint16_t msg_id;
     void *pnode;
+    frame_pool_t *pool;
     transaction_tick_t tick;
     _Atomic(int) state;
-    STAILQ_ENTRY(transaction_item) next;
+    uint32_t seq;                               // enqueue order of the items with the same msg_id
+    uint16_t pos;                               // position of the item in the index table
+    bool is_used;
+    TAILQ_ENTRY(transaction_item) next;         // enqueue order list or free list
+    LIST_ENTRY(transaction_item) wheel;         // expiry slot of the timer wheel
 } transaction_item_t;
 
-STAILQ_HEAD(transaction_list_t, transaction_item);
+TAILQ_HEAD(transaction_list_t, transaction_item);
+LIST_HEAD(transaction_slot_t, transaction_item);
 
 struct transaction_t {
     _lock_t lock;
     uint64_t size;
-    struct transaction_list_t *list;
+    struct transaction_list_t *list;            // the items in enqueue order
+    struct transaction_list_t free_list;        // the free items of the pool
+    transaction_item_t *items;                  // the pool of items allocated once
+    uint16_t items_max;
+    uint16_t *index;                            // open addressed table of item numbers hashed by msg_id
+    uint16_t index_mask;
+    uint8_t index_shift;
+    uint32_t seq;
+    transaction_tick_t wheel_cursor;            // all items are placed in the slots not older than the cursor
+    struct transaction_slot_t wheel[TRANSACTION_WHEEL_SLOTS];
 };
 
-transaction_handle_t transaction_init(void)
+// Fibonacci hashing of msg_id, the sequential TIDs are spread over the table
+static inline uint16_t transaction_hash(transaction_handle_t transaction, uint16_t msg_id)
+{
+    return (uint16_t)((uint16_t)(msg_id * 40503U) >> transaction->index_shift);
+}
+
+// The item is placed in the wheel slot of its tick, the ticks older than the cursor are placed in the cursor slot
+static void transaction_wheel_insert(transaction_handle_t transaction, transaction_item_t *item)
+{
+    transaction_tick_t slot_time = item->tick >> TRANSACTION_WHEEL_SHIFT;
+    if (slot_time < transaction->wheel_cursor) {
+        slot_time = transaction->wheel_cursor;
+    }
+    LIST_INSERT_HEAD(&transaction->wheel[slot_time & TRANSACTION_WHEEL_MASK], item, wheel);
+}
+
+// The oldest item with msg_id is found in the probe sequence of its hash
+static transaction_item_t *transaction_find(transaction_handle_t transaction, uint16_t msg_id)
+{
+    transaction_item_t *found = NULL;
+    for (uint16_t pos = transaction_hash(transaction, msg_id);
+            transaction->index[pos] != TRANSACTION_INDEX_EMPTY; pos = (pos + 1) & transaction->index_mask) {
+        transaction_item_t *item = &transaction->items[transaction->index[pos]];
+        if ((item->msg_id == msg_id) && (!found || ((int32_t)(item->seq - found->seq) < 0))) {
+            found = item;
+        }
+    }
+    return found;
+}
+
+// The item of the pool is reused after delete, the handle is valid while the item keeps the same message
+static bool transaction_is_item(transaction_handle_t transaction, transaction_item_t *item, uint16_t msg_id, int node_id)
+{
+    return (item >= transaction->items) && (item < &transaction->items[transaction->items_max]) && item->is_used
+            && (item->msg_id == msg_id) && (item->node_id == node_id);
+}
+
+// Remove the item from the index, the following entries of the probe sequence are shifted back to keep it without gaps
+static void transaction_remove(transaction_handle_t transaction, transaction_item_t *item)
+{
+    uint16_t mask = transaction->index_mask;
+    uint16_t hole = item->pos;
+    for (uint16_t pos = (hole + 1) & mask; transaction->index[pos] != TRANSACTION_INDEX_EMPTY; pos = (pos + 1) & mask) {
+        transaction_item_t *moved = &transaction->items[transaction->index[pos]];
+        uint16_t home = transaction_hash(transaction, moved->msg_id);
+        // The entry is moved if the hole is between its hash position and its current position
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            transaction->index[hole] = transaction->index[pos];
+            moved->pos = hole;
+            hole = pos;
+        }
+    }
+    transaction->index[hole] = TRANSACTION_INDEX_EMPTY;
+    TAILQ_REMOVE(transaction->list, item, next);
+    LIST_REMOVE(item, wheel);
+    transaction->size -= item->len;
+    frame_buf_free(item->pool, item->buffer);
+    item->buffer = NULL;
+    item->is_used = false;
+    TAILQ_INSERT_HEAD(&transaction->free_list, item, next);
+}
+
+// Delete the items with (current_tick - tick > timeout) from the wheel slots up to the tick (current_tick - timeout).
+// Stops after the items_max items are deleted, returns the number of deleted items.
+static int transaction_expire(transaction_handle_t transaction, transaction_tick_t current_tick,
+                                transaction_tick_t timeout, int items_max, uint16_t *msg_id)
 {
+    if (current_tick <= timeout) {
+        return 0;
+    }
+    transaction_tick_t limit_slot = (current_tick - timeout) >> TRANSACTION_WHEEL_SHIFT;
+    transaction_tick_t slots = 1;
+    if (limit_slot > transaction->wheel_cursor) {
+        slots = limit_slot - transaction->wheel_cursor + 1;
+        if (slots > TRANSACTION_WHEEL_SLOTS) {
+            slots = TRANSACTION_WHEEL_SLOTS;
+        }
+    }
+    int deleted_items = 0;
+    for (transaction_tick_t i = 0; i < slots; i++) {
+        transaction_item_t *item, *tmp;
+        struct transaction_slot_t *slot = &transaction->wheel[(transaction->wheel_cursor + i) & TRANSACTION_WHEEL_MASK];
+        LIST_FOREACH_SAFE(item, slot, wheel, tmp) {
+            if (current_tick - item->tick > timeout) {
+                if (msg_id) {
+                    *msg_id = item->msg_id;
+                }
+                transaction_remove(transaction, item);
+                if (++deleted_items >= items_max) {
+                    // The slots before this one do not keep the expired items
+                    transaction->wheel_cursor += i;
+                    return deleted_items;
+                }
+            }
+        }
+    }
+    // The slot of the limit is kept, its items can expire later
+    if (limit_slot > transaction->wheel_cursor) {
+        transaction->wheel_cursor = limit_slot;
+    }
+    return deleted_items;
+}
+
+transaction_handle_t transaction_create(uint16_t items_max)
+{
+    ESP_MEM_CHECK(TAG, (items_max && (items_max <= TRANSACTION_ITEMS_MAX)), return NULL);
     transaction_handle_t transaction = calloc(1, sizeof(struct transaction_t));
     ESP_MEM_CHECK(TAG, transaction, return NULL);
+    // The index is at least twice larger than the pool, so the probe sequences stay short
+    uint8_t index_bits = 1;
+    while ((1U << index_bits) < (2U * items_max)) {
+        index_bits++;
+    }
+    transaction->items_max = items_max;
+    transaction->index_mask = (uint16_t)((1U << index_bits) - 1);
+    transaction->index_shift = (uint8_t)(16 - index_bits);
     transaction->list = calloc(1, sizeof(struct transaction_list_t));
-    ESP_MEM_CHECK(TAG, transaction->list, {free(transaction); return NULL;});
+    transaction->items = calloc(items_max, sizeof(transaction_item_t));
+    transaction->index = malloc((1U << index_bits) * sizeof(uint16_t));
+    ESP_MEM_CHECK(TAG, (transaction->list && transaction->items && transaction->index), {
+        free(transaction->list);
+        free(transaction->items);
+        free(transaction->index);
+        free(transaction);
+        return NULL;
+    });
+    memset(transaction->index, 0xFF, (1U << index_bits) * sizeof(uint16_t));
     transaction->size = 0;
     CRITICAL_SECTION_INIT(transaction->lock);
-    STAILQ_INIT(transaction->list);
+    TAILQ_INIT(transaction->list);
+    TAILQ_INIT(&transaction->free_list);
+    for (uint16_t i = 0; i < items_max; i++) {
+        TAILQ_INSERT_TAIL(&transaction->free_list, &transaction->items[i], next);
+    }
+    for (int i = 0; i < TRANSACTION_WHEEL_SLOTS; i++) {
+        LIST_INIT(&transaction->wheel[i]);
+    }
     return transaction;
 }
 
+transaction_handle_t transaction_init(void)
+{
+    return transaction_create(TRANSACTION_ITEMS_DEFAULT);
+}
+
 transaction_item_handle_t transaction_enqueue(transaction_handle_t transaction, transaction_message_handle_t message, transaction_tick_t tick)
 {
     ESP_MEM_CHECK(TAG, (message && message->buffer && message->len), {
         return NULL;
     });
-    transaction_item_handle_t item = calloc(1, sizeof(transaction_item_t));
-    ESP_MEM_CHECK(TAG, (item), { 
-        return NULL;
-    });
     CRITICAL_SECTION_LOCK(transaction->lock);
+    transaction_item_handle_t item = TAILQ_FIRST(&transaction->free_list);
+    if (!item) {
+        CRITICAL_SECTION_UNLOCK(transaction->lock);
+        ESP_LOGE(TAG, "ENQUEUE msgid=%x, all %u items are in use.", message->msg_id, (unsigned)transaction->items_max);
+        return NULL;
+    }
+    TAILQ_REMOVE(&transaction->free_list, item, next);
     item->tick = tick;
     item->node_id = message->node_id;
     item->pnode = message->pnode;
@@ -60,7 +215,17 @@ transaction_item_handle_t transaction_enqueue(transaction_handle_t transaction,
     item->len =  message->len;
     item->state = QUEUED;
     item->buffer = message->buffer;
-    STAILQ_INSERT_TAIL(transaction->list, item, next);
+    item->pool = message->pool;
+    item->seq = transaction->seq++;
+    item->is_used = true;
+    uint16_t pos = transaction_hash(transaction, item->msg_id);
+    while (transaction->index[pos] != TRANSACTION_INDEX_EMPTY) {
+        pos = (pos + 1) & transaction->index_mask;
+    }
+    transaction->index[pos] = (uint16_t)(item - transaction->items);
+    item->pos = pos;
+    TAILQ_INSERT_TAIL(transaction->list, item, next);
+    transaction_wheel_insert(transaction, item);
     transaction->size += item->len;
     CRITICAL_SECTION_UNLOCK(transaction->lock);
     ESP_LOGD(TAG, "ENQUEUE msgid=%x, len=%d, size=%"PRIu64, message->msg_id, message->len, transaction_get_size(transaction));
@@ -71,36 +236,25 @@ transaction_item_handle_t transaction_get(transaction_handle_t transaction, uint
 {
     transaction_item_handle_t item;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH(item, transaction->list, next) {
-        if (item->msg_id == msg_id) {
-            CRITICAL_SECTION_UNLOCK(transaction->lock);
-            return item;
-        }
-    }
+    item = transaction_find(transaction, msg_id);
     CRITICAL_SECTION_UNLOCK(transaction->lock);
-    return NULL;
+    return item;
 }
 
 transaction_item_handle_t transaction_get_first(transaction_handle_t transaction)
 {
     transaction_item_handle_t item;
-    if (STAILQ_EMPTY(transaction->list)) {
-        return NULL;
-    }
-    
-    item = STAILQ_FIRST(transaction->list); 
-    if (item)
-    {
-        return item;
-    }
-    return NULL;
+    CRITICAL_SECTION_LOCK(transaction->lock);
+    item = TAILQ_FIRST(transaction->list);
+    CRITICAL_SECTION_UNLOCK(transaction->lock);
+    return item;
 }
 
 transaction_item_handle_t transaction_dequeue(transaction_handle_t transaction, pending_state_t state, transaction_tick_t *tick)
 {
     transaction_item_handle_t item;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH(item, transaction->list, next) {
+    TAILQ_FOREACH(item, transaction->list, next) {
         if (atomic_load(&(item->state)) == state) {
             if (tick) {
                 *tick = item->tick;
@@ -113,22 +267,17 @@ transaction_item_handle_t transaction_dequeue(transaction_handle_t transaction,
     return NULL;
 }
 
-esp_err_t transaction_delete_item(transaction_handle_t transaction, transaction_item_handle_t item_to_delete)
+esp_err_t transaction_delete_item(transaction_handle_t transaction, transaction_item_handle_t item_to_delete,
+                                    uint16_t msg_id, int node_id)
 {
-    transaction_item_handle_t item;
+    esp_err_t err = ESP_FAIL;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH(item, transaction->list, next) {
-        if (item == item_to_delete) {
-            STAILQ_REMOVE(transaction->list, item, transaction_item, next);
-            transaction->size -= item->len;
-            free(item->buffer);
-            free(item);
-            CRITICAL_SECTION_UNLOCK(transaction->lock);
-            return ESP_OK;
-        }
+    if (transaction_is_item(transaction, item_to_delete, msg_id, node_id)) {
+        transaction_remove(transaction, item_to_delete);
+        err = ESP_OK;
     }
     CRITICAL_SECTION_UNLOCK(transaction->lock);
-    return ESP_FAIL;
+    return err;
 }
 
 uint16_t transaction_item_get_id(transaction_item_handle_t item)
@@ -156,20 +305,23 @@ uint8_t *transaction_item_get_data(transaction_item_handle_t item,  size_t *len,
     return NULL;
 }
 
+void *transaction_item_get_pnode(transaction_item_handle_t item)
+{
+    if (item) {
+        return item->pnode;
+    }
+    return NULL;
+}
+
 esp_err_t transaction_delete(transaction_handle_t transaction, uint16_t msg_id)
 {
-    transaction_item_handle_t item, tmp;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH_SAFE(item, transaction->list, next, tmp) {
-        if (item->msg_id == msg_id) {
-            STAILQ_REMOVE(transaction->list, item, transaction_item, next);
-            transaction->size -= item->len;
-            free(item->buffer);
-            free(item);
-            CRITICAL_SECTION_UNLOCK(transaction->lock);
-            ESP_LOGD(TAG, "DELETED msgid=%x, remain size=%"PRIu64, msg_id, transaction_get_size(transaction));
-            return ESP_OK;
-        }
+    transaction_item_handle_t item = transaction_find(transaction, msg_id);
+    if (item) {
+        transaction_remove(transaction, item);
+        CRITICAL_SECTION_UNLOCK(transaction->lock);
+        ESP_LOGD(TAG, "DELETED msgid=%x, remain size=%"PRIu64, msg_id, transaction_get_size(transaction));
+        return ESP_OK;
     }
     CRITICAL_SECTION_UNLOCK(transaction->lock);
     return ESP_FAIL;
@@ -212,30 +364,25 @@ transaction_tick_t transaction_item_get_tick(transaction_item_handle_t item)
 
 esp_err_t transaction_set_tick(transaction_handle_t transaction, uint16_t msg_id, transaction_tick_t tick)
 {
-    transaction_item_handle_t item = transaction_get(transaction, msg_id);
+    CRITICAL_SECTION_LOCK(transaction->lock);
+    transaction_item_handle_t item = transaction_find(transaction, msg_id);
     if (item) {
+        // The item is moved to the wheel slot of the new tick
+        LIST_REMOVE(item, wheel);
         item->tick = tick;
+        transaction_wheel_insert(transaction, item);
+        CRITICAL_SECTION_UNLOCK(transaction->lock);
         return ESP_OK;
     }
+    CRITICAL_SECTION_UNLOCK(transaction->lock);
     return ESP_FAIL;
 }
 
 uint16_t transaction_delete_single_expired(transaction_handle_t transaction, transaction_tick_t current_tick, transaction_tick_t timeout)
 {
     uint16_t msg_id = 0xFFFF;
-    transaction_item_handle_t item;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH(item, transaction->list, next) {
-        if (current_tick - item->tick > timeout) {
-            STAILQ_REMOVE(transaction->list, item, transaction_item, next);
-            free(item->buffer);
-            transaction->size -= item->len;
-            msg_id = item->msg_id;
-            free(item);
-            CRITICAL_SECTION_UNLOCK(transaction->lock);
-            return msg_id;
-        }
-    }
+    (void)transaction_expire(transaction, current_tick, timeout, 1, &msg_id);
     CRITICAL_SECTION_UNLOCK(transaction->lock);
     return msg_id;
 }
@@ -245,12 +392,9 @@ int transaction_delete_by_node_id(transaction_handle_t transaction, int node_id)
     int deleted_items = 0;
     transaction_item_handle_t item, tmp;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH_SAFE(item, transaction->list, next, tmp) {
+    TAILQ_FOREACH_SAFE(item, transaction->list, next, tmp) {
         if (item->node_id == node_id) {
-            STAILQ_REMOVE(transaction->list, item, transaction_item, next);
-            free(item->buffer);
-            transaction->size -= item->len;
-            free(item);
+            transaction_remove(transaction, item);
             deleted_items ++;
         }
     }
@@ -261,17 +405,8 @@ int transaction_delete_by_node_id(transaction_handle_t transaction, int node_id)
 int transaction_delete_expired(transaction_handle_t transaction, transaction_tick_t current_tick, transaction_tick_t timeout)
 {
     int deleted_items = 0;
-    transaction_item_handle_t item, tmp;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH_SAFE(item, transaction->list, next, tmp) {
-        if (current_tick - item->tick > timeout) {
-            STAILQ_REMOVE(transaction->list, item, transaction_item, next);
-            free(item->buffer);
-            transaction->size -= item->len;
-            free(item);
-            deleted_items ++;
-        }
-    }
+    deleted_items = transaction_expire(transaction, current_tick, timeout, INT32_MAX, NULL);
     CRITICAL_SECTION_UNLOCK(transaction->lock);
     return deleted_items;
 }
@@ -281,15 +416,21 @@ uint64_t transaction_get_size(transaction_handle_t transaction)
     return transaction->size;
 }
 
+bool transaction_is_full(transaction_handle_t transaction)
+{
+    bool is_full = false;
+    CRITICAL_SECTION_LOCK(transaction->lock);
+    is_full = TAILQ_EMPTY(&transaction->free_list);
+    CRITICAL_SECTION_UNLOCK(transaction->lock);
+    return is_full;
+}
+
 void transaction_delete_all_items(transaction_handle_t transaction)
 {
     transaction_item_handle_t item, tmp;
     CRITICAL_SECTION_LOCK(transaction->lock);
-    STAILQ_FOREACH_SAFE(item, transaction->list, next, tmp) {
-        STAILQ_REMOVE(transaction->list, item, transaction_item, next);
-        transaction->size -= item->len;
-        free(item->buffer);
-        free(item);
+    TAILQ_FOREACH_SAFE(item, transaction->list, next, tmp) {
+        transaction_remove(transaction, item);
     }
     CRITICAL_SECTION_UNLOCK(transaction->lock);
 }
@@ -298,7 +439,8 @@ void transaction_destroy(transaction_handle_t transaction)
 {
     transaction_delete_all_items(transaction);
     CRITICAL_SECTION_CLOSE(transaction->lock);
+    free(transaction->index);
+    free(transaction->items);
     free(transaction->list);
     free(transaction);
 }
-
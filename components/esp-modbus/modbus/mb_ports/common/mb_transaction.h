@@ -14,6 +14,14 @@ extern "C" {
 
 #define TRANSACTION_MEMORY MALLOC_CAP_DEFAULT
 
+// The number of pooled items of the transaction created by transaction_init()
+#define TRANSACTION_ITEMS_DEFAULT (32)
+#define TRANSACTION_ITEMS_MAX (8192)
+
+// The timer wheel of expiry, the slot keeps the items of (1 << TRANSACTION_WHEEL_SHIFT) ticks
+#define TRANSACTION_WHEEL_SHIFT (16)
+#define TRANSACTION_WHEEL_SLOTS (64)
+
 #define ESP_MEM_CHECK(TAG, a, action) if (!(a)) {                                                      \
         ESP_LOGE(TAG,"%s(%d): %s",  __FUNCTION__, __LINE__, "Memory exhausted"); \
         action;                                                                                         \
@@ -30,6 +38,7 @@ typedef struct transaction_message {
     uint16_t msg_id;
     int node_id;
     void *pnode;
+    frame_pool_t *pool;
 } transaction_message_t;
 
 typedef struct transaction_message *transaction_message_handle_t;
@@ -47,14 +56,30 @@ typedef enum pending_state {
 } pending_state_t;
 
 transaction_handle_t transaction_init(void);
+
+/**
+ * @brief Creates the transaction with the pool of items_max items
+ *
+ * The items are indexed by msg_id in the hash table and are kept in the timer wheel by their tick,
+ * so the lookup and the expiry do not scan all items. The enqueue fails if all items are in use.
+ */
+transaction_handle_t transaction_create(uint16_t items_max);
 transaction_item_handle_t transaction_enqueue(transaction_handle_t transaction, transaction_message_handle_t message, transaction_tick_t tick);
 transaction_item_handle_t transaction_dequeue(transaction_handle_t transaction, pending_state_t pending, transaction_tick_t *tick);
 transaction_item_handle_t transaction_get(transaction_handle_t transaction, uint16_t msg_id);
 transaction_item_handle_t transaction_get_first(transaction_handle_t transaction);
 uint16_t transaction_item_get_id(transaction_item_handle_t item);
 uint8_t *transaction_item_get_data(transaction_item_handle_t item,  size_t *len, uint16_t *msg_id, int *node_id);
+void *transaction_item_get_pnode(transaction_item_handle_t item);
 esp_err_t transaction_delete(transaction_handle_t transaction, uint16_t msg_id);
-esp_err_t transaction_delete_item(transaction_handle_t transaction, transaction_item_handle_t item);
+
+/**
+ * @brief Deletes the item if it still keeps the message msg_id of node_id
+ *
+ * The items are reused from the pool, so the handle of the deleted (expired) item can point to the other message,
+ * such item is kept and ESP_FAIL is returned.
+ */
+esp_err_t transaction_delete_item(transaction_handle_t transaction, transaction_item_handle_t item, uint16_t msg_id, int node_id);
 int transaction_delete_by_node_id(transaction_handle_t transaction, int node_id);
 int transaction_delete_expired(transaction_handle_t transaction, transaction_tick_t current_tick, transaction_tick_t timeout);
 
@@ -70,6 +95,11 @@ esp_err_t transaction_item_set_state(transaction_item_handle_t item, pending_sta
 esp_err_t transaction_set_tick(transaction_handle_t transaction, uint16_t msg_id, transaction_tick_t tick);
 transaction_tick_t transaction_item_get_tick(transaction_item_handle_t item);
 uint64_t transaction_get_size(transaction_handle_t transaction);
+
+/**
+ * @brief Checks if all items of the pool are in use, so the next enqueue fails
+ */
+bool transaction_is_full(transaction_handle_t transaction);
 void transaction_destroy(transaction_handle_t transaction);
 void transaction_delete_all_items(transaction_handle_t transaction);
 
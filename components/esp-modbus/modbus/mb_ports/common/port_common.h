@@ -137,6 +137,7 @@ typedef struct
 typedef struct mb_port_event_t mb_port_event_t;
 typedef struct mb_port_timer_t mb_port_timer_t;
 typedef struct obj_descr_s obj_descr_t;
+typedef struct frame_pool_s frame_pool_t;
 
 typedef struct frame_queue_entry_s
 {
@@ -146,8 +147,21 @@ typedef struct frame_queue_entry_s
     uint8_t *buf;  /*!< Points to the buffer for the frame */
     uint16_t len;  /*!< Length of the frame in the buffer */
     bool check;    /*!< Checked flag */
+    frame_pool_t *pool; /*!< Frame pool the buffer is taken from (NULL - heap) */
 } frame_entry_t;
 
+/**
+ * @brief Frame buffer allocation statistics (common for all instances)
+ */
+typedef struct
+{
+    uint32_t heap_alloc_count;  /*!< Number of frame buffers allocated from heap */
+    uint32_t heap_free_count;   /*!< Number of frame buffers returned to heap */
+    uint32_t pool_alloc_count;  /*!< Number of frame buffers taken from frame pools */
+    uint32_t pool_free_count;   /*!< Number of frame buffers returned to frame pools */
+    uint32_t pool_miss_count;   /*!< Number of pool requests served from heap (pool exhausted) */
+} mb_frame_stats_t;
+
 struct mb_port_base_t
 {
     obj_descr_t descr;
@@ -182,6 +196,8 @@ void mb_port_set_cur_timer_mode(mb_port_base_t *inst, mb_timer_mode_enum_t tmr_m
 mb_timer_mode_enum_t mb_port_get_cur_timer_mode(mb_port_base_t *inst);
 void mb_port_timer_set_response_time(mb_port_base_t *inst, uint32_t resp_time_ms);
 uint32_t mb_port_timer_get_response_time_ms(mb_port_base_t *inst);
+// The next response timeout is counted from the time stamp (us) instead of the call of respond timeout enable
+void mb_port_timer_set_respond_origin(mb_port_base_t *inst, int64_t origin_ts);
 void mb_port_timer_delay(mb_port_base_t *inst, uint16_t timeout_ms);
 void mb_port_timer_delete(mb_port_base_t *inst);
 
@@ -196,9 +212,19 @@ QueueHandle_t queue_create(int queue_size);
 void queue_delete(QueueHandle_t queue);
 void queue_flush(QueueHandle_t queue);
 bool queue_is_empty(QueueHandle_t queue);
+bool queue_is_full(QueueHandle_t queue);
 esp_err_t queue_push(QueueHandle_t queue, void *buf, size_t len, frame_entry_t *frame);
 ssize_t queue_pop(QueueHandle_t queue, void *buf, size_t len, frame_entry_t *frame);
 
+// Frame pool functions
+frame_pool_t *frame_pool_create(uint16_t slot_count, uint16_t slot_size);
+void frame_pool_delete(frame_pool_t *pool);
+uint8_t *frame_buf_alloc(frame_pool_t *pool, size_t len);
+void frame_buf_free(frame_pool_t *pool, uint8_t *buf);
+bool frame_buf_is_pooled(frame_pool_t *pool, const uint8_t *buf);
+void mb_port_get_frame_stats(mb_frame_stats_t *stats);
+void mb_port_reset_frame_stats(void);
+
 
 #ifdef __cplusplus
 }
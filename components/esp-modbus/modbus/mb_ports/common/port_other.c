@@ -4,15 +4,38 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include <stdatomic.h>
+#include <stddef.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "sys/lock.h"
 
 #include "port_common.h"
 
+/* ----------------------- Defines ------------------------------------------*/
+// The slots hold the parameter values of any type (U32, FLOAT, DOUBLE) which are accessed directly
+#define FRAME_POOL_ALIGN                (_Alignof(max_align_t))
+#define FRAME_POOL_ALIGN_UP(size)       (((size) + (FRAME_POOL_ALIGN - 1)) & ~(FRAME_POOL_ALIGN - 1))
+
+struct frame_pool_s
+{
+    _lock_t lock;
+    uint8_t *slab;          /*!< Storage for all slots of the pool */
+    uint16_t slot_size;     /*!< Size of one slot in bytes */
+    uint16_t slot_count;    /*!< Number of slots in the pool */
+    uint16_t free_count;    /*!< Number of free slot indexes in the free stack */
+    bool is_deleted;        /*!< The pool is deleted, release it with the last slot */
+    uint16_t free_stack[];  /*!< Stack of free slot indexes */
+};
+
 /* ----------------------- Variables ----------------------------------------*/
 static _Atomic(uint32_t) inst_counter = 0;
 
+static _Atomic(uint32_t) heap_alloc_counter = 0;
+static _Atomic(uint32_t) heap_free_counter = 0;
+static _Atomic(uint32_t) pool_alloc_counter = 0;
+static _Atomic(uint32_t) pool_free_counter = 0;
+static _Atomic(uint32_t) pool_miss_counter = 0;
+
 /* ----------------------- Start implementation -----------------------------*/
 int lock_obj(_lock_t *lock_ptr)
 {
@@ -74,19 +97,26 @@ esp_err_t queue_push(QueueHandle_t queue, void *buf, size_t len, frame_entry_t *
         frame_info = *frame;
     }
 
+    bool is_allocated = false;
     if (buf && (len > 0)) {
         if (!frame_info.buf) {
-            frame_info.buf = calloc(1, len);
+            frame_info.buf = frame_buf_alloc(frame_info.pool, len);
+            is_allocated = true;
         }
         if (!frame_info.buf) {
             return ESP_ERR_NO_MEM;
         }
         frame_info.len = len;
-        memcpy(frame_info.buf, buf, len);
+        if (frame_info.buf != buf) {
+            memcpy(frame_info.buf, buf, len);
+        }
     }
 
     // try send to queue and check if the queue is full
     if (xQueueSend(queue, &frame_info, portMAX_DELAY) != pdTRUE) {
+        if (is_allocated) {
+            frame_buf_free(frame_info.pool, frame_info.buf);
+        }
         return ESP_ERR_NO_MEM;
     }
     return ESP_OK;
@@ -110,7 +140,7 @@ ssize_t queue_pop(QueueHandle_t queue, void *buf, size_t len, frame_entry_t *fra
         if (frame_info.buf && buf) {
             memcpy(buf, frame_info.buf, len);
             if (!frame) {
-                free(frame_info.buf); // must free the buffer manually!
+                frame_buf_free(frame_info.pool, frame_info.buf); // must free the buffer manually!
             }
         }
     } else {
@@ -126,12 +156,135 @@ bool queue_is_empty(QueueHandle_t queue)
     return (uxQueueMessagesWaiting(queue) == 0);
 }
 
+bool queue_is_full(QueueHandle_t queue)
+{
+    return (uxQueueSpacesAvailable(queue) == 0);
+}
+
 void queue_flush(QueueHandle_t queue)
 {
     frame_entry_t frame_info;
     while (xQueueReceive(queue, &frame_info, 0) == pdTRUE) {
         if ((frame_info.len > 0) && frame_info.buf) {
-            free(frame_info.buf);
+            frame_buf_free(frame_info.pool, frame_info.buf);
         }
     }
 }
+
+frame_pool_t *frame_pool_create(uint16_t slot_count, uint16_t slot_size)
+{
+    size_t slot_aligned = FRAME_POOL_ALIGN_UP((size_t)slot_size);
+    if (!slot_count || !slot_size || (slot_aligned > UINT16_MAX)) {
+        return NULL;
+    }
+    // The descriptor, free stack and slots are placed in one allocation,
+    // the slab start and slot size are aligned so each slot is aligned as well
+    size_t slab_offset = FRAME_POOL_ALIGN_UP(sizeof(frame_pool_t) + (slot_count * sizeof(uint16_t)));
+    frame_pool_t *pool = calloc(1, slab_offset + (slot_count * slot_aligned));
+    if (!pool) {
+        return NULL;
+    }
+    CRITICAL_SECTION_INIT(pool->lock);
+    pool->slab = (uint8_t *)pool + slab_offset;
+    pool->slot_size = (uint16_t)slot_aligned;
+    pool->slot_count = slot_count;
+    pool->is_deleted = false;
+    for (uint16_t i = 0; i < slot_count; i++) {
+        pool->free_stack[i] = (slot_count - 1 - i);
+    }
+    pool->free_count = slot_count;
+    return pool;
+}
+
+static void frame_pool_destroy(frame_pool_t *pool)
+{
+    CRITICAL_SECTION_CLOSE(pool->lock);
+    free(pool);
+}
+
+// The slots which are still owned by other objects (transactions) keep the pool alive,
+// so the pool memory is released together with the last returned slot.
+void frame_pool_delete(frame_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+    bool is_free = false;
+    CRITICAL_SECTION(pool->lock) {
+        pool->is_deleted = true;
+        is_free = (pool->free_count == pool->slot_count);
+    }
+    if (is_free) {
+        frame_pool_destroy(pool);
+    }
+}
+
+uint8_t *frame_buf_alloc(frame_pool_t *pool, size_t len)
+{
+    uint8_t *buf = NULL;
+    if (pool && (len <= pool->slot_size)) {
+        CRITICAL_SECTION(pool->lock) {
+            if (pool->free_count && !pool->is_deleted) {
+                uint16_t index = pool->free_stack[--pool->free_count];
+                buf = pool->slab + ((size_t)index * pool->slot_size);
+            }
+        }
+        if (buf) {
+            atomic_fetch_add(&pool_alloc_counter, 1);
+            return buf;
+        }
+        atomic_fetch_add(&pool_miss_counter, 1);
+    }
+    buf = calloc(1, len);
+    if (buf) {
+        atomic_fetch_add(&heap_alloc_counter, 1);
+    }
+    return buf;
+}
+
+void frame_buf_free(frame_pool_t *pool, uint8_t *buf)
+{
+    if (!buf) {
+        return;
+    }
+    if (pool && (buf >= pool->slab) && (buf < (pool->slab + ((size_t)pool->slot_count * pool->slot_size)))) {
+        bool is_released = false;
+        CRITICAL_SECTION(pool->lock) {
+            pool->free_stack[pool->free_count++] = (uint16_t)((buf - pool->slab) / pool->slot_size);
+            is_released = (pool->is_deleted && (pool->free_count == pool->slot_count));
+        }
+        atomic_fetch_add(&pool_free_counter, 1);
+        if (is_released) {
+            frame_pool_destroy(pool);
+        }
+        return;
+    }
+    free(buf);
+    atomic_fetch_add(&heap_free_counter, 1);
+}
+
+// The buffer is the slot of the pool (not the heap buffer of the exhausted pool)
+bool frame_buf_is_pooled(frame_pool_t *pool, const uint8_t *buf)
+{
+    return (pool && buf && (buf >= pool->slab) && (buf < (pool->slab + ((size_t)pool->slot_count * pool->slot_size))));
+}
+
+void mb_port_get_frame_stats(mb_frame_stats_t *stats)
+{
+    if (stats) {
+        stats->heap_alloc_count = atomic_load(&heap_alloc_counter);
+        stats->heap_free_count = atomic_load(&heap_free_counter);
+        stats->pool_alloc_count = atomic_load(&pool_alloc_counter);
+        stats->pool_free_count = atomic_load(&pool_free_counter);
+        stats->pool_miss_count = atomic_load(&pool_miss_counter);
+    }
+}
+
+void mb_port_reset_frame_stats(void)
+{
+    atomic_store(&heap_alloc_counter, 0);
+    atomic_store(&heap_free_counter, 0);
+    atomic_store(&pool_alloc_counter, 0);
+    atomic_store(&pool_free_counter, 0);
+    atomic_store(&pool_miss_counter, 0);
+}
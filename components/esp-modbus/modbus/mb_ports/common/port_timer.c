@@ -32,6 +32,7 @@ struct mb_port_timer_t
     _Atomic(uint32_t) response_time_ms;
     _Atomic(bool) timer_state;
     _Atomic(uint16_t) timer_mode;
+    _Atomic(int64_t) respond_origin_ts;
 };
 
 /* ----------------------- Static variables ---------------------------------*/
@@ -62,6 +63,7 @@ mb_err_enum_t mb_port_timer_create(mb_port_base_t *inst, uint16_t t35_timer_tick
     inst->timer_obj->timer_handle = NULL;
     atomic_init(&(inst->timer_obj->timer_mode), MB_TMODE_T35);
     atomic_init(&(inst->timer_obj->timer_state), false);
+    atomic_init(&(inst->timer_obj->respond_origin_ts), 0);
     // Set default response time according to kconfig
     atomic_init(&(inst->timer_obj->response_time_ms), MB_MASTER_TIMEOUT_MS_RESPOND);
     // Save timer reload value for Modbus T35 period
@@ -153,6 +155,14 @@ void mb_port_timer_respond_timeout_enable(mb_port_base_t *inst)
 {
     uint64_t tout_us = (inst->timer_obj->response_time_ms * 1000);
 
+    // The port has set the end of request, the time since the last stop bit is already waited
+    int64_t origin_ts = atomic_exchange(&(inst->timer_obj->respond_origin_ts), 0);
+    if (origin_ts) {
+        int64_t elapsed_us = esp_timer_get_time() - origin_ts;
+        if ((elapsed_us > 0) && ((uint64_t)elapsed_us < tout_us)) {
+            tout_us -= (uint64_t)elapsed_us;
+        }
+    }
     mb_port_set_cur_timer_mode(inst, MB_TMODE_RESPOND_TIMEOUT);
     ESP_LOGD(TAG, "%s, respond enable timeout (%u).", 
                 inst->descr.parent_name, (unsigned)mb_port_timer_get_response_time_ms(inst));
@@ -183,6 +193,12 @@ void mb_port_timer_set_response_time(mb_port_base_t *inst, uint32_t resp_time_ms
     atomic_store(&(inst->timer_obj->response_time_ms), resp_time_ms);
 }
 
+void mb_port_timer_set_respond_origin(mb_port_base_t *inst, int64_t origin_ts)
+{
+    MB_RETURN_ON_FALSE((inst && inst->timer_obj), ;, TAG, "timer is not initialized.");
+    atomic_store(&(inst->timer_obj->respond_origin_ts), origin_ts);
+}
+
 uint32_t mb_port_timer_get_response_time_ms(mb_port_base_t *inst)
 {
     return atomic_load(&(inst->timer_obj->response_time_ms));
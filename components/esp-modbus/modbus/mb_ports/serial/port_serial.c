@@ -9,6 +9,7 @@
 #include "port_common.h"
 #include "mb_config.h"
 #include "port_serial_common.h"
+#include "rtu/mbcrc.h"
 
 /* ----------------------- Defines ------------------------------------------*/
 #define MB_SERIAL_RX_SEMA_TOUT_MS   (1000)
@@ -24,6 +25,9 @@
 #define MB_SERIAL_MIN_POST_IDLE         (0)
 #define MB_SERIAL_MIN_PRE_IDLE          (0)
 
+#define MB_SERIAL_CHAR_BITS             (11)    // start, data, parity or second stop and stop bits
+#define MB_SERIAL_GAP_WINDOW_MAX_US     (50000) // the longest gap inside the frame tolerated by measured timing
+
 #if (CONFIG_FMB_COMM_MODE_ASCII_EN || CONFIG_FMB_COMM_MODE_RTU_EN)
 
 typedef struct
@@ -41,6 +45,35 @@ typedef struct
     QueueHandle_t uart_queue;           // A queue to handle UART event.
     TaskHandle_t  task_handle;          // UART task to handle UART event.
     SemaphoreHandle_t bus_sema_handle;   // Rx blocking semaphore handle
+#if (MB_SERIAL_RS485_HALF_DUPLEX_ENABLED)
+    uint32_t tx_char_ns;                // Time of one character on the line
+    uint32_t tx_done_us;                // Delay of the TX done notification after the last stop bit
+#endif
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+    // RTU receiver: the bytes are read from UART as they arrive and folded into the frame CRC,
+    // one buffer collects the next frame while the other keeps the frame for the transport
+    _lock_t rx_lock;
+    uint8_t rx_buf[2][MB_BUFFER_SIZE];
+    uint8_t rx_idx;                     // Index of the collecting buffer
+    uint16_t rx_len;
+    uint16_t rx_crc;
+    bool rx_overflow;
+    uint16_t frame_len;                 // Length of the ready frame in the other buffer
+    uint16_t frame_crc;
+    uint16_t recv_crc_len;              // Length and CRC of the frame read by the transport
+    uint16_t recv_crc;
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+    // Measured timing: the frame with wrong CRC waits for the rest of data during the learned gap window
+    uint32_t char_time_us;
+    uint32_t gap_base_us;               // T3.5, the window returns to it after the clean frames
+    uint32_t gap_window_us;
+    bool rx_pending;
+    int64_t rx_pending_ts;
+    mb_ser_rx_timing_t rx_timing;       // Timing of the collected, ready and read frames
+    mb_ser_rx_timing_t frame_timing;
+    mb_ser_rx_timing_t recv_timing;
+#endif
+#endif
 } mb_ser_port_t;
 
 /* ----------------------- Static variables & functions ----------------------*/
@@ -93,6 +126,197 @@ static bool mb_port_ser_bus_sema_is_busy(mb_port_base_t *inst)
     return status;
 }
 
+#if (MB_SERIAL_RS485_HALF_DUPLEX_ENABLED)
+
+static void mb_port_ser_tx_init(mb_ser_port_t *port_obj)
+{
+    uint32_t baudrate = port_obj->ser_opts.baudrate ? port_obj->ser_opts.baudrate : 9600;
+    // Count the half bits to take into account 1.5 stop bits
+    uint32_t half_bits = 2 * (1 + 5 + (uint32_t)port_obj->ser_opts.data_bits);
+    half_bits += (port_obj->ser_opts.parity != UART_PARITY_DISABLE) ? 2 : 0;
+    half_bits += (port_obj->ser_opts.stop_bits == UART_STOP_BITS_2) ? 4
+                    : ((port_obj->ser_opts.stop_bits == UART_STOP_BITS_1_5) ? 3 : 2);
+    port_obj->tx_char_ns = (uint32_t)(((uint64_t)half_bits * 500000000ULL) / baudrate);
+}
+
+// The TX done is notified to the task after the last stop bit with the wake up delay,
+// the frame starts at once on the idle line, so its end is known from the length of the frame
+static void mb_port_ser_tx_end(mb_ser_port_t *port_obj, int64_t write_ts, uint16_t length)
+{
+    int64_t done_ts = (int64_t)port_obj->send_time_stamp;
+    int64_t end_ts = write_ts + (int64_t)(((uint64_t)length * port_obj->tx_char_ns) / 1000);
+    end_ts = (end_ts < done_ts) ? end_ts : done_ts;
+    port_obj->tx_done_us = (uint32_t)(done_ts - end_ts);
+    port_obj->send_time_stamp = (uint64_t)end_ts;
+    if (port_obj->base.descr.is_master) {
+        // The response timeout starts from the last stop bit of request
+        mb_port_timer_set_respond_origin(&port_obj->base, end_ts);
+    }
+}
+
+#endif
+
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+
+static void mb_port_ser_rx_reset(mb_ser_port_t *port_obj)
+{
+    CRITICAL_SECTION(port_obj->rx_lock) {
+        port_obj->rx_len = 0;
+        port_obj->rx_crc = MB_CRC16_INIT;
+        port_obj->rx_overflow = false;
+        port_obj->frame_len = 0;
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+        port_obj->rx_pending = false;
+        memset(&port_obj->rx_timing, 0, sizeof(port_obj->rx_timing));
+#endif
+    }
+}
+
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+
+static void mb_port_ser_timing_init(mb_ser_port_t *port_obj)
+{
+    uint32_t baudrate = port_obj->ser_opts.baudrate ? port_obj->ser_opts.baudrate : 9600;
+    port_obj->char_time_us = (MB_SERIAL_CHAR_BITS * 1000000UL) / baudrate;
+    // Start from T3.5, the fixed 1750 us is used above 19200 bps
+    port_obj->gap_base_us = (baudrate > 19200) ? 1750 : ((port_obj->char_time_us * 7) / 2);
+    port_obj->gap_window_us = port_obj->gap_base_us;
+}
+
+// Widen the gap window to the measured silent interval inside the frame,
+// the gap is measured only when the slave continues the pending frame
+static void mb_port_ser_timing_learn_gap(mb_ser_port_t *port_obj, uint32_t gap_us)
+{
+    uint32_t window_us = gap_us + (gap_us >> 1);
+    window_us = (window_us < MB_SERIAL_GAP_WINDOW_MAX_US) ? window_us : MB_SERIAL_GAP_WINDOW_MAX_US;
+    if (window_us > port_obj->gap_window_us) {
+        port_obj->gap_window_us = window_us;
+        ESP_LOGD(TAG, "%s, gap window is %" PRIu32 " us.", port_obj->base.descr.parent_name, window_us);
+    }
+    if (gap_us > port_obj->rx_timing.gap_max_us) {
+        port_obj->rx_timing.gap_max_us = gap_us;
+    }
+}
+
+// Measure the gaps and the response start, called under rx_lock before the bytes are read
+static void mb_port_ser_timing_update(mb_ser_port_t *port_obj, size_t size, bool is_tout)
+{
+    int64_t now_ts = esp_timer_get_time();
+    // The UART event is generated after the bytes are received and the RX timeout symbols when set
+    int64_t chunk_us = (int64_t)(size + (is_tout ? MB_SERIAL_TOUT : 0)) * port_obj->char_time_us;
+    if (port_obj->rx_pending) {
+        // The slave continues the frame after the gap
+        int64_t gap_us = now_ts - port_obj->rx_pending_ts + (MB_SERIAL_TOUT * port_obj->char_time_us) - chunk_us;
+        mb_port_ser_timing_learn_gap(port_obj, (gap_us > 0) ? (uint32_t)gap_us : 0);
+        port_obj->rx_pending = false;
+    } else if (!port_obj->rx_len) {
+        int64_t latency_us = now_ts - chunk_us - (int64_t)port_obj->send_time_stamp;
+        port_obj->rx_timing.latency_us = (port_obj->base.descr.is_master && port_obj->send_time_stamp && (latency_us > 0))
+                                            ? (uint32_t)latency_us : 0;
+    }
+}
+
+// The frame without the gaps inside is received with correct CRC, narrow the window back toward T3.5
+// so one noisy frame does not delay all next frames with wrong CRC
+static void mb_port_ser_timing_shrink_gap(mb_ser_port_t *port_obj)
+{
+    uint32_t excess_us = port_obj->gap_window_us - port_obj->gap_base_us;
+    if (excess_us) {
+        port_obj->gap_window_us -= (excess_us > 7) ? (excess_us >> 3) : excess_us;
+    }
+}
+
+// The CRC is wrong when the UART timeout expires, the rest of the frame can come after the gap
+static bool mb_port_ser_rx_wait_rest(mb_ser_port_t *port_obj)
+{
+    bool is_pending = false;
+    CRITICAL_SECTION(port_obj->rx_lock) {
+        if (!port_obj->rx_pending && !port_obj->rx_overflow && port_obj->rx_crc
+            && (port_obj->rx_len > MB_SER_PDU_SIZE_MIN)) {
+            port_obj->rx_pending = true;
+            port_obj->rx_pending_ts = esp_timer_get_time();
+            is_pending = true;
+        }
+    }
+    return is_pending;
+}
+
+static TickType_t mb_port_ser_rx_wait_ticks(mb_ser_port_t *port_obj)
+{
+    if (!port_obj->rx_pending) {
+        return MB_SERIAL_RX_TOUT_TICKS;
+    }
+    TickType_t ticks = pdMS_TO_TICKS((port_obj->gap_window_us + 999) / 1000);
+    return ticks ? ticks : 1;
+}
+
+#endif
+
+// Read the received bytes into the collecting buffer and update the frame CRC
+static void mb_port_ser_rx_collect(mb_ser_port_t *port_obj, bool is_tout)
+{
+    size_t size = 0;
+    CRITICAL_SECTION(port_obj->rx_lock) {
+        (void)uart_get_buffered_data_len(port_obj->ser_opts.port, &size);
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+        if (size) {
+            mb_port_ser_timing_update(port_obj, size, is_tout);
+        }
+#else
+        (void)is_tout;
+#endif
+        uint8_t *buf = port_obj->rx_buf[port_obj->rx_idx];
+        while (size && !port_obj->rx_overflow) {
+            size_t room = MB_BUFFER_SIZE - port_obj->rx_len;
+            if (!room) {
+                // The frame is longer than the buffer, drop it
+                (void)uart_flush_input(port_obj->ser_opts.port);
+                port_obj->rx_overflow = true;
+                break;
+            }
+            int count = uart_read_bytes(port_obj->ser_opts.port, &buf[port_obj->rx_len],
+                                        (size < room) ? size : room, 0);
+            if (count <= 0) {
+                break;
+            }
+            port_obj->rx_crc = mb_crc16_update(port_obj->rx_crc, &buf[port_obj->rx_len], (uint16_t)count);
+            port_obj->rx_len += (uint16_t)count;
+            size -= (size_t)count;
+        }
+    }
+}
+
+// The T3.5 gap is detected, pass the collected frame to the transport and start the next one
+static uint16_t mb_port_ser_rx_complete(mb_ser_port_t *port_obj)
+{
+    uint16_t length = 0;
+    CRITICAL_SECTION(port_obj->rx_lock) {
+        if (!port_obj->rx_overflow) {
+            length = port_obj->rx_len;
+            port_obj->frame_len = port_obj->rx_len;
+            port_obj->frame_crc = port_obj->rx_crc;
+            port_obj->rx_idx ^= 1;
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+            port_obj->rx_timing.length = port_obj->rx_len;
+            port_obj->frame_timing = port_obj->rx_timing;
+            if (!port_obj->rx_crc && !port_obj->rx_timing.gap_max_us) {
+                mb_port_ser_timing_shrink_gap(port_obj);
+            }
+#endif
+        }
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+        port_obj->rx_pending = false;
+        memset(&port_obj->rx_timing, 0, sizeof(port_obj->rx_timing));
+#endif
+        port_obj->rx_len = 0;
+        port_obj->rx_crc = MB_CRC16_INIT;
+        port_obj->rx_overflow = false;
+    }
+    return length;
+}
+
+#endif
+
 static void mb_port_ser_rx_flush(mb_port_base_t *inst)
 {
     size_t size = 1;
@@ -109,6 +333,11 @@ static void mb_port_ser_rx_flush(mb_port_base_t *inst)
                                 "%s, mb flush serial fail, error = 0x%x.", inst->descr.parent_name, (int)err);
         }
     }
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+    if (port_obj->ser_opts.mode == MB_RTU) {
+        mb_port_ser_rx_reset(port_obj);
+    }
+#endif
 }
 
 void mb_port_ser_enable(mb_port_base_t *inst)
@@ -133,6 +362,20 @@ void mb_port_ser_disable(mb_port_base_t *inst)
     }
 }
 
+// Pass the received frame to the main FSM
+static void mb_port_ser_frame_post(mb_ser_port_t *port_obj, size_t size)
+{
+    port_obj->recv_length = (size < MB_BUFFER_SIZE) ? size : MB_BUFFER_SIZE;
+    if (size <= MB_SER_PDU_SIZE_MIN) {
+        ESP_LOGD(TAG, "%s, drop short packet %d byte(s)", port_obj->base.descr.parent_name, (int)size);
+        (void)mb_port_ser_rx_flush(&port_obj->base);
+        return;
+    }
+    // New frame is received, send an event to main FSM to read it into receiver buffer
+    mb_port_event_post(&port_obj->base, EVENT(EV_FRAME_RECEIVED, port_obj->recv_length, NULL, 0));
+    ESP_LOGD(TAG, "%s, frame %d bytes is ready.", port_obj->base.descr.parent_name, (int)port_obj->recv_length);
+}
+
 // UART receive event task
 static void mb_port_ser_task(void *p_args)
 {
@@ -146,11 +389,21 @@ static void mb_port_ser_task(void *p_args)
             ESP_LOGI(TAG, "%s, suspend port from task.", port_obj->base.descr.parent_name);
             ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         }
-        if (xQueueReceive(port_obj->uart_queue, (void *)&event, MB_SERIAL_RX_TOUT_TICKS)) {
+        TickType_t rx_tout_ticks = MB_SERIAL_RX_TOUT_TICKS;
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+        rx_tout_ticks = mb_port_ser_rx_wait_ticks(port_obj);
+#endif
+        if (xQueueReceive(port_obj->uart_queue, (void *)&event, rx_tout_ticks)) {
             ESP_LOGD(TAG, "%s, UART[%d] event:", port_obj->base.descr.parent_name, port_obj->ser_opts.port);
             switch(event.type) {
                 case UART_DATA:
                     ESP_LOGD(TAG, "%s, data event, len: %d.", port_obj->base.descr.parent_name, (int)event.size);
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+                    // The CRC is calculated while the frame is received, it is ready when the gap is detected
+                    if (port_obj->ser_opts.mode == MB_RTU) {
+                        mb_port_ser_rx_collect(port_obj, event.timeout_flag);
+                    }
+#endif
                     // This flag set in the event means that no more
                     // data received during configured timeout and UART TOUT feature is triggered
                     if (event.timeout_flag) {
@@ -159,16 +412,21 @@ static void mb_port_ser_task(void *p_args)
                             mb_port_ser_rx_flush(&port_obj->base);
                             break;
                         }
-                        uart_get_buffered_data_len(port_obj->ser_opts.port, (unsigned int*)&event.size);
-                        port_obj->recv_length = (event.size < MB_BUFFER_SIZE) ? event.size : MB_BUFFER_SIZE;
-                        if (event.size <= MB_SER_PDU_SIZE_MIN) {
-                            ESP_LOGD(TAG, "%s, drop short packet %d byte(s)", port_obj->base.descr.parent_name, (int)event.size);
-                            (void)mb_port_ser_rx_flush(&port_obj->base);
-                            break;
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+                        if (port_obj->ser_opts.mode == MB_RTU) {
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+                            // The slave with irregular gaps can continue the frame
+                            if (mb_port_ser_rx_wait_rest(port_obj)) {
+                                break;
+                            }
+#endif
+                            event.size = mb_port_ser_rx_complete(port_obj);
+                        } else
+#endif
+                        {
+                            uart_get_buffered_data_len(port_obj->ser_opts.port, (unsigned int*)&event.size);
                         }
-                        // New frame is received, send an event to main FSM to read it into receiver buffer
-                        mb_port_event_post(&port_obj->base, EVENT(EV_FRAME_RECEIVED, port_obj->recv_length, NULL, 0));
-                        ESP_LOGD(TAG, "%s, frame %d bytes is ready.", port_obj->base.descr.parent_name, (int)port_obj->recv_length);
+                        mb_port_ser_frame_post(port_obj, event.size);
                     }
                     break;
                 //Event of HW FIFO overflow detected
@@ -200,6 +458,12 @@ static void mb_port_ser_task(void *p_args)
                     break;
             }
         }
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+        else if (port_obj->rx_pending) {
+            // The rest of the frame is not received during the gap window
+            mb_port_ser_frame_post(port_obj, mb_port_ser_rx_complete(port_obj));
+        }
+#endif
     }
     vTaskDelete(NULL);
 }
@@ -213,12 +477,22 @@ mb_err_enum_t mb_port_ser_create(mb_serial_opts_t *ser_opts, mb_port_base_t **in
     MB_GOTO_ON_FALSE((ser_port && in_out_obj), MB_EILLSTATE, error, TAG, "mb serial port creation error.");
 
     CRITICAL_SECTION_INIT(ser_port->base.lock);
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+    CRITICAL_SECTION_INIT(ser_port->rx_lock);
+    ser_port->rx_crc = MB_CRC16_INIT;
+#endif
     ser_port->base.descr = (*in_out_obj)->descr;
     ser_opts->data_bits = ((ser_opts->data_bits > UART_DATA_5_BITS) 
                                 && (ser_opts->data_bits < UART_DATA_BITS_MAX)) 
                                 ? ser_opts->data_bits : UART_DATA_8_BITS;
     // Keep the UART communication options
     ser_port->ser_opts = *ser_opts;
+#if (CONFIG_FMB_COMM_MODE_RTU_EN && MB_SERIAL_MEASURED_TIMING_ENABLED)
+    mb_port_ser_timing_init(ser_port);
+#endif
+#if (MB_SERIAL_RS485_HALF_DUPLEX_ENABLED)
+    mb_port_ser_tx_init(ser_port);
+#endif
     // Configure serial communication parameters
     uart_config_t uart_cfg = {
         .baud_rate = ser_opts->baudrate,
@@ -247,6 +521,12 @@ mb_err_enum_t mb_port_ser_create(mb_serial_opts_t *ser_opts, mb_port_base_t **in
                         "%s, mb serial set rx timeout failure, returned (0x%x).", ser_port->base.descr.parent_name, (int)err);
     // Set always timeout flag to trigger timeout interrupt even after rx fifo full
     uart_set_always_rx_timeout(ser_port->ser_opts.port, true);
+#if (MB_SERIAL_RS485_HALF_DUPLEX_ENABLED)
+    // The UART drives the RTS (DE) pin during transmission and releases it after the last stop bit
+    err = uart_set_mode(ser_port->ser_opts.port, UART_MODE_RS485_HALF_DUPLEX);
+    MB_GOTO_ON_FALSE((err == ESP_OK), MB_EILLSTATE, error, TAG,
+                        "%s, mb serial set rs485 mode failure, returned (0x%x).", ser_port->base.descr.parent_name, (int)err);
+#endif
     MB_GOTO_ON_FALSE((mb_port_ser_bus_sema_init(&ser_port->base)), MB_EILLSTATE, error, TAG,
                                 "%s, mb serial bus semaphore create fail.", ser_port->base.descr.parent_name);
     // Suspend task on start and then resume when initialization is completed
@@ -271,6 +551,9 @@ error:
         }
         uart_driver_delete(ser_port->ser_opts.port);
         CRITICAL_SECTION_CLOSE(ser_port->base.lock);
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+        CRITICAL_SECTION_CLOSE(ser_port->rx_lock);
+#endif
         mb_port_ser_bus_sema_close(&ser_port->base);
     }
     free(ser_port);
@@ -284,6 +567,9 @@ void mb_port_ser_delete(mb_port_base_t *inst)
     ESP_ERROR_CHECK(uart_driver_delete(port_obj->ser_opts.port));
     mb_port_ser_bus_sema_close(inst);
     CRITICAL_SECTION_CLOSE(inst->lock);
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+    CRITICAL_SECTION_CLOSE(port_obj->rx_lock);
+#endif
     free(port_obj);
 }
 
@@ -296,8 +582,29 @@ bool mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **ser_frame, uint16_t *
 
     status = mb_port_ser_bus_sema_take(inst, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
     if (status && counter && *ser_frame && atomic_load(&(port_obj->enabled))) {
-        // Read frame data from the ringbuffer of receiver
-        counter = uart_read_bytes(port_obj->ser_opts.port, *ser_frame, counter, MB_SERIAL_RX_TOUT_TICKS);
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+        if (port_obj->ser_opts.mode == MB_RTU) {
+            // The frame is already read from UART by the port task
+            CRITICAL_SECTION(port_obj->rx_lock) {
+                counter = (counter < port_obj->frame_len) ? counter : port_obj->frame_len;
+                memcpy(*ser_frame, port_obj->rx_buf[port_obj->rx_idx ^ 1], counter);
+                port_obj->recv_crc_len = (counter == port_obj->frame_len) ? counter : 0;
+                port_obj->recv_crc = port_obj->frame_crc;
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+                port_obj->recv_timing = port_obj->frame_timing;
+                if (port_obj->base.descr.is_master && port_obj->recv_timing.length) {
+                    ESP_LOGD(TAG, "%s, turnaround of response: %" PRIu32 " us.",
+                                inst->descr.parent_name, port_obj->recv_timing.latency_us);
+                }
+#endif
+                port_obj->frame_len = 0;
+            }
+        } else
+#endif
+        {
+            // Read frame data from the ringbuffer of receiver
+            counter = uart_read_bytes(port_obj->ser_opts.port, *ser_frame, counter, MB_SERIAL_RX_TOUT_TICKS);
+        }
         // Store the timestamp of received frame
         port_obj->recv_time_stamp = esp_timer_get_time();
         ESP_LOGD(TAG, "%s, received data: %d bytes.", inst->descr.parent_name, (int)counter);
@@ -326,6 +633,10 @@ bool mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t
     if (res && p_ser_frame && ser_length && atomic_load(&(port_obj->enabled))) {
         // Flush buffer received from previous transaction
         mb_port_ser_rx_flush(inst);
+#if (MB_SERIAL_RS485_HALF_DUPLEX_ENABLED)
+        // The frame is queued into the TX ring buffer of the driver and sent from the UART interrupt
+        int64_t write_ts = esp_timer_get_time();
+#endif
         count = uart_write_bytes(port_obj->ser_opts.port, p_ser_frame, ser_length);
         // Waits while UART sending the packet
         esp_err_t status = uart_wait_tx_done(port_obj->ser_opts.port, MB_SERIAL_TX_TOUT_TICKS);
@@ -334,6 +645,12 @@ bool mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t
                                 inst->descr.parent_name);
         MB_PRT_BUF(inst->descr.parent_name, ":PORT_SEND", p_ser_frame, ser_length, ESP_LOG_DEBUG);
         port_obj->send_time_stamp = esp_timer_get_time();
+#if (MB_SERIAL_RS485_HALF_DUPLEX_ENABLED)
+        mb_port_ser_tx_end(port_obj, write_ts, ser_length);
+#endif
+#if (CONFIG_FMB_COMM_MODE_RTU_EN && MB_SERIAL_MEASURED_TIMING_ENABLED)
+        port_obj->recv_timing.length = 0;
+#endif
         res = true;
     } else {
         ESP_LOGE(TAG, "%s, send fail state:%d, %p, %u. ", inst->descr.parent_name, (int)port_obj->tx_state_en, p_ser_frame, (unsigned)ser_length);
@@ -342,4 +659,33 @@ bool mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t
     return res;
 }
 
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+
+uint16_t mb_port_ser_get_recv_crc(mb_port_base_t *inst, const uint8_t *ser_frame, uint16_t ser_length)
+{
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    // Use the CRC calculated on reception if the whole frame is read
+    if ((port_obj->ser_opts.mode == MB_RTU) && ser_length && (ser_length == port_obj->recv_crc_len)) {
+        return port_obj->recv_crc;
+    }
+    return mb_crc16_update(MB_CRC16_INIT, ser_frame, ser_length);
+}
+
+bool mb_port_ser_get_rx_timing(mb_port_base_t *inst, mb_ser_rx_timing_t *timing)
+{
+#if (MB_SERIAL_MEASURED_TIMING_ENABLED)
+    mb_ser_port_t *port_obj = __containerof(inst, mb_ser_port_t, base);
+    if (timing && port_obj->recv_timing.length) {
+        *timing = port_obj->recv_timing;
+#if (MB_SERIAL_RS485_HALF_DUPLEX_ENABLED)
+        timing->tx_done_us = port_obj->tx_done_us;
+#endif
+        return true;
+    }
+#endif
+    return false;
+}
+
+#endif
+
 #endif
@@ -30,6 +30,24 @@ void mb_port_ser_enable(mb_port_base_t *inst);
 void mb_port_ser_disable(mb_port_base_t *inst);
 void mb_port_ser_delete(mb_port_base_t *inst);
 
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+/**
+ * @brief Measured timing of the received RTU frame
+ */
+typedef struct {
+    uint32_t latency_us;        /*!< From the end of request transmission to the first byte of response (master) */
+    uint32_t tx_done_us;        /*!< Delay of the TX done notification after the last stop bit of request */
+    uint32_t gap_max_us;        /*!< The longest silent interval inside the frame */
+    uint16_t length;            /*!< Length of the frame */
+} mb_ser_rx_timing_t;
+
+// Returns the timing of the frame read by mb_port_ser_recv_data() after the last send, false if it is not measured
+bool mb_port_ser_get_rx_timing(mb_port_base_t *inst, mb_ser_rx_timing_t *timing);
+
+// Returns the RTU CRC16 of the frame read by mb_port_ser_recv_data(), zero if the frame is correct
+uint16_t mb_port_ser_get_recv_crc(mb_port_base_t *inst, const uint8_t *ser_frame, uint16_t ser_length);
+#endif
+
 #endif
 
 #ifdef __cplusplus
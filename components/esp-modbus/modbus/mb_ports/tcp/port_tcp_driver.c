@@ -78,6 +78,7 @@ static esp_err_t close_event_fd(void *ctx)
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     if (mb_drv_loop_inst_counter) {
         close(drv_obj->event_fd);
+        drv_obj->event_fd = UNDEF_FD;
     } else {
         ESP_LOGD(TAG, "close eventfd (%d).", (int)drv_obj->event_fd);
         return esp_vfs_eventfd_unregister();
@@ -96,17 +97,55 @@ int32_t write_event(void *ctx, mb_event_info_t *event)
         ESP_LOGE(TAG, "%p, event loop send fail, err = %d.", ctx, (int)err);
         return -1;
     }
-    // send eventfd to just trigger select
-    int32_t ret = write(drv_obj->event_fd, (char *)&event->val, sizeof(mb_event_info_t));
-    return (ret == sizeof(mb_event_info_t)) ? event->event_id : -1;
+    // increment the eventfd counter to trigger select, the counter is the number of posted events
+    uint64_t count = 1;
+    int32_t ret = write(drv_obj->event_fd, (char *)&count, sizeof(count));
+    return (ret == sizeof(count)) ? event->event_id : -1;
 }
 
-static int32_t read_event(void *ctx, mb_event_info_t *event)
+// Returns the number of events posted since the last read and resets the eventfd counter
+static int32_t read_event(void *ctx, uint64_t *count)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
-    MB_RETURN_ON_FALSE(event, ESP_ERR_INVALID_STATE, TAG, "cannot get event.");
-    int ret = read(drv_obj->event_fd, (char *)&event->val, sizeof(mb_event_info_t));
-    return (ret == sizeof(mb_event_info_t)) ? event->event_id : -1;
+    MB_RETURN_ON_FALSE(count, -1, TAG, "cannot get event.");
+    int ret = read(drv_obj->event_fd, (char *)count, sizeof(uint64_t));
+    return (ret == sizeof(uint64_t)) ? (int32_t)*count : -1;
+}
+
+// Unblocks the select of driver task without posting an event
+static void mb_drv_wakeup(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    uint64_t count = 1;
+    if ((drv_obj->event_fd > 0) && (write(drv_obj->event_fd, (char *)&count, sizeof(count)) != sizeof(count))) {
+        ESP_LOGD(TAG, "%p, driver wakeup fail.", ctx);
+    }
+}
+
+// Mark the watched set as changed, the driver task rebuilds it before the next select
+static void mb_drv_set_watch_changed(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    atomic_store(&drv_obj->watch_changed, true);
+    if (xTaskGetCurrentTaskHandle() != drv_obj->mb_tcp_task_handle) {
+        mb_drv_wakeup(ctx);
+    }
+}
+
+// The event loop is shared between instances, so the event can be handled by the task of other instance.
+// The dispatcher calls the handler of the instance and then marks the watched set as changed
+// if the handled event could change the state of nodes.
+static MB_EVENT_HANDLER(mb_drv_event_dispatch)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    int event_num = (id > 0) ? __builtin_ctz((unsigned)id) : MB_EVENT_COUNT;
+    mb_event_handler_fp fp = (event_num < MB_EVENT_COUNT) ? drv_obj->event_fp[event_num] : NULL;
+    if (fp) {
+        fp(ctx, base, id, data);
+    }
+    if (id & MB_EVENT_STATE_MASK) {
+        mb_drv_set_watch_changed(ctx);
+    }
 }
 
 static esp_err_t mb_drv_event_loop_init(void *ctx)
@@ -163,8 +202,9 @@ esp_err_t mb_drv_register_handler(void *ctx, mb_driver_event_num_t event_num, mb
     MB_RETURN_ON_FALSE((drv_obj->event_handler[event_num] == NULL), ESP_ERR_INVALID_ARG,
                         TAG, "%p, event handler %p, for event %x, is not empty.", drv_obj, drv_obj->event_handler[event_num], (int)event);
 
+    drv_obj->event_fp[event_num] = fp;
     ret = esp_event_handler_instance_register_with(mb_drv_loop_handle, MB_EVENT_BASE(ctx), event,
-                                                                fp, ctx, &drv_obj->event_handler[event_num]);
+                                                                mb_drv_event_dispatch, ctx, &drv_obj->event_handler[event_num]);
     ESP_LOGD(TAG, "%p, registered event handler %p, event 0x%x", drv_obj, drv_obj->event_handler[event_num], (int)event);
     MB_RETURN_ON_FALSE((ret == ESP_OK), ESP_ERR_INVALID_STATE,
                             TAG, "%p, event handler %p, registration error.", drv_obj, drv_obj->event_handler[event_num]);
@@ -185,6 +225,7 @@ esp_err_t mb_drv_unregister_handler(void *ctx, mb_driver_event_num_t event_num)
     ret = esp_event_handler_instance_unregister_with(mb_drv_loop_handle,
                                                       MB_EVENT_BASE(ctx), (int32_t)event, drv_obj->event_handler[event_num]);
     drv_obj->event_handler[event_num] = NULL;
+    drv_obj->event_fp[event_num] = NULL;
     MB_RETURN_ON_FALSE((ret == ESP_OK), ESP_ERR_INVALID_STATE ,
                         TAG, "%p, event handler %p, instance unregister with, error = %d", drv_obj, drv_obj->event_handler[event_num], (int)ret);
 
@@ -193,6 +234,12 @@ esp_err_t mb_drv_unregister_handler(void *ctx, mb_driver_event_num_t event_num)
 
 static esp_err_t init_queues(mb_node_info_t *mb_node)
 {
+    // The pool is optional, the frames are allocated from heap if it is not created
+    mb_node->frame_pool = frame_pool_create(MB_FRAME_POOL_SLOTS, MB_TCP_BUFF_MAX_SIZE);
+    mb_node->rx_buf = malloc(MB_RX_BUFFER_SIZE);
+    MB_RETURN_ON_FALSE(mb_node->rx_buf, ESP_ERR_NO_MEM, TAG, "create receive buffer failed");
+    mb_node->rx_len = 0;
+    mb_node->rx_pending = false;
     mb_node->rx_queue = queue_create(MB_RX_QUEUE_MAX_SIZE);
     MB_RETURN_ON_FALSE(mb_node->rx_queue, ESP_ERR_NO_MEM, TAG, "create rx queue failed");
     mb_node->tx_queue = queue_create(MB_TX_QUEUE_MAX_SIZE);
@@ -217,6 +264,11 @@ static void delete_queues(mb_node_info_t *pmb_node)
             queue_delete(pmb_node->tx_queue);
             pmb_node->tx_queue = NULL;
         }
+        frame_pool_delete(pmb_node->frame_pool);
+        pmb_node->frame_pool = NULL;
+        free(pmb_node->rx_buf);
+        pmb_node->rx_buf = NULL;
+        pmb_node->rx_len = 0;
     }
 }
 
@@ -361,7 +413,9 @@ ssize_t mb_drv_write(void *ctx, int fd, const void *data, size_t size)
     }
 
     if (MB_GET_NODE_STATE(node_ptr) >= MB_SOCK_STATE_CONNECTED) {
-        if (queue_push(node_ptr->tx_queue, (void *)data, size, NULL) == ESP_OK) {
+        frame_entry_t frame_info = {0};
+        frame_info.pool = node_ptr->frame_pool;
+        if (queue_push(node_ptr->tx_queue, (void *)data, size, &frame_info) == ESP_OK) {
             ret = size;
             // Inform FSM that is new frame data is ready to be send
             DRIVER_SEND_EVENT(ctx, MB_EVENT_SEND_DATA, node_ptr->index);
@@ -444,6 +498,7 @@ int mb_drv_close(void *ctx, int fd)
     free(node_ptr);
     drv_obj->mb_nodes[fd] = NULL;
     mb_drv_unlock(ctx);
+    mb_drv_set_watch_changed(ctx);
 
     return 0;
 }
@@ -481,31 +536,58 @@ mb_node_info_t *mb_drv_get_node_info_from_addr(void *ctx, uint8_t uid)
     return NULL;
 }
 
-static int mb_drv_register_fds(void *ctx, fd_set *fdset)
+// Rebuild the cached set of watched file descriptors, it is done only when the state of nodes is changed
+static void mb_drv_update_watch_set(void *ctx)
 {
     mb_node_info_t *node_ptr = NULL;
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
-    // Setup select waiting for eventfd && socket events
-    FD_ZERO(fdset);
+    fd_set *fdset = &drv_obj->watch_set;
     int max_fd = UNDEF_FD;
-    // Add to the set all connected slaves
+    FD_ZERO(fdset);
+    drv_obj->watch_count = 0;
+    // Add to the set all connected nodes
     for (int i = 0; i < MB_MAX_FDS; i++) {
         node_ptr = drv_obj->mb_nodes[i];
-        if (node_ptr && node_ptr->sock_id && (MB_GET_NODE_STATE(node_ptr) >= MB_SOCK_STATE_CONNECTED)) {
+        if (node_ptr && (node_ptr->sock_id > 0) && (MB_GET_NODE_STATE(node_ptr) >= MB_SOCK_STATE_CONNECTED)) {
             MB_ADD_FD(node_ptr->sock_id, max_fd, fdset);
+            drv_obj->watch_list[drv_obj->watch_count++] = (uint16_t)i;
         }
     }
     // Add event fd events to the set to handle them in one select
     MB_ADD_FD(drv_obj->event_fd, max_fd, fdset);
     // Add listen socket to handle incoming connections (for slave only)
     MB_ADD_FD(drv_obj->listen_sock_fd, max_fd, fdset);
-    return max_fd;
+    drv_obj->watch_max_fd = max_fd;
+    ESP_LOGD(TAG, "%p, watched set is updated, nodes: %u, max_fd: %d.", ctx, (unsigned)drv_obj->watch_count, max_fd);
 }
 
-// Wait socket ready event during timeout
+// Returns the time to wait for the earliest node check in milliseconds or -1 to wait forever
+static int mb_drv_get_wait_time(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    // Only the slave checks the idle connections on timeout event
+    if (drv_obj->is_master || !drv_obj->watch_count) {
+        return -1;
+    }
+    int64_t time_now = esp_timer_get_time();
+    int64_t wait_us = INT64_MAX;
+    for (int i = 0; i < drv_obj->watch_count; i++) {
+        mb_node_info_t *node_ptr = drv_obj->mb_nodes[drv_obj->watch_list[i]];
+        if (node_ptr) {
+            int64_t node_wait_us = node_ptr->recv_time + (int64_t)(MB_TCP_KEEP_ALIVE_TOUT_MS * 1000) - time_now;
+            wait_us = (node_wait_us < wait_us) ? node_wait_us : wait_us;
+        }
+    }
+    if (wait_us == INT64_MAX) {
+        return -1;
+    }
+    return (wait_us > (MB_SELECT_WAIT_MS * 1000)) ? (int)(wait_us / 1000) : MB_SELECT_WAIT_MS;
+}
+
+// Wait socket ready event during timeout, the negative timeout means wait forever
 static int mb_drv_wait_fd_events(void *ctx, fd_set *fdset, fd_set *perrset, int time_ms)
 {
-    fd_set readset = *fdset;
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     int ret = 0;
     struct timeval tv;
 
@@ -516,13 +598,13 @@ static int mb_drv_wait_fd_events(void *ctx, fd_set *fdset, fd_set *perrset, int
     tv.tv_sec = time_ms / 1000;
     tv.tv_usec = (time_ms - (tv.tv_sec * 1000)) * 1000;
 
-    // fill the readset according to the active fds
-    int max_fd = mb_drv_register_fds(ctx, &readset);
+    // the readset is the cached set of the active fds
+    fd_set readset = drv_obj->watch_set;
     if (perrset) {
         *perrset = readset; // initialize error set if used
     }
 
-    ret = select(max_fd + 1, &readset, NULL, perrset, &tv);
+    ret = select(drv_obj->watch_max_fd + 1, &readset, NULL, perrset, (time_ms < 0) ? NULL : &tv);
     if (ret == 0) {
         // No respond from node during timeout
         ret = ERR_TIMEOUT;
@@ -550,6 +632,8 @@ esp_err_t mb_drv_stop_task(void *ctx)
         drv_obj->close_done_sema = xSemaphoreCreateBinary();
     }
     (void)mb_drv_set_status_flag(ctx, MB_FLAG_SUSPEND);
+    // The task can be blocked in select without timeout, unblock it to check the flag
+    mb_drv_wakeup(ctx);
     // Check if we can safely suspend the port task (workaround for issue with deadlock in suspend)
     if (!drv_obj->close_done_sema 
             || !(mb_drv_wait_status_flag(ctx, MB_FLAG_SUSPEND, 1) & MB_FLAG_SUSPEND) 
@@ -595,6 +679,104 @@ err_t mb_drv_check_node_state(void *ctx, int *fd_ptr, uint32_t timeout_ms)
     return err;
 }
 
+// Read the ready socket of the node and queue the received frame
+static void mb_drv_read_node(void *ctx, mb_node_info_t *node_ptr)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    // All complete frames received in the socket are queued at once
+    int ret = port_read_packet(node_ptr);
+    if (ret > 0) {
+        ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", %d frame(s) received."), ctx, (int)node_ptr->fd,
+                    (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str, ret);
+        mb_drv_lock(ctx);
+        node_ptr->recv_time = esp_timer_get_time();
+        mb_drv_unlock(ctx);
+        // The handler processes one frame per event
+        for (int i = 0; i < ret; i++) {
+            DRIVER_SEND_EVENT(ctx, MB_EVENT_RECV_DATA, node_ptr->index);
+        }
+    } else if (ret == ERR_TIMEOUT) {
+        ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", no complete frame received."), ctx, (int)node_ptr->fd,
+                    (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
+    } else if (ret == ERR_BUF) {
+        // After retries a response with incorrect TID received, process failure.
+        drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_RECV_FAIL);
+        ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", frame error."), ctx, (int)node_ptr->fd,
+                    (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
+    } else {
+        if (ret == ERR_CONN) {
+            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", connection lost."), ctx, (int)node_ptr->fd,
+                        (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
+        } else {
+            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", critical read error=%d, errno=%u."), ctx, (int)node_ptr->fd,
+                    (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str, (int)ret, (unsigned)errno);
+        }
+        DRIVER_SEND_EVENT(ctx, MB_EVENT_ERROR, node_ptr->index);
+    }
+}
+
+// Queue the frames kept in the receive buffers of nodes while their queues were full,
+// the posted events wake up the task to handle them
+static void mb_drv_read_pending(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    for (int i = 0; i < drv_obj->watch_count; i++) {
+        mb_node_info_t *node_ptr = drv_obj->mb_nodes[drv_obj->watch_list[i]];
+        if (!node_ptr || !node_ptr->rx_pending || (node_ptr->sock_id <= 0)
+                || queue_is_full(node_ptr->rx_queue)) {
+            continue;
+        }
+        int ret = port_parse_packets(node_ptr);
+        ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", %d pending frame(s) queued."), ctx, (int)node_ptr->fd,
+                    (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str, ret);
+        for (int j = 0; j < ret; j++) {
+            DRIVER_SEND_EVENT(ctx, MB_EVENT_RECV_DATA, node_ptr->index);
+        }
+    }
+}
+
+// Accept the incoming connection on the listen socket (slave only)
+static void mb_drv_accept_node(void *ctx)
+{
+    port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
+    ESP_LOGD(TAG, "%p, listen_sock is active.", ctx);
+    mb_uid_info_t node_info;
+    int sock_id = port_accept_connection(drv_obj->listen_sock_fd, &node_info);
+    if (sock_id) {
+        if (drv_obj->mb_node_open_count >= MB_MAX_FDS) {
+            ESP_LOGE(TAG, "%p, unable to accept node, maximum is %u connections.", drv_obj, MB_MAX_FDS);
+#if LWIP_SO_LINGER
+            struct linger sl;
+            sl.l_onoff = 1;  // non-zero value enables linger option in lwip
+            sl.l_linger = 0; // timeout interval in seconds
+            setsockopt(sock_id, SOL_SOCKET, SO_LINGER, &sl, sizeof(sl));
+#endif // LWIP_SO_LINGER
+            close(sock_id);
+        } else {
+            // Create new node info and open it
+            int fd = mb_drv_open(drv_obj, node_info, 0);
+            if (fd < 0) {
+                ESP_LOGE(TAG, "%p, unable to open node: %s", drv_obj, node_info.ip_addr_str);
+            } else {
+                DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, fd);
+            }
+        }
+    }
+}
+
+// Drive the event loop for the posted events without blocking,
+// one extra run handles the events posted from ISR without eventfd notification
+static void mb_drv_run_event_loop(void *ctx, uint64_t count)
+{
+    for (uint64_t i = 0; i <= count; i++) {
+        esp_err_t err = esp_event_loop_run(mb_drv_loop_handle, 0);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "%p, event loop run, returns fail: %x", ctx, (int)err);
+            break;
+        }
+    }
+}
+
 void mb_drv_tcp_task(void *ctx)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
@@ -603,97 +785,55 @@ void mb_drv_tcp_task(void *ctx)
         fd_set readset, errorset;
         FD_ZERO(&readset);
         FD_ZERO(&errorset);
-        // check all active socket and fd events
-        int ret = mb_drv_wait_fd_events(ctx, &readset, &errorset, MB_SELECT_WAIT_MS);
+        // The watched set is rebuilt only when the state of nodes has been changed
+        if (atomic_exchange(&drv_obj->watch_changed, false)) {
+            mb_drv_update_watch_set(ctx);
+        }
+        // The frames left after the queue overflow are queued after the previous frames are handled
+        mb_drv_read_pending(ctx);
+        // check all active socket and fd events, wait without timeout when there are no nodes to check
+        int ret = mb_drv_wait_fd_events(ctx, &readset, &errorset, mb_drv_get_wait_time(ctx));
         if (ret == ERR_TIMEOUT) {
             // timeout occured waiting for the vfds
             DRIVER_SEND_EVENT(ctx, MB_EVENT_TIMEOUT, UNDEF_FD);
             mb_drv_check_suspend_shutdown(ctx);
         } else if (ret == -1) {
-            // error occured during waiting for vfds activation
+            // error occured during waiting for vfds activation, the socket could be closed outside
             ESP_LOGD(TAG, "%p, task select error.", ctx);
             mb_drv_check_suspend_shutdown(ctx);
             ESP_LOGD(TAG, "%p, socket error, fdset: %" PRIx64, ctx, *(uint64_t *)&errorset);
+            atomic_store(&drv_obj->watch_changed, true);
         } else {
-            // Is the fd event triggered, process the event
-            if (drv_obj->event_fd && FD_ISSET(drv_obj->event_fd, &readset)) {
-                mb_event_info_t mb_event = {0};
-                int32_t event_id = read_event(ctx, &mb_event);
-                ESP_LOGD(TAG, "%p, fd event get: 0x%02x:%d, %s", 
-                            ctx, (int)event_id, (int)mb_event.opt_fd, driver_event_to_name_r(event_id));
+            // Process all ready sources in one pass, the event fd first
+            if ((drv_obj->event_fd > 0) && FD_ISSET(drv_obj->event_fd, &readset)) {
+                uint64_t count = 0;
+                int32_t ret = read_event(ctx, &count);
+                ESP_LOGD(TAG, "%p, fd event get: %d", ctx, (int)ret);
                 mb_drv_check_suspend_shutdown(ctx);
-                // Drive the event loop
-                esp_err_t err = esp_event_loop_run(mb_drv_loop_handle, pdMS_TO_TICKS(MB_TCP_EVENT_LOOP_TICK_MS));
-                if (err != ESP_OK) {
-                    ESP_LOGE(TAG, "%p, event loop run, returns fail: %x", ctx, (int)err);
-                }
-            } else if (drv_obj->listen_sock_fd && FD_ISSET(drv_obj->listen_sock_fd, &readset)) {
+                mb_drv_run_event_loop(ctx, (ret > 0) ? count : 0);
+            }
+            if ((drv_obj->listen_sock_fd > 0) && FD_ISSET(drv_obj->listen_sock_fd, &readset)) {
                 // If something happened on the listen socket, then it is an incoming connection.
-                ESP_LOGD(TAG, "%p, listen_sock is active.", ctx);
-                mb_uid_info_t node_info;
-                int sock_id = port_accept_connection(drv_obj->listen_sock_fd, &node_info);
-                if (sock_id) {
-                    if (drv_obj->mb_node_open_count >= MB_MAX_FDS) {
-                        ESP_LOGE(TAG, "%p, unable to accept node, maximum is %u connections.", drv_obj, MB_MAX_FDS);
-#if LWIP_SO_LINGER
-                        struct linger sl;
-                        sl.l_onoff = 1;  // non-zero value enables linger option in lwip
-                        sl.l_linger = 0; // timeout interval in seconds
-                        setsockopt(sock_id, SOL_SOCKET, SO_LINGER, &sl, sizeof(sl));
-#endif // LWIP_SO_LINGER
-                        close(sock_id);
-                    } else {
-                        // Create new node info and open it
-                        int fd = mb_drv_open(drv_obj, node_info, 0);
-                        if (fd < 0) {
-                            ESP_LOGE(TAG, "%p, unable to open node: %s", drv_obj, node_info.ip_addr_str);
-                        } else {
-                            DRIVER_SEND_EVENT(ctx, MB_EVENT_CONNECT, fd);
-                        }
-                    }
+                mb_drv_accept_node(ctx);
+            }
+            // The nodes could be closed by the handled events, the ready sockets are processed on next select
+            if (atomic_load(&drv_obj->watch_changed)) {
+                continue;
+            }
+            // socket event is ready, process each ready socket of the watched nodes
+            for (int i = 0; i < drv_obj->watch_count; i++) {
+                mb_node_info_t *node_ptr = drv_obj->mb_nodes[drv_obj->watch_list[i]];
+                if (!node_ptr || (node_ptr->sock_id <= 0) || !FD_ISSET(node_ptr->sock_id, &readset)) {
+                    continue;
                 }
-            } else {
-                // socket event is ready, process each socket event
-                mb_drv_check_suspend_shutdown(ctx);
-                int curr_fd = 0;
-                mb_node_info_t *node_ptr = NULL;
-                ESP_LOGD(TAG, "%p, socket event active: %" PRIx64, ctx, *(uint64_t *)&readset);
-                while(((node_ptr = mb_drv_get_next_node_from_set(ctx, &curr_fd, &readset))
-                           && (curr_fd < MB_MAX_FDS))) {
-                    if (FD_ISSET(node_ptr->sock_id, &drv_obj->conn_set)) {
-                        // The data is ready in the socket, read frame and queue
-                        FD_CLR(node_ptr->sock_id, &readset);
-                        int ret = port_read_packet(node_ptr);
-                        if (ret > 0) {
-                            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", frame received."), ctx, (int)node_ptr->fd,
-                                        (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
-                            mb_drv_lock(ctx);
-                            node_ptr->recv_time = esp_timer_get_time();
-                            mb_drv_unlock(ctx);
-                            DRIVER_SEND_EVENT(ctx, MB_EVENT_RECV_DATA, node_ptr->index);
-                        } else if (ret == ERR_TIMEOUT) {
-                            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", frame read timeout or closed connection."), ctx, (int)node_ptr->fd,
-                                        (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
-                        } else if (ret == ERR_BUF) {
-                            // After retries a response with incorrect TID received, process failure.
-                            drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_RECV_FAIL);
-                            ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", frame error."), ctx, (int)node_ptr->fd,
-                                        (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
-                        } else {
-                            if (ret == ERR_CONN) {
-                                ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", connection lost."), ctx, (int)node_ptr->fd,
-                                            (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
-                                DRIVER_SEND_EVENT(ctx, MB_EVENT_ERROR, node_ptr->index);
-                            } else {
-                                ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", critical read error=%d, errno=%u."), ctx, (int)node_ptr->fd,
-                                        (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str, (int)ret, (unsigned)errno);
-                                DRIVER_SEND_EVENT(ctx, MB_EVENT_ERROR, node_ptr->index);
-                            }
-                        }
-                    }
-                    curr_fd++;
-                    mb_drv_check_suspend_shutdown(ctx);
+                if (FD_ISSET(node_ptr->sock_id, &drv_obj->conn_set)
+                        && (MB_GET_NODE_STATE(node_ptr) >= MB_SOCK_STATE_CONNECTED)) {
+                    // The data is ready in the socket, read frame and queue
+                    mb_drv_read_node(ctx, node_ptr);
+                } else {
+                    atomic_store(&drv_obj->watch_changed, true);
                 }
+                mb_drv_check_suspend_shutdown(ctx);
             }
         }
     }
@@ -718,9 +858,13 @@ esp_err_t mb_drv_register(port_driver_t **ctx)
     for (i = 0; i < MB_MAX_FDS; i++) {
         pctx->mb_nodes[i] = NULL;
     }
+    pctx->watch_list = calloc(MB_MAX_FDS, sizeof(uint16_t));
+    MB_GOTO_ON_FALSE((pctx->watch_list), ESP_ERR_NO_MEM, error, TAG, "%p, watch list allocation fail.", pctx);
+    FD_ZERO(&pctx->watch_set);
     // initialization of event handlers
     for (i = 0; i < MB_EVENT_COUNT; i++) {
         pctx->event_handler[i] = NULL;
+        pctx->event_fp[i] = NULL;
     }
 
     ret = init_event_fd((void *)pctx);
@@ -775,6 +919,7 @@ error:
             pctx->close_done_sema = NULL;
         }
         free(pctx->mb_nodes);
+        free(pctx->watch_list);
     }
     free(pctx);
     return ret;
@@ -786,6 +931,7 @@ esp_err_t mb_drv_unregister(void *ctx)
     ESP_LOGD(TAG, "%p, driver unregister.", drv_obj);
     (void)mb_drv_set_status_flag(ctx, MB_FLAG_SHUTDOWN);
     drv_obj->close_done_sema = xSemaphoreCreateBinary();
+    mb_drv_wakeup(ctx);
 
     // if no semaphore (alloc issues) or couldn't acquire it, just delete the task
     if (!drv_obj->close_done_sema 
@@ -823,6 +969,8 @@ esp_err_t mb_drv_unregister(void *ctx)
 
     free(drv_obj->mb_nodes); // free the node info address array
     drv_obj->mb_nodes = NULL;
+    free(drv_obj->watch_list);
+    drv_obj->watch_list = NULL;
 
     vEventGroupDelete(drv_obj->status_flags_hdl);
 
@@ -47,13 +47,14 @@ typedef void (*mb_event_handler_fp)(void *ctx, esp_event_base_t base, int32_t id
 #define MB_RX_QUEUE_MAX_SIZE        (CONFIG_FMB_QUEUE_LENGTH)
 #define MB_TX_QUEUE_MAX_SIZE        (CONFIG_FMB_QUEUE_LENGTH)
 #define MB_EVENT_QUEUE_SZ           (CONFIG_FMB_QUEUE_LENGTH * MB_TCP_PORT_MAX_CONN)
+#define MB_FRAME_POOL_SLOTS         (CONFIG_FMB_TCP_FRAME_POOL_SLOTS)
+#define MB_RX_BUFFER_SIZE           (CONFIG_FMB_TCP_RX_BUFFER_SIZE)
 
 #define MB_DROP_TRANSACTION_TIME_US    (1000UL * (CONFIG_FMB_TCP_KEEP_ALIVE_TOUT_SEC * 2000UL)) // drop after twice keep alive timeout is reasonable
 
 #define MB_WAIT_DONE_MS             (5000)
-#define MB_SELECT_WAIT_MS           (200)
+#define MB_SELECT_WAIT_MS           (200) // minimal interval to repeat the node timeout check
 #define MB_TCP_SEND_TIMEOUT_MS      (500)
-#define MB_TCP_EVENT_LOOP_TICK_MS   (50)
 
 #define MB_DRIVER_CONFIG_DEFAULT {              \
     .spin_lock = portMUX_INITIALIZER_UNLOCKED,  \
@@ -70,6 +71,9 @@ typedef void (*mb_event_handler_fp)(void *ctx, esp_event_base_t base, int32_t id
     .close_done_sema = NULL,                    \
     .node_conn_count = 0,                       \
     .event_fd = UNDEF_FD,                       \
+    .watch_max_fd = UNDEF_FD,                   \
+    .watch_count = 0,                           \
+    .watch_changed = true,                      \
 }
 
 #define MB_EVENTFD_CONFIG() (esp_vfs_eventfd_config_t) {    \
@@ -165,6 +169,10 @@ typedef enum _mb_driver_event {
     MB_EVENT_TIMEOUT =(1 << MB_EVENT_TIMEOUT_NUM)
 } mb_driver_event_t;
 
+// The events which handlers can change the state of nodes and then the watched socket set
+#define MB_EVENT_STATE_MASK (MB_EVENT_READY | MB_EVENT_OPEN | MB_EVENT_RESOLVE \
+                                | MB_EVENT_CONNECT | MB_EVENT_ERROR | MB_EVENT_CLOSE)
+
 typedef struct {
     mb_driver_event_t event;
     const char *msg;
@@ -187,6 +195,10 @@ typedef struct mb_node_info_s {
     int recv_err;                       /*!< socket receive error */
     QueueHandle_t rx_queue;             /*!< receive response queue */
     QueueHandle_t tx_queue;             /*!< send request queue */
+    frame_pool_t *frame_pool;           /*!< preallocated frame buffers for rx/tx queues */
+    uint8_t *rx_buf;                    /*!< receive buffer to drain the socket and extract frames */
+    uint16_t rx_len;                    /*!< number of received bytes kept in the receive buffer */
+    bool rx_pending;                    /*!< complete frames are kept in the receive buffer until the queue has space */
     int64_t send_time;                  /*!< send request time stamp */
     int64_t recv_time;                  /*!< receive response time stamp */
     uint16_t tid_counter;               /*!< transaction identifier (TID) for slave */
@@ -245,11 +257,17 @@ typedef struct _port_driver {
     fd_set open_set;                            /*!< file descriptor set for opened nodes */
     fd_set conn_set;                            /*!< file descriptor set for associated nodes */
     int event_fd;                               /*!< eventfd descriptor for modbus event tracking */
+    fd_set watch_set;                           /*!< cached file descriptor set watched by the driver task */
+    int watch_max_fd;                           /*!< maximum file descriptor in the watched set */
+    uint16_t *watch_list;                       /*!< indexes of the connected nodes in the watched set */
+    uint16_t watch_count;                       /*!< number of the connected nodes in the watched set */
+    _Atomic(bool) watch_changed;                /*!< the watched set needs to be rebuilt */
     SemaphoreHandle_t close_done_sema;          /*!< close and done semaphore */
     EventGroupHandle_t status_flags_hdl;        /*!< status bits to control nodes states */
     TaskHandle_t mb_tcp_task_handle;            /*!< TCP/UDP handling task handle */
     esp_event_loop_handle_t event_loop_hdl;     /*!< event loop handle */
     esp_event_handler_instance_t event_handler[MB_EVENT_COUNT]; /*!< event handler instance */
+    mb_event_handler_fp event_fp[MB_EVENT_COUNT]; /*!< event handler functions called by the dispatcher */
     char *loop_name;                            /*!< name for event loop used as base */
     mb_driver_event_cb_t event_cbs;
     //LIST_HEAD(mb_uid_info_, mb_uid_entry_s) node_list; /*!< node address information list */
@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */ 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <string.h>
 
@@ -10,6 +11,8 @@
 #include "port_tcp_driver.h"
 #include "port_tcp_master.h"
 #include "port_tcp_utils.h"
+#include "port_tcp_pipe.h"
+#include "mb_transaction.h"
 
 #if (CONFIG_FMB_COMM_MODE_TCP_EN)
 
@@ -20,6 +23,11 @@ typedef struct
     mb_tcp_opts_t tcp_opts;
     uint8_t ptemp_buf[MB_TCP_BUFF_MAX_SIZE];
     port_driver_t *drv_obj;
+    _Atomic(uint16_t) tid_wait;         // TID of the response the master object waits for
+    _Atomic(bool) is_tid_waited;        // the response with tid_wait is not signaled yet
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+    mbm_tcp_pipe_t pipe[MB_TCP_PORT_MAX_CONN];
+#endif
 } mbm_tcp_port_t;
 
 /* ----------------------- Static variables & functions ----------------------*/
@@ -28,6 +36,49 @@ static uint64_t mbm_port_tcp_sync_event(void *inst, mb_sync_event_t sync_event);
 bool mbm_port_timer_expired(void *inst);
 extern int port_scan_addr_string(char *buffer, mb_uid_info_t *info_ptr);
 
+// Every request to the node takes the next TID, the TIDs of the node start from its index
+static uint16_t mbm_port_tcp_next_tid(port_driver_t *drv_obj, mb_node_info_t *info_ptr)
+{
+    mb_drv_lock(drv_obj);
+    uint16_t tid = info_ptr->tid_counter;
+    if (info_ptr->tid_counter < (USHRT_MAX - 1)) {
+        info_ptr->tid_counter++;
+    } else {
+        info_ptr->tid_counter = (uint16_t)(info_ptr->index << 8U);
+    }
+    mb_drv_unlock(drv_obj);
+    return tid;
+}
+
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+
+static esp_err_t mbm_port_tcp_pipe_init(mbm_tcp_port_t *port_obj)
+{
+    for (int node = 0; node < MB_TCP_PORT_MAX_CONN; node++) {
+        esp_err_t err = mbm_tcp_pipe_init(&port_obj->pipe[node], MB_TCP_MASTER_TID_WINDOW);
+        MB_RETURN_ON_FALSE((err == ESP_OK), err, TAG, "mb tcp port pipeline #%d, resource allocation fail.", node);
+    }
+    return ESP_OK;
+}
+
+static void mbm_port_tcp_pipe_deinit(mbm_tcp_port_t *port_obj)
+{
+    for (int node = 0; node < MB_TCP_PORT_MAX_CONN; node++) {
+        mbm_tcp_pipe_deinit(&port_obj->pipe[node]);
+    }
+}
+
+// The window of the raw requests to the node, NULL if the node is unknown
+static mbm_tcp_pipe_t *mbm_port_tcp_get_pipe(mbm_tcp_port_t *port_obj, mb_node_info_t *info_ptr)
+{
+    if (!info_ptr || (info_ptr->index < 0) || (info_ptr->index >= MB_TCP_PORT_MAX_CONN)) {
+        return NULL;
+    }
+    return &port_obj->pipe[info_ptr->index];
+}
+
+#endif
+
 static esp_err_t mbm_port_tcp_register_handlers(void *ctx)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
@@ -111,6 +162,10 @@ mb_err_enum_t mbm_port_tcp_create(mb_tcp_opts_t *tcp_opts, mb_port_base_t **port
     ptcp->drv_obj = NULL;
     CRITICAL_SECTION_INIT(ptcp->base.lock);
     ptcp->base.descr = (*port_obj)->descr;
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+    err = mbm_port_tcp_pipe_init(ptcp);
+    MB_GOTO_ON_FALSE((err == ESP_OK), MB_EILLSTATE, error, TAG, "mb tcp port pipeline creation error.");
+#endif
 
     err = mb_drv_register(&ptcp->drv_obj);
     MB_GOTO_ON_FALSE(((err == ESP_OK) && ptcp->drv_obj), MB_EILLSTATE, error, 
@@ -180,6 +235,11 @@ error:
         CRITICAL_SECTION_CLOSE(ptcp->base.lock);
         // if the MDNS resolving is enabled, then free it
     }
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+    if (ptcp) {
+        mbm_port_tcp_pipe_deinit(ptcp);
+    }
+#endif
     free(ptcp);
     return ret;
 }
@@ -197,6 +257,9 @@ void mbm_port_tcp_delete(mb_port_base_t *inst)
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "driver unregister fail, returns (0x%d).", (uint16_t)err);
     }
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+    mbm_port_tcp_pipe_deinit(port_obj);
+#endif
     CRITICAL_SECTION_CLOSE(inst->lock);
     free(port_obj);
 }
@@ -226,24 +289,32 @@ bool mbm_port_tcp_recv_data(mb_port_base_t *inst, uint8_t **frame, uint16_t *len
     bool status = false;
 
     size_t sz = mb_drv_read(port_obj->drv_obj, info_ptr->fd, port_obj->ptemp_buf, MB_BUFFER_SIZE);
-    if (sz > MB_TCP_FUNC) {
+    uint16_t tid_wait = atomic_load(&port_obj->tid_wait);
+    while (sz > MB_TCP_FUNC) {
         uint16_t tid_counter = MB_TCP_MBAP_GET_FIELD(port_obj->ptemp_buf, MB_TCP_TID);
-        if (tid_counter == (info_ptr->tid_counter - 1)) {
+        if (tid_counter == tid_wait) {
             *frame = port_obj->ptemp_buf;
             *length = sz;
             ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", get packet TID: 0x%04" PRIx16 ":0x%04" PRIx16 ", %p."),
                             port_obj->drv_obj, info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, 
-                            (unsigned)tid_counter, (unsigned)info_ptr->tid_counter, *frame);
+                            (unsigned)tid_counter, (unsigned)tid_wait, *frame);
             uint64_t time = 0;
             time = port_get_timestamp() - info_ptr->send_time;
             ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", processing time[us] = %ju."), port_obj->drv_obj, info_ptr->index,
                         info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, time);
             status = true;
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+        } else if (mbm_tcp_pipe_complete(mbm_port_tcp_get_pipe(port_obj, info_ptr), tid_counter, port_obj->ptemp_buf, sz, MB_ENOERR)) {
+            // The response of the raw request is queued ahead of the awaited one
+            sz = mb_drv_read(port_obj->drv_obj, info_ptr->fd, port_obj->ptemp_buf, MB_BUFFER_SIZE);
+            continue;
+#endif
         } else {
             ESP_LOGE(TAG, "%p, "MB_NODE_FMT(", drop packet TID: 0x%04" PRIx16 ":0x%04" PRIx16 ", %p."),
                             port_obj->drv_obj, info_ptr->index, info_ptr->sock_id,
-                            info_ptr->addr_info.ip_addr_str, (unsigned)tid_counter, (unsigned)info_ptr->tid_counter, *frame);
+                            info_ptr->addr_info.ip_addr_str, (unsigned)tid_counter, (unsigned)tid_wait, *frame);
         }
+        break;
     }
     return status;
 }
@@ -263,7 +334,11 @@ bool mbm_port_tcp_send_data(mb_port_base_t *inst, uint8_t address, uint8_t *fram
 
     if (info_ptr && frame) {
         // Apply TID field to the frame before send
-        MB_TCP_MBAP_SET_FIELD(frame, MB_TCP_TID, info_ptr->tid_counter);
+        uint16_t tid = mbm_port_tcp_next_tid(port_obj->drv_obj, info_ptr);
+        // The driver task reads the awaited TID, it is published before the flag
+        atomic_store(&port_obj->tid_wait, tid);
+        atomic_store(&port_obj->is_tid_waited, true);
+        MB_TCP_MBAP_SET_FIELD(frame, MB_TCP_TID, tid);
         frame[MB_TCP_UID] = (uint8_t)(info_ptr->addr_info.uid);
     }
 
@@ -282,6 +357,65 @@ bool mbm_port_tcp_send_data(mb_port_base_t *inst, uint8_t address, uint8_t *fram
     return frame_sent;
 }
 
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+
+mb_err_enum_t mbm_port_tcp_send_raw(mb_port_base_t *inst, uint8_t address, const uint8_t *pdu, uint16_t pdu_len,
+                                    uint8_t *rsp_buf, uint16_t rsp_size, uint16_t *rsp_len, uint32_t tout)
+{
+    MB_RETURN_ON_FALSE((inst && pdu && pdu_len && (pdu_len <= MB_PDU_SIZE_MAX) && rsp_buf && rsp_len),
+                        MB_EINVAL, TAG, "raw request wrong arguments");
+    mbm_tcp_port_t *port_obj = __containerof(inst, mbm_tcp_port_t, base);
+    mb_node_info_t *info_ptr = mb_drv_get_node_info_from_addr(port_obj->drv_obj, address);
+    mbm_tcp_pipe_t *pipe = mbm_port_tcp_get_pipe(port_obj, info_ptr);
+    MB_RETURN_ON_FALSE((pipe && (MB_GET_NODE_STATE(info_ptr) >= MB_SOCK_STATE_CONNECTED)),
+                        MB_EILLSTATE, TAG, "The node UID #%d, is not connected.", address);
+
+    mbm_tcp_waiter_t waiter = {
+        .rsp_buf = rsp_buf,
+        .rsp_size = rsp_size,
+        .rsp_len = rsp_len
+    };
+    // Take the free place in the window of the node
+    mb_err_enum_t status = mbm_tcp_pipe_begin(pipe, &waiter, tout);
+    if (status != MB_ENOERR) {
+        return status;
+    }
+    uint16_t length = pdu_len + MB_TCP_FUNC;
+    uint8_t *frame = frame_buf_alloc(info_ptr->frame_pool, length);
+    uint16_t tid = mbm_port_tcp_next_tid(port_obj->drv_obj, info_ptr);
+    status = MB_ENORES;
+    if (frame) {
+        MB_TCP_MBAP_SET_FIELD(frame, MB_TCP_TID, tid);
+        MB_TCP_MBAP_SET_FIELD(frame, MB_TCP_PID, MB_TCP_PROTOCOL_ID);
+        MB_TCP_MBAP_SET_FIELD(frame, MB_TCP_LEN, (pdu_len + 1));
+        frame[MB_TCP_UID] = (uint8_t)(info_ptr->addr_info.uid);
+        memcpy(&frame[MB_TCP_FUNC], pdu, pdu_len);
+        transaction_message_t msg = {
+            .buffer = frame,
+            .len = length,
+            .msg_id = tid,
+            .node_id = info_ptr->index,
+            .pool = info_ptr->frame_pool
+        };
+        // The pipe owns the frame from now on
+        status = mbm_tcp_pipe_add(pipe, &waiter, &msg);
+    }
+    if (status == MB_ENOERR) {
+        ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", send raw request TID: 0x%04" PRIx16 ", len: %u."),
+                    port_obj->drv_obj, info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str,
+                    tid, (unsigned)length);
+        if (mb_drv_write(port_obj->drv_obj, info_ptr->fd, frame, length) <= 0) {
+            ESP_LOGE(TAG, "%p, "MB_NODE_FMT(", raw request TID: 0x%04" PRIx16 ", write fail."),
+                        port_obj->drv_obj, info_ptr->index, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, tid);
+            (void)mbm_tcp_pipe_complete(pipe, tid, NULL, 0, MB_EIO);
+        }
+    }
+    // The late response of the request is dropped after the end of waiting
+    return mbm_tcp_pipe_end(pipe, &waiter, pdMS_TO_TICKS(mb_port_timer_get_response_time_ms(inst)));
+}
+
+#endif
+
 void mbm_port_tcp_set_conn_cb(mb_port_base_t *inst, void *conn_fp, void *arg)
 {
     mbm_tcp_port_t *port_obj = __containerof(inst, mbm_tcp_port_t, base);
@@ -568,10 +702,22 @@ MB_EVENT_HANDLER(mbm_on_send_data)
                     ctx, (int)event_info->opt_fd, (int)info_ptr->sock_id, 
                     (int)queue_is_empty(info_ptr->tx_queue), (int)MB_GET_NODE_STATE(info_ptr));
         size_t sz = queue_pop(info_ptr->tx_queue, tx_buffer, sizeof(tx_buffer), NULL);
+        uint16_t tid = MB_TCP_MBAP_GET_FIELD(tx_buffer, MB_TCP_TID);
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+        mbm_tcp_port_t *port_obj = (mbm_tcp_port_t *)drv_obj->parent;
+        // The raw requests do not change the current node of the master object
+        mbm_tcp_pipe_t *pipe = mbm_port_tcp_get_pipe(port_obj, info_ptr);
+        bool is_raw = mbm_tcp_pipe_is_pending(pipe, tid);
+#endif
         if (MB_GET_NODE_STATE(info_ptr) < MB_SOCK_STATE_CONNECTED) {
             // if slave is not connected, drop data.
             ESP_LOGE(TAG, "%p, "MB_NODE_FMT(", is invalid, drop send data."),
                         ctx, (int)info_ptr->index, (int)info_ptr->sock_id, info_ptr->addr_info.ip_addr_str);
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+            if (is_raw) {
+                (void)mbm_tcp_pipe_complete(pipe, tid, NULL, 0, MB_EIO);
+            }
+#endif
             return;
         }
         int ret = port_write_poll(info_ptr, tx_buffer, sz, MB_TCP_SEND_TIMEOUT_MS);
@@ -584,15 +730,20 @@ MB_EVENT_HANDLER(mbm_on_send_data)
         } else {
             ESP_LOGD(TAG, "%p, "MB_NODE_FMT(", send data successful: TID:0x%04x, %d (bytes), errno %d"),
                         ctx, (int)info_ptr->index, (int)info_ptr->sock_id, 
-                        info_ptr->addr_info.ip_addr_str, (unsigned)info_ptr->tid_counter, (int)ret, (unsigned)errno);
+                        info_ptr->addr_info.ip_addr_str, (unsigned)tid, (int)ret, (unsigned)errno);
             info_ptr->error = 0;
-            // Every successful write increase TID counter
-            if (info_ptr->tid_counter < (USHRT_MAX - 1)) {
-                info_ptr->tid_counter++;
+        }
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+        if (is_raw) {
+            if (ret < 0) {
+                (void)mbm_tcp_pipe_complete(pipe, tid, NULL, 0, MB_EIO);
             } else {
-                info_ptr->tid_counter = (uint16_t)(info_ptr->index << 8U);
+                mbm_tcp_pipe_set_sent(pipe, tid);
             }
+            ESP_LOG_BUFFER_HEX_LEVEL("SENT", tx_buffer, sz, ESP_LOG_DEBUG);
+            return;
         }
+#endif
         mb_drv_lock(ctx);
         drv_obj->mb_node_curr = info_ptr;
         drv_obj->curr_node_index = info_ptr->index;
@@ -609,30 +760,43 @@ MB_EVENT_HANDLER(mbm_on_recv_data)
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     mb_event_info_t *event_info = (mb_event_info_t *)data;
     ESP_LOGD(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
-    size_t sz = 0;
-    uint8_t buf[MB_TCP_BUFF_MAX_SIZE] = {0};
     mb_drv_check_suspend_shutdown(ctx);
     // Get frame from queue, check for correctness, push back correct frame and generate receive condition.
     // Removes incorrect or expired frames from the queue, leave just correct one then sent sync event
+    mbm_tcp_port_t *port_obj = (mbm_tcp_port_t *)drv_obj->parent;
     mb_node_info_t *node_ptr = mb_drv_get_node(drv_obj, event_info->opt_fd);
     if (node_ptr) {
         ESP_LOGD(TAG, "%p, slave #%d(%d) [%s], receive data ready.", ctx, (int)event_info->opt_fd,
                     (int)node_ptr->sock_id, node_ptr->addr_info.ip_addr_str);
-        while ((sz <= 0) && !queue_is_empty(node_ptr->rx_queue)) {
-            size_t sz = queue_pop(node_ptr->rx_queue, buf, MB_TCP_BUFF_MAX_SIZE, NULL);
-            if ((sz > MB_TCP_FUNC) && (sz < sizeof(buf))) {
-                uint16_t tid = MB_TCP_MBAP_GET_FIELD(buf, MB_TCP_TID);
+        while (!queue_is_empty(node_ptr->rx_queue)) {
+            frame_entry_t frame_entry = {0};
+            // Pop the frame entry, keep the buffer
+            ssize_t sz = queue_pop(node_ptr->rx_queue, NULL, MB_TCP_BUFF_MAX_SIZE, &frame_entry);
+            if ((sz > MB_TCP_FUNC) && (sz < MB_TCP_BUFF_MAX_SIZE) && frame_entry.buf) {
+                uint16_t tid = MB_TCP_MBAP_GET_FIELD(frame_entry.buf, MB_TCP_TID);
                 ESP_LOGD(TAG, "%p, packet TID: 0x%04" PRIx16 " received.", ctx, tid);
-                if (tid == (node_ptr->tid_counter - 1)) {
-                    queue_push(node_ptr->rx_queue, buf, sz, NULL);
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+                // The responses of the raw requests are completed here in any order
+                if (mbm_tcp_pipe_complete(mbm_port_tcp_get_pipe(port_obj, node_ptr), tid, frame_entry.buf, sz, MB_ENOERR)) {
+                    frame_buf_free(frame_entry.pool, frame_entry.buf);
+                    continue;
+                }
+#endif
+                // Push back the same entry, so the buffer ownership stays with the queue
+                if ((tid == atomic_load(&port_obj->tid_wait))
+                        && (queue_push(node_ptr->rx_queue, NULL, 0, &frame_entry) == ESP_OK)) {
                     mb_drv_lock(ctx);
                     node_ptr->recv_time = esp_timer_get_time();
                     mb_drv_unlock(ctx);
-                    // send receive event to modbus object
-                    drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_RECV_OK);
+                    // The awaited response is signaled once even if it is popped by the next receive event
+                    if (atomic_exchange(&port_obj->is_tid_waited, false)) {
+                        // send receive event to modbus object
+                        drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_RECV_OK);
+                    }
                     break;
                 }
             }
+            frame_buf_free(frame_entry.pool, frame_entry.buf);
             mb_drv_check_suspend_shutdown(ctx);
         }
     }
@@ -23,12 +23,41 @@ extern "C" {
 
 #if (CONFIG_FMB_COMM_MODE_TCP_EN)
 
+// The number of raw requests sent to the slave before their responses are received
+#if CONFIG_FMB_TCP_MASTER_TID_WINDOW
+#define MB_TCP_MASTER_TID_WINDOW (CONFIG_FMB_TCP_MASTER_TID_WINDOW)
+#else
+#define MB_TCP_MASTER_TID_WINDOW (1)
+#endif
+
+#define MB_TCP_MASTER_PIPELINE_ENABLED (MB_TCP_MASTER_TID_WINDOW > 1)
+
 typedef enum mb_sock_state_enum mb_sock_state_t;
 typedef struct uid_info_s mb_uid_info_t;
 
 void mbm_port_tcp_set_conn_cb(mb_port_base_t *inst, void *conn_fp, void *arg);
 mb_uid_info_t *mbm_port_tcp_get_slave_info(mb_port_base_t *inst, uint8_t uid, mb_sock_state_t exp_state);
 
+#if (MB_TCP_MASTER_PIPELINE_ENABLED)
+
+/**
+ * @brief Send the raw request to the slave bypassing the master object and wait for its response
+ *
+ * Up to MB_TCP_MASTER_TID_WINDOW requests of the concurrent callers are sent to the same slave,
+ * the responses are matched to the requests by TID in any order.
+ *
+ * @return MB_ENOERR - the response PDU is copied into rsp_buf,
+ *         MB_EBUSY - the window of the slave is full during the tout ticks,
+ *         MB_ETIMEDOUT - no response during the response time of the port,
+ *         MB_EILLFUNC - the response does not fit into rsp_buf,
+ *         MB_ERECVDATA - the response does not correspond to the request,
+ *         MB_EILLSTATE, MB_ENORES, MB_EIO - the slave is not connected or the request is not sent.
+ */
+mb_err_enum_t mbm_port_tcp_send_raw(mb_port_base_t *inst, uint8_t address, const uint8_t *pdu, uint16_t pdu_len,
+                                    uint8_t *rsp_buf, uint16_t rsp_size, uint16_t *rsp_len, uint32_t tout);
+
+#endif
+
 MB_EVENT_HANDLER(mbm_on_ready);
 MB_EVENT_HANDLER(mbm_on_open);
 MB_EVENT_HANDLER(mbm_on_resolve);
@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "esp_timer.h"
+
+#include "port_common.h"
+#include "port_tcp_pipe.h"
+#include "sdkconfig.h"
+
+#define TAG "port.tcp.pipe"
+
+#if (CONFIG_FMB_COMM_MODE_TCP_EN)
+
+esp_err_t mbm_tcp_pipe_init(mbm_tcp_pipe_t *pipe, uint16_t window)
+{
+    MB_RETURN_ON_FALSE((pipe && window && (window <= (sizeof(pipe->slot_mask) * 8))), ESP_ERR_INVALID_ARG,
+                        TAG, "mb tcp pipe wrong arguments.");
+    CRITICAL_SECTION_INIT(pipe->lock);
+    pipe->pending = transaction_create(window);
+    pipe->slots = xSemaphoreCreateCounting(window, window);
+    pipe->done = xEventGroupCreate();
+    pipe->slot_mask = 0;
+    MB_RETURN_ON_FALSE((pipe->pending && pipe->slots && pipe->done), ESP_ERR_NO_MEM,
+                        TAG, "mb tcp pipe, resource allocation fail.");
+    return ESP_OK;
+}
+
+void mbm_tcp_pipe_deinit(mbm_tcp_pipe_t *pipe)
+{
+    if (!pipe) {
+        return;
+    }
+    if (pipe->pending) {
+        transaction_destroy(pipe->pending);
+        pipe->pending = NULL;
+    }
+    if (pipe->slots) {
+        vSemaphoreDelete(pipe->slots);
+        pipe->slots = NULL;
+    }
+    if (pipe->done) {
+        vEventGroupDelete(pipe->done);
+        pipe->done = NULL;
+    }
+    CRITICAL_SECTION_CLOSE(pipe->lock);
+}
+
+mb_err_enum_t mbm_tcp_pipe_begin(mbm_tcp_pipe_t *pipe, mbm_tcp_waiter_t *waiter, TickType_t tout)
+{
+    MB_RETURN_ON_FALSE((pipe && waiter && waiter->rsp_buf && waiter->rsp_len), MB_EINVAL,
+                        TAG, "mb tcp pipe wrong arguments.");
+    if (xSemaphoreTake(pipe->slots, tout) != pdTRUE) {
+        return MB_EBUSY;
+    }
+    waiter->status = MB_ETIMEDOUT;
+    waiter->item = NULL;
+    CRITICAL_SECTION(pipe->lock) {
+        // The lowest free bit, the taken slot guarantees it is inside of the window
+        waiter->done_bit = (EventBits_t)(pipe->slot_mask + 1) & ~pipe->slot_mask;
+        pipe->slot_mask |= waiter->done_bit;
+    }
+    (void)xEventGroupClearBits(pipe->done, waiter->done_bit);
+    *waiter->rsp_len = 0;
+    return MB_ENOERR;
+}
+
+mb_err_enum_t mbm_tcp_pipe_add(mbm_tcp_pipe_t *pipe, mbm_tcp_waiter_t *waiter, transaction_message_t *msg)
+{
+    MB_RETURN_ON_FALSE((pipe && waiter && msg && msg->buffer), MB_EINVAL, TAG, "mb tcp pipe wrong arguments.");
+    msg->pnode = (void *)waiter;
+    transaction_item_handle_t item = transaction_enqueue(pipe->pending, msg, (transaction_tick_t)esp_timer_get_time());
+    if (!item) {
+        frame_buf_free(msg->pool, msg->buffer);
+        return MB_ENORES;
+    }
+    CRITICAL_SECTION(pipe->lock) {
+        waiter->item = item;
+        waiter->tid = msg->msg_id;
+        waiter->node_id = msg->node_id;
+    }
+    return MB_ENOERR;
+}
+
+mb_err_enum_t mbm_tcp_pipe_end(mbm_tcp_pipe_t *pipe, mbm_tcp_waiter_t *waiter, TickType_t tout)
+{
+    MB_RETURN_ON_FALSE((pipe && waiter && waiter->done_bit), MB_EINVAL, TAG, "mb tcp pipe wrong arguments.");
+    mb_err_enum_t status = MB_ENORES;
+    if (waiter->item) {
+        (void)xEventGroupWaitBits(pipe->done, waiter->done_bit, pdTRUE, pdTRUE, tout);
+    }
+    // The late response of the request is dropped after its transaction is removed
+    CRITICAL_SECTION(pipe->lock) {
+        if (waiter->item) {
+            (void)transaction_delete_item(pipe->pending, waiter->item, waiter->tid, waiter->node_id);
+            waiter->item = NULL;
+            status = waiter->status;
+        }
+        pipe->slot_mask &= ~waiter->done_bit;
+    }
+    (void)xEventGroupClearBits(pipe->done, waiter->done_bit);
+    (void)xSemaphoreGive(pipe->slots);
+    return status;
+}
+
+bool mbm_tcp_pipe_complete(mbm_tcp_pipe_t *pipe, uint16_t tid, const uint8_t *frame, size_t length, mb_err_enum_t status)
+{
+    if (!pipe || !pipe->pending) {
+        return false;
+    }
+    bool is_matched = false;
+    CRITICAL_SECTION(pipe->lock) {
+        transaction_item_handle_t item = transaction_get(pipe->pending, tid);
+        if (item && (transaction_item_get_state(item) != REPLIED)) {
+            mbm_tcp_waiter_t *waiter = (mbm_tcp_waiter_t *)transaction_item_get_pnode(item);
+            uint8_t *req_frame = transaction_item_get_data(item, NULL, NULL, NULL);
+            if (frame) {
+                // The function of the response is the requested one or its exception
+                uint16_t pdu_len = (length > MB_TCP_FUNC) ? (uint16_t)(length - MB_TCP_FUNC) : 0;
+                if (!pdu_len || (frame[MB_TCP_UID] != req_frame[MB_TCP_UID])
+                        || ((frame[MB_TCP_FUNC] & ~MB_FUNC_ERROR) != req_frame[MB_TCP_FUNC])) {
+                    status = MB_ERECVDATA;
+                } else if (pdu_len > waiter->rsp_size) {
+                    status = MB_EILLFUNC;
+                } else {
+                    memcpy(waiter->rsp_buf, &frame[MB_TCP_FUNC], pdu_len);
+                    *waiter->rsp_len = pdu_len;
+                }
+            }
+            waiter->status = status;
+            (void)transaction_item_set_state(item, REPLIED);
+            (void)xEventGroupSetBits(pipe->done, waiter->done_bit);
+            is_matched = true;
+        }
+    }
+    return is_matched;
+}
+
+bool mbm_tcp_pipe_is_pending(mbm_tcp_pipe_t *pipe, uint16_t tid)
+{
+    return (pipe && pipe->pending && transaction_get(pipe->pending, tid));
+}
+
+void mbm_tcp_pipe_set_sent(mbm_tcp_pipe_t *pipe, uint16_t tid)
+{
+    if (pipe && pipe->pending) {
+        CRITICAL_SECTION(pipe->lock) {
+            transaction_item_handle_t item = transaction_get(pipe->pending, tid);
+            // The response can be received before the sent state is applied
+            if (item && (transaction_item_get_state(item) != REPLIED)) {
+                (void)transaction_item_set_state(item, TRANSMITTED);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "sys/lock.h"
+
+#include "mb_common.h"
+#include "mb_transaction.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (CONFIG_FMB_COMM_MODE_TCP_EN)
+
+// The raw request waiting for its response, placed in the stack of the caller
+typedef struct
+{
+    uint8_t *rsp_buf;
+    uint16_t rsp_size;
+    uint16_t *rsp_len;
+    EventBits_t done_bit;
+    mb_err_enum_t status;
+    transaction_item_handle_t item;
+    uint16_t tid;                       // the message of the item to check the handle on delete
+    int node_id;
+} mbm_tcp_waiter_t;
+
+// The window of the raw requests sent to the node
+typedef struct
+{
+    _lock_t lock;
+    transaction_handle_t pending;       // the sent requests keyed by TID, the item owns the copy of request frame
+    SemaphoreHandle_t slots;            // free places in the window
+    EventGroupHandle_t done;            // the bit of the waiter is set when its request is completed
+    uint32_t slot_mask;                 // the bits of the waiters in the window
+} mbm_tcp_pipe_t;
+
+esp_err_t mbm_tcp_pipe_init(mbm_tcp_pipe_t *pipe, uint16_t window);
+void mbm_tcp_pipe_deinit(mbm_tcp_pipe_t *pipe);
+
+/**
+ * @brief Take the free place in the window for the waiter
+ *
+ * @return MB_ENOERR - the place is taken, MB_EBUSY - the window is full during the tout ticks
+ */
+mb_err_enum_t mbm_tcp_pipe_begin(mbm_tcp_pipe_t *pipe, mbm_tcp_waiter_t *waiter, TickType_t tout);
+
+/**
+ * @brief Register the request frame of the waiter, the pipe owns the frame from now on
+ *
+ * @return MB_ENOERR - the request is pending, MB_ENORES - the frame is released, the request is not registered
+ */
+mb_err_enum_t mbm_tcp_pipe_add(mbm_tcp_pipe_t *pipe, mbm_tcp_waiter_t *waiter, transaction_message_t *msg);
+
+/**
+ * @brief Wait the completion of the request during tout ticks and release the place of the waiter in the window.
+ *        The late response of the request is dropped after this call.
+ *
+ * @return the status of request (MB_ETIMEDOUT if it is not completed)
+ */
+mb_err_enum_t mbm_tcp_pipe_end(mbm_tcp_pipe_t *pipe, mbm_tcp_waiter_t *waiter, TickType_t tout);
+
+// Complete the pending request with the response frame or the error status.
+// Returns false if the TID does not belong to the pending requests.
+bool mbm_tcp_pipe_complete(mbm_tcp_pipe_t *pipe, uint16_t tid, const uint8_t *frame, size_t length, mb_err_enum_t status);
+bool mbm_tcp_pipe_is_pending(mbm_tcp_pipe_t *pipe, uint16_t tid);
+void mbm_tcp_pipe_set_sent(mbm_tcp_pipe_t *pipe, uint16_t tid);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -112,7 +112,8 @@ mb_err_enum_t mbs_port_tcp_create(mb_tcp_opts_t *tcp_opts, mb_port_base_t **port
     // Copy object descriptor from parent object (is used for logging)
     ptcp->base.descr = (*port_obj)->descr;
     ptcp->drv_obj = NULL;
-    ptcp->transaction = transaction_init();
+    // Every connection can queue up to MB_FRAME_QUEUE_SZ requests
+    ptcp->transaction = transaction_create(MB_TCP_PORT_MAX_CONN * MB_FRAME_QUEUE_SZ);
     MB_GOTO_ON_FALSE((ptcp->transaction), MB_EILLSTATE, error,
                      TAG, "mb transaction init failed.");
 
@@ -280,7 +281,7 @@ bool mbs_port_tcp_send_data(mb_port_base_t *inst, uint8_t *frame, uint16_t lengt
             ESP_LOGE(TAG, "%p, node: #%d, socket(#%d)[%s], could not write transaction, TID: 0x%04" PRIx16 ":0x%04" PRIx16 ", %p, len: %d, ",
                             drv_obj, pnode->index, pnode->sock_id, pnode->addr_info.node_name_str,
                             (unsigned)tid, (unsigned)msg_id, frame, length);
-            if (item && transaction_delete_item(port_obj->transaction, item) != ESP_OK) {
+            if (item && transaction_delete_item(port_obj->transaction, item, msg_id, node_id) != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to remove queued TID:0x%04" PRIx16, tid);
             } else {
                 ESP_LOGD(TAG, "Remove the message TID:0x%04" PRIx16, tid);
@@ -399,84 +400,129 @@ MB_EVENT_HANDLER(mbs_on_connect)
     mb_drv_unlock(ctx);
 }
 
+// Move the received frame from the node queue into the transaction queue,
+// returns false if there is no frame or the frame is left in the node queue (the transaction queue is full)
+static bool mbs_port_tcp_enqueue_frame(port_driver_t *drv_obj, mb_node_info_t *pnode)
+{
+    mbs_tcp_port_t *port_obj = (mbs_tcp_port_t *)drv_obj->parent;
+    transaction_item_handle_t item = NULL;
+    frame_entry_t frame_entry;
+    if (queue_is_empty(pnode->rx_queue)) {
+        return false;
+    }
+    mb_drv_lock(drv_obj);
+    if (transaction_is_full(port_obj->transaction)) {
+        (void)transaction_delete_expired(port_obj->transaction, port_get_timestamp(), MB_DROP_TRANSACTION_TIME_US);
+    }
+    bool is_full = transaction_is_full(port_obj->transaction);
+    mb_drv_unlock(drv_obj);
+    if (is_full) {
+        // Keep the frame in the node queue and postpone it to the next cycle
+        ESP_LOGW(TAG, "%p, " MB_NODE_FMT(", transaction queue is full, postpone the received frame."),
+                 drv_obj, pnode->index, pnode->sock_id, pnode->addr_info.ip_addr_str);
+        DRIVER_SEND_EVENT(drv_obj, MB_EVENT_RECV_DATA, pnode->index);
+        return false;
+    }
+    ESP_LOGD(TAG, "%p, node #%d, socket(#%d) [%s], receive data ready.", drv_obj, (int)pnode->index,
+             (int)pnode->sock_id, pnode->addr_info.ip_addr_str);
+    size_t sz = queue_pop(pnode->rx_queue, NULL, MB_BUFFER_SIZE, &frame_entry);
+    if (sz > MB_TCP_FUNC) {
+        uint16_t tid_counter = MB_TCP_MBAP_GET_FIELD(frame_entry.buf, MB_TCP_TID);
+        ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", received packet TID: 0x%04" PRIx16 ", frame: %p, %u"),
+                 drv_obj, pnode->index, pnode->sock_id,
+                 pnode->addr_info.ip_addr_str, (unsigned)tid_counter, frame_entry.buf, frame_entry.len);
+        mb_drv_lock(drv_obj);
+        transaction_message_t msg;
+        msg.buffer = frame_entry.buf;
+        msg.len = frame_entry.len;
+        msg.msg_id = frame_entry.tid;
+        msg.node_id = pnode->index;
+        msg.pnode = pnode;
+        msg.pool = frame_entry.pool;
+        // Enqueue the transaction, keep time of receiving (the transaction owns the frame buffer).
+        item = transaction_enqueue(port_obj->transaction, &msg, port_get_timestamp());
+        mb_drv_unlock(drv_obj);
+        if (!item) {
+            ESP_LOGE(TAG, "%p, " MB_NODE_FMT(", enqueue fail, drop the frame TID: 0x%04" PRIx16 "."),
+                     drv_obj, pnode->index, pnode->sock_id, pnode->addr_info.ip_addr_str, (unsigned)tid_counter);
+            frame_buf_free(frame_entry.pool, frame_entry.buf);
+            return false;
+        }
+    } else if (sz) {
+        frame_buf_free(frame_entry.pool, frame_entry.buf);
+    }
+    return true;
+}
+
+// Start the first queued transaction if the modbus object is not busy
+static void mbs_port_tcp_start_transaction(port_driver_t *drv_obj)
+{
+    mbs_tcp_port_t *port_obj = (mbs_tcp_port_t *)drv_obj->parent;
+    transaction_item_handle_t item = transaction_get_first(port_obj->transaction);
+    mb_node_info_t *pnode = NULL;
+    uint16_t msg_id = 0;
+    int node_id = 0;
+    if (!item) {
+        ESP_LOGD(TAG, "%p, no queued items found", drv_obj);
+        return;
+    }
+    if (transaction_item_get_state(item) != QUEUED) {
+        if (transaction_item_get_state(item) != TRANSMITTED) {
+            // Transaction procesing is ongoing, just delete expired transactions
+            mb_drv_lock(drv_obj);
+            transaction_delete_expired(port_obj->transaction, port_get_timestamp(), MB_DROP_TRANSACTION_TIME_US);
+            mb_drv_unlock(drv_obj);
+        }
+        return;
+    }
+    (void)transaction_item_get_data(item, NULL, &msg_id, &node_id);
+    // Check if the main FSM is not busy
+    if (mb_port_event_res_take(&port_obj->base, TRANSACTION_TICKS)) {
+        (void)mb_drv_clear_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
+    } else {
+        if (port_get_timestamp() - transaction_item_get_tick(item) > MB_DROP_TRANSACTION_TIME_US) {
+            ESP_LOGD(TAG, "Transaction TID:0x%04" PRIx16 " is expired.", transaction_item_get_id(item));
+        } else {
+            // postpone the packet processing to next cycle
+            DRIVER_SEND_EVENT(drv_obj, MB_EVENT_RECV_DATA, node_id);
+        }
+        mb_drv_lock(drv_obj);
+        transaction_delete_expired(port_obj->transaction, port_get_timestamp(), MB_DROP_TRANSACTION_TIME_US);
+        mb_drv_unlock(drv_obj);
+        return;
+    }
+    mb_drv_lock(drv_obj);
+    pnode = mb_drv_get_node(drv_obj, node_id);
+    if (pnode) {
+        // assign the TID of the started transaction to check it on send
+        pnode->tid_counter = msg_id;
+        ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", acknoledged packet TID: 0x%04" PRIx16 ", start transaction."),
+                     drv_obj, pnode->index, pnode->sock_id,
+                     pnode->addr_info.ip_addr_str, (unsigned)msg_id);
+    }
+    if (ESP_OK != transaction_item_set_state(item, ACKNOWLEDGED)) {
+        ESP_LOGE(TAG, "%p, transaction set state fail for TID: 0x%04" PRIx16 ".", drv_obj, (unsigned)msg_id);
+    }
+    mb_drv_unlock(drv_obj);
+    // send receive event to modbus object to get the new data
+    drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_RECV_OK);
+}
+
 MB_EVENT_HANDLER(mbs_on_recv_data)
 {
     port_driver_t *drv_obj = MB_GET_DRV_PTR(ctx);
     mb_event_info_t *event_info = (mb_event_info_t *)data;
-    mbs_tcp_port_t *port_obj = (mbs_tcp_port_t *)drv_obj->parent;
     ESP_LOGD(TAG, "%s  %s: fd: %d", (char *)base, __func__, (int)event_info->opt_fd);
     mb_node_info_t *pnode = mb_drv_get_node(drv_obj, event_info->opt_fd);
-    transaction_item_handle_t item = NULL;
     if (pnode) {
-        if (!queue_is_empty(pnode->rx_queue)) {
-            ESP_LOGD(TAG, "%p, node #%d, socket(#%d) [%s], receive data ready.", ctx, (int)event_info->opt_fd,
-                     (int)pnode->sock_id, pnode->addr_info.ip_addr_str);
-            frame_entry_t frame_entry;
-            size_t sz = queue_pop(pnode->rx_queue, NULL, MB_BUFFER_SIZE, &frame_entry);
-            if (sz > MB_TCP_FUNC) {
-                uint16_t tid_counter = MB_TCP_MBAP_GET_FIELD(frame_entry.buf, MB_TCP_TID);
-                ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", received packet TID: 0x%04" PRIx16 ", frame: %p, %u"),
-                         drv_obj, pnode->index, pnode->sock_id,
-                         pnode->addr_info.ip_addr_str, (unsigned)tid_counter, frame_entry.buf, frame_entry.len);
-                mb_drv_lock(drv_obj);
-                transaction_message_t msg;
-                msg.buffer = frame_entry.buf;
-                msg.len = frame_entry.len;
-                msg.msg_id = frame_entry.tid;
-                msg.node_id = pnode->index;
-                msg.pnode = pnode;
-                // Enqueue the transaction, keep time of receiving.
-                item = transaction_enqueue(port_obj->transaction, &msg, port_get_timestamp());
-                pnode->tid_counter = tid_counter; // assign the TID from frame to use it on send
-                mb_drv_unlock(drv_obj);
-            }
-        }
-        item = transaction_get_first(port_obj->transaction);
-        if (item) {
-            if (transaction_item_get_state(item) == QUEUED) {
-                // Check if the main FSM is not busy
-                if (mb_port_event_res_take(&port_obj->base, TRANSACTION_TICKS)) {
-                    (void)mb_drv_clear_status_flag(drv_obj, MB_FLAG_TRANSACTION_READY);
-                } else {
-                    if (port_get_timestamp() - transaction_item_get_tick(item) > MB_DROP_TRANSACTION_TIME_US) {
-                        ESP_LOGD(TAG, "Transaction TID:0x%04" PRIx16 " is expired.", transaction_item_get_id(item));
-                    } else {
-                        // postpone the packet processing to next cycle
-                        DRIVER_SEND_EVENT(ctx, MB_EVENT_RECV_DATA, pnode->index);
-                    }
-                    mb_drv_lock(drv_obj);
-                    transaction_delete_expired(port_obj->transaction, port_get_timestamp(), MB_DROP_TRANSACTION_TIME_US);
-                    mb_drv_unlock(drv_obj);
-                    mb_drv_check_suspend_shutdown(ctx);
-                    return;
-                }
-                // send receive event to modbus object to get the new data
-                drv_obj->event_cbs.mb_sync_event_cb(drv_obj->event_cbs.port_arg, MB_SYNC_EVENT_RECV_OK);
-                mb_drv_lock(drv_obj);
-                uint16_t msg_id = 0;
-                int node_id = 0;
-                (void)transaction_item_get_data(item, NULL, &msg_id, &node_id);
-                pnode = mb_drv_get_node(drv_obj, node_id);
-                ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", acknoledged packet TID: 0x%04" PRIx16 ", start transaction."),
-                             drv_obj, pnode->index, pnode->sock_id,
-                             pnode->addr_info.ip_addr_str, (unsigned)msg_id);
-                if (ESP_OK == transaction_item_set_state(item, ACKNOWLEDGED)) {
-                    ESP_LOGD(TAG, "%p, " MB_NODE_FMT(", acknoledged packet TID: 0x%04" PRIx16 "."),
-                             drv_obj, pnode->index, pnode->sock_id,
-                             pnode->addr_info.ip_addr_str, (unsigned)msg_id);
-                }
-                mb_drv_unlock(drv_obj);
-            } else {
-                if (transaction_item_get_state(item) != TRANSMITTED) {
-                    // Transaction procesing is ongoing, just delete expired transactions
-                    mb_drv_lock(drv_obj);
-                    transaction_delete_expired(port_obj->transaction, port_get_timestamp(), MB_DROP_TRANSACTION_TIME_US);
-                    mb_drv_unlock(drv_obj);
-                }
-            }
-        } else {
-            ESP_LOGD(TAG, "%p, no queued items found", ctx);
-        }
+#if MB_TCP_SLAVE_DRAIN_FRAMES
+        // Move all received frames of the node into the transaction queue,
+        // the receive events posted for the rest of frames just start the next queued transaction.
+        while (mbs_port_tcp_enqueue_frame(drv_obj, pnode));
+#else
+        (void)mbs_port_tcp_enqueue_frame(drv_obj, pnode);
+#endif
+        mbs_port_tcp_start_transaction(drv_obj);
     }
     mb_drv_check_suspend_shutdown(ctx);
 }
@@ -550,7 +596,7 @@ MB_EVENT_HANDLER(mbs_on_send_data)
                                     drv_obj, pnode->index, pnode->sock_id,
                                     pnode->addr_info.ip_addr_str, tid, frame_entry.buf);
                     }
-                    if (transaction_delete_item(port_obj->transaction, item) != ESP_OK) {
+                    if (transaction_delete_item(port_obj->transaction, item, msg_id, node_id) != ESP_OK) {
                         ESP_LOGE(TAG, "Failed to remove queued TID:0x%04" PRIx16, tid);
                     } else {
                         ESP_LOGD(TAG, "Remove the message TID:0x%04" PRIx16, tid);
@@ -558,6 +604,10 @@ MB_EVENT_HANDLER(mbs_on_send_data)
                     pnode->send_time = port_get_timestamp();
                     pnode->send_counter = (pnode->send_counter < (USHRT_MAX - 1)) ? (pnode->send_counter + 1) : 0;
                     mb_drv_unlock(drv_obj);
+#if MB_TCP_SLAVE_DRAIN_FRAMES
+                    // Start the next queued transaction without waiting for the receive event
+                    mbs_port_tcp_start_transaction(drv_obj);
+#endif
                 }
             } else {
                 // It looks like no current registered transaction. It might be happen if the transaction has deleted as expired.
@@ -573,7 +623,7 @@ MB_EVENT_HANDLER(mbs_on_send_data)
             ESP_LOGE(TAG, "%p, "MB_NODE_FMT(", frame is invalid, drop data."),
                         ctx, (int)pnode->index, (int)pnode->sock_id, pnode->addr_info.ip_addr_str);
         }
-        free(frame_entry.buf);
+        frame_buf_free(frame_entry.pool, frame_entry.buf);
     }
     mb_drv_check_suspend_shutdown(ctx);
 }
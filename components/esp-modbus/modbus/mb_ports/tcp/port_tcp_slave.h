@@ -22,6 +22,9 @@
 
 #define TRANSACTION_TICKS pdMS_TO_TICKS(50)
 
+// Move all received frames of the connection into the transaction queue per receive event
+#define MB_TCP_SLAVE_DRAIN_FRAMES (CONFIG_FMB_TCP_SLAVE_DRAIN_FRAMES)
+
 /**
  * @brief Modbus slave addr list item for the master
  */
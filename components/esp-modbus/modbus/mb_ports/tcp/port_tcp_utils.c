@@ -76,6 +76,8 @@ bool port_close_connection(mb_node_info_t *info_ptr)
 
     // Empty tcp buffer before shutdown
     (void)recv(info_ptr->sock_id, &tmp_buff[0], MB_PDU_SIZE_MAX, MSG_DONTWAIT);
+    info_ptr->rx_len = 0;
+    info_ptr->rx_pending = false;
     queue_flush(info_ptr->rx_queue);
     queue_flush(info_ptr->tx_queue);
 
@@ -102,7 +104,8 @@ static void port_ms_to_tv(uint16_t timeout_ms, struct timeval *tv)
     tv->tv_usec = (timeout_ms - (tv->tv_sec * 1000)) * 1000;
 }
 
-int port_enqueue_packet(QueueHandle_t queue, uint8_t *buf, uint16_t len)
+// Enqueue the frame buffer by reference, the ownership of buffer is passed to the queue
+int port_enqueue_packet(QueueHandle_t queue, frame_pool_t *pool, uint8_t *buf, uint16_t len)
 {
     frame_entry_t frame_info = {0};
     esp_err_t ret = ESP_ERR_INVALID_STATE;
@@ -112,12 +115,14 @@ int port_enqueue_packet(QueueHandle_t queue, uint8_t *buf, uint16_t len)
         frame_info.uid = buf[MB_TCP_UID];
         frame_info.pid = MB_TCP_MBAP_GET_FIELD(buf, MB_TCP_PID);
         frame_info.len = MB_TCP_MBAP_GET_FIELD(buf, MB_TCP_LEN) + MB_TCP_UID;
+        frame_info.buf = buf;
+        frame_info.pool = pool;
         if (len != frame_info.len) {
             ESP_LOGE(TAG, "Packet TID (%x), length in frame %u != %u expected.", frame_info.tid, frame_info.len, len);
+            frame_info.len = (frame_info.len > len) ? len : frame_info.len;
         }
-        assert(xPortGetFreeHeapSize() > frame_info.len);
 
-        ret = queue_push(queue, buf, frame_info.len, &frame_info);
+        ret = queue_push(queue, NULL, 0, &frame_info);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Packet TID (%x), data enqueue failed.", frame_info.tid);
             // The packet send fail or the task which is waiting for event is already unblocked
@@ -150,25 +155,23 @@ int port_dequeue_packet(QueueHandle_t queue, frame_entry_t *frame_info_ptr)
     return ERR_BUF;
 }
 
-static int port_get_buf(mb_node_info_t *info_ptr, uint8_t *pdst_buf, uint16_t len, uint16_t read_tick_ms)
+// Drain the socket into the free space of the receive buffer with one call
+static int port_recv_buf(mb_node_info_t *info_ptr)
 {
     int ret = 0;
-    uint8_t *buf = pdst_buf;
-    uint16_t bytes_left = len;
-    struct timeval time_val;
-
-    MB_RETURN_ON_FALSE((info_ptr && (info_ptr->sock_id > UNDEF_FD)), -1, TAG, "Try to read incorrect socket = #%d.", info_ptr->sock_id);
 
-    // Set receive timeout for socket <= slave respond time
-    time_val.tv_sec = read_tick_ms / 1000;
-    time_val.tv_usec = (read_tick_ms % 1000) * 1000;
-    setsockopt(info_ptr->sock_id, SOL_SOCKET, SO_RCVTIMEO, &time_val, sizeof(time_val));
+    MB_RETURN_ON_FALSE((info_ptr && info_ptr->rx_buf && (info_ptr->sock_id > UNDEF_FD)), -1, TAG, "Try to read incorrect socket.");
 
-    // blocking read of data from socket
-    ret = recv(info_ptr->sock_id, buf, bytes_left, 0);
+    // the socket is ready, read all available data without blocking
+    ret = recv(info_ptr->sock_id, &info_ptr->rx_buf[info_ptr->rx_len], (MB_RX_BUFFER_SIZE - info_ptr->rx_len), MSG_DONTWAIT);
+    if (ret == 0) {
+        ESP_LOGD(TAG, "socket(#%d)(%s) connection closed by peer.", 
+                        info_ptr->sock_id, info_ptr->addr_info.ip_addr_str);
+        return ERR_CONN;
+    }
     if (ret < 0) {
         if (errno == EINPROGRESS || errno == EAGAIN || errno == EWOULDBLOCK) {
-            // Read timeout occurred, check the timeout and return
+            // No data is available, check the timeout and return
             return 0;
         }
         if ((errno == ENOTCONN) || (errno == ECONNRESET)) {
@@ -180,76 +183,114 @@ static int port_get_buf(mb_node_info_t *info_ptr, uint8_t *pdst_buf, uint16_t le
         // Other error occurred during receiving
         ESP_LOGD(TAG, "Socket(#%d)(%s) receive error, ret = %d, errno = %d(%s)",
                     info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, ret, (int)errno, strerror(errno));
-        ret = -1;
-    } 
+        return -1;
+    }
+    info_ptr->rx_len += ret;
     return ret;
 }
 
-int port_read_packet(mb_node_info_t *info_ptr)
+// Queues the complete frames from the receive buffer of node, each frame is copied once into
+// the frame buffer from the pool. The incomplete frame is kept in the buffer until the rest of it
+// is received. The queue is served by the same task, so when it is full the remaining frames
+// are kept in the buffer and queued on next call. Returns the number of queued frames or error code.
+int port_parse_packets(mb_node_info_t *info_ptr)
 {
-    uint16_t temp = 0;
-    int ret = 0;
-    uint8_t ptemp_buf[MB_TCP_BUFF_MAX_SIZE] = {0};
+    uint16_t len = 0;
+    uint16_t pos = 0;
+    int frames = 0;
+    int err = ERR_TIMEOUT;
 
-    // Receive data from connected client
-    if (info_ptr) {
-        MB_RETURN_ON_FALSE((info_ptr->sock_id > 0), -1, TAG, "try to read incorrect socket = #%d", info_ptr->sock_id);
-        // Read packet header
-        ret = port_get_buf(info_ptr, ptemp_buf, MB_TCP_UID, MB_READ_TICK);
-        if (ret < 0) {
-            info_ptr->recv_err = ret;
-            return ret;
-        } 
-        
-        if (ret != MB_TCP_UID) {
-            ESP_LOGD(TAG, "node #%d, Socket (#%d)(%s), fail to read modbus header, err=%d",
-                        info_ptr->fd, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, ret);
-            info_ptr->recv_err = ERR_VAL;
-            return ERR_VAL;
-        }
-
-        temp = MB_TCP_MBAP_GET_FIELD(ptemp_buf, MB_TCP_PID);
-        if (temp != 0) {
-            info_ptr->recv_err = ERR_BUF;
-            return ERR_BUF;
-        }
+    MB_RETURN_ON_FALSE((info_ptr && info_ptr->rx_buf && info_ptr->rx_queue), -1, TAG, "incorrect node info.");
 
+    uint8_t *pbuf = info_ptr->rx_buf;
+    info_ptr->rx_pending = false;
+    while ((info_ptr->rx_len - pos) >= MB_TCP_FUNC) {
+        uint8_t *pframe = &pbuf[pos];
         // If we have received the MBAP header we can analyze it and calculate
-        // the number of bytes left to complete the current response.
-        temp = MB_TCP_MBAP_GET_FIELD(ptemp_buf, MB_TCP_LEN);
-        if (temp > MB_TCP_BUFF_MAX_SIZE) {
-            ESP_LOGD(TAG, "Incorrect packet length: %d", temp);
-            ESP_LOG_BUFFER_HEX_LEVEL(TAG, ptemp_buf, MB_TCP_FUNC, ESP_LOG_DEBUG);
+        // the number of bytes left to complete the current frame.
+        // The length includes the unit ID and at least the function code of PDU
+        len = MB_TCP_MBAP_GET_FIELD(pframe, MB_TCP_LEN);
+        if ((MB_TCP_MBAP_GET_FIELD(pframe, MB_TCP_PID) != 0) 
+                || (len < (MB_TCP_FUNC - MB_TCP_UID + MB_PDU_SIZE_MIN))
+                || (len > (MB_TCP_BUFF_MAX_SIZE - MB_TCP_UID))) {
+            // The stream can not be synchronized with the frame boundaries, drop all received data
+            ESP_LOGD(TAG, "node #%d, Socket (#%d)(%s), incorrect MBAP header, drop %u bytes.",
+                        info_ptr->fd, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, 
+                        (unsigned)(info_ptr->rx_len - pos));
+            ESP_LOG_BUFFER_HEX_LEVEL(TAG, pframe, MB_TCP_FUNC, ESP_LOG_DEBUG);
             info_ptr->recv_err = ERR_BUF;
-            temp = MB_TCP_BUFF_MAX_SIZE; // read all remaining data from buffer
+            info_ptr->rx_len = 0;
+            return frames ? frames : ERR_BUF;
         }
-
-        ret = port_get_buf(info_ptr, &ptemp_buf[MB_TCP_UID], temp, MB_READ_TICK);
-        if (ret < 0) {
-            info_ptr->recv_err = ret;
-            return ret;
+        if ((info_ptr->rx_len - pos) < (len + MB_TCP_UID)) {
+            // The frame is incomplete
+            break;
         }
-        
-        if (ret != temp) {
-            info_ptr->recv_err = ERR_VAL;
-            return ERR_VAL;
+
+        if (pframe[MB_TCP_UID] > MB_ADDRESS_MAX) {
+            // The frame boundaries are correct, skip the frame with wrong address only
+            ESP_LOGD(TAG, "node #%d, Socket (#%d)(%s), incorrect UID = %u, drop the frame.",
+                        info_ptr->fd, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str, 
+                        (unsigned)pframe[MB_TCP_UID]);
+            err = info_ptr->recv_err = ERR_BUF;
+            pos += (len + MB_TCP_UID);
+            continue;
         }
 
-        if (ptemp_buf[MB_TCP_UID] > MB_ADDRESS_MAX) {
-            info_ptr->recv_err = ERR_BUF;
-            return ERR_BUF;
+        if (queue_is_full(info_ptr->rx_queue)) {
+            // Keep the frames in the buffer until the queued frames are handled
+            info_ptr->rx_pending = true;
+            break;
         }
 
-        ret = port_enqueue_packet(info_ptr->rx_queue, ptemp_buf, temp + MB_TCP_UID);
+        // Copy the frame into the buffer which will be passed to the queue
+        uint8_t *pframe_buf = frame_buf_alloc(info_ptr->frame_pool, MB_TCP_BUFF_MAX_SIZE);
+        if (!pframe_buf) {
+            // Keep the frame in the buffer and try again on next call
+            ESP_LOGD(TAG, "node #%d, Socket (#%d)(%s), no memory for frame, keep it pending.",
+                        info_ptr->fd, info_ptr->sock_id, info_ptr->addr_info.ip_addr_str);
+            info_ptr->recv_err = ERR_MEM;
+            info_ptr->rx_pending = true;
+            break;
+        }
+        memcpy(pframe_buf, pframe, (len + MB_TCP_UID));
+        int ret = port_enqueue_packet(info_ptr->rx_queue, info_ptr->frame_pool, pframe_buf, (len + MB_TCP_UID));
         if (ret < 0) {
+            frame_buf_free(info_ptr->frame_pool, pframe_buf);
             info_ptr->recv_err = ret;
-            return ret;
+            info_ptr->rx_pending = true;
+            break;
         }
-
+        pos += (len + MB_TCP_UID);
         info_ptr->recv_counter++;
-
         info_ptr->recv_err = ERR_OK;
-        return ret + MB_TCP_FUNC;
+        frames++;
+    }
+
+    // Move the rest of data to the start of buffer
+    if (pos) {
+        info_ptr->rx_len -= pos;
+        memmove(pbuf, &pbuf[pos], info_ptr->rx_len);
+    }
+    return frames ? frames : err;
+}
+
+// Reads the socket into the receive buffer of node and queues all complete frames from it.
+// Returns the number of queued frames or error code.
+int port_read_packet(mb_node_info_t *info_ptr)
+{
+    // Receive data from connected client
+    if (info_ptr) {
+        MB_RETURN_ON_FALSE((info_ptr->sock_id > 0), -1, TAG, "try to read incorrect socket = #%d", info_ptr->sock_id);
+        // The full buffer is parsed first to free the space for the socket data
+        if (info_ptr->rx_len < MB_RX_BUFFER_SIZE) {
+            int ret = port_recv_buf(info_ptr);
+            if (ret < 0) {
+                info_ptr->recv_err = ret;
+                return ret;
+            }
+        }
+        return port_parse_packets(info_ptr);
     }
     return -1;
 }
@@ -58,7 +58,6 @@ extern "C" {
 #endif
 
 #define MB_MDNS_PORT (CONFIG_FMB_TCP_PORT_DEFAULT)
-#define MB_READ_TICK (500)
 #define MB_MDNS_QUERY_TIME_MS (2000)
 
 #define MB_STR_LEN_HOST 1  // "mb_node_tcp_01"
@@ -81,6 +80,7 @@ extern "C" {
 ))
 
 typedef struct frame_queue_entry_s frame_entry_t;
+typedef struct frame_pool_s frame_pool_t;
 typedef struct mb_node_info_s mb_node_info_t;
 typedef enum addr_type_enum mb_tcp_addr_type_t;
 
@@ -88,8 +88,9 @@ bool port_check_host_addr(const char *host_str, ip_addr_t* host_addr);
 mb_node_info_t* port_get_current_info(void *ctx);
 void port_check_shutdown(void *ctx);
 int64_t port_get_resp_time_left(mb_node_info_t* info_ptr);
-int port_enqueue_packet(QueueHandle_t queue, uint8_t *buf, uint16_t len);
+int port_enqueue_packet(QueueHandle_t queue, frame_pool_t *pool, uint8_t *buf, uint16_t len);
 int port_dequeue_packet(QueueHandle_t queue, frame_entry_t* frame_info);
+int port_parse_packets(mb_node_info_t* info_ptr);
 int port_read_packet(mb_node_info_t* info_ptr);
 err_t port_set_blocking(mb_node_info_t* info_ptr, bool is_blocking);
 int port_keep_alive_enable(int sock, int timeout_sec);
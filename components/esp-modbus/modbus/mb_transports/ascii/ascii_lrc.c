@@ -8,30 +8,43 @@
 #include <assert.h>
 #include "ascii_lrc.h"
 
+/* ----------------------- Static variables ---------------------------------*/
+// The hex character of the nibble
+static const uint8_t mb_ascii_hex_chars[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+// The nibble of the hex character ('0' - '9', 'A' - 'F' and 'a' - 'f'), MB_ASCII_HEX_INVALID for other characters
+static const uint8_t mb_ascii_hex_values[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
 /* ----------------------- functions ---------------------------------*/
 uint8_t mb_char2bin(uint8_t char_val)
 {
-    uint8_t symb = 0xFF;
-    if ((char_val >= '0') && (char_val <= '9')) {
-        symb = (uint8_t)(char_val - '0');
-    } else if ((char_val >= 'A') && (char_val <= 'F')) {
-        symb = (uint8_t)(char_val - 'A' + 0x0A);
-    }
-    return symb;
+    return mb_ascii_hex_values[char_val];
 }
 
 uint8_t mb_bin2char(uint8_t byte_val)
 {
-    uint8_t symb = '0';
-    if (byte_val <= 0x09) {
-        symb = (uint8_t)('0' + byte_val);
-    } else if ((byte_val >= 0x0A) && (byte_val <= 0x0F)) {
-        symb = (uint8_t)(byte_val - 0x0A + 'A');
-    } else {
-        /* Programming error. */
-        assert(0);
-    }
-    return symb;
+    /* Programming error if the value is not a nibble. */
+    assert(byte_val <= 0x0F);
+    return mb_ascii_hex_chars[byte_val & 0x0F];
 }
 
 uint8_t __attribute__ ((unused)) mb_lrc(uint8_t *frame, uint16_t length)
@@ -47,47 +60,54 @@ uint8_t __attribute__ ((unused)) mb_lrc(uint8_t *frame, uint16_t length)
     return lrc;
 }
 
-// The helper function to fill ASCII frame buffer
+// The helper function to fill ASCII frame buffer, the LRC is calculated in the same pass
 int mb_ascii_set_buf(const uint8_t *data_ptr, uint8_t *buf, int bin_length)
 {
-    int bin_idx = 0;
-    int frm_idx = 0;
+    uint8_t *frm_ptr = buf;
     uint8_t lrc = 0;
 
     assert(data_ptr && buf);
 
-    buf[0] = MB_ASCII_START;
-    for (frm_idx = 1; (bin_idx < bin_length); bin_idx++) {
-        buf[frm_idx++] = mb_bin2char((uint8_t)(data_ptr[bin_idx] >> 4));   // High nibble
-        buf[frm_idx++] = mb_bin2char((uint8_t)(data_ptr[bin_idx] & 0X0F)); // Low nibble
-        lrc += data_ptr[bin_idx];
+    *frm_ptr++ = MB_ASCII_START;
+    for (int bin_idx = 0; bin_idx < bin_length; bin_idx++) {
+        uint8_t byte_val = data_ptr[bin_idx];
+        *frm_ptr++ = mb_ascii_hex_chars[byte_val >> 4];     // High nibble
+        *frm_ptr++ = mb_ascii_hex_chars[byte_val & 0x0F];   // Low nibble
+        lrc += byte_val;
     }
     lrc = (uint8_t)(-((char)lrc));
-    buf[frm_idx++] = mb_bin2char((uint8_t)(lrc >> 4));
-    buf[frm_idx++] = mb_bin2char((uint8_t)(lrc & 0X0F));
-    buf[frm_idx++] = MB_ASCII_CR;
-    buf[frm_idx++] = MB_ASCII_LF;
+    *frm_ptr++ = mb_ascii_hex_chars[lrc >> 4];
+    *frm_ptr++ = mb_ascii_hex_chars[lrc & 0x0F];
+    *frm_ptr++ = MB_ASCII_CR;
+    *frm_ptr++ = MB_ASCII_LF;
 
-    return frm_idx;
+    return (int)(frm_ptr - buf);
 }
 
+// Decode the frame in place and check its LRC in one pass, the binary data never overtakes the characters
 int mb_ascii_get_binary_buf(uint8_t *data_ptr, int length)
 {
-    int bin_idx = 0;
     uint8_t lrc = 0;
+    uint8_t invalid = 0;
 
     assert(data_ptr);
 
-    if ((data_ptr[0] == ':') && (data_ptr[length - 1] == '\n') && (data_ptr[length - 2] == '\r')) {
-        for (int str_idx = 1; (str_idx < length) && (data_ptr[str_idx] > ' '); str_idx += 2) {
-            data_ptr[bin_idx] = (mb_char2bin(data_ptr[str_idx]) << 4); // High nibble
-            data_ptr[bin_idx] |= mb_char2bin(data_ptr[str_idx + 1]);   // Low nibble
-            lrc += data_ptr[bin_idx++];
-        }
+    if ((length < 3) || (data_ptr[0] != MB_ASCII_START)
+        || (data_ptr[length - 2] != MB_ASCII_CR) || (data_ptr[length - 1] != MB_ASCII_LF)
+        || ((length - 3) & 1)) {
+        return -1;
     }
-    
-    lrc = (uint8_t)(-((char)lrc));
-    bin_idx = ((lrc == 0) && (bin_idx == ((length - 3) >> 1))) ? bin_idx : -1;
-    return bin_idx;
-}
 
+    int bin_length = (length - 3) >> 1;
+    const uint8_t *str_ptr = &data_ptr[1];
+    for (int bin_idx = 0; bin_idx < bin_length; bin_idx++, str_ptr += 2) {
+        uint8_t high = mb_ascii_hex_values[str_ptr[0]];
+        uint8_t low = mb_ascii_hex_values[str_ptr[1]];
+        // Any invalid character sets the upper bits
+        invalid |= (high | low);
+        data_ptr[bin_idx] = (uint8_t)((high << 4) | (low & 0x0F));
+        lrc += data_ptr[bin_idx];
+    }
+
+    return ((lrc == 0) && !(invalid & 0xF0)) ? bin_length : -1;
+}
@@ -11,10 +11,32 @@
 #define MB_ASCII_CR         '\r'                          /*!< Default CR character for Modbus ASCII. */
 #define MB_ASCII_LF         '\n'                          /*!< Default LF character for Modbus ASCII. */
 #define MB_ASCII_START       ':'                          /*!< Start of frame for Modbus ASCII. */
+#define MB_ASCII_HEX_INVALID 0xFF                         /*!< Result of mb_char2bin() for not a hex character. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /* ----------------------- Static functions ---------------------------------*/
 uint8_t mb_char2bin(uint8_t char_val);
 uint8_t mb_bin2char(uint8_t byte_val);
 uint8_t mb_lrc(uint8_t *frame, uint16_t length);
+
+/**
+ * @brief Convert the ASCII frame ':' + hex characters + CR LF into binary data in place and check the LRC
+ *
+ * @return the length of binary data including the LRC byte, -1 if the frame is incorrect
+ *         (wrong delimiters, not a hex character or wrong LRC)
+ */
 int mb_ascii_get_binary_buf(uint8_t *data_ptr, int length);
-int mb_ascii_set_buf(const uint8_t *data_ptr, uint8_t *buf, int bin_length);
\ No newline at end of file
+
+/**
+ * @brief Encode the binary data into the ASCII frame with LRC and delimiters
+ *
+ * @return the length of the ASCII frame (2 * bin_length + 5)
+ */
+int mb_ascii_set_buf(const uint8_t *data_ptr, uint8_t *buf, int bin_length);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -37,5 +37,32 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Initial value of the RTU CRC16 for the incremental calculation.
+ */
+#define MB_CRC16_INIT (0xFFFF)
+
+/*! \brief Continue the CRC16 calculation with the next part of the frame.
+ *
+ * The frame can be passed in parts of any length as the bytes arrive, the result
+ * of the whole frame is the same as for mb_crc16(). The result over a frame which
+ * includes its CRC field is zero.
+ *
+ * \param crc The value returned for the previous part or MB_CRC16_INIT.
+ * \param data_ptr Pointer to the next part of the frame.
+ * \param len_buf Length of the part.
+ * \return The CRC16 value, the low byte is transmitted first.
+ */
+uint16_t mb_crc16_update(uint16_t crc, const uint8_t *data_ptr, uint16_t len_buf);
+
 uint16_t mb_crc16(uint8_t *frame_ptr, uint16_t len_buf);
 
+#ifdef __cplusplus
+}
+#endif
+
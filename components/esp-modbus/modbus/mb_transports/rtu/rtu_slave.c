@@ -146,7 +146,7 @@ static mb_err_enum_t mbs_rtu_transp_receive(mb_trans_base_t *inst, uint8_t *recv
 
     /* Check length and CRC checksum */
     if ((length >= MB_RTU_SER_PDU_SIZE_MIN)
-        && (mb_crc16(buf, length) == 0)) {
+        && (mb_port_ser_get_recv_crc(inst->port_obj, buf, length) == 0)) {
         /* Save the address field. All frames are passed to the upper layed
          * and the decision if a frame is used is done there.
          */
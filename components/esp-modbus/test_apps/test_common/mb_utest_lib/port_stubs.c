@@ -18,6 +18,7 @@
 #include "port_common.h"
 #include "mb_config.h"
 #include "port_serial_common.h"
+#include "mbcrc.h"
 #include "port_tcp_common.h"
 #include "port_adapter.h"
 #include "port_stubs.h"
@@ -69,6 +70,22 @@ void __wrap_mb_port_ser_disable(mb_port_base_t *inst)
     mb_port_adapter_disable(inst);
 }
 
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+
+// The adapter passes the whole frame, the CRC is calculated over it
+uint16_t __wrap_mb_port_ser_get_recv_crc(mb_port_base_t *inst, const uint8_t *frame, uint16_t length)
+{
+    return mb_crc16_update(MB_CRC16_INIT, frame, length);
+}
+
+// The frames of the adapter are not timed, the master keeps the configured response timeout
+bool __wrap_mb_port_ser_get_rx_timing(mb_port_base_t *inst, mb_ser_rx_timing_t *timing)
+{
+    return false;
+}
+
+#endif
+
 #endif
 
 IRAM_ATTR
@@ -32,6 +32,10 @@ void __wrap_mb_port_ser_disable(mb_port_base_t *inst);
 bool __wrap_mb_port_ser_send_data(mb_port_base_t *inst, uint8_t *p_ser_frame, uint16_t ser_length);
 bool __wrap_mb_port_ser_recv_data(mb_port_base_t *inst, uint8_t **ser_frame, uint16_t *p_ser_length);
 void __wrap_mb_port_ser_delete(mb_port_base_t *inst);
+#if (CONFIG_FMB_COMM_MODE_RTU_EN)
+uint16_t __wrap_mb_port_ser_get_recv_crc(mb_port_base_t *inst, const uint8_t *frame, uint16_t length);
+bool __wrap_mb_port_ser_get_rx_timing(mb_port_base_t *inst, mb_ser_rx_timing_t *timing);
+#endif
 
 #endif
 
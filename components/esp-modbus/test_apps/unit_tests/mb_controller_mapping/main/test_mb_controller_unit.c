@@ -6,9 +6,11 @@
 #include "unity_fixture.h"
 
 #include "sdkconfig.h"
+#include "esp_timer.h"
 #include "test_common.h"
 #include "mbc_master.h"
 #include "mbc_slave.h"
+#include "mb_utils.h"
 
 #include "Mocktest_mbm_object.h"
 #include "mb_object_stub.h"
@@ -23,6 +25,23 @@
 
 #define TEST_MASTER_RESPOND_TOUT_MS CONFIG_FMB_MASTER_TIMEOUT_MS_RESPOND
 
+#define TEST_LOOKUP_AREA_REGS 4
+#define TEST_LOOKUP_AREA_STEP 8
+#define TEST_LOOKUP_AREAS_MAX 512
+#define TEST_LOOKUP_CYCLES 10000
+#define TEST_IMAGE_REGS 4
+#define TEST_CHANGE_REGS 16
+#define TEST_BITS_BUF_SIZE 256
+#define TEST_BITS_CYCLES 1000
+#define TEST_REGS_MAX 125
+#define TEST_REGS_CYCLES 10000
+#define TEST_SCHED_WRITE_ID 1
+#define TEST_SCHED_WAIT_MS 50
+#define TEST_CACHE_UID 7
+#define TEST_CACHE_TTL_MS 50
+#define TEST_MERGE_UID 9
+#define TEST_MERGE_WAIT_MS 50
+
 #define TAG "MB_CONTROLLER_TEST"
 
 // The workaround to statically link whole test library
@@ -89,7 +108,8 @@ TEST_TEAR_DOWN(unit_test_controller)
     test_common_stop();
 }
 
-static void test_slave_check_descriptor(int par_index)
+// Creates the serial slave controller over the fake mb object, the destructor of controller destroys the object
+static void *test_slave_create(mb_base_t **mb_base_ptr)
 {
     mb_communication_info_t slave_config = {
         .ser_opts.port = TEST_SER_PORT_NUM,
@@ -113,6 +133,14 @@ static void test_slave_check_descriptor(int par_index)
 
     TEST_ESP_OK(mbc_slave_create_serial(&slave_config, &mbs_handle));
     TEST_ASSERT(mbs_handle);
+    *mb_base_ptr = mb_base;
+    return mbs_handle;
+}
+
+static void test_slave_check_descriptor(int par_index)
+{
+    mb_base_t *mb_base = NULL; // fake mb_base handle
+    void *mbs_handle = test_slave_create(&mb_base);
 
     mbs_controller_iface_t *mbs_iface = (mbs_controller_iface_t *)mbs_handle;
     //mb_slave_options_t *mbs_opts = MB_SLAVE_GET_OPTS(mbs_iface);
@@ -158,6 +186,534 @@ static void test_slave_check_descriptor(int par_index)
     ESP_LOGI(TAG, "Test passed successfully.");
 }
 
+static uint16_t lookup_registers[TEST_LOOKUP_AREAS_MAX][TEST_LOOKUP_AREA_REGS] = {0};
+
+// Returns the average time of area lookup in nanoseconds
+static uint32_t test_slave_lookup_time(void *mbs_handle, int num_areas)
+{
+    uint32_t seed = 0x1234;
+    int64_t start_time = esp_timer_get_time();
+    for (int i = 0; i < TEST_LOOKUP_CYCLES; i++) {
+        seed = (seed * 1103515245 + 12345);
+        int area = (seed >> 8) % num_areas;
+        uint16_t addr = (area * TEST_LOOKUP_AREA_STEP) + ((seed >> 4) % TEST_LOOKUP_AREA_REGS);
+        mb_descr_entry_t *it = mbc_slave_find_reg_descriptor(mbs_handle, MB_PARAM_INPUT, addr, 1);
+        TEST_ASSERT_NOT_NULL(it);
+        TEST_ASSERT_EQUAL_HEX32(&lookup_registers[area][0], it->p_data);
+    }
+    return (uint32_t)(((esp_timer_get_time() - start_time) * 1000) / TEST_LOOKUP_CYCLES);
+}
+
+static void test_slave_check_lookup(int num_areas)
+{
+    mb_base_t *mb_base = NULL; // fake mb_base handle
+    void *mbs_handle = test_slave_create(&mb_base);
+    mb_slave_options_t *mbs_opts = MB_SLAVE_GET_OPTS(mbs_handle);
+
+    // Define the areas in reverse order to check the sorting of index
+    mb_register_area_descriptor_t reg_area;
+    for (int i = (num_areas - 1); i >= 0; i--) {
+        reg_area.type = MB_PARAM_INPUT;
+        reg_area.start_offset = (i * TEST_LOOKUP_AREA_STEP);
+        reg_area.address = (void *)&lookup_registers[i][0];
+        reg_area.size = (TEST_LOOKUP_AREA_REGS << 1);
+        reg_area.access = MB_ACCESS_RW;
+        TEST_ESP_OK(mbc_slave_set_descriptor(mbs_handle, reg_area));
+    }
+    TEST_ASSERT_TRUE(mbs_opts->area_index[MB_PARAM_INPUT].is_valid);
+    TEST_ASSERT_EQUAL(num_areas, mbs_opts->area_index[MB_PARAM_INPUT].count);
+
+    // The registers in the gaps and over the area end are not mapped
+    TEST_ASSERT_NULL(mbc_slave_find_reg_descriptor(mbs_handle, MB_PARAM_INPUT, TEST_LOOKUP_AREA_REGS, 1));
+    TEST_ASSERT_NULL(mbc_slave_find_reg_descriptor(mbs_handle, MB_PARAM_INPUT, 0, TEST_LOOKUP_AREA_REGS + 1));
+    TEST_ASSERT_NULL(mbc_slave_find_reg_descriptor(mbs_handle, MB_PARAM_INPUT, (num_areas * TEST_LOOKUP_AREA_STEP), 1));
+    TEST_ASSERT_NULL(mbc_slave_find_reg_descriptor(mbs_handle, MB_PARAM_HOLDING, 0, 1));
+
+    uint32_t index_time = test_slave_lookup_time(mbs_handle, num_areas);
+    // Invalidate the index to measure the linear search of the descriptor list
+    mbs_opts->area_index[MB_PARAM_INPUT].is_valid = false;
+    uint32_t list_time = test_slave_lookup_time(mbs_handle, num_areas);
+    mbs_opts->area_index[MB_PARAM_INPUT].is_valid = true;
+    ESP_LOGI(TAG, "Area lookup, areas: %d, index: %" PRIu32 " ns, list: %" PRIu32 " ns.",
+                    num_areas, index_time, list_time);
+
+    TEST_ESP_OK(mbc_slave_delete(mbs_handle)); // the destructor of mb controller destroys the fake mb_object as well
+    TEST_ASSERT_EQUAL_HEX(mb_port_get_inst_counter(), 0);
+}
+
+static uint16_t image_registers[2][TEST_IMAGE_REGS] = {{0x1111, 0x2222, 0x3333, 0x4444}};
+
+static void test_slave_check_reg_image(void)
+{
+    mb_base_t *mb_base = NULL; // fake mb_base handle
+    mb_reg_image_t image;
+    uint8_t reg_data[TEST_IMAGE_REGS << 1] = {0};
+    uint16_t value = 0;
+
+    void *mbs_handle = test_slave_create(&mb_base);
+    mb_base->descr.parent = mbs_handle;
+
+    mb_register_area_descriptor_t reg_area = {
+        .type = MB_PARAM_INPUT,
+        .start_offset = TEST_AREA0_REG_OFFS,
+        .address = (void *)&image_registers[0][0],
+        .size = sizeof(image_registers[0]),
+        .access = MB_ACCESS_RW
+    };
+    TEST_ESP_OK(mbc_slave_set_descriptor(mbs_handle, reg_area));
+    TEST_ESP_OK(mbc_slave_reg_image_init(&image, &image_registers[0][0], &image_registers[1][0], sizeof(image_registers[0])));
+    TEST_ESP_ERR(ESP_ERR_NOT_SUPPORTED, mbc_slave_set_reg_image(mbs_handle, MB_PARAM_HOLDING, TEST_AREA0_REG_OFFS, &image));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, mbc_slave_set_reg_image(mbs_handle, MB_PARAM_INPUT, TEST_AREA0_REG_OFFS + 1, &image));
+    TEST_ESP_OK(mbc_slave_set_reg_image(mbs_handle, MB_PARAM_INPUT, TEST_AREA0_REG_OFFS, &image));
+
+    // The updated values are not visible until the image is published
+    uint16_t *back = (uint16_t *)mbc_slave_reg_image_begin(&image);
+    TEST_ASSERT_EQUAL_HEX32(&image_registers[1][0], back);
+    TEST_ASSERT_EQUAL_HEX16(0x4444, back[3]);
+    back[1] = 0xA5B6;
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbc_reg_input_slave_cb(mb_base, reg_data, TEST_AREA0_REG_OFFS + 2, 1));
+    TEST_ASSERT_EQUAL_HEX8(0x22, reg_data[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x22, reg_data[1]);
+
+    TEST_ESP_OK(mbc_slave_reg_image_publish(&image));
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbc_reg_input_slave_cb(mb_base, reg_data, TEST_AREA0_REG_OFFS + 1, TEST_IMAGE_REGS));
+    TEST_ASSERT_EQUAL_HEX8(0x11, reg_data[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, reg_data[2]); // big endian register data
+    TEST_ASSERT_EQUAL_HEX8(0xB6, reg_data[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x44, reg_data[7]);
+    TEST_ESP_OK(mbc_slave_reg_image_read(&image, sizeof(uint16_t), &value, sizeof(value)));
+    TEST_ASSERT_EQUAL_HEX16(0xA5B6, value);
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, mbc_slave_reg_image_read(&image, sizeof(image_registers[0]), &value, sizeof(value)));
+
+    // The next update starts from the published values in the other buffer
+    back = (uint16_t *)mbc_slave_reg_image_begin(&image);
+    TEST_ASSERT_EQUAL_HEX32(&image_registers[0][0], back);
+    TEST_ASSERT_EQUAL_HEX16(0xA5B6, back[1]);
+
+    TEST_ESP_OK(mbc_slave_delete(mbs_handle)); // the destructor of mb controller destroys the fake mb_object as well
+    TEST_ASSERT_EQUAL_HEX(mb_port_get_inst_counter(), 0);
+}
+
+static uint16_t change_hold_registers[TEST_CHANGE_REGS] = {0};
+static uint8_t change_coil_registers[TEST_CHANGE_REGS >> 3] = {0};
+
+static void test_slave_check_change_log(void)
+{
+    mb_base_t *mb_base = NULL; // fake mb_base handle
+    mb_param_change_t changes[2];
+    mb_change_log_stats_t stats;
+    size_t count = 0;
+    uint8_t reg_data[8] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0};
+
+    void *mbs_handle = test_slave_create(&mb_base);
+    mb_base->descr.parent = mbs_handle;
+
+    mb_register_area_descriptor_t reg_area = {
+        .type = MB_PARAM_HOLDING,
+        .start_offset = TEST_AREA0_REG_OFFS,
+        .address = (void *)&change_hold_registers[0],
+        .size = sizeof(change_hold_registers),
+        .access = MB_ACCESS_RW
+    };
+    TEST_ESP_OK(mbc_slave_set_descriptor(mbs_handle, reg_area));
+    reg_area.type = MB_PARAM_COIL;
+    reg_area.address = (void *)&change_coil_registers[0];
+    reg_area.size = sizeof(change_coil_registers);
+    TEST_ESP_OK(mbc_slave_set_descriptor(mbs_handle, reg_area));
+
+    TEST_ESP_OK(mbc_slave_get_changes(mbs_handle, changes, 2, &count));
+    TEST_ASSERT_EQUAL(0, count);
+
+    // The overlapped writes are merged, the register address in callback is already +1
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbc_reg_holding_slave_cb(mb_base, reg_data, TEST_AREA0_REG_OFFS + 1, 2, MB_REG_WRITE));
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbc_reg_holding_slave_cb(mb_base, reg_data, TEST_AREA0_REG_OFFS + 2, 3, MB_REG_WRITE));
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbc_reg_holding_slave_cb(mb_base, reg_data, TEST_AREA0_REG_OFFS + 9, 1, MB_REG_WRITE));
+    TEST_ASSERT_EQUAL(MB_ENOERR, mbc_reg_coils_slave_cb(mb_base, reg_data, TEST_AREA0_REG_OFFS + 4, 3, MB_REG_WRITE));
+    TEST_ASSERT_EQUAL_HEX16(0x1234, change_hold_registers[1]);
+
+    // The ranges which do not fit into the array are kept for the next call
+    TEST_ESP_OK(mbc_slave_get_changes(mbs_handle, changes, 2, &count));
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL(MB_PARAM_HOLDING, changes[0].type);
+    TEST_ASSERT_EQUAL(TEST_AREA0_REG_OFFS, changes[0].mb_offset);
+    TEST_ASSERT_EQUAL(4, changes[0].size);
+    TEST_ASSERT_EQUAL_HEX32(&change_hold_registers[0], changes[0].address);
+    TEST_ASSERT_EQUAL(TEST_AREA0_REG_OFFS + 8, changes[1].mb_offset);
+    TEST_ASSERT_EQUAL(1, changes[1].size);
+    TEST_ESP_OK(mbc_slave_get_changes(mbs_handle, changes, 2, &count));
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL(MB_PARAM_COIL, changes[0].type);
+    TEST_ASSERT_EQUAL(TEST_AREA0_REG_OFFS + 3, changes[0].mb_offset);
+    TEST_ASSERT_EQUAL(3, changes[0].size);
+    TEST_ESP_OK(mbc_slave_get_changes(mbs_handle, changes, 2, &count));
+    TEST_ASSERT_EQUAL(0, count);
+
+    TEST_ESP_OK(mbc_slave_get_change_stats(mbs_handle, &stats));
+    TEST_ASSERT_EQUAL(4, stats.accesses);
+    TEST_ASSERT_EQUAL(2, stats.coalesced);
+    TEST_ASSERT_EQUAL(3, stats.ranges);
+
+    // The burst of writes overflows the notification queue, but all changes are kept in the log
+    for (int i = 0; i < (CONFIG_FMB_CONTROLLER_NOTIFY_QUEUE_SIZE + TEST_CHANGE_REGS); i++) {
+        TEST_ASSERT_EQUAL(MB_ENOERR, mbc_reg_holding_slave_cb(mb_base, reg_data,
+                                        TEST_AREA0_REG_OFFS + 1 + (i % TEST_CHANGE_REGS), 1, MB_REG_WRITE));
+    }
+    TEST_ESP_OK(mbc_slave_get_changes(mbs_handle, changes, 2, &count));
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL(TEST_AREA0_REG_OFFS, changes[0].mb_offset);
+    TEST_ASSERT_EQUAL(TEST_CHANGE_REGS, changes[0].size);
+    TEST_ESP_OK(mbc_slave_get_change_stats(mbs_handle, &stats));
+    TEST_ASSERT_TRUE(stats.queue_overflows > 0);
+    ESP_LOGI(TAG, "Change log, accesses: %" PRIu32 ", coalesced: %" PRIu32 ", queue overflows: %" PRIu32 ".",
+                    stats.accesses, stats.coalesced, stats.queue_overflows);
+
+    TEST_ESP_OK(mbc_slave_delete(mbs_handle)); // the destructor of mb controller destroys the fake mb_object as well
+    TEST_ASSERT_EQUAL_HEX(mb_port_get_inst_counter(), 0);
+}
+
+static uint8_t bits_src[TEST_BITS_BUF_SIZE] = {0};
+static uint8_t bits_dst[TEST_BITS_BUF_SIZE] = {0};
+static uint8_t bits_ref[TEST_BITS_BUF_SIZE] = {0};
+
+// The bit per call copy used by the callbacks before, the reference for the block copy
+static void test_copy_bits_by_one(uint8_t *dst, uint16_t dst_offset, uint8_t *src, uint16_t src_offset, uint16_t bit_num)
+{
+    for (uint16_t i = 0; i < bit_num; i++) {
+        mb_util_set_bits(dst, dst_offset + i, 1, mb_util_get_bits(src, src_offset + i, 1));
+    }
+}
+
+// Checks the block copy of bits against the reference and logs the average time of the transfer
+static void test_check_copy_bits(uint16_t dst_offset, uint16_t src_offset, uint16_t bit_num)
+{
+    uint32_t seed = 0x5A5A + bit_num + src_offset;
+    for (int i = 0; i < TEST_BITS_BUF_SIZE; i++) {
+        seed = (seed * 1103515245 + 12345);
+        bits_src[i] = (uint8_t)(seed >> 16);
+        bits_dst[i] = bits_ref[i] = (uint8_t)(seed >> 8);
+    }
+    test_copy_bits_by_one(bits_ref, dst_offset, bits_src, src_offset, bit_num);
+    mb_util_copy_bits(bits_dst, dst_offset, bits_src, src_offset, bit_num);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(bits_ref, bits_dst, TEST_BITS_BUF_SIZE);
+
+    int64_t start_time = esp_timer_get_time();
+    for (int i = 0; i < TEST_BITS_CYCLES; i++) {
+        test_copy_bits_by_one(bits_ref, dst_offset, bits_src, src_offset, bit_num);
+    }
+    uint32_t by_one_time = (uint32_t)(((esp_timer_get_time() - start_time) * 1000) / TEST_BITS_CYCLES);
+    start_time = esp_timer_get_time();
+    for (int i = 0; i < TEST_BITS_CYCLES; i++) {
+        mb_util_copy_bits(bits_dst, dst_offset, bits_src, src_offset, bit_num);
+    }
+    uint32_t block_time = (uint32_t)(((esp_timer_get_time() - start_time) * 1000) / TEST_BITS_CYCLES);
+    ESP_LOGI(TAG, "Copy bits (dst, src, num): %u, %u, %u, by one: %" PRIu32 " ns, block: %" PRIu32 " ns.",
+                    (unsigned)dst_offset, (unsigned)src_offset, (unsigned)bit_num, by_one_time, block_time);
+}
+
+static uint8_t regs_src[(TEST_REGS_MAX + 4) << 1] __attribute__((aligned(4))) = {0};
+static uint8_t regs_dst[(TEST_REGS_MAX + 4) << 1] __attribute__((aligned(4))) = {0};
+static uint8_t regs_ref[(TEST_REGS_MAX + 4) << 1] __attribute__((aligned(4))) = {0};
+
+// The register per iteration copy used by the callbacks before, the reference for the bulk copy
+static void test_copy_regs_by_one(uint8_t *dst, uint8_t *src, uint16_t reg_num)
+{
+    while (reg_num > 0) {
+        _XFER_2_RD(dst, src);
+        reg_num--;
+    }
+}
+
+// Checks the bulk copy of registers against the reference and logs the average time per register
+static void test_check_copy_regs(uint16_t dst_offset, uint16_t src_offset, uint16_t reg_num)
+{
+    uint32_t seed = 0xA5A5 + reg_num + dst_offset;
+    for (size_t i = 0; i < sizeof(regs_src); i++) {
+        seed = (seed * 1103515245 + 12345);
+        regs_src[i] = (uint8_t)(seed >> 16);
+        regs_dst[i] = regs_ref[i] = (uint8_t)(seed >> 8);
+    }
+    test_copy_regs_by_one(&regs_ref[dst_offset], &regs_src[src_offset], reg_num);
+    mb_util_copy_regs(&regs_dst[dst_offset], &regs_src[src_offset], reg_num);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(regs_ref, regs_dst, sizeof(regs_dst));
+
+    int64_t start_time = esp_timer_get_time();
+    for (int i = 0; i < TEST_REGS_CYCLES; i++) {
+        test_copy_regs_by_one(&regs_ref[dst_offset], &regs_src[src_offset], reg_num);
+    }
+    uint32_t by_one_time = (uint32_t)(((esp_timer_get_time() - start_time) * 1000) / ((int64_t)TEST_REGS_CYCLES * reg_num));
+    start_time = esp_timer_get_time();
+    for (int i = 0; i < TEST_REGS_CYCLES; i++) {
+        mb_util_copy_regs(&regs_dst[dst_offset], &regs_src[src_offset], reg_num);
+    }
+    uint32_t bulk_time = (uint32_t)(((esp_timer_get_time() - start_time) * 1000) / ((int64_t)TEST_REGS_CYCLES * reg_num));
+    ESP_LOGI(TAG, "Copy regs (dst, src, num): %u, %u, %u, by one: %" PRIu32 " ns/reg, bulk: %" PRIu32 " ns/reg.",
+                    (unsigned)dst_offset, (unsigned)src_offset, (unsigned)reg_num, by_one_time, bulk_time);
+}
+
+static mb_master_sched_t *test_sched = NULL;
+static int test_sched_ids[MB_MASTER_SCHED_QUEUE_SIZE] = {0};
+static int test_sched_order[MB_MASTER_SCHED_QUEUE_SIZE] = {0};
+static volatile int test_sched_count = 0;
+
+static void test_sched_task(void *arg)
+{
+    int id = *(int *)arg;
+    if (mbc_master_sched_enter(test_sched, (id == TEST_SCHED_WRITE_ID), portMAX_DELAY) == ESP_OK) {
+        test_sched_order[test_sched_count++] = id;
+        mbc_master_sched_leave(test_sched);
+    }
+    vTaskDelete(NULL);
+}
+
+static void test_master_check_sched(void)
+{
+    mb_master_sched_stats_t stats;
+
+    TEST_ESP_OK(mbc_master_sched_create(&test_sched));
+    test_sched_count = 0;
+
+    // The bus is free, the request gets it without waiting
+    TEST_ESP_OK(mbc_master_sched_enter(test_sched, false, 0));
+
+    // The requests of other tasks are queued while the bus is owned
+    for (int i = 0; i < MB_MASTER_SCHED_QUEUE_SIZE; i++) {
+        test_sched_ids[i] = i;
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(test_sched_task, "test_sched", 4096,
+                                                &test_sched_ids[i], tskIDLE_PRIORITY + 1, NULL));
+        vTaskDelay(pdMS_TO_TICKS(TEST_SCHED_WAIT_MS / 5));
+    }
+    TEST_ESP_OK(mbc_master_sched_get_stats(test_sched, &stats));
+    TEST_ASSERT_EQUAL(MB_MASTER_SCHED_QUEUE_SIZE, stats.depth);
+
+    // The queue is full, the request is rejected immediately as Slave Device Busy
+    int64_t start_time = esp_timer_get_time();
+    TEST_ESP_ERR(ESP_ERR_NOT_FINISHED, mbc_master_sched_enter(test_sched, true, pdMS_TO_TICKS(TEST_SCHED_WAIT_MS)));
+    TEST_ASSERT_TRUE((esp_timer_get_time() - start_time) < (TEST_SCHED_WAIT_MS * 1000));
+
+    // The write request is sent first, then the read requests in the order of arrival
+    mbc_master_sched_leave(test_sched);
+    vTaskDelay(pdMS_TO_TICKS(TEST_SCHED_WAIT_MS));
+    TEST_ASSERT_EQUAL(MB_MASTER_SCHED_QUEUE_SIZE, test_sched_count);
+    TEST_ASSERT_EQUAL(TEST_SCHED_WRITE_ID, test_sched_order[0]);
+    for (int i = 1, id = 0; i < MB_MASTER_SCHED_QUEUE_SIZE; i++, id++) {
+        id += (id == TEST_SCHED_WRITE_ID) ? 1 : 0;
+        TEST_ASSERT_EQUAL(id, test_sched_order[i]);
+    }
+
+    // The bus is not granted during the timeout
+    TEST_ESP_OK(mbc_master_sched_enter(test_sched, false, 0));
+    TEST_ESP_ERR(ESP_ERR_NOT_FINISHED, mbc_master_sched_enter(test_sched, false, pdMS_TO_TICKS(1)));
+    mbc_master_sched_leave(test_sched);
+
+    TEST_ESP_OK(mbc_master_sched_get_stats(test_sched, &stats));
+    TEST_ASSERT_EQUAL(0, stats.depth);
+    TEST_ASSERT_EQUAL(MB_MASTER_SCHED_QUEUE_SIZE, stats.depth_max);
+    TEST_ASSERT_EQUAL(MB_MASTER_SCHED_QUEUE_SIZE + 4, stats.requests);
+    TEST_ASSERT_EQUAL(MB_MASTER_SCHED_QUEUE_SIZE + 1, stats.queued);
+    TEST_ASSERT_EQUAL(1, stats.rejected);
+    TEST_ASSERT_EQUAL(1, stats.timeouts);
+    ESP_LOGI(TAG, "Scheduler, max depth: %u, wait max: %" PRIu32 " us, wait total: %" PRIu64 " us.",
+                    (unsigned)stats.depth_max, stats.wait_max_us, stats.wait_total_us);
+
+    mbc_master_sched_delete(test_sched);
+    test_sched = NULL;
+}
+
+static void test_master_check_cache(void)
+{
+    mb_master_cache_t *cache = NULL;
+    mb_master_cache_stats_t stats;
+    uint16_t data[10] = {0x1111, 0x2222, 0x3333, 0x4444, 0x5555, 0x6666, 0x7777, 0x8888, 0x9999, 0xAAAA};
+    uint16_t cached[10] = {0};
+    mb_param_request_t read_req = {TEST_CACHE_UID, MB_FUNC_READ_HOLDING_REGISTER, 0, 10};
+    mb_param_request_t read_req2 = {TEST_CACHE_UID, MB_FUNC_READ_HOLDING_REGISTER, 0, 2};
+    mb_param_request_t read_req3 = {TEST_CACHE_UID, MB_FUNC_READ_HOLDING_REGISTER, 2, 2};
+    mb_param_request_t other_req = {TEST_CACHE_UID + 1, MB_FUNC_READ_HOLDING_REGISTER, 0, 10};
+    mb_param_request_t write_req = {TEST_CACHE_UID, MB_FUNC_WRITE_REGISTER, 5, 1};
+    mb_param_request_t write_req2 = {TEST_CACHE_UID, MB_FUNC_WRITE_REGISTER, 15, 1};
+    mb_param_request_t coil_req = {TEST_CACHE_UID, MB_FUNC_WRITE_SINGLE_COIL, 5, 1};
+    mb_cache_range_t range = {
+        .slave_addr = TEST_CACHE_UID,
+        .param_type = MB_PARAM_HOLDING,
+        .reg_start = 0,
+        .reg_size = 20,
+        .ttl_ms = TEST_CACHE_TTL_MS
+    };
+
+    TEST_ESP_OK(mbc_master_cache_create(&cache, 2));
+    TEST_ESP_OK(mbc_master_cache_set_range(cache, &range));
+
+    // The first read goes to the bus, the repeated read is answered from the cache
+    TEST_ASSERT_FALSE(mbc_master_cache_read(cache, &read_req, cached));
+    mbc_master_cache_store(cache, &read_req, data);
+    TEST_ASSERT_TRUE(mbc_master_cache_read(cache, &read_req, cached));
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(data, cached, 10);
+
+    // The slave out of configured ranges is not cached
+    mbc_master_cache_store(cache, &other_req, data);
+    TEST_ASSERT_FALSE(mbc_master_cache_read(cache, &other_req, cached));
+
+    // The write to the overlapped register drops the data, other writes keep it
+    mbc_master_cache_invalidate(cache, &write_req);
+    TEST_ASSERT_FALSE(mbc_master_cache_read(cache, &read_req, cached));
+    mbc_master_cache_store(cache, &read_req, data);
+    mbc_master_cache_invalidate(cache, &write_req2);
+    mbc_master_cache_invalidate(cache, &coil_req);
+    TEST_ASSERT_TRUE(mbc_master_cache_read(cache, &read_req, cached));
+    TEST_ASSERT_TRUE(mbc_master_cache_read(cache, &read_req, cached));
+
+    // The least recently used entry is replaced when the cache is full
+    mbc_master_cache_store(cache, &read_req2, data);
+    mbc_master_cache_store(cache, &read_req3, &data[2]);
+    TEST_ASSERT_FALSE(mbc_master_cache_read(cache, &read_req, cached));
+    TEST_ASSERT_TRUE(mbc_master_cache_read(cache, &read_req3, cached));
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(&data[2], cached, 2);
+
+    // The expired data is not used
+    vTaskDelay(pdMS_TO_TICKS(TEST_CACHE_TTL_MS * 2));
+    TEST_ASSERT_FALSE(mbc_master_cache_read(cache, &read_req3, cached));
+
+    TEST_ESP_OK(mbc_master_cache_get_stats(cache, &stats));
+    TEST_ASSERT_EQUAL(4, stats.hits);
+    TEST_ASSERT_EQUAL(4, stats.misses);
+    TEST_ASSERT_EQUAL(1, stats.invalidations);
+    TEST_ASSERT_EQUAL(1, stats.evictions);
+
+    mbc_master_cache_delete(cache);
+}
+
+static mb_read_coalesce_t *test_coalesce = NULL;
+static volatile esp_err_t test_follower_err = ESP_FAIL;
+static volatile bool test_follower_done = false;
+
+// The follower waits for the result of the leader without deadline
+static void test_follower_task(void *arg)
+{
+    mb_param_request_t *request = (mb_param_request_t *)arg;
+    uint16_t data[4] = {0};
+    bool is_leader = true;
+    int idx = mbc_master_coalesce_join(test_coalesce, request, &is_leader);
+    if ((idx >= 0) && !is_leader) {
+        test_follower_err = mbc_master_coalesce_leave(test_coalesce, idx, request, data, portMAX_DELAY);
+    }
+    test_follower_done = true;
+    vTaskDelete(NULL);
+}
+
+static void test_master_check_coalesce(void)
+{
+    uint16_t data[2][10] = {0};
+    uint16_t max_data[MB_MASTER_READ_GROUP_REGS_MAX] = {0};
+    mb_param_request_t merged = {0};
+    bool is_leader = false;
+
+    mb_param_request_t lead_req = {TEST_MERGE_UID, MB_FUNC_READ_HOLDING_REGISTER, 10, 10};
+    mb_param_request_t overlap_req = {TEST_MERGE_UID, MB_FUNC_READ_HOLDING_REGISTER, 15, 10};
+    mb_param_request_t adjacent_req = {TEST_MERGE_UID, MB_FUNC_READ_HOLDING_REGISTER, 25, 5};
+    mb_param_request_t gap_req = {TEST_MERGE_UID, MB_FUNC_READ_HOLDING_REGISTER, 31, 2};
+    mb_param_request_t max_req = {TEST_MERGE_UID, MB_FUNC_READ_HOLDING_REGISTER, 30, 105};
+    mb_param_request_t over_req = {TEST_MERGE_UID, MB_FUNC_READ_HOLDING_REGISTER, 130, 6};
+    mb_param_request_t input_req = {TEST_MERGE_UID, MB_FUNC_READ_INPUT_REGISTER, 10, 10};
+    mb_param_request_t other_req = {TEST_MERGE_UID + 1, MB_FUNC_READ_HOLDING_REGISTER, 10, 10};
+    mb_param_request_t coil_req = {TEST_MERGE_UID, MB_FUNC_READ_COILS, 10, 10};
+    mb_param_request_t write_req = {TEST_MERGE_UID, MB_FUNC_WRITE_MULTIPLE_REGISTERS, 10, 10};
+    mb_param_request_t long_req = {TEST_MERGE_UID, MB_FUNC_READ_HOLDING_REGISTER, 0, MB_MASTER_READ_GROUP_REGS_MAX + 1};
+
+    TEST_ESP_OK(mbc_master_coalesce_create(&test_coalesce));
+
+    // Only the register reads up to the function limit are merged
+    TEST_ASSERT_EQUAL(-1, mbc_master_coalesce_join(test_coalesce, &coil_req, &is_leader));
+    TEST_ASSERT_EQUAL(-1, mbc_master_coalesce_join(test_coalesce, &write_req, &is_leader));
+    TEST_ASSERT_EQUAL(-1, mbc_master_coalesce_join(test_coalesce, &long_req, &is_leader));
+
+    // The overlapped and adjacent reads join the group of the first read
+    int lead_idx = mbc_master_coalesce_join(test_coalesce, &lead_req, &is_leader);
+    TEST_ASSERT_TRUE(lead_idx >= 0);
+    TEST_ASSERT_TRUE(is_leader);
+    TEST_ASSERT_EQUAL(lead_idx, mbc_master_coalesce_join(test_coalesce, &overlap_req, &is_leader));
+    TEST_ASSERT_FALSE(is_leader);
+    TEST_ASSERT_EQUAL(lead_idx, mbc_master_coalesce_join(test_coalesce, &adjacent_req, &is_leader));
+    TEST_ASSERT_FALSE(is_leader);
+
+    // The range with the gap, the other function or slave starts its own group
+    int gap_idx = mbc_master_coalesce_join(test_coalesce, &gap_req, &is_leader);
+    TEST_ASSERT_TRUE(is_leader);
+    TEST_ASSERT_NOT_EQUAL(lead_idx, gap_idx);
+    int input_idx = mbc_master_coalesce_join(test_coalesce, &input_req, &is_leader);
+    TEST_ASSERT_TRUE(is_leader);
+    TEST_ASSERT_NOT_EQUAL(lead_idx, input_idx);
+    int other_idx = mbc_master_coalesce_join(test_coalesce, &other_req, &is_leader);
+    TEST_ASSERT_TRUE(is_leader);
+    TEST_ASSERT_NOT_EQUAL(lead_idx, other_idx);
+
+    // The merged request is limited by 125 registers
+    TEST_ASSERT_EQUAL(lead_idx, mbc_master_coalesce_join(test_coalesce, &max_req, &is_leader));
+    int over_idx = mbc_master_coalesce_join(test_coalesce, &over_req, &is_leader);
+    TEST_ASSERT_TRUE(is_leader);
+    TEST_ASSERT_NOT_EQUAL(lead_idx, over_idx);
+
+    // The active group does not accept new reads
+    uint16_t *group_data = mbc_master_coalesce_activate(test_coalesce, lead_idx, &merged);
+    TEST_ASSERT_NOT_NULL(group_data);
+    TEST_ASSERT_EQUAL(10, merged.reg_start);
+    TEST_ASSERT_EQUAL(MB_MASTER_READ_GROUP_REGS_MAX, merged.reg_size);
+    int late_idx = mbc_master_coalesce_join(test_coalesce, &overlap_req, &is_leader);
+    TEST_ASSERT_TRUE(is_leader);
+    TEST_ASSERT_NOT_EQUAL(lead_idx, late_idx);
+
+    // Each caller gets its part of the merged response
+    for (int i = 0; i < merged.reg_size; i++) {
+        group_data[i] = (uint16_t)(merged.reg_start + i);
+    }
+    mbc_master_coalesce_complete(test_coalesce, lead_idx, ESP_OK);
+    TEST_ESP_OK(mbc_master_coalesce_leave(test_coalesce, lead_idx, &lead_req, data[0], 0));
+    TEST_ESP_OK(mbc_master_coalesce_leave(test_coalesce, lead_idx, &overlap_req, data[1], 0));
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_HEX16((lead_req.reg_start + i), data[0][i]);
+        TEST_ASSERT_EQUAL_HEX16((overlap_req.reg_start + i), data[1][i]);
+    }
+    TEST_ESP_OK(mbc_master_coalesce_leave(test_coalesce, lead_idx, &adjacent_req, data[0], 0));
+    TEST_ASSERT_EQUAL_HEX16(adjacent_req.reg_start, data[0][0]);
+    TEST_ESP_OK(mbc_master_coalesce_leave(test_coalesce, lead_idx, &max_req, max_data, 0));
+    TEST_ASSERT_EQUAL_HEX16(max_req.reg_start, max_data[0]);
+    TEST_ASSERT_EQUAL_HEX16((max_req.reg_start + max_req.reg_size - 1), max_data[max_req.reg_size - 1]);
+
+    // The error of the leader is returned to the followers, the data is not changed
+    memset(data, 0, sizeof(data));
+    mbc_master_coalesce_complete(test_coalesce, gap_idx, ESP_ERR_TIMEOUT);
+    TEST_ESP_ERR(ESP_ERR_TIMEOUT, mbc_master_coalesce_leave(test_coalesce, gap_idx, &gap_req, data[0], 0));
+    TEST_ASSERT_EQUAL_HEX16(0, data[0][0]);
+
+    // The follower waits until the leader completes the group
+    test_follower_done = false;
+    test_follower_err = ESP_FAIL;
+    mb_param_request_t follower_req = {TEST_MERGE_UID, MB_FUNC_READ_INPUT_REGISTER, 12, 4};
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(test_follower_task, "test_follower", 4096,
+                                            &follower_req, tskIDLE_PRIORITY + 1, NULL));
+    vTaskDelay(pdMS_TO_TICKS(TEST_MERGE_WAIT_MS));
+    TEST_ASSERT_FALSE(test_follower_done);
+    (void)mbc_master_coalesce_activate(test_coalesce, input_idx, &merged);
+    mbc_master_coalesce_complete(test_coalesce, input_idx, ESP_ERR_INVALID_RESPONSE);
+    TEST_ESP_ERR(ESP_ERR_INVALID_RESPONSE, mbc_master_coalesce_leave(test_coalesce, input_idx, &input_req, data[0], 0));
+    vTaskDelay(pdMS_TO_TICKS(TEST_MERGE_WAIT_MS));
+    TEST_ASSERT_TRUE(test_follower_done);
+    TEST_ESP_ERR(ESP_ERR_INVALID_RESPONSE, test_follower_err);
+
+    // The incomplete group is not waited longer than the timeout
+    TEST_ESP_ERR(ESP_ERR_TIMEOUT, mbc_master_coalesce_leave(test_coalesce, other_idx, &other_req, data[0], 0));
+    TEST_ESP_ERR(ESP_ERR_TIMEOUT, mbc_master_coalesce_leave(test_coalesce, over_idx, &over_req, data[0], 0));
+    TEST_ESP_ERR(ESP_ERR_TIMEOUT, mbc_master_coalesce_leave(test_coalesce, late_idx, &overlap_req, data[0], 0));
+
+    // The released groups are reused
+    TEST_ASSERT_EQUAL(lead_idx, mbc_master_coalesce_join(test_coalesce, &lead_req, &is_leader));
+    TEST_ASSERT_TRUE(is_leader);
+    mbc_master_coalesce_complete(test_coalesce, lead_idx, ESP_OK);
+    TEST_ESP_OK(mbc_master_coalesce_leave(test_coalesce, lead_idx, &lead_req, data[0], 0));
+
+    mbc_master_coalesce_delete(test_coalesce);
+    test_coalesce = NULL;
+}
+
 static esp_err_t test_master_read_req(int par_index, mb_err_enum_t mb_err)
 {
     mb_communication_info_t master_config = {
@@ -195,7 +751,28 @@ static esp_err_t test_master_read_req(int par_index, mb_err_enum_t mb_err)
     mb_port_event_res_release_ExpectAnyArgs();
 
     // Call the read method of modbus controller
+    mb_frame_stats_t frame_stats = {0};
+    mb_port_reset_frame_stats();
     esp_err_t err = mbc_master_get_parameter(mbm_handle, par_index, data_ptr, &type);
+    // The parameter data is placed into the scratch buffer of the controller without heap allocation
+    mb_port_get_frame_stats(&frame_stats);
+    TEST_ASSERT_EQUAL_UINT32(0, frame_stats.heap_alloc_count);
+    TEST_ASSERT_EQUAL_UINT32(1, frame_stats.pool_alloc_count);
+    TEST_ASSERT_EQUAL_UINT32(1, frame_stats.pool_free_count);
+    // The scratch buffers must be aligned for the direct access to U32, FLOAT and DOUBLE values
+    mb_master_options_t *mbm_opts = MB_MASTER_GET_OPTS(mbm_handle);
+    frame_pool_t *param_pools[2] = {NULL, NULL};
+    uint8_t *param_bufs[2] = {mbc_master_param_buf_alloc(mbm_opts, 1, &param_pools[0]),
+                                mbc_master_param_buf_alloc(mbm_opts, 1, &param_pools[1])};
+    // The descriptor table is replaced while the buffers are taken, they are returned into the previous pool
+    TEST_ESP_OK(mbc_master_set_descriptor(mbm_handle, &descriptors[0], num_descriptors));
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_NOT_NULL(param_bufs[i]);
+        TEST_ASSERT_EQUAL(0, ((uintptr_t)param_bufs[i] % _Alignof(double)));
+        TEST_ASSERT_NOT_NULL(param_pools[i]);
+        TEST_ASSERT_TRUE(param_pools[i] != mbm_opts->param_pool);
+        frame_buf_free(param_pools[i], param_bufs[i]);
+    }
     uint8_t *mb_frame_ptr = NULL;
     // get send buffer back using the fake mb_object
     mb_base->get_send_buf(mb_base, &mb_frame_ptr);
@@ -469,6 +1046,72 @@ TEST(unit_test_controller, test_slave_check_area_descriptor)
     test_slave_check_descriptor(CID_DEV_DISCR_AREA);
 }
 
+TEST(unit_test_controller, test_slave_area_lookup)
+{
+    ESP_LOGI(TAG, "TEST: Check the modbus slave controller finds the register areas and measure the lookup time.");
+    test_slave_check_lookup(1);
+    test_slave_check_lookup(64);
+    test_slave_check_lookup(TEST_LOOKUP_AREAS_MAX);
+}
+
+TEST(unit_test_controller, test_slave_reg_image)
+{
+    ESP_LOGI(TAG, "TEST: Check the modbus slave controller reads the input registers from the published register image.");
+    test_slave_check_reg_image();
+}
+
+TEST(unit_test_controller, test_slave_change_log)
+{
+    ESP_LOGI(TAG, "TEST: Check the modbus slave controller keeps the changed parameter ranges in the change log.");
+    test_slave_check_change_log();
+}
+
+TEST(unit_test_controller, test_copy_bits)
+{
+    ESP_LOGI(TAG, "TEST: Check the block copy of coils and discrete inputs and measure the transfer time.");
+    test_check_copy_bits(0, 0, 0);
+    test_check_copy_bits(0, 0, 1);
+    test_check_copy_bits(0, 0, 16);
+    test_check_copy_bits(0, 8, 100); // byte aligned
+    test_check_copy_bits(0, 3, 100); // unaligned source, FC01 and FC02 read
+    test_check_copy_bits(5, 0, 100); // unaligned destination, FC15 write
+    test_check_copy_bits(7, 13, 37);
+    test_check_copy_bits(0, 0, 2000); // max FC01 read
+    test_check_copy_bits(0, 5, 2000);
+    test_check_copy_bits(0, 0, 1968); // max FC15 write
+    test_check_copy_bits(3, 0, 1968);
+}
+
+TEST(unit_test_controller, test_copy_regs)
+{
+    ESP_LOGI(TAG, "TEST: Check the bulk copy of holding and input registers and measure the time per register.");
+    test_check_copy_regs(0, 0, 1);
+    test_check_copy_regs(0, 0, 3);
+    test_check_copy_regs(2, 2, 7); // the same alignment
+    test_check_copy_regs(3, 0, 10); // the register data in the frame is not aligned
+    test_check_copy_regs(0, 0, TEST_REGS_MAX); // max FC03 and FC04 read
+    test_check_copy_regs(3, 0, TEST_REGS_MAX);
+    test_check_copy_regs(0, 7, 123); // max FC16 write
+}
+
+TEST(unit_test_controller, test_master_sched)
+{
+    ESP_LOGI(TAG, "TEST: Check the master request scheduler queues the requests of several tasks and rejects the overflow.");
+    test_master_check_sched();
+}
+
+TEST(unit_test_controller, test_master_cache)
+{
+    ESP_LOGI(TAG, "TEST: Check the master read cache answers the repeated reads and drops the overwritten data.");
+    test_master_check_cache();
+}
+
+TEST(unit_test_controller, test_master_coalesce)
+{
+    ESP_LOGI(TAG, "TEST: Check the master merges the overlapped reads and returns the result of the merged read to each caller.");
+    test_master_check_coalesce();
+}
+
 TEST(unit_test_controller, test_master_register_callbacks)
 {
     ESP_LOGI(TAG, "TEST: Check the modbus master controller handles mapping callback functions correctly.");
@@ -483,5 +1126,13 @@ TEST_GROUP_RUNNER(unit_test_controller)
     RUN_TEST_CASE(unit_test_controller, test_master_send_read_request);
     RUN_TEST_CASE(unit_test_controller, test_master_send_write_request);
     RUN_TEST_CASE(unit_test_controller, test_master_register_callbacks);
+    RUN_TEST_CASE(unit_test_controller, test_master_sched);
+    RUN_TEST_CASE(unit_test_controller, test_master_cache);
+    RUN_TEST_CASE(unit_test_controller, test_master_coalesce);
     RUN_TEST_CASE(unit_test_controller, test_slave_check_area_descriptor);
+    RUN_TEST_CASE(unit_test_controller, test_slave_area_lookup);
+    RUN_TEST_CASE(unit_test_controller, test_slave_reg_image);
+    RUN_TEST_CASE(unit_test_controller, test_slave_change_log);
+    RUN_TEST_CASE(unit_test_controller, test_copy_bits);
+    RUN_TEST_CASE(unit_test_controller, test_copy_regs);
 }
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "unity.h"
+#include "unity_test_runner.h"
+#include "unity_fixture.h"
+
+static void run_all_tests(void)
+{
+    RUN_TEST_GROUP(unit_test_crc16);
+    RUN_TEST_GROUP(unit_test_ascii_lrc);
+    RUN_TEST_GROUP(unit_test_transaction);
+    RUN_TEST_GROUP(unit_test_tcp_parser);
+    RUN_TEST_GROUP(unit_test_tcp_pipe);
+    RUN_TEST_GROUP(unit_test_frame_pool);
+    RUN_TEST_GROUP(unit_test_master_timing);
+}
+
+void app_main(void)
+{
+    UNITY_MAIN_FUNC(run_all_tests);
+}
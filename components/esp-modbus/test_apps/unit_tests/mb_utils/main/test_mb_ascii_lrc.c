@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "unity_fixture.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "sdkconfig.h"
+#include "ascii/ascii_lrc.h"
+
+#define TAG "MB_ASCII_LRC_TEST"
+
+#define TEST_BIN_SIZE_MAX       (252)
+#define TEST_ASCII_SIZE_MAX     ((TEST_BIN_SIZE_MAX * 2) + 5)
+#define TEST_RANDOM_FRAMES      (500)
+#define TEST_BENCH_ROUNDS       (1000)
+
+static uint8_t test_bin[TEST_BIN_SIZE_MAX + 1];
+static uint8_t test_frame[TEST_ASCII_SIZE_MAX + 2];
+static uint8_t test_ref_frame[TEST_ASCII_SIZE_MAX + 2];
+static uint8_t test_ref_decoded[TEST_ASCII_SIZE_MAX + 2];
+
+// Per-character reference of the encoder, the frame contains the data and its LRC
+static int test_ascii_encode_reference(const uint8_t *data_ptr, uint8_t *buf, int bin_length)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    int frm_idx = 0;
+    uint8_t lrc = 0;
+    buf[frm_idx++] = ':';
+    for (int i = 0; i < bin_length; i++) {
+        buf[frm_idx++] = hex[data_ptr[i] >> 4];
+        buf[frm_idx++] = hex[data_ptr[i] & 0x0F];
+        lrc += data_ptr[i];
+    }
+    lrc = (uint8_t)(-lrc);
+    buf[frm_idx++] = hex[lrc >> 4];
+    buf[frm_idx++] = hex[lrc & 0x0F];
+    buf[frm_idx++] = '\r';
+    buf[frm_idx++] = '\n';
+    return frm_idx;
+}
+
+static int test_ascii_char_reference(uint8_t char_val)
+{
+    if ((char_val >= '0') && (char_val <= '9')) {
+        return char_val - '0';
+    } else if ((char_val >= 'A') && (char_val <= 'F')) {
+        return char_val - 'A' + 0x0A;
+    } else if ((char_val >= 'a') && (char_val <= 'f')) {
+        return char_val - 'a' + 0x0A;
+    }
+    return -1;
+}
+
+// Per-character reference of the decoder with the separate LRC pass
+static int test_ascii_decode_reference(uint8_t *data_ptr, int length)
+{
+    if ((length < 3) || (data_ptr[0] != ':') || (data_ptr[length - 2] != '\r')
+        || (data_ptr[length - 1] != '\n') || ((length - 3) & 1)) {
+        return -1;
+    }
+    int bin_idx = 0;
+    for (int str_idx = 1; str_idx < (length - 2); str_idx += 2) {
+        int high = test_ascii_char_reference(data_ptr[str_idx]);
+        int low = test_ascii_char_reference(data_ptr[str_idx + 1]);
+        if ((high < 0) || (low < 0)) {
+            return -1;
+        }
+        data_ptr[bin_idx++] = (uint8_t)((high << 4) | low);
+    }
+    uint8_t lrc = 0;
+    for (int i = 0; i < bin_idx; i++) {
+        lrc += data_ptr[i];
+    }
+    return lrc ? -1 : bin_idx;
+}
+
+static void test_fill_random(uint8_t *data_ptr, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        data_ptr[i] = (uint8_t)rand();
+    }
+}
+
+TEST_GROUP(unit_test_ascii_lrc);
+
+TEST_SETUP(unit_test_ascii_lrc)
+{
+}
+
+TEST_TEAR_DOWN(unit_test_ascii_lrc)
+{
+}
+
+TEST(unit_test_ascii_lrc, test_hex_char_conversion)
+{
+    for (int char_val = 0; char_val <= UINT8_MAX; char_val++) {
+        int value = test_ascii_char_reference((uint8_t)char_val);
+        TEST_ASSERT_EQUAL_HEX8((value < 0) ? MB_ASCII_HEX_INVALID : value, mb_char2bin((uint8_t)char_val));
+    }
+    for (uint8_t nibble = 0; nibble <= 0x0F; nibble++) {
+        TEST_ASSERT_EQUAL_HEX8(nibble, mb_char2bin(mb_bin2char(nibble)));
+    }
+}
+
+TEST(unit_test_ascii_lrc, test_encode_decode_random_frames)
+{
+    srand(0x4D41);
+    for (int frame = 0; frame < TEST_RANDOM_FRAMES; frame++) {
+        int bin_len = frame % (TEST_BIN_SIZE_MAX + 1);
+        test_fill_random(test_bin, bin_len);
+
+        int ref_len = test_ascii_encode_reference(test_bin, test_ref_frame, bin_len);
+        int frm_len = mb_ascii_set_buf(test_bin, test_frame, bin_len);
+        TEST_ASSERT_EQUAL_INT(ref_len, frm_len);
+        TEST_ASSERT_EQUAL_MEMORY(test_ref_frame, test_frame, frm_len);
+
+        // The decoded frame contains the data and the LRC byte
+        TEST_ASSERT_EQUAL_INT(bin_len + 1, mb_ascii_get_binary_buf(test_frame, frm_len));
+        TEST_ASSERT_EQUAL_MEMORY(test_bin, test_frame, bin_len);
+        TEST_ASSERT_EQUAL_HEX8(mb_lrc(test_bin, bin_len), test_frame[bin_len]);
+
+        // The lower case characters are accepted
+        memcpy(test_frame, test_ref_frame, frm_len);
+        for (int i = 1; i < (frm_len - 2); i++) {
+            if ((test_frame[i] >= 'A') && (test_frame[i] <= 'F')) {
+                test_frame[i] = (uint8_t)(test_frame[i] - 'A' + 'a');
+            }
+        }
+        TEST_ASSERT_EQUAL_INT(bin_len + 1, mb_ascii_get_binary_buf(test_frame, frm_len));
+        TEST_ASSERT_EQUAL_MEMORY(test_bin, test_frame, bin_len);
+    }
+}
+
+TEST(unit_test_ascii_lrc, test_decode_corrupted_frames)
+{
+    srand(0x4C52);
+    for (int frame = 0; frame < TEST_RANDOM_FRAMES; frame++) {
+        int bin_len = 2 + (frame % (TEST_BIN_SIZE_MAX - 1));
+        test_fill_random(test_bin, bin_len);
+        int frm_len = mb_ascii_set_buf(test_bin, test_ref_frame, bin_len);
+
+        // Any character of the frame replaced by the random one
+        int pos = rand() % frm_len;
+        memcpy(test_frame, test_ref_frame, frm_len);
+        test_frame[pos] = (uint8_t)rand();
+        bool is_changed = (test_frame[pos] != test_ref_frame[pos]);
+        memcpy(test_ref_decoded, test_frame, frm_len);
+        int expected = test_ascii_decode_reference(test_ref_decoded, frm_len);
+        int result = mb_ascii_get_binary_buf(test_frame, frm_len);
+        TEST_ASSERT_EQUAL_INT(expected, result);
+        if (is_changed && (result >= 0)) {
+            // Only the change of letter case keeps the frame correct
+            TEST_ASSERT_EQUAL_INT(test_ascii_char_reference(test_ref_frame[pos]),
+                                    test_ascii_char_reference(test_ref_frame[pos] ^ 0x20));
+            TEST_ASSERT_EQUAL_HEX8((test_ref_frame[pos] ^ 0x20), test_frame[pos]);
+        }
+    }
+
+    // The frame without delimiters or with odd number of characters
+    TEST_ASSERT_EQUAL_INT(-1, mb_ascii_get_binary_buf((uint8_t[]){'0', '1', 'F', 'F', '\r', '\n'}, 6));
+    TEST_ASSERT_EQUAL_INT(-1, mb_ascii_get_binary_buf((uint8_t[]){':', '0', '1', 'F', 'F', '\n'}, 6));
+    TEST_ASSERT_EQUAL_INT(-1, mb_ascii_get_binary_buf((uint8_t[]){':', '0', '1', 'F', '\r', '\n'}, 6));
+    TEST_ASSERT_EQUAL_INT(-1, mb_ascii_get_binary_buf((uint8_t[]){':', '\n'}, 2));
+    TEST_ASSERT_EQUAL_INT(2, mb_ascii_get_binary_buf((uint8_t[]){':', '0', '1', 'F', 'F', '\r', '\n'}, 7));
+}
+
+TEST(unit_test_ascii_lrc, test_encode_decode_speed)
+{
+    test_fill_random(test_bin, TEST_BIN_SIZE_MAX);
+    int frm_len = mb_ascii_set_buf(test_bin, test_ref_frame, TEST_BIN_SIZE_MAX);
+
+    int64_t start_ts = esp_timer_get_time();
+    for (int round = 0; round < TEST_BENCH_ROUNDS; round++) {
+        (void)mb_ascii_set_buf(test_bin, test_frame, TEST_BIN_SIZE_MAX);
+        TEST_ASSERT_EQUAL_INT(TEST_BIN_SIZE_MAX + 1, mb_ascii_get_binary_buf(test_frame, frm_len));
+    }
+    int64_t method_us = esp_timer_get_time() - start_ts;
+
+    start_ts = esp_timer_get_time();
+    for (int round = 0; round < TEST_BENCH_ROUNDS; round++) {
+        (void)test_ascii_encode_reference(test_bin, test_frame, TEST_BIN_SIZE_MAX);
+        TEST_ASSERT_EQUAL_INT(TEST_BIN_SIZE_MAX + 1, test_ascii_decode_reference(test_frame, frm_len));
+    }
+    int64_t reference_us = esp_timer_get_time() - start_ts;
+
+    // The time depends on the load and cache of the target, it is logged only
+    ESP_LOGI(TAG, "%d frames of %d bytes encoded and decoded: %lld us (per character reference: %lld us)",
+             TEST_BENCH_ROUNDS, frm_len, (long long)method_us, (long long)reference_us);
+}
+
+TEST_GROUP_RUNNER(unit_test_ascii_lrc)
+{
+    RUN_TEST_CASE(unit_test_ascii_lrc, test_hex_char_conversion);
+    RUN_TEST_CASE(unit_test_ascii_lrc, test_encode_decode_random_frames);
+    RUN_TEST_CASE(unit_test_ascii_lrc, test_decode_corrupted_frames);
+    RUN_TEST_CASE(unit_test_ascii_lrc, test_encode_decode_speed);
+}
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "unity_fixture.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "sdkconfig.h"
+#include "rtu/mbcrc.h"
+
+#define TAG "MB_CRC16_TEST"
+
+#define TEST_FRAME_SIZE_MAX     (256)
+#define TEST_RANDOM_FRAMES      (500)
+#define TEST_BENCH_ROUNDS       (2000)
+
+// The check value of CRC-16/MODBUS for the string "123456789"
+#define TEST_CRC16_CHECK        (0x4B37)
+
+static uint8_t test_frame[TEST_FRAME_SIZE_MAX + 2];
+
+// Bitwise reference calculation, polynomial 0xA001 (reflected 0x8005)
+static uint16_t test_crc16_reference(const uint8_t *data_ptr, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= *(data_ptr++);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static void test_fill_random(uint8_t *data_ptr, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        data_ptr[i] = (uint8_t)rand();
+    }
+}
+
+TEST_GROUP(unit_test_crc16);
+
+TEST_SETUP(unit_test_crc16)
+{
+}
+
+TEST_TEAR_DOWN(unit_test_crc16)
+{
+}
+
+TEST(unit_test_crc16, test_check_value_two_byte_frames)
+{
+    TEST_ASSERT_EQUAL_HEX16(TEST_CRC16_CHECK, mb_crc16((uint8_t *)"123456789", 9));
+    TEST_ASSERT_EQUAL_HEX16(MB_CRC16_INIT, mb_crc16(test_frame, 0));
+
+    // Exhaustive check of the table entries of all slices
+    for (uint32_t value = 0; value <= UINT16_MAX; value++) {
+        test_frame[0] = (uint8_t)(value & 0xFF);
+        test_frame[1] = (uint8_t)(value >> 8);
+        TEST_ASSERT_EQUAL_HEX16(test_crc16_reference(test_frame, 2), mb_crc16(test_frame, 2));
+    }
+}
+
+TEST(unit_test_crc16, test_random_frames_incremental)
+{
+    srand(0x4D42);
+    for (int frame = 0; frame < TEST_RANDOM_FRAMES; frame++) {
+        uint16_t len = (uint16_t)(frame % (TEST_FRAME_SIZE_MAX + 1));
+        test_fill_random(test_frame, len);
+        uint16_t crc = test_crc16_reference(test_frame, len);
+        TEST_ASSERT_EQUAL_HEX16(crc, mb_crc16(test_frame, len));
+
+        // The frame fed in two parts at every split point, as the bytes arrive from UART
+        for (uint16_t split = 0; split <= len; split++) {
+            uint16_t part = mb_crc16_update(MB_CRC16_INIT, test_frame, split);
+            TEST_ASSERT_EQUAL_HEX16(crc, mb_crc16_update(part, &test_frame[split], len - split));
+        }
+
+        // The unaligned start of the frame
+        if (len > 1) {
+            TEST_ASSERT_EQUAL_HEX16(test_crc16_reference(&test_frame[1], len - 1), mb_crc16(&test_frame[1], len - 1));
+        }
+
+        // The frame with appended CRC field gives zero
+        test_frame[len] = (uint8_t)(crc & 0xFF);
+        test_frame[len + 1] = (uint8_t)(crc >> 8);
+        TEST_ASSERT_EQUAL_HEX16(0, mb_crc16(test_frame, len + 2));
+    }
+}
+
+TEST(unit_test_crc16, test_calculation_speed)
+{
+    volatile uint16_t crc = 0;
+    test_fill_random(test_frame, TEST_FRAME_SIZE_MAX);
+    TEST_ASSERT_EQUAL_HEX16(test_crc16_reference(test_frame, TEST_FRAME_SIZE_MAX),
+                            mb_crc16(test_frame, TEST_FRAME_SIZE_MAX));
+
+    int64_t start_ts = esp_timer_get_time();
+    for (int round = 0; round < TEST_BENCH_ROUNDS; round++) {
+        crc ^= mb_crc16(test_frame, TEST_FRAME_SIZE_MAX);
+    }
+    int64_t method_us = esp_timer_get_time() - start_ts;
+
+    start_ts = esp_timer_get_time();
+    for (int round = 0; round < TEST_BENCH_ROUNDS; round++) {
+        crc ^= test_crc16_reference(test_frame, TEST_FRAME_SIZE_MAX);
+    }
+    int64_t reference_us = esp_timer_get_time() - start_ts;
+
+    // The time depends on the load and cache of the target, it is logged only
+    ESP_LOGI(TAG, "slices = %d, %d frames of %d bytes: %lld us (bitwise reference: %lld us)",
+             CONFIG_FMB_SERIAL_CRC16_SLICES, TEST_BENCH_ROUNDS, TEST_FRAME_SIZE_MAX,
+             (long long)method_us, (long long)reference_us);
+}
+
+TEST_GROUP_RUNNER(unit_test_crc16)
+{
+    RUN_TEST_CASE(unit_test_crc16, test_check_value_two_byte_frames);
+    RUN_TEST_CASE(unit_test_crc16, test_random_frames_incremental);
+    RUN_TEST_CASE(unit_test_crc16, test_calculation_speed);
+}
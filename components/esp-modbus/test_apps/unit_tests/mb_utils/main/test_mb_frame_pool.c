@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "unity_fixture.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+
+#define TAG "MB_FRAME_POOL_TEST"
+
+#define TEST_POOL_SLOTS         (4)
+#define TEST_SLOT_SIZE          (32)
+
+static frame_pool_t *test_pool = NULL;
+static uint8_t *test_bufs[TEST_POOL_SLOTS + 2];
+
+// Checks the difference of the frame buffer counters from the reset in setup
+static void test_check_stats(uint32_t pool_alloc, uint32_t pool_free, uint32_t pool_miss,
+                                uint32_t heap_alloc, uint32_t heap_free)
+{
+    mb_frame_stats_t stats = {0};
+    mb_port_get_frame_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(pool_alloc, stats.pool_alloc_count);
+    TEST_ASSERT_EQUAL_UINT32(pool_free, stats.pool_free_count);
+    TEST_ASSERT_EQUAL_UINT32(pool_miss, stats.pool_miss_count);
+    TEST_ASSERT_EQUAL_UINT32(heap_alloc, stats.heap_alloc_count);
+    TEST_ASSERT_EQUAL_UINT32(heap_free, stats.heap_free_count);
+}
+
+// Takes all slots of the pool, the buffers are distinct and can be written entirely
+static void test_take_all_slots(void)
+{
+    for (int i = 0; i < TEST_POOL_SLOTS; i++) {
+        test_bufs[i] = frame_buf_alloc(test_pool, TEST_SLOT_SIZE);
+        TEST_ASSERT_NOT_NULL(test_bufs[i]);
+        memset(test_bufs[i], (0xA0 + i), TEST_SLOT_SIZE);
+    }
+    for (int i = 0; i < TEST_POOL_SLOTS; i++) {
+        for (int j = 0; j < TEST_SLOT_SIZE; j++) {
+            TEST_ASSERT_EQUAL_HEX8((0xA0 + i), test_bufs[i][j]);
+        }
+    }
+}
+
+TEST_GROUP(unit_test_frame_pool);
+
+TEST_SETUP(unit_test_frame_pool)
+{
+    memset(test_bufs, 0, sizeof(test_bufs));
+    test_pool = frame_pool_create(TEST_POOL_SLOTS, TEST_SLOT_SIZE);
+    TEST_ASSERT_NOT_NULL(test_pool);
+    mb_port_reset_frame_stats();
+}
+
+TEST_TEAR_DOWN(unit_test_frame_pool)
+{
+    if (test_pool) {
+        frame_pool_delete(test_pool);
+        test_pool = NULL;
+    }
+}
+
+TEST(unit_test_frame_pool, test_slab_exhaustion)
+{
+    test_take_all_slots();
+    test_check_stats(TEST_POOL_SLOTS, 0, 0, 0, 0);
+
+    // The exhausted pool and the buffer larger than the slot are served from heap
+    test_bufs[TEST_POOL_SLOTS] = frame_buf_alloc(test_pool, TEST_SLOT_SIZE);
+    TEST_ASSERT_NOT_NULL(test_bufs[TEST_POOL_SLOTS]);
+    test_bufs[TEST_POOL_SLOTS + 1] = frame_buf_alloc(test_pool, (TEST_SLOT_SIZE * 2));
+    TEST_ASSERT_NOT_NULL(test_bufs[TEST_POOL_SLOTS + 1]);
+    memset(test_bufs[TEST_POOL_SLOTS + 1], 0x55, (TEST_SLOT_SIZE * 2));
+    test_check_stats(TEST_POOL_SLOTS, 0, 1, 2, 0);
+    TEST_ASSERT_TRUE(frame_buf_is_pooled(test_pool, test_bufs[TEST_POOL_SLOTS - 1]));
+    TEST_ASSERT_FALSE(frame_buf_is_pooled(test_pool, test_bufs[TEST_POOL_SLOTS]));
+    TEST_ASSERT_FALSE(frame_buf_is_pooled(test_pool, test_bufs[TEST_POOL_SLOTS + 1]));
+    TEST_ASSERT_FALSE(frame_buf_is_pooled(NULL, test_bufs[0]));
+
+    // The returned slot is taken again instead of heap
+    frame_buf_free(test_pool, test_bufs[1]);
+    uint8_t *buf = frame_buf_alloc(test_pool, TEST_SLOT_SIZE);
+    TEST_ASSERT_EQUAL_PTR(test_bufs[1], buf);
+    test_check_stats((TEST_POOL_SLOTS + 1), 1, 1, 2, 0);
+
+    for (int i = 0; i < (TEST_POOL_SLOTS + 2); i++) {
+        frame_buf_free(test_pool, test_bufs[i]);
+    }
+    test_check_stats((TEST_POOL_SLOTS + 1), (TEST_POOL_SLOTS + 1), 1, 2, 2);
+}
+
+TEST(unit_test_frame_pool, test_heap_buffer_free)
+{
+    // The buffer outside of the slab range is returned to heap and does not take the place in the pool
+    uint8_t *heap_buf = frame_buf_alloc(NULL, TEST_SLOT_SIZE);
+    TEST_ASSERT_NOT_NULL(heap_buf);
+    frame_buf_free(test_pool, heap_buf);
+    test_check_stats(0, 0, 0, 1, 1);
+
+    // The pool still has all its slots
+    test_take_all_slots();
+    test_check_stats(TEST_POOL_SLOTS, 0, 0, 1, 1);
+    for (int i = 0; i < TEST_POOL_SLOTS; i++) {
+        frame_buf_free(test_pool, test_bufs[i]);
+    }
+
+    // The NULL buffer is ignored
+    frame_buf_free(test_pool, NULL);
+    test_check_stats(TEST_POOL_SLOTS, TEST_POOL_SLOTS, 0, 1, 1);
+}
+
+TEST(unit_test_frame_pool, test_deferred_destroy)
+{
+    test_bufs[0] = frame_buf_alloc(test_pool, TEST_SLOT_SIZE);
+    test_bufs[1] = frame_buf_alloc(test_pool, TEST_SLOT_SIZE);
+    TEST_ASSERT_NOT_NULL(test_bufs[0]);
+    TEST_ASSERT_NOT_NULL(test_bufs[1]);
+
+    // The pool with the taken slots stays alive after delete, but gives no more slots
+    frame_pool_t *pool = test_pool;
+    test_pool = NULL;
+    frame_pool_delete(pool);
+    test_bufs[2] = frame_buf_alloc(pool, TEST_SLOT_SIZE);
+    TEST_ASSERT_NOT_NULL(test_bufs[2]);
+    test_check_stats(2, 0, 1, 1, 0);
+
+    // The slots are written and returned after delete, the last one releases the pool
+    memset(test_bufs[0], 0xAA, TEST_SLOT_SIZE);
+    frame_buf_free(pool, test_bufs[0]);
+    memset(test_bufs[1], 0x55, TEST_SLOT_SIZE);
+    frame_buf_free(pool, test_bufs[1]);
+    test_check_stats(2, 2, 1, 1, 0);
+
+    // The heap buffer taken from the deleted pool is released by the owner without the pool
+    frame_buf_free(NULL, test_bufs[2]);
+    test_check_stats(2, 2, 1, 1, 1);
+}
+
+TEST_GROUP_RUNNER(unit_test_frame_pool)
+{
+    RUN_TEST_CASE(unit_test_frame_pool, test_slab_exhaustion);
+    RUN_TEST_CASE(unit_test_frame_pool, test_heap_buffer_free);
+    RUN_TEST_CASE(unit_test_frame_pool, test_deferred_destroy);
+}
@@ -0,0 +1,162 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/param.h>
+#include "unity_fixture.h"
+
+#include "sdkconfig.h"
+#include "mbc_master.h"
+
+#define TAG "MB_MASTER_TIMING_TEST"
+
+#define TEST_BASE_TOUT_MS       (2000)
+#define TEST_SLAVE_ADDR         (1)
+#define TEST_NOW_TS             (1000000)
+
+static mb_master_timing_entry_t test_entry;
+
+// Adds the samples to the entry until the response timeout is adapted
+static void test_take_samples(uint32_t rtt_us)
+{
+    for (int i = 0; i < MB_MASTER_TIMING_SAMPLES_MIN; i++) {
+        mbc_master_timing_rtt_update(&test_entry, rtt_us);
+    }
+}
+
+TEST_GROUP(unit_test_master_timing);
+
+TEST_SETUP(unit_test_master_timing)
+{
+    memset(&test_entry, 0, sizeof(test_entry));
+    test_entry.slave_addr = TEST_SLAVE_ADDR;
+}
+
+TEST_TEAR_DOWN(unit_test_master_timing)
+{
+}
+
+TEST(unit_test_master_timing, test_rtt_update)
+{
+    // The first sample sets the smoothed time and the half of it as deviation
+    mbc_master_timing_rtt_update(&test_entry, 8000);
+    TEST_ASSERT_EQUAL_UINT32(8000, test_entry.info.srtt_us);
+    TEST_ASSERT_EQUAL_UINT32(4000, test_entry.info.rttvar_us);
+    TEST_ASSERT_EQUAL_UINT16(1, test_entry.samples);
+
+    // The next samples are added with the gains 1/8 (srtt) and 1/4 (rttvar)
+    mbc_master_timing_rtt_update(&test_entry, 16000);
+    TEST_ASSERT_EQUAL_UINT32(9000, test_entry.info.srtt_us);
+    TEST_ASSERT_EQUAL_UINT32(5000, test_entry.info.rttvar_us);
+    mbc_master_timing_rtt_update(&test_entry, 9000);
+    TEST_ASSERT_EQUAL_UINT32(9000, test_entry.info.srtt_us);
+    TEST_ASSERT_EQUAL_UINT32(3750, test_entry.info.rttvar_us);
+    mbc_master_timing_rtt_update(&test_entry, 1000);
+    TEST_ASSERT_EQUAL_UINT32(8000, test_entry.info.srtt_us);
+    TEST_ASSERT_EQUAL_UINT32(4813, test_entry.info.rttvar_us);
+    TEST_ASSERT_EQUAL_UINT16(4, test_entry.samples);
+
+    // The stable round trip time takes the deviation down
+    for (int i = 0; i < 64; i++) {
+        mbc_master_timing_rtt_update(&test_entry, 8000);
+    }
+    TEST_ASSERT_UINT32_WITHIN(8, 8000, test_entry.info.srtt_us);
+    TEST_ASSERT_LESS_THAN_UINT32(8, test_entry.info.rttvar_us);
+}
+
+TEST(unit_test_master_timing, test_tout_clamp)
+{
+    // The configured timeout is used until the slave has enough samples
+    mbc_master_timing_rtt_update(&test_entry, 9000);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BASE_TOUT_MS, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+#if (MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED)
+    // srtt + 4 * rttvar is rounded up to milliseconds
+    test_entry.samples = MB_MASTER_TIMING_SAMPLES_MIN;
+    test_entry.info.srtt_us = 9000;
+    test_entry.info.rttvar_us = 3750;
+    TEST_ASSERT_EQUAL_UINT32(24, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+
+    // The small deviation is replaced by the margin, the result is limited by the minimum
+    test_entry.info.srtt_us = 1000;
+    test_entry.info.rttvar_us = 100;
+    TEST_ASSERT_EQUAL_UINT32(MB_MASTER_TIMING_TOUT_MIN_MS, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+    test_entry.info.srtt_us = 9500;
+    TEST_ASSERT_EQUAL_UINT32(15, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+
+    // The configured timeout is the upper limit
+    test_take_samples(5000000);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BASE_TOUT_MS, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+#else
+    test_take_samples(9000);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BASE_TOUT_MS, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+#endif
+}
+
+TEST(unit_test_master_timing, test_backoff_recovery)
+{
+    test_take_samples(9000);
+    uint32_t tout_ms = mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS);
+
+    // Each timeout doubles the adapted timeout up to the shift limit
+    mbc_master_timing_fail(&test_entry, TEST_NOW_TS);
+    TEST_ASSERT_EQUAL_UINT16(1, test_entry.rto_shift);
+    TEST_ASSERT_EQUAL_UINT32(MIN((tout_ms << 1), TEST_BASE_TOUT_MS),
+                                mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+    for (int i = 0; i < (MB_MASTER_TIMING_BACKOFF_SHIFT_MAX + 2); i++) {
+        mbc_master_timing_fail(&test_entry, TEST_NOW_TS);
+    }
+    TEST_ASSERT_EQUAL_UINT16(MB_MASTER_TIMING_BACKOFF_SHIFT_MAX, test_entry.rto_shift);
+    TEST_ASSERT_EQUAL_UINT32((MB_MASTER_TIMING_BACKOFF_SHIFT_MAX + 3), test_entry.info.timeouts);
+
+#if (MB_MASTER_ADAPTIVE_TIMEOUT_ENABLED)
+    // The slave is offline after the configured timeouts in a row
+    memset(&test_entry, 0, sizeof(test_entry));
+    test_entry.slave_addr = TEST_SLAVE_ADDR;
+    test_take_samples(9000);
+    for (int i = 0; i < (MB_MASTER_OFFLINE_TIMEOUTS - 1); i++) {
+        mbc_master_timing_fail(&test_entry, TEST_NOW_TS);
+        TEST_ASSERT_FALSE(test_entry.info.is_offline);
+    }
+    mbc_master_timing_fail(&test_entry, TEST_NOW_TS);
+    TEST_ASSERT_TRUE(test_entry.info.is_offline);
+    TEST_ASSERT_EQUAL_UINT32(MB_MASTER_OFFLINE_BACKOFF_MS, test_entry.info.backoff_ms);
+    TEST_ASSERT_EQUAL_UINT64((TEST_NOW_TS + (int64_t)MB_MASTER_OFFLINE_BACKOFF_MS * 1000), test_entry.probe_ts);
+
+    // The probe of the offline slave waits the estimated time without the doubling
+    TEST_ASSERT_EQUAL_UINT32(tout_ms, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+
+    // Each failed probe doubles the probe interval up to the limit
+    uint32_t backoff_ms = MB_MASTER_OFFLINE_BACKOFF_MS;
+    while (backoff_ms < MB_MASTER_OFFLINE_BACKOFF_MAX_MS) {
+        mbc_master_timing_fail(&test_entry, TEST_NOW_TS);
+        backoff_ms = MIN((backoff_ms << 1), MB_MASTER_OFFLINE_BACKOFF_MAX_MS);
+        TEST_ASSERT_EQUAL_UINT32(backoff_ms, test_entry.info.backoff_ms);
+        TEST_ASSERT_EQUAL_UINT64((TEST_NOW_TS + (int64_t)backoff_ms * 1000), test_entry.probe_ts);
+    }
+    mbc_master_timing_fail(&test_entry, TEST_NOW_TS);
+    TEST_ASSERT_EQUAL_UINT32(MB_MASTER_OFFLINE_BACKOFF_MAX_MS, test_entry.info.backoff_ms);
+#endif
+
+    // The response brings the slave online and restores the adapted timeout
+    uint32_t timeouts = test_entry.info.timeouts;
+    mbc_master_timing_alive(&test_entry);
+    TEST_ASSERT_FALSE(test_entry.info.is_offline);
+    TEST_ASSERT_EQUAL_UINT16(0, test_entry.info.fail_count);
+    TEST_ASSERT_EQUAL_UINT32(0, test_entry.info.backoff_ms);
+    TEST_ASSERT_EQUAL_UINT16(0, test_entry.rto_shift);
+    TEST_ASSERT_EQUAL_UINT32(1, test_entry.info.responses);
+    TEST_ASSERT_EQUAL_UINT32(timeouts, test_entry.info.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(tout_ms, mbc_master_timing_get_tout(&test_entry, TEST_BASE_TOUT_MS));
+}
+
+TEST_GROUP_RUNNER(unit_test_master_timing)
+{
+    RUN_TEST_CASE(unit_test_master_timing, test_rtt_update);
+    RUN_TEST_CASE(unit_test_master_timing, test_tout_clamp);
+    RUN_TEST_CASE(unit_test_master_timing, test_backoff_recovery);
+}
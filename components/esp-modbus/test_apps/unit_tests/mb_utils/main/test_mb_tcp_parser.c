@@ -0,0 +1,196 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "unity_fixture.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+#include "port_tcp_driver.h"
+#include "port_tcp_utils.h"
+
+#define TAG "MB_TCP_PARSER_TEST"
+
+#define TEST_QUEUE_SIZE         (4)
+#define TEST_POOL_SLOTS         (TEST_QUEUE_SIZE)
+#define TEST_PDU_SIZE           (5)
+#define TEST_FRAME_SIZE         (MB_TCP_FUNC + TEST_PDU_SIZE)
+#define TEST_FRAMES_MAX         (TEST_QUEUE_SIZE + 2)
+#define TEST_UID                (1)
+
+static mb_node_info_t test_node;
+static uint8_t test_rx_buf[MB_RX_BUFFER_SIZE];
+static uint8_t test_frames[TEST_FRAMES_MAX][TEST_FRAME_SIZE];
+
+// Builds the MBAP frame with the PDU of read holding registers request
+static void test_build_frame(uint8_t *frame_ptr, uint16_t tid, uint8_t uid)
+{
+    frame_ptr[MB_TCP_TID] = (uint8_t)(tid >> 8);
+    frame_ptr[MB_TCP_TID + 1] = (uint8_t)(tid & 0xFF);
+    frame_ptr[MB_TCP_PID] = 0;
+    frame_ptr[MB_TCP_PID + 1] = 0;
+    frame_ptr[MB_TCP_LEN] = 0;
+    frame_ptr[MB_TCP_LEN + 1] = (uint8_t)(TEST_PDU_SIZE + 1);
+    frame_ptr[MB_TCP_UID] = uid;
+    frame_ptr[MB_TCP_FUNC] = 0x03;
+    for (int i = 1; i < TEST_PDU_SIZE; i++) {
+        frame_ptr[MB_TCP_FUNC + i] = (uint8_t)(tid + i);
+    }
+}
+
+// Appends the data to the receive buffer as it is received from socket
+static void test_receive(const uint8_t *data_ptr, uint16_t len)
+{
+    TEST_ASSERT_TRUE((test_node.rx_len + len) <= MB_RX_BUFFER_SIZE);
+    memcpy(&test_node.rx_buf[test_node.rx_len], data_ptr, len);
+    test_node.rx_len += len;
+}
+
+// Checks the next queued frame is equal to the expected one and releases it
+static void test_check_frame(const uint8_t *frame_ptr)
+{
+    frame_entry_t frame_info = {0};
+    TEST_ASSERT_FALSE(queue_is_empty(test_node.rx_queue));
+    TEST_ASSERT_EQUAL_INT(TEST_FRAME_SIZE, queue_pop(test_node.rx_queue, NULL, MB_TCP_BUFF_MAX_SIZE, &frame_info));
+    TEST_ASSERT_EQUAL_HEX16(MB_TCP_MBAP_GET_FIELD(frame_ptr, MB_TCP_TID), frame_info.tid);
+    TEST_ASSERT_EQUAL_UINT8(frame_ptr[MB_TCP_UID], frame_info.uid);
+    TEST_ASSERT_EQUAL_MEMORY(frame_ptr, frame_info.buf, TEST_FRAME_SIZE);
+    frame_buf_free(frame_info.pool, frame_info.buf);
+}
+
+TEST_GROUP(unit_test_tcp_parser);
+
+TEST_SETUP(unit_test_tcp_parser)
+{
+    memset(&test_node, 0, sizeof(test_node));
+    test_node.sock_id = UNDEF_FD;
+    test_node.addr_info.ip_addr_str = "test";
+    test_node.rx_buf = test_rx_buf;
+    test_node.rx_queue = queue_create(TEST_QUEUE_SIZE);
+    test_node.frame_pool = frame_pool_create(TEST_POOL_SLOTS, MB_TCP_BUFF_MAX_SIZE);
+    TEST_ASSERT_NOT_NULL(test_node.rx_queue);
+    TEST_ASSERT_NOT_NULL(test_node.frame_pool);
+    for (int i = 0; i < TEST_FRAMES_MAX; i++) {
+        test_build_frame(test_frames[i], (uint16_t)(0x0100 + i), TEST_UID);
+    }
+}
+
+TEST_TEAR_DOWN(unit_test_tcp_parser)
+{
+    TEST_ASSERT_TRUE(queue_is_empty(test_node.rx_queue));
+    queue_delete(test_node.rx_queue);
+    frame_pool_delete(test_node.frame_pool);
+}
+
+TEST(unit_test_tcp_parser, test_multi_frame_buffer)
+{
+    for (int i = 0; i < TEST_QUEUE_SIZE; i++) {
+        test_receive(test_frames[i], TEST_FRAME_SIZE);
+    }
+    TEST_ASSERT_EQUAL_INT(TEST_QUEUE_SIZE, port_parse_packets(&test_node));
+    TEST_ASSERT_EQUAL_INT(0, test_node.rx_len);
+    TEST_ASSERT_FALSE(test_node.rx_pending);
+    for (int i = 0; i < TEST_QUEUE_SIZE; i++) {
+        test_check_frame(test_frames[i]);
+    }
+}
+
+TEST(unit_test_tcp_parser, test_split_frame)
+{
+    // The frame is received in two parts, split at every position
+    for (uint16_t split = 1; split < TEST_FRAME_SIZE; split++) {
+        test_receive(test_frames[0], split);
+        TEST_ASSERT_EQUAL_INT(ERR_TIMEOUT, port_parse_packets(&test_node));
+        TEST_ASSERT_EQUAL_INT(split, test_node.rx_len);
+        TEST_ASSERT_TRUE(queue_is_empty(test_node.rx_queue));
+        test_receive(&test_frames[0][split], (TEST_FRAME_SIZE - split));
+        TEST_ASSERT_EQUAL_INT(1, port_parse_packets(&test_node));
+        TEST_ASSERT_EQUAL_INT(0, test_node.rx_len);
+        test_check_frame(test_frames[0]);
+    }
+}
+
+TEST(unit_test_tcp_parser, test_partial_frame_tail)
+{
+    // Two complete frames and the beginning of the third one
+    const uint16_t part = (MB_TCP_FUNC + 2);
+    test_receive(test_frames[0], TEST_FRAME_SIZE);
+    test_receive(test_frames[1], TEST_FRAME_SIZE);
+    test_receive(test_frames[2], part);
+    TEST_ASSERT_EQUAL_INT(2, port_parse_packets(&test_node));
+    TEST_ASSERT_EQUAL_INT(part, test_node.rx_len);
+    TEST_ASSERT_EQUAL_MEMORY(test_frames[2], test_node.rx_buf, part);
+    test_check_frame(test_frames[0]);
+    test_check_frame(test_frames[1]);
+
+    // The rest of the third frame together with the next frame
+    test_receive(&test_frames[2][part], (TEST_FRAME_SIZE - part));
+    test_receive(test_frames[3], TEST_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_INT(2, port_parse_packets(&test_node));
+    TEST_ASSERT_EQUAL_INT(0, test_node.rx_len);
+    test_check_frame(test_frames[2]);
+    test_check_frame(test_frames[3]);
+}
+
+TEST(unit_test_tcp_parser, test_queue_full)
+{
+    // More frames than the queue can hold, the rest is kept in the buffer without blocking
+    for (int i = 0; i < TEST_FRAMES_MAX; i++) {
+        test_receive(test_frames[i], TEST_FRAME_SIZE);
+    }
+    TEST_ASSERT_EQUAL_INT(TEST_QUEUE_SIZE, port_parse_packets(&test_node));
+    TEST_ASSERT_TRUE(test_node.rx_pending);
+    TEST_ASSERT_EQUAL_INT(((TEST_FRAMES_MAX - TEST_QUEUE_SIZE) * TEST_FRAME_SIZE), test_node.rx_len);
+    TEST_ASSERT_EQUAL_INT(ERR_TIMEOUT, port_parse_packets(&test_node));
+    TEST_ASSERT_TRUE(test_node.rx_pending);
+
+    // The kept frames are queued in order when the queue has free space
+    test_check_frame(test_frames[0]);
+    test_check_frame(test_frames[1]);
+    TEST_ASSERT_EQUAL_INT((TEST_FRAMES_MAX - TEST_QUEUE_SIZE), port_parse_packets(&test_node));
+    TEST_ASSERT_FALSE(test_node.rx_pending);
+    TEST_ASSERT_EQUAL_INT(0, test_node.rx_len);
+    for (int i = 2; i < TEST_FRAMES_MAX; i++) {
+        test_check_frame(test_frames[i]);
+    }
+}
+
+TEST(unit_test_tcp_parser, test_incorrect_frames)
+{
+    // The frame with wrong UID is dropped, the next frame is queued
+    test_build_frame(test_frames[1], 0x0101, (MB_ADDRESS_MAX + 1));
+    test_receive(test_frames[1], TEST_FRAME_SIZE);
+    test_receive(test_frames[2], TEST_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_INT(1, port_parse_packets(&test_node));
+    TEST_ASSERT_EQUAL_INT(0, test_node.rx_len);
+    test_check_frame(test_frames[2]);
+
+    // The stream with wrong protocol ID can not be synchronized, all data is dropped
+    test_frames[3][MB_TCP_PID + 1] = 1;
+    test_receive(test_frames[3], TEST_FRAME_SIZE);
+    test_receive(test_frames[4], TEST_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_INT(ERR_BUF, port_parse_packets(&test_node));
+    TEST_ASSERT_EQUAL_INT(0, test_node.rx_len);
+
+    // The length of only unit ID without the function code is rejected the same way
+    test_frames[5][MB_TCP_LEN + 1] = 1;
+    test_receive(test_frames[5], (MB_TCP_UID + 1));
+    test_receive(test_frames[0], TEST_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_INT(ERR_BUF, port_parse_packets(&test_node));
+    TEST_ASSERT_EQUAL_INT(0, test_node.rx_len);
+    TEST_ASSERT_TRUE(queue_is_empty(test_node.rx_queue));
+}
+
+TEST_GROUP_RUNNER(unit_test_tcp_parser)
+{
+    RUN_TEST_CASE(unit_test_tcp_parser, test_multi_frame_buffer);
+    RUN_TEST_CASE(unit_test_tcp_parser, test_split_frame);
+    RUN_TEST_CASE(unit_test_tcp_parser, test_partial_frame_tail);
+    RUN_TEST_CASE(unit_test_tcp_parser, test_queue_full);
+    RUN_TEST_CASE(unit_test_tcp_parser, test_incorrect_frames);
+}
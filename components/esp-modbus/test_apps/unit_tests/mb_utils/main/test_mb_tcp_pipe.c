@@ -0,0 +1,189 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "unity_fixture.h"
+
+#include "sdkconfig.h"
+#include "port_common.h"
+#include "port_tcp_common.h"
+#include "port_tcp_pipe.h"
+
+#define TAG "MB_TCP_PIPE_TEST"
+
+#define TEST_WINDOW             (4)
+#define TEST_UID                (1)
+#define TEST_FUNC               (0x03)
+#define TEST_TID_BASE           (0x0100)
+#define TEST_RSP_PDU_SIZE       (7)
+#define TEST_FRAME_SIZE         (MB_TCP_FUNC + TEST_RSP_PDU_SIZE)
+
+static mbm_tcp_pipe_t test_pipe;
+static mbm_tcp_waiter_t test_waiters[TEST_WINDOW];
+static uint8_t test_rsp_bufs[TEST_WINDOW][TEST_RSP_PDU_SIZE];
+static uint16_t test_rsp_lens[TEST_WINDOW];
+
+// Builds the MBAP frame with the read holding registers PDU
+static void test_build_frame(uint8_t *frame_ptr, uint16_t tid, uint8_t uid, uint8_t func, uint16_t pdu_len)
+{
+    MB_TCP_MBAP_SET_FIELD(frame_ptr, MB_TCP_TID, tid);
+    MB_TCP_MBAP_SET_FIELD(frame_ptr, MB_TCP_PID, MB_TCP_PROTOCOL_ID);
+    MB_TCP_MBAP_SET_FIELD(frame_ptr, MB_TCP_LEN, (pdu_len + 1));
+    frame_ptr[MB_TCP_UID] = uid;
+    frame_ptr[MB_TCP_FUNC] = func;
+    for (int i = 1; i < pdu_len; i++) {
+        frame_ptr[MB_TCP_FUNC + i] = (uint8_t)(tid + i);
+    }
+}
+
+// Takes the place in the window and registers the request with TID
+static void test_send_request(int index, uint16_t tid)
+{
+    mbm_tcp_waiter_t *waiter = &test_waiters[index];
+    waiter->rsp_buf = test_rsp_bufs[index];
+    waiter->rsp_size = TEST_RSP_PDU_SIZE;
+    waiter->rsp_len = &test_rsp_lens[index];
+    TEST_ASSERT_EQUAL_INT(MB_ENOERR, mbm_tcp_pipe_begin(&test_pipe, waiter, 0));
+    uint8_t *frame_ptr = frame_buf_alloc(NULL, (MB_TCP_FUNC + 5));
+    TEST_ASSERT_NOT_NULL(frame_ptr);
+    test_build_frame(frame_ptr, tid, TEST_UID, TEST_FUNC, 5);
+    transaction_message_t msg = {
+        .buffer = frame_ptr,
+        .len = (MB_TCP_FUNC + 5),
+        .msg_id = tid,
+        .node_id = 0,
+        .pool = NULL
+    };
+    TEST_ASSERT_EQUAL_INT(MB_ENOERR, mbm_tcp_pipe_add(&test_pipe, waiter, &msg));
+    TEST_ASSERT_TRUE(mbm_tcp_pipe_is_pending(&test_pipe, tid));
+    mbm_tcp_pipe_set_sent(&test_pipe, tid);
+}
+
+TEST_GROUP(unit_test_tcp_pipe);
+
+TEST_SETUP(unit_test_tcp_pipe)
+{
+    memset(&test_pipe, 0, sizeof(test_pipe));
+    memset(test_waiters, 0, sizeof(test_waiters));
+    memset(test_rsp_bufs, 0, sizeof(test_rsp_bufs));
+    TEST_ESP_OK(mbm_tcp_pipe_init(&test_pipe, TEST_WINDOW));
+}
+
+TEST_TEAR_DOWN(unit_test_tcp_pipe)
+{
+    mbm_tcp_pipe_deinit(&test_pipe);
+}
+
+TEST(unit_test_tcp_pipe, test_out_of_order_responses)
+{
+    uint8_t frames[TEST_WINDOW][TEST_FRAME_SIZE];
+    for (int i = 0; i < TEST_WINDOW; i++) {
+        test_send_request(i, (TEST_TID_BASE + i));
+        test_build_frame(frames[i], (TEST_TID_BASE + i), TEST_UID, TEST_FUNC, TEST_RSP_PDU_SIZE);
+    }
+    // The responses are matched by TID regardless of their order
+    const int order[TEST_WINDOW] = {2, 0, 3, 1};
+    for (int i = 0; i < TEST_WINDOW; i++) {
+        int index = order[i];
+        TEST_ASSERT_TRUE(mbm_tcp_pipe_complete(&test_pipe, (TEST_TID_BASE + index), frames[index], TEST_FRAME_SIZE, MB_ENOERR));
+        // The completed request does not accept the repeated response
+        TEST_ASSERT_FALSE(mbm_tcp_pipe_complete(&test_pipe, (TEST_TID_BASE + index), frames[index], TEST_FRAME_SIZE, MB_ENOERR));
+    }
+    for (int i = 0; i < TEST_WINDOW; i++) {
+        TEST_ASSERT_EQUAL_INT(MB_ENOERR, mbm_tcp_pipe_end(&test_pipe, &test_waiters[i], 0));
+        TEST_ASSERT_EQUAL_UINT16(TEST_RSP_PDU_SIZE, test_rsp_lens[i]);
+        TEST_ASSERT_EQUAL_MEMORY(&frames[i][MB_TCP_FUNC], test_rsp_bufs[i], TEST_RSP_PDU_SIZE);
+        TEST_ASSERT_FALSE(mbm_tcp_pipe_is_pending(&test_pipe, (TEST_TID_BASE + i)));
+    }
+}
+
+TEST(unit_test_tcp_pipe, test_late_response_drop)
+{
+    uint8_t frame[TEST_FRAME_SIZE];
+    test_send_request(0, TEST_TID_BASE);
+    test_build_frame(frame, TEST_TID_BASE, TEST_UID, TEST_FUNC, TEST_RSP_PDU_SIZE);
+    // The response is not received during the wait, then it is dropped
+    TEST_ASSERT_EQUAL_INT(MB_ETIMEDOUT, mbm_tcp_pipe_end(&test_pipe, &test_waiters[0], 0));
+    TEST_ASSERT_FALSE(mbm_tcp_pipe_is_pending(&test_pipe, TEST_TID_BASE));
+    TEST_ASSERT_FALSE(mbm_tcp_pipe_complete(&test_pipe, TEST_TID_BASE, frame, TEST_FRAME_SIZE, MB_ENOERR));
+    TEST_ASSERT_EQUAL_UINT16(0, test_rsp_lens[0]);
+
+    // The unknown TID is not matched
+    test_send_request(1, (TEST_TID_BASE + 1));
+    TEST_ASSERT_FALSE(mbm_tcp_pipe_complete(&test_pipe, (TEST_TID_BASE + 2), frame, TEST_FRAME_SIZE, MB_ENOERR));
+    TEST_ASSERT_EQUAL_INT(MB_ETIMEDOUT, mbm_tcp_pipe_end(&test_pipe, &test_waiters[1], 0));
+}
+
+TEST(unit_test_tcp_pipe, test_window_exhaustion)
+{
+    for (int i = 0; i < TEST_WINDOW; i++) {
+        test_send_request(i, (TEST_TID_BASE + i));
+    }
+    // No place in the window, the caller gets the busy error (returned as ESP_ERR_NOT_FINISHED)
+    mbm_tcp_waiter_t waiter = {
+        .rsp_buf = test_rsp_bufs[0],
+        .rsp_size = TEST_RSP_PDU_SIZE,
+        .rsp_len = &test_rsp_lens[0]
+    };
+    TEST_ASSERT_EQUAL_INT(MB_EBUSY, mbm_tcp_pipe_begin(&test_pipe, &waiter, 0));
+
+    // The place is released with the end of waiting and the bit of waiter is reused
+    EventBits_t done_bit = test_waiters[1].done_bit;
+    TEST_ASSERT_TRUE(mbm_tcp_pipe_complete(&test_pipe, (TEST_TID_BASE + 1), NULL, 0, MB_EIO));
+    TEST_ASSERT_EQUAL_INT(MB_EIO, mbm_tcp_pipe_end(&test_pipe, &test_waiters[1], 0));
+    TEST_ASSERT_EQUAL_INT(MB_ENOERR, mbm_tcp_pipe_begin(&test_pipe, &waiter, 0));
+    TEST_ASSERT_EQUAL_HEX32(done_bit, waiter.done_bit);
+    TEST_ASSERT_EQUAL_INT(MB_ENORES, mbm_tcp_pipe_end(&test_pipe, &waiter, 0));
+    for (int i = 0; i < TEST_WINDOW; i++) {
+        if (i != 1) {
+            TEST_ASSERT_EQUAL_INT(MB_ETIMEDOUT, mbm_tcp_pipe_end(&test_pipe, &test_waiters[i], 0));
+        }
+    }
+    TEST_ASSERT_EQUAL_HEX32(0, test_pipe.slot_mask);
+}
+
+TEST(unit_test_tcp_pipe, test_response_check)
+{
+    uint8_t frame[TEST_FRAME_SIZE + 1];
+
+    // The response from other unit is rejected
+    test_send_request(0, TEST_TID_BASE);
+    test_build_frame(frame, TEST_TID_BASE, (TEST_UID + 1), TEST_FUNC, TEST_RSP_PDU_SIZE);
+    TEST_ASSERT_TRUE(mbm_tcp_pipe_complete(&test_pipe, TEST_TID_BASE, frame, TEST_FRAME_SIZE, MB_ENOERR));
+    TEST_ASSERT_EQUAL_INT(MB_ERECVDATA, mbm_tcp_pipe_end(&test_pipe, &test_waiters[0], 0));
+    TEST_ASSERT_EQUAL_UINT16(0, test_rsp_lens[0]);
+
+    // The response with other function is rejected
+    test_send_request(0, TEST_TID_BASE);
+    test_build_frame(frame, TEST_TID_BASE, TEST_UID, (TEST_FUNC + 1), TEST_RSP_PDU_SIZE);
+    TEST_ASSERT_TRUE(mbm_tcp_pipe_complete(&test_pipe, TEST_TID_BASE, frame, TEST_FRAME_SIZE, MB_ENOERR));
+    TEST_ASSERT_EQUAL_INT(MB_ERECVDATA, mbm_tcp_pipe_end(&test_pipe, &test_waiters[0], 0));
+
+    // The exception of the requested function is the valid response
+    test_send_request(0, TEST_TID_BASE);
+    test_build_frame(frame, TEST_TID_BASE, TEST_UID, (TEST_FUNC | MB_FUNC_ERROR), 2);
+    TEST_ASSERT_TRUE(mbm_tcp_pipe_complete(&test_pipe, TEST_TID_BASE, frame, (MB_TCP_FUNC + 2), MB_ENOERR));
+    TEST_ASSERT_EQUAL_INT(MB_ENOERR, mbm_tcp_pipe_end(&test_pipe, &test_waiters[0], 0));
+    TEST_ASSERT_EQUAL_UINT16(2, test_rsp_lens[0]);
+    TEST_ASSERT_EQUAL_HEX8((TEST_FUNC | MB_FUNC_ERROR), test_rsp_bufs[0][0]);
+
+    // The response which does not fit the buffer of the caller
+    test_send_request(0, TEST_TID_BASE);
+    test_build_frame(frame, TEST_TID_BASE, TEST_UID, TEST_FUNC, (TEST_RSP_PDU_SIZE + 1));
+    TEST_ASSERT_TRUE(mbm_tcp_pipe_complete(&test_pipe, TEST_TID_BASE, frame, (TEST_FRAME_SIZE + 1), MB_ENOERR));
+    TEST_ASSERT_EQUAL_INT(MB_EILLFUNC, mbm_tcp_pipe_end(&test_pipe, &test_waiters[0], 0));
+    TEST_ASSERT_EQUAL_UINT16(0, test_rsp_lens[0]);
+}
+
+TEST_GROUP_RUNNER(unit_test_tcp_pipe)
+{
+    RUN_TEST_CASE(unit_test_tcp_pipe, test_out_of_order_responses);
+    RUN_TEST_CASE(unit_test_tcp_pipe, test_late_response_drop);
+    RUN_TEST_CASE(unit_test_tcp_pipe, test_window_exhaustion);
+    RUN_TEST_CASE(unit_test_tcp_pipe, test_response_check);
+}
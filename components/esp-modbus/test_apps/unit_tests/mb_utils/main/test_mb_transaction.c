@@ -0,0 +1,302 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "unity_fixture.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sys/queue.h"
+
+#include "sdkconfig.h"
+#include "mb_transaction.h"
+
+#define TAG "MB_TRANSACTION_TEST"
+
+#define TEST_FRAME_SIZE         (12)
+#define TEST_CYCLES             (10000)
+#define TEST_WINDOW             (256)
+#define TEST_ITEMS_MAX          (TEST_WINDOW + 128)
+#define TEST_TICK_STEP          (100)
+#define TEST_LOST_PERIOD        (16)
+#define TEST_EXPIRE_PERIOD      (64)
+#define TEST_EXPIRE_TIMEOUT     (TEST_EXPIRE_PERIOD * TEST_TICK_STEP * 16)
+
+// Reference of the transaction list with the linear scan and the item allocated per request
+typedef struct test_ref_item_s {
+    uint8_t *buffer;
+    frame_pool_t *pool;
+    uint16_t msg_id;
+    transaction_tick_t tick;
+    STAILQ_ENTRY(test_ref_item_s) next;
+} test_ref_item_t;
+
+STAILQ_HEAD(test_ref_list_s, test_ref_item_s);
+
+static struct test_ref_list_s test_ref_list = STAILQ_HEAD_INITIALIZER(test_ref_list);
+
+static bool test_ref_enqueue(uint8_t *buffer, frame_pool_t *pool, uint16_t msg_id, transaction_tick_t tick)
+{
+    test_ref_item_t *item = calloc(1, sizeof(test_ref_item_t));
+    if (!item) {
+        return false;
+    }
+    item->buffer = buffer;
+    item->pool = pool;
+    item->msg_id = msg_id;
+    item->tick = tick;
+    STAILQ_INSERT_TAIL(&test_ref_list, item, next);
+    return true;
+}
+
+static bool test_ref_match(uint16_t msg_id)
+{
+    test_ref_item_t *item;
+    STAILQ_FOREACH(item, &test_ref_list, next) {
+        if (item->msg_id == msg_id) {
+            STAILQ_REMOVE(&test_ref_list, item, test_ref_item_s, next);
+            frame_buf_free(item->pool, item->buffer);
+            free(item);
+            return true;
+        }
+    }
+    return false;
+}
+
+static int test_ref_expire(transaction_tick_t current_tick, transaction_tick_t timeout)
+{
+    int deleted_items = 0;
+    test_ref_item_t *item, *tmp;
+    STAILQ_FOREACH_SAFE(item, &test_ref_list, next, tmp) {
+        if (current_tick - item->tick > timeout) {
+            STAILQ_REMOVE(&test_ref_list, item, test_ref_item_s, next);
+            frame_buf_free(item->pool, item->buffer);
+            free(item);
+            deleted_items++;
+        }
+    }
+    return deleted_items;
+}
+
+static uint8_t *test_alloc_frame(frame_pool_t *pool)
+{
+    uint8_t *buffer = frame_buf_alloc(pool, TEST_FRAME_SIZE);
+    TEST_ASSERT_NOT_NULL(buffer);
+    return buffer;
+}
+
+static transaction_item_handle_t test_enqueue(transaction_handle_t transaction, uint16_t msg_id, int node_id, transaction_tick_t tick)
+{
+    transaction_message_t msg = {
+        .buffer = test_alloc_frame(NULL),
+        .len = TEST_FRAME_SIZE,
+        .msg_id = msg_id,
+        .node_id = node_id,
+        .pnode = NULL,
+        .pool = NULL
+    };
+    transaction_item_handle_t item = transaction_enqueue(transaction, &msg, tick);
+    if (!item) {
+        frame_buf_free(NULL, msg.buffer);
+    }
+    return item;
+}
+
+TEST_GROUP(unit_test_transaction);
+
+TEST_SETUP(unit_test_transaction)
+{
+}
+
+TEST_TEAR_DOWN(unit_test_transaction)
+{
+}
+
+TEST(unit_test_transaction, test_lookup_duplicated_out_of_order)
+{
+    transaction_handle_t transaction = transaction_create(8);
+    TEST_ASSERT_NOT_NULL(transaction);
+
+    transaction_item_handle_t first = test_enqueue(transaction, 0x0105, 0, 1000);
+    transaction_item_handle_t second = test_enqueue(transaction, 0x0107, 1, 1000);
+    transaction_item_handle_t third = test_enqueue(transaction, 0x0105, 2, 1000);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_NOT_NULL(third);
+    TEST_ASSERT_EQUAL_UINT64(3 * TEST_FRAME_SIZE, transaction_get_size(transaction));
+
+    // The oldest item with the message ID is returned first
+    TEST_ASSERT_EQUAL_PTR(first, transaction_get(transaction, 0x0105));
+    TEST_ASSERT_EQUAL_PTR(second, transaction_get(transaction, 0x0107));
+    TEST_ASSERT_NULL(transaction_get(transaction, 0x0106));
+    TEST_ASSERT_EQUAL(ESP_OK, transaction_delete(transaction, 0x0105));
+    TEST_ASSERT_EQUAL_PTR(third, transaction_get(transaction, 0x0105));
+    TEST_ASSERT_EQUAL_PTR(second, transaction_get_first(transaction));
+
+    // The state and the tick are changed by message ID
+    TEST_ASSERT_EQUAL(ESP_OK, transaction_set_state(transaction, 0x0105, ACKNOWLEDGED));
+    TEST_ASSERT_EQUAL_PTR(third, transaction_dequeue(transaction, ACKNOWLEDGED, NULL));
+    TEST_ASSERT_EQUAL(ESP_FAIL, transaction_set_state(transaction, 0x0106, ACKNOWLEDGED));
+
+    // The pool is exhausted, the item is returned to the pool after delete
+    for (uint16_t msg_id = 0x0200; msg_id < 0x0206; msg_id++) {
+        TEST_ASSERT_NOT_NULL(test_enqueue(transaction, msg_id, 3, 1000));
+    }
+    TEST_ASSERT_TRUE(transaction_is_full(transaction));
+    TEST_ASSERT_NULL(test_enqueue(transaction, 0x0300, 3, 1000));
+    TEST_ASSERT_EQUAL(ESP_FAIL, transaction_delete_item(transaction, second, 0x0107, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, transaction_delete_item(transaction, second, 0x0107, 1));
+    TEST_ASSERT_EQUAL(ESP_FAIL, transaction_delete_item(transaction, second, 0x0107, 1));
+    TEST_ASSERT_FALSE(transaction_is_full(transaction));
+
+    // The stale handle of the reused item does not delete the new message
+    TEST_ASSERT_EQUAL_PTR(second, test_enqueue(transaction, 0x0300, 3, 1000));
+    TEST_ASSERT_EQUAL(ESP_FAIL, transaction_delete_item(transaction, second, 0x0107, 1));
+    TEST_ASSERT_EQUAL_PTR(second, transaction_get(transaction, 0x0300));
+
+    // All items of the node are deleted, other ones are kept in the enqueue order
+    TEST_ASSERT_EQUAL_INT(7, transaction_delete_by_node_id(transaction, 3));
+    TEST_ASSERT_EQUAL_PTR(third, transaction_get_first(transaction));
+    for (uint16_t msg_id = 0x0200; msg_id < 0x0206; msg_id++) {
+        TEST_ASSERT_NULL(transaction_get(transaction, msg_id));
+    }
+    TEST_ASSERT_EQUAL_UINT64(TEST_FRAME_SIZE, transaction_get_size(transaction));
+    transaction_destroy(transaction);
+}
+
+TEST(unit_test_transaction, test_expiry_wheel_turns)
+{
+    const transaction_tick_t slot_ticks = (1ULL << TRANSACTION_WHEEL_SHIFT);
+    const transaction_tick_t turn_ticks = TRANSACTION_WHEEL_SLOTS * slot_ticks;
+    const transaction_tick_t item_ticks = (3 * turn_ticks / TRANSACTION_ITEMS_DEFAULT);
+    const transaction_tick_t start_tick = 10 * turn_ticks;
+    const transaction_tick_t timeout = 2 * turn_ticks;
+    transaction_handle_t transaction = transaction_create(TRANSACTION_ITEMS_DEFAULT);
+    TEST_ASSERT_NOT_NULL(transaction);
+
+    // The items are spread over three turns of the wheel, the timeout is longer than one turn
+    for (uint16_t i = 0; i < TRANSACTION_ITEMS_DEFAULT; i++) {
+        TEST_ASSERT_NOT_NULL(test_enqueue(transaction, i, 0, start_tick + (i * item_ticks)));
+    }
+    int expected = 0;
+    int deleted = 0;
+    for (transaction_tick_t current = start_tick + 3 * turn_ticks; current <= start_tick + 6 * turn_ticks; current += 5 * slot_ticks) {
+        while ((expected < TRANSACTION_ITEMS_DEFAULT) && ((current - (start_tick + (expected * item_ticks))) > timeout)) {
+            expected++;
+        }
+        deleted += transaction_delete_expired(transaction, current, timeout);
+        TEST_ASSERT_EQUAL_INT(expected, deleted);
+        if (expected < TRANSACTION_ITEMS_DEFAULT) {
+            TEST_ASSERT_EQUAL_UINT16(expected, transaction_item_get_id(transaction_get_first(transaction)));
+        }
+    }
+    TEST_ASSERT_NULL(transaction_get_first(transaction));
+
+    // The tick moved back is expired by the next call
+    transaction_tick_t current = start_tick + 8 * TRANSACTION_WHEEL_SLOTS * slot_ticks;
+    TEST_ASSERT_NOT_NULL(test_enqueue(transaction, 0x0A01, 0, current));
+    TEST_ASSERT_NOT_NULL(test_enqueue(transaction, 0x0A02, 0, current));
+    TEST_ASSERT_EQUAL_INT(0, transaction_delete_expired(transaction, current, slot_ticks));
+    TEST_ASSERT_EQUAL(ESP_OK, transaction_set_tick(transaction, 0x0A02, start_tick));
+    TEST_ASSERT_EQUAL_UINT16(0x0A02, transaction_delete_single_expired(transaction, current, slot_ticks));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, transaction_delete_single_expired(transaction, current, slot_ticks));
+    TEST_ASSERT_NOT_NULL(transaction_get(transaction, 0x0A01));
+    transaction_destroy(transaction);
+}
+
+TEST(unit_test_transaction, test_enqueue_match_expire_speed)
+{
+    static uint16_t in_flight[TEST_WINDOW];
+    frame_pool_t *pool = frame_pool_create(TEST_ITEMS_MAX, TEST_FRAME_SIZE);
+    TEST_ASSERT_NOT_NULL(pool);
+    transaction_handle_t transaction = transaction_create(TEST_ITEMS_MAX);
+    TEST_ASSERT_NOT_NULL(transaction);
+
+    // Every request waits until the window is full, then a random one is answered,
+    // some responses are lost and the late responses of the expired requests are dropped
+    srand(0x5449);
+    int in_flight_num = 0;
+    int matched = 0;
+    int expired = 0;
+    transaction_tick_t tick = TEST_EXPIRE_TIMEOUT;
+    int64_t start_ts = esp_timer_get_time();
+    for (int cycle = 0; cycle < TEST_CYCLES; cycle++, tick += TEST_TICK_STEP) {
+        uint16_t msg_id = (uint16_t)cycle;
+        transaction_message_t msg = {
+            .buffer = test_alloc_frame(pool),
+            .len = TEST_FRAME_SIZE,
+            .msg_id = msg_id,
+            .node_id = 0,
+            .pnode = NULL,
+            .pool = pool
+        };
+        TEST_ASSERT_NOT_NULL(transaction_enqueue(transaction, &msg, tick));
+        if (cycle % TEST_LOST_PERIOD) {
+            in_flight[in_flight_num++] = msg_id;
+        }
+        if (in_flight_num == TEST_WINDOW) {
+            int pos = rand() % in_flight_num;
+            transaction_item_handle_t item = transaction_get(transaction, in_flight[pos]);
+            if (item) {
+                TEST_ASSERT_EQUAL_UINT16(in_flight[pos], transaction_item_get_id(item));
+                TEST_ASSERT_EQUAL(ESP_OK, transaction_delete_item(transaction, item, in_flight[pos], 0));
+                matched++;
+            }
+            in_flight[pos] = in_flight[--in_flight_num];
+        }
+        if (!(cycle % TEST_EXPIRE_PERIOD)) {
+            expired += transaction_delete_expired(transaction, tick, TEST_EXPIRE_TIMEOUT);
+        }
+    }
+    int64_t method_us = esp_timer_get_time() - start_ts;
+    int remaining = TEST_CYCLES - matched - expired;
+    transaction_delete_all_items(transaction);
+    TEST_ASSERT_EQUAL_UINT64(0, transaction_get_size(transaction));
+    TEST_ASSERT(matched > 0);
+    TEST_ASSERT(expired > 0);
+
+    srand(0x5449);
+    in_flight_num = 0;
+    int ref_matched = 0;
+    int ref_expired = 0;
+    tick = TEST_EXPIRE_TIMEOUT;
+    start_ts = esp_timer_get_time();
+    for (int cycle = 0; cycle < TEST_CYCLES; cycle++, tick += TEST_TICK_STEP) {
+        uint16_t msg_id = (uint16_t)cycle;
+        TEST_ASSERT_TRUE(test_ref_enqueue(test_alloc_frame(pool), pool, msg_id, tick));
+        if (cycle % TEST_LOST_PERIOD) {
+            in_flight[in_flight_num++] = msg_id;
+        }
+        if (in_flight_num == TEST_WINDOW) {
+            int pos = rand() % in_flight_num;
+            if (test_ref_match(in_flight[pos])) {
+                ref_matched++;
+            }
+            in_flight[pos] = in_flight[--in_flight_num];
+        }
+        if (!(cycle % TEST_EXPIRE_PERIOD)) {
+            ref_expired += test_ref_expire(tick, TEST_EXPIRE_TIMEOUT);
+        }
+    }
+    int64_t reference_us = esp_timer_get_time() - start_ts;
+    (void)test_ref_expire(UINT64_MAX, 0);
+
+    // The time depends on the load and cache of the target, it is logged only
+    ESP_LOGI(TAG, "%d cycles (%d matched, %d expired, %d remaining) with %d requests in flight: %lld us (linear list reference: %lld us)",
+             TEST_CYCLES, matched, expired, remaining, TEST_WINDOW, (long long)method_us, (long long)reference_us);
+    TEST_ASSERT_EQUAL_INT(ref_matched, matched);
+    TEST_ASSERT_EQUAL_INT(ref_expired, expired);
+    transaction_destroy(transaction);
+    frame_pool_delete(pool);
+}
+
+TEST_GROUP_RUNNER(unit_test_transaction)
+{
+    RUN_TEST_CASE(unit_test_transaction, test_lookup_duplicated_out_of_order);
+    RUN_TEST_CASE(unit_test_transaction, test_expiry_wheel_turns);
+    RUN_TEST_CASE(unit_test_transaction, test_enqueue_match_expire_speed);
+}
@@ -0,0 +1,182 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Host side latency benchmark for the Modbus TCP slave.
+# Sends read requests to the slave and reports the request turnaround percentiles.
+# Run it against the firmware before and after a change and compare the saved results:
+#
+#   python mb_tcp_latency.py --host 192.168.1.10 --count 2000 --save before.json
+#   python mb_tcp_latency.py --host 192.168.1.10 --count 2000 --save after.json --compare before.json
+
+import argparse
+import json
+import socket
+import struct
+import sys
+import threading
+import time
+from typing import Dict, List, Optional
+
+MB_DEF_PORT = 502
+MB_DEF_UID = 1
+MB_DEF_FUNC = 0x03
+MB_DEF_START = 0
+MB_DEF_QUANTITY = 1
+MB_DEF_COUNT = 1000
+MB_DEF_WARMUP = 20
+MB_DEF_TOUT = 2.0
+MB_MBAP_LEN = 7
+
+
+def percentile(samples: List[float], pct: float) -> float:
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    idx = int(round((pct / 100.0) * (len(ordered) - 1)))
+    return ordered[idx]
+
+
+def recv_exact(sock: socket.socket, size: int) -> bytes:
+    data = b''
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError('connection closed by slave')
+        data += chunk
+    return data
+
+
+def recv_response(sock: socket.socket) -> bytes:
+    header = recv_exact(sock, MB_MBAP_LEN)
+    length = struct.unpack('>H', header[4:6])[0]
+    return header + recv_exact(sock, length - 1)
+
+
+class LatencyClient:
+    """One TCP connection sending read requests with the configured pipeline depth."""
+
+    def __init__(self, args: argparse.Namespace, index: int) -> None:
+        self.args = args
+        self.index = index
+        self.samples: List[float] = []
+        self.errors = 0
+        self.error_msg: Optional[str] = None
+        self.tid = (index << 12) & 0xFFFF
+
+    def request(self) -> bytes:
+        self.tid = (self.tid + 1) & 0xFFFF
+        pdu = struct.pack('>BHH', self.args.func, self.args.start, self.args.quantity)
+        return struct.pack('>HHHB', self.tid, 0, len(pdu) + 1, self.args.uid) + pdu
+
+    def run(self) -> None:
+        try:
+            with socket.create_connection((self.args.host, self.args.port), timeout=self.args.timeout) as sock:
+                sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                total = self.args.warmup + self.args.count
+                sent = 0
+                while sent < total:
+                    depth = min(self.args.pipeline, total - sent)
+                    frames = [self.request() for _ in range(depth)]
+                    start = time.perf_counter()
+                    sock.sendall(b''.join(frames))
+                    for frame in frames:
+                        resp = recv_response(sock)
+                        if resp[0:2] != frame[0:2] or (resp[7] & 0x80):
+                            self.errors += 1
+                    elapsed_us = (time.perf_counter() - start) * 1e6
+                    if sent >= self.args.warmup:
+                        self.samples.append(elapsed_us)
+                    sent += depth
+                    if self.args.interval:
+                        time.sleep(self.args.interval / 1000.0)
+        except (OSError, ConnectionError) as err:
+            self.error_msg = str(err)
+
+
+def summarize(samples: List[float], errors: int, duration: float) -> Dict[str, float]:
+    return {
+        'samples': len(samples),
+        'errors': errors,
+        'min_us': min(samples) if samples else 0.0,
+        'p50_us': percentile(samples, 50),
+        'p90_us': percentile(samples, 90),
+        'p99_us': percentile(samples, 99),
+        'max_us': max(samples) if samples else 0.0,
+        'rate_per_s': (len(samples) / duration) if duration > 0 else 0.0,
+    }
+
+
+def print_summary(title: str, result: Dict[str, float]) -> None:
+    print('{}: samples={:.0f}, errors={:.0f}, min={:.0f}us, p50={:.0f}us, p90={:.0f}us, p99={:.0f}us, '
+          'max={:.0f}us, rate={:.1f}/s'.format(title, result['samples'], result['errors'], result['min_us'],
+                                               result['p50_us'], result['p90_us'], result['p99_us'],
+                                               result['max_us'], result['rate_per_s']))
+
+
+def print_compare(base: Dict[str, float], result: Dict[str, float]) -> None:
+    for key in ('p50_us', 'p90_us', 'p99_us', 'max_us'):
+        delta = result[key] - base[key]
+        ratio = (100.0 * delta / base[key]) if base[key] else 0.0
+        print('  {}: {:.0f}us -> {:.0f}us ({:+.1f}%)'.format(key, base[key], result[key], ratio))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Modbus TCP slave request turnaround benchmark')
+    parser.add_argument('--host', required=True, help='slave IP address or host name')
+    parser.add_argument('--port', type=int, default=MB_DEF_PORT, help='slave TCP port')
+    parser.add_argument('--uid', type=int, default=MB_DEF_UID, help='unit identifier')
+    parser.add_argument('--func', type=lambda x: int(x, 0), default=MB_DEF_FUNC, help='read function code (1-4)')
+    parser.add_argument('--start', type=int, default=MB_DEF_START, help='start register or bit address')
+    parser.add_argument('--quantity', type=int, default=MB_DEF_QUANTITY, help='number of registers or bits')
+    parser.add_argument('--count', type=int, default=MB_DEF_COUNT, help='measured requests per connection')
+    parser.add_argument('--warmup', type=int, default=MB_DEF_WARMUP, help='not measured requests per connection')
+    parser.add_argument('--connections', type=int, default=1, help='number of concurrent connections')
+    parser.add_argument('--pipeline', type=int, default=1, help='requests sent back to back, the turnaround of whole batch is measured')
+    parser.add_argument('--interval', type=float, default=0.0, help='idle time between requests, ms')
+    parser.add_argument('--timeout', type=float, default=MB_DEF_TOUT, help='socket timeout, s')
+    parser.add_argument('--save', help='save the result into json file')
+    parser.add_argument('--compare', help='compare the result with the saved json file')
+    args = parser.parse_args()
+
+    if args.func not in (0x01, 0x02, 0x03, 0x04) or args.pipeline < 1 or args.connections < 1:
+        parser.error('incorrect function code, pipeline or connections option')
+
+    clients = [LatencyClient(args, i) for i in range(args.connections)]
+    threads = [threading.Thread(target=client.run) for client in clients]
+    start = time.perf_counter()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    duration = time.perf_counter() - start
+
+    samples: List[float] = []
+    errors = 0
+    for client in clients:
+        if client.error_msg:
+            print('connection #{}: {}'.format(client.index, client.error_msg), file=sys.stderr)
+            errors += 1
+        samples.extend(client.samples)
+        errors += client.errors
+
+    result = summarize(samples, errors, duration)
+    print_summary('{}:{}'.format(args.host, args.port), result)
+
+    if args.save:
+        with open(args.save, 'w') as out_file:
+            json.dump({'args': vars(args), 'result': result}, out_file, indent=2)
+
+    if args.compare:
+        with open(args.compare) as base_file:
+            base = json.load(base_file)['result']
+        print_summary('baseline ({})'.format(args.compare), base)
+        print_compare(base, result)
+
+    return 0 if samples and not errors else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
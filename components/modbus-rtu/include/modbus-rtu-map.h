@@ -1,4 +1,34 @@
 #ifndef MODBUS_RTU_MAP_INCLUDE
 #define MODBUS_RTU_MAP_INCLUDE
 
-#endif
\ No newline at end of file
+#include "driver/uart.h"
+
+/* ==============================================
+ *  RS-485 SEGMENT (gateway downstream side)
+ * ============================================== */
+#define MODBUS_RTU_UART_PORT         UART_NUM_2
+#define MODBUS_RTU_PIN_TX            17
+#define MODBUS_RTU_PIN_RX            16
+#define MODBUS_RTU_PIN_RTS           4      // DE/RE của transceiver RS-485
+#define MODBUS_RTU_UNIT_MIN          1
+#define MODBUS_RTU_UNIT_MAX          247
+#define MODBUS_RTU_BUS_MAX           3      // Số segment RS-485 tối đa, mỗi segment một UART và một master
+
+/* ==============================================
+ *  DEFAULTS
+ * ============================================== */
+#define MODBUS_RTU_DEFAULT_BAUDRATE  9600
+#define MODBUS_RTU_DEFAULT_PARITY    UART_PARITY_DISABLE
+#define MODBUS_RTU_RESPONSE_TOUT_MS  500    // Thời gian chờ phản hồi của slave RTU
+#define MODBUS_RTU_LOCK_TOUT_MS      1000   // Thời gian chờ khi gateway đang start/stop
+#define MODBUS_RTU_PDU_SIZE_MAX      253
+
+/* ==============================================
+ *  POLL ENGINE (mirror of the RTU slaves)
+ * ============================================== */
+#define MODBUS_RTU_SCAN_MAX          16     // Số dòng tối đa của bảng scan
+#define MODBUS_RTU_SCAN_PERIOD_MIN_MS 50
+#define MODBUS_RTU_POLL_TASK_STACK   (4096)
+#define MODBUS_RTU_POLL_TASK_PRIO    (5)
+
+#endif /* MODBUS_RTU_MAP_INCLUDE */
@@ -3,24 +3,165 @@
 #ifndef MODBUS_RTU_INCLUDE
 #define MODBUS_RTU_INCLUDE
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
+#include "driver/uart.h"
+#include "esp_modbus_master.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief Start Modbus RTU slave task
+ * @brief Serial settings of the RS-485 segment
+ */
+typedef struct {
+    uint32_t baudrate;          /*!< Baud rate of the segment */
+    uart_parity_t parity;       /*!< Parity of the segment */
+} modbus_rtu_config_t;
+
+/**
+ * @brief RS-485 segment of the gateway, one UART and serial master per segment
+ */
+typedef struct {
+    uart_port_t port;           /*!< UART of the segment */
+    int pin_tx;                 /*!< TX pin */
+    int pin_rx;                 /*!< RX pin */
+    int pin_rts;                /*!< RTS pin, drives DE/RE of the RS-485 transceiver */
+    uint8_t unit_min;           /*!< First unit ID routed to the segment */
+    uint8_t unit_max;           /*!< Last unit ID routed to the segment */
+    uint32_t baudrate;          /*!< Baud rate of the segment, 0 - the settings of modbus_rtu_set_config() are used */
+    uart_parity_t parity;       /*!< Parity of the segment, used when the baud rate is set */
+} modbus_rtu_segment_t;
+
+/**
+ * @brief Gateway counters, TX is the TCP to RTU direction, RX is the RTU to TCP direction
+ */
+typedef struct {
+    uint32_t tx_frames;         /*!< Requests forwarded to the RTU slaves */
+    uint32_t rx_frames;         /*!< Responses returned from the RTU slaves */
+    uint32_t tx_bytes;          /*!< PDU bytes of the forwarded requests */
+    uint32_t rx_bytes;          /*!< PDU bytes of the returned responses */
+    uint32_t errors;            /*!< Requests failed with gateway exception (no response, gateway stopped) */
+    uint32_t last_latency_us;   /*!< Round trip time of the last answered request */
+    uint32_t max_latency_us;    /*!< Maximum round trip time */
+    uint64_t total_latency_us;  /*!< Sum of round trip times of the answered requests */
+} modbus_rtu_stats_t;
+
+/**
+ * @brief Entry of the scan table, the poll engine reads the registers of the RTU slave periodically
+ *        and copies them into the local buffer (register area of the TCP slave)
+ */
+typedef struct {
+    uint8_t unit;               /*!< Address of the RTU slave */
+    mb_param_type_t type;       /*!< Register area of the RTU slave, read with function 03, 04, 01 or 02 */
+    uint16_t reg_start;         /*!< Start register in the RTU slave (0 based) */
+    uint16_t reg_size;          /*!< Number of registers (coils or discrete inputs for the bit areas) */
+    uint32_t period_ms;         /*!< Poll period */
+    void *mirror;               /*!< Local buffer for the values, registers or packed bits (size of the read data) */
+} modbus_rtu_scan_t;
+
+/**
+ * @brief Freshness of the mirrored values of one scan entry
+ */
+typedef struct {
+    int64_t last_update_us;     /*!< Time stamp (esp_timer) of the last successful read, 0 if never read */
+    uint32_t age_ms;            /*!< Age of the mirrored values, UINT32_MAX if never read */
+    uint32_t reads;             /*!< Successful reads */
+    uint32_t errors;            /*!< Failed reads */
+    esp_err_t last_error;       /*!< Result of the last read, ESP_ERR_NOT_FINISHED if never read */
+} modbus_rtu_scan_status_t;
+
+/**
+ * @brief Set serial settings of the RS-485 segments, applied on next modbus_rtu_start()
+ *        to the segments without their own baud rate
+ * @param config Serial settings
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the settings are incorrect
+ */
+esp_err_t modbus_rtu_set_config(const modbus_rtu_config_t *config);
+
+/**
+ * @brief Set the RS-485 segments of the gateway, applied on next modbus_rtu_start()
+ *
+ * The request for the unit is forwarded to the segment with the unit in its range. Each segment has its own
+ * serial master, lock, poll task and counters, so the poll tasks of the segments run concurrently. The forwarded
+ * requests are executed one at a time in the task of the TCP slave, so a slow segment still delays the
+ * requests to the other segments. By default the gateway has one segment
+ * (MODBUS_RTU_UART_PORT) for all units.
+ *
+ * @param segments Segment table, the UARTs and unit ranges must not overlap
+ * @param count Number of segments (up to MODBUS_RTU_BUS_MAX)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the table is incorrect,
+ *         ESP_ERR_INVALID_STATE if the gateway is running
+ */
+esp_err_t modbus_rtu_set_segments(const modbus_rtu_segment_t *segments, uint8_t count);
+
+/**
+ * @brief Start the Modbus TCP to RTU gateway (serial master on each RS-485 segment)
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t modbus_rtu_start(void);
 
 /**
- * @brief Stop Modbus RTU slave task
+ * @brief Stop the Modbus TCP to RTU gateway
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t modbus_rtu_stop(void);
 
+/**
+ * @brief Check if the gateway is started
+ */
+bool modbus_rtu_is_running(void);
+
+/**
+ * @brief Forward handler for the TCP slave (see mbc_slave_set_forward_handler())
+ *
+ * Sends the request PDU to the RTU slave with address uid on its segment and places its response into the frame buffer.
+ * The request shares the bus with the poll task through the scheduler of the segment master.
+ * Returns MB_EX_GATEWAY_TGT_FAILED if the slave does not respond, MB_EX_SLAVE_BUSY if the bus of the segment
+ * is busy (the request queue is full or the bus is not granted in time) and MB_EX_GATEWAY_PATH_FAILED
+ * if the gateway is stopped or the segment is not available.
+ */
+mb_exception_t modbus_rtu_forward(void *arg, uint8_t uid, uint8_t *frame, uint16_t *len);
+
+/**
+ * @brief Set the scan table of the poll engine, applied on next modbus_rtu_start()
+ *
+ * The poll task of the segment of the unit reads each entry with its period through the master data dictionary
+ * and copies the values into the mirror buffer under mbc_slave_lock() of the slave, so the TCP reads of
+ * the mirror are answered from RAM. The table and the mirror buffers must stay valid while the gateway runs.
+ *
+ * @param table Scan table, NULL to disable the poll engine
+ * @param count Number of entries (up to MODBUS_RTU_SCAN_MAX)
+ * @param slave_handle Slave which registered the mirror buffers, used to lock the slave while the values are copied
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the table is incorrect
+ */
+esp_err_t modbus_rtu_set_scan_table(const modbus_rtu_scan_t *table, uint16_t count, void *slave_handle);
+
+/**
+ * @brief Get the freshness of the mirrored values of the scan entry
+ * @param index Index of the entry in the scan table
+ * @param status Pointer to store the status
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the index or pointer is incorrect
+ */
+esp_err_t modbus_rtu_get_scan_status(uint16_t index, modbus_rtu_scan_status_t *status);
+
+/**
+ * @brief Get the gateway counters (all segments)
+ * @param stats Pointer to store the counters
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t modbus_rtu_get_stats(modbus_rtu_stats_t *stats);
+
+/**
+ * @brief Get the counters of one segment
+ * @param index Index of the segment in the segment table
+ * @param stats Pointer to store the counters
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the index or pointer is incorrect
+ */
+esp_err_t modbus_rtu_get_segment_stats(uint8_t index, modbus_rtu_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,22 +1,626 @@
 /**
  * @file modbus-rtu.c
- * @brief Modbus RTU Slave implementation (stub for future implementation)
+ * @brief Modbus TCP to RTU gateway, forwards the TCP requests to the slaves of RS-485 segments
+ *
+ * Each segment has its own UART and serial master (with its port task and request queue), its lock,
+ * poll task and counters, the requests are routed to the segment by the unit ID range. The forwarded requests
+ * are executed one at a time by the TCP slave task, only the poll tasks of the segments run in parallel.
  */
 
-#include "modbus-rtu.h"
+#include <inttypes.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+
+#include "esp_modbus_slave.h"
+
+#include "modbus-rtu.h"
+#include "modbus-rtu-map.h"
 
 static const char *TAG = "MODBUS_RTU";
 
+/**
+ * @brief RS-485 segment of the gateway
+ */
+typedef struct {
+    modbus_rtu_segment_t segment;
+    void *handle;                   // Serial master, the mutex protects it only during start/stop
+    SemaphoreHandle_t lock;
+    uint16_t users;                 // Requests using the handle, the master scheduler shares the bus between them
+    SemaphoreHandle_t idle;         // Given by the last request when the segment is stopping
+    modbus_rtu_stats_t stats;
+    // Poll engine of the segment, the scan entries of its units are converted to the master descriptors
+    mb_parameter_descriptor_t descriptors[MODBUS_RTU_SCAN_MAX];
+    uint16_t scan_index[MODBUS_RTU_SCAN_MAX];   // Index of the scan entry for each cid of the segment
+    uint16_t scan_count;
+    TaskHandle_t poll_task;
+    SemaphoreHandle_t poll_done;
+    volatile bool poll_stop;
+    // Buffer for the read data, the largest request is 125 registers (or 2000 coils)
+    uint8_t poll_buffer[MODBUS_RTU_PDU_SIZE_MAX];
+} modbus_rtu_bus_t;
+
+static modbus_rtu_bus_t rtu_buses[MODBUS_RTU_BUS_MAX] = {
+    [0] = {
+        .segment = {
+            .port = MODBUS_RTU_UART_PORT,
+            .pin_tx = MODBUS_RTU_PIN_TX,
+            .pin_rx = MODBUS_RTU_PIN_RX,
+            .pin_rts = MODBUS_RTU_PIN_RTS,
+            .unit_min = MODBUS_RTU_UNIT_MIN,
+            .unit_max = MODBUS_RTU_UNIT_MAX,
+            .baudrate = 0
+        }
+    }
+};
+static uint8_t rtu_bus_count = 1;
+static modbus_rtu_config_t rtu_config = {
+    .baudrate = MODBUS_RTU_DEFAULT_BAUDRATE,
+    .parity = MODBUS_RTU_DEFAULT_PARITY
+};
+
+// Counters are updated from Modbus TCP task and read by the application
+static modbus_rtu_stats_t rtu_stats = {0};
+static portMUX_TYPE rtu_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// The master controller requires the descriptor table to start, the gateway does not use the characteristics
+static const mb_parameter_descriptor_t rtu_dummy_descriptor[] = {
+    {
+        .cid = 0,
+        .param_key = "rtu_gateway",
+        .param_units = "",
+        .mb_slave_addr = 1,
+        .mb_param_type = MB_PARAM_HOLDING,
+        .mb_reg_start = 0,
+        .mb_size = 1,
+        .param_offset = 0,
+        .param_type = PARAM_TYPE_U16,
+        .param_size = PARAM_SIZE_U16,
+        .access = PAR_PERMS_READ
+    }
+};
+
+// Poll engine: the scan table is converted to the master descriptors, one characteristic per entry
+static const modbus_rtu_scan_t *scan_table = NULL;
+static uint16_t scan_count = 0;
+static void *scan_slave = NULL;
+static modbus_rtu_scan_status_t scan_status[MODBUS_RTU_SCAN_MAX];
+static int64_t scan_next_us[MODBUS_RTU_SCAN_MAX];
+static portMUX_TYPE scan_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// The segment of the unit, NULL if no segment serves it
+static modbus_rtu_bus_t *modbus_rtu_find_bus(uint8_t unit)
+{
+    for (uint8_t i = 0; i < rtu_bus_count; i++) {
+        if ((unit >= rtu_buses[i].segment.unit_min) && (unit <= rtu_buses[i].segment.unit_max)) {
+            return &rtu_buses[i];
+        }
+    }
+    return NULL;
+}
+
+// Take the serial master of the segment for one request, NULL if the segment is stopped.
+// The lock is held only to count the request, the bus itself is granted by the master scheduler.
+static void *modbus_rtu_bus_acquire(modbus_rtu_bus_t *bus)
+{
+    void *handle = NULL;
+    if (bus->lock && (xSemaphoreTake(bus->lock, pdMS_TO_TICKS(MODBUS_RTU_LOCK_TOUT_MS)) == pdTRUE)) {
+        handle = bus->handle;
+        if (handle != NULL) {
+            bus->users++;
+        }
+        xSemaphoreGive(bus->lock);
+    }
+    return handle;
+}
+
+static void modbus_rtu_bus_release(modbus_rtu_bus_t *bus)
+{
+    xSemaphoreTake(bus->lock, portMAX_DELAY);
+    // modbus_rtu_bus_stop() đã xóa handle và chờ request cuối cùng
+    if ((--bus->users == 0) && (bus->handle == NULL)) {
+        xSemaphoreGive(bus->idle);
+    }
+    xSemaphoreGive(bus->lock);
+}
+
+static bool modbus_rtu_any_poll_task(void)
+{
+    for (uint8_t i = 0; i < rtu_bus_count; i++) {
+        if (rtu_buses[i].poll_task != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint16_t modbus_rtu_scan_data_size(const modbus_rtu_scan_t *entry)
+{
+    if ((entry->type == MB_PARAM_COIL) || (entry->type == MB_PARAM_DISCRETE)) {
+        return (uint16_t)((entry->reg_size + 7) >> 3);
+    }
+    return (uint16_t)(entry->reg_size << 1);
+}
+
+static void modbus_rtu_poll_entry(modbus_rtu_bus_t *bus, void *handle, uint16_t cid)
+{
+    uint16_t index = bus->scan_index[cid];
+    const modbus_rtu_scan_t *entry = &scan_table[index];
+    uint16_t size = modbus_rtu_scan_data_size(entry);
+    uint8_t type = 0;
+    esp_err_t err = mbc_master_get_parameter(handle, cid, bus->poll_buffer, &type);
+    int64_t now_us = esp_timer_get_time();
+
+    if (err == ESP_OK) {
+        // Slave TCP đọc mirror trong callback của nó, copy dưới lock để không trả về dữ liệu nửa cũ nửa mới
+        if (scan_slave) {
+            (void)mbc_slave_lock(scan_slave);
+        }
+        memcpy(entry->mirror, bus->poll_buffer, size);
+        if (scan_slave) {
+            (void)mbc_slave_unlock(scan_slave);
+        }
+    } else {
+        ESP_LOGD(TAG, "Scan %u (unit %u, reg %u) failed: %s", (unsigned)index,
+                 (unsigned)entry->unit, (unsigned)entry->reg_start, esp_err_to_name(err));
+    }
+
+    portENTER_CRITICAL(&scan_mux);
+    modbus_rtu_scan_status_t *status = &scan_status[index];
+    status->last_error = err;
+    if (err == ESP_OK) {
+        status->last_update_us = now_us;
+        status->reads++;
+    } else {
+        status->errors++;
+    }
+    portEXIT_CRITICAL(&scan_mux);
+}
+
+// Each segment polls its own units, so the slow segment does not delay the mirror of the others
+static void modbus_rtu_poll_task(void *arg)
+{
+    modbus_rtu_bus_t *bus = (modbus_rtu_bus_t *)arg;
+    for (uint16_t cid = 0; cid < bus->scan_count; cid++) {
+        scan_next_us[bus->scan_index[cid]] = esp_timer_get_time();
+    }
+
+    while (!bus->poll_stop) {
+        int64_t now_us = esp_timer_get_time();
+        int64_t wake_us = now_us + ((int64_t)MODBUS_RTU_LOCK_TOUT_MS * 1000);
+
+        for (uint16_t cid = 0; (cid < bus->scan_count) && !bus->poll_stop; cid++) {
+            uint16_t i = bus->scan_index[cid];
+            if (scan_next_us[i] <= now_us) {
+                // Chung bus với request forward từ TCP, scheduler của master chia bus cho hai bên
+                void *handle = modbus_rtu_bus_acquire(bus);
+                if (handle != NULL) {
+                    modbus_rtu_poll_entry(bus, handle, cid);
+                    modbus_rtu_bus_release(bus);
+                }
+                // Giữ nhịp cố định, bỏ qua các chu kỳ đã lỡ khi bus chậm
+                scan_next_us[i] += ((int64_t)scan_table[i].period_ms * 1000);
+                now_us = esp_timer_get_time();
+                if (scan_next_us[i] <= now_us) {
+                    scan_next_us[i] = now_us + ((int64_t)scan_table[i].period_ms * 1000);
+                }
+            }
+            if (scan_next_us[i] < wake_us) {
+                wake_us = scan_next_us[i];
+            }
+        }
+
+        int64_t sleep_us = wake_us - esp_timer_get_time();
+        if (sleep_us > 0) {
+            // modbus_rtu_stop() đánh thức task bằng notification
+            (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((sleep_us + 999) / 1000) + 1);
+        }
+    }
+
+    xSemaphoreGive(bus->poll_done);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t modbus_rtu_poll_start(modbus_rtu_bus_t *bus)
+{
+    if (!bus->scan_count) {
+        return ESP_OK;
+    }
+    if (bus->poll_done == NULL) {
+        bus->poll_done = xSemaphoreCreateBinary();
+        if (bus->poll_done == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    bus->poll_stop = false;
+    if (xTaskCreate(modbus_rtu_poll_task, "rtu_poll", MODBUS_RTU_POLL_TASK_STACK,
+                    bus, MODBUS_RTU_POLL_TASK_PRIO, &bus->poll_task) != pdPASS) {
+        bus->poll_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Poll engine (UART%d): %u scan entries", (int)bus->segment.port, (unsigned)bus->scan_count);
+    return ESP_OK;
+}
+
+static void modbus_rtu_poll_stop(modbus_rtu_bus_t *bus)
+{
+    if (bus->poll_task == NULL) {
+        return;
+    }
+    bus->poll_stop = true;
+    xTaskNotifyGive(bus->poll_task);
+    (void)xSemaphoreTake(bus->poll_done, portMAX_DELAY);
+    bus->poll_task = NULL;
+}
+
+// Distribute the scan entries to the segments of their units, cid of the characteristic is its index in the segment
+static void modbus_rtu_scan_split(void)
+{
+    for (uint8_t i = 0; i < rtu_bus_count; i++) {
+        rtu_buses[i].scan_count = 0;
+    }
+    for (uint16_t i = 0; i < scan_count; i++) {
+        const modbus_rtu_scan_t *entry = &scan_table[i];
+        modbus_rtu_bus_t *bus = modbus_rtu_find_bus(entry->unit);
+        if (bus == NULL) {
+            ESP_LOGW(TAG, "Scan entry %u: no segment for unit %u", (unsigned)i, (unsigned)entry->unit);
+            portENTER_CRITICAL(&scan_mux);
+            scan_status[i].last_error = ESP_ERR_NOT_FOUND;
+            portEXIT_CRITICAL(&scan_mux);
+            continue;
+        }
+        uint16_t cid = bus->scan_count++;
+        bus->scan_index[cid] = i;
+        // Kiểu BIN: master copy nguyên khối dữ liệu (thanh ghi host order hoặc bit đã đóng gói) vào buffer
+        bus->descriptors[cid] = (mb_parameter_descriptor_t) {
+            .cid = cid,
+            .param_key = "rtu_scan",
+            .param_units = "",
+            .mb_slave_addr = entry->unit,
+            .mb_param_type = entry->type,
+            .mb_reg_start = entry->reg_start,
+            .mb_size = entry->reg_size,
+            .param_offset = 0,
+            .param_type = PARAM_TYPE_BIN,
+            .param_size = modbus_rtu_scan_data_size(entry),
+            .access = PAR_PERMS_READ
+        };
+    }
+}
+
+static esp_err_t modbus_rtu_bus_start(modbus_rtu_bus_t *bus)
+{
+    const modbus_rtu_segment_t *segment = &bus->segment;
+    uint32_t baudrate = segment->baudrate ? segment->baudrate : rtu_config.baudrate;
+    uart_parity_t parity = segment->baudrate ? segment->parity : rtu_config.parity;
+    mb_communication_info_t comm_info = {
+        .ser_opts.port = segment->port,
+        .ser_opts.mode = MB_RTU,
+        .ser_opts.baudrate = baudrate,
+        .ser_opts.parity = parity,
+        .ser_opts.data_bits = UART_DATA_8_BITS,
+        .ser_opts.stop_bits = UART_STOP_BITS_1,
+        .ser_opts.response_tout_ms = MODBUS_RTU_RESPONSE_TOUT_MS
+    };
+    void *handle = NULL;
+
+    esp_err_t err = mbc_master_create_serial(&comm_info, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "mbc_master_create_serial (UART%d) failed: %s", (int)segment->port, esp_err_to_name(err));
+        return err;
+    }
+
+    if (bus->scan_count) {
+        err = mbc_master_set_descriptor(handle, &bus->descriptors[0], bus->scan_count);
+    } else {
+        err = mbc_master_set_descriptor(handle, &rtu_dummy_descriptor[0],
+                                        sizeof(rtu_dummy_descriptor) / sizeof(rtu_dummy_descriptor[0]));
+    }
+    if (err == ESP_OK) {
+        err = mbc_master_start(handle);
+    }
+    if (err == ESP_OK) {
+        // Driver RS-485 half duplex, RTS điều khiển hướng truyền của transceiver
+        err = uart_set_pin(segment->port, segment->pin_tx, segment->pin_rx,
+                           segment->pin_rts, UART_PIN_NO_CHANGE);
+    }
+#if !CONFIG_FMB_SERIAL_RS485_HALF_DUPLEX
+    // Port của esp-modbus tự bật RS-485 half duplex khi CONFIG_FMB_SERIAL_RS485_HALF_DUPLEX
+    if (err == ESP_OK) {
+        err = uart_set_mode(segment->port, UART_MODE_RS485_HALF_DUPLEX);
+    }
+#endif
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Modbus RTU segment (UART%d) start failed: %s", (int)segment->port, esp_err_to_name(err));
+        mbc_master_delete(handle);
+        return err;
+    }
+
+    xSemaphoreTake(bus->lock, portMAX_DELAY);
+    bus->handle = handle;
+    xSemaphoreGive(bus->lock);
+
+    err = modbus_rtu_poll_start(bus);
+    if (err != ESP_OK) {
+        // Gateway vẫn chạy, chỉ thiếu mirror
+        ESP_LOGE(TAG, "Poll engine start failed: %s", esp_err_to_name(err));
+    }
+
+    ESP_LOGI(TAG, "✓ Modbus RTU segment đang chạy (UART%d, unit %u-%u, %" PRIu32 " bps, parity %d)",
+             (int)segment->port, (unsigned)segment->unit_min, (unsigned)segment->unit_max,
+             baudrate, (int)parity);
+    return ESP_OK;
+}
+
+static esp_err_t modbus_rtu_bus_stop(modbus_rtu_bus_t *bus)
+{
+    if (bus->lock == NULL) {
+        return ESP_OK;
+    }
+
+    // Dừng poll task trước, nó dùng handle của segment ngoài request forward
+    modbus_rtu_poll_stop(bus);
+
+    // Request mới không lấy được handle nữa, chờ các request đang forward hoàn tất trước khi xóa master
+    xSemaphoreTake(bus->lock, portMAX_DELAY);
+    void *handle = bus->handle;
+    bus->handle = NULL;
+    bool is_busy = (bus->users != 0);
+    xSemaphoreGive(bus->lock);
+    if (is_busy) {
+        (void)xSemaphoreTake(bus->idle, portMAX_DELAY);
+    }
+
+    if (handle == NULL) {
+        return ESP_OK;
+    }
+
+    esp_err_t err = mbc_master_delete(handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "mbc_master_delete (UART%d) failed: %s", (int)bus->segment.port, esp_err_to_name(err));
+    }
+    return err;
+}
+
+/* ==================================================================
+ *  PUBLIC API
+ * ================================================================== */
+
+esp_err_t modbus_rtu_set_config(const modbus_rtu_config_t *config)
+{
+    if (!config || !config->baudrate || (config->parity > UART_PARITY_ODD)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rtu_config = *config;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_set_segments(const modbus_rtu_segment_t *segments, uint8_t count)
+{
+    if (!segments || !count || (count > MODBUS_RTU_BUS_MAX)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        const modbus_rtu_segment_t *segment = &segments[i];
+        if ((segment->port >= UART_NUM_MAX) || !segment->unit_min
+            || (segment->unit_min > segment->unit_max) || (segment->unit_max > MODBUS_RTU_UNIT_MAX)
+            || (segment->baudrate && (segment->parity > UART_PARITY_ODD))) {
+            ESP_LOGE(TAG, "Segment %u is incorrect", (unsigned)i);
+            return ESP_ERR_INVALID_ARG;
+        }
+        // Mỗi segment một UART riêng, dải unit ID không được chồng lên nhau
+        for (uint8_t j = 0; j < i; j++) {
+            if ((segments[j].port == segment->port)
+                || ((segment->unit_min <= segments[j].unit_max) && (segment->unit_max >= segments[j].unit_min))) {
+                ESP_LOGE(TAG, "Segment %u overlaps segment %u", (unsigned)i, (unsigned)j);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+    if (modbus_rtu_is_running()) {
+        ESP_LOGW(TAG, "Stop the gateway before changing the segments");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        rtu_buses[i].segment = segments[i];
+    }
+    rtu_bus_count = count;
+    return ESP_OK;
+}
+
 esp_err_t modbus_rtu_start(void)
 {
-    ESP_LOGW(TAG, "Modbus RTU not implemented yet");
-    return ESP_ERR_NOT_SUPPORTED;
+    if (modbus_rtu_is_running()) {
+        ESP_LOGW(TAG, "Modbus RTU gateway already running");
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (uint8_t i = 0; i < rtu_bus_count; i++) {
+        if (rtu_buses[i].lock == NULL) {
+            rtu_buses[i].lock = xSemaphoreCreateMutex();
+            if (rtu_buses[i].lock == NULL) {
+                ESP_LOGE(TAG, "Failed to create gateway lock");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        if (rtu_buses[i].idle == NULL) {
+            rtu_buses[i].idle = xSemaphoreCreateBinary();
+            if (rtu_buses[i].idle == NULL) {
+                ESP_LOGE(TAG, "Failed to create gateway lock");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+    }
+
+    modbus_rtu_scan_split();
+    esp_err_t err = ESP_OK;
+    for (uint8_t i = 0; (i < rtu_bus_count) && (err == ESP_OK); i++) {
+        err = modbus_rtu_bus_start(&rtu_buses[i]);
+    }
+    if (err != ESP_OK) {
+        // Không chạy gateway với một phần segment, unit của segment lỗi sẽ không có đường đi
+        (void)modbus_rtu_stop();
+        return err;
+    }
+    ESP_LOGI(TAG, "✓ Modbus RTU gateway đang chạy (%u segment)", (unsigned)rtu_bus_count);
+    return ESP_OK;
 }
 
 esp_err_t modbus_rtu_stop(void)
 {
-    ESP_LOGW(TAG, "Modbus RTU not implemented yet");
-    return ESP_ERR_NOT_SUPPORTED;
+    bool was_running = modbus_rtu_is_running();
+    esp_err_t result = ESP_OK;
+    for (uint8_t i = 0; i < rtu_bus_count; i++) {
+        esp_err_t err = modbus_rtu_bus_stop(&rtu_buses[i]);
+        if (err != ESP_OK) {
+            result = err;
+        }
+    }
+    if (was_running && (result == ESP_OK)) {
+        ESP_LOGI(TAG, "Modbus RTU gateway stopped");
+    }
+    return result;
 }
 
+bool modbus_rtu_is_running(void)
+{
+    for (uint8_t i = 0; i < rtu_bus_count; i++) {
+        if (rtu_buses[i].handle != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called under rtu_stats_mux
+static void modbus_rtu_stats_update(modbus_rtu_stats_t *stats, esp_err_t err,
+                                    uint16_t req_len, uint16_t rsp_len, int64_t latency_us)
+{
+    stats->tx_frames++;
+    stats->tx_bytes += req_len;
+    if (err == ESP_OK) {
+        stats->rx_frames++;
+        stats->rx_bytes += rsp_len;
+        stats->last_latency_us = (latency_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency_us;
+        if (stats->last_latency_us > stats->max_latency_us) {
+            stats->max_latency_us = stats->last_latency_us;
+        }
+        stats->total_latency_us += (uint64_t)latency_us;
+    } else {
+        stats->errors++;
+    }
+}
+
+mb_exception_t modbus_rtu_forward(void *arg, uint8_t uid, uint8_t *frame, uint16_t *len)
+{
+    (void)arg;
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    uint16_t req_len = *len;
+    uint16_t rsp_len = 0;
+    int64_t start_us = esp_timer_get_time();
+    // Chạy trong task của slave TCP, các request forward tuần tự kể cả khi tới các segment khác nhau
+    modbus_rtu_bus_t *bus = modbus_rtu_find_bus(uid);
+    void *handle = bus ? modbus_rtu_bus_acquire(bus) : NULL;
+
+    if (handle != NULL) {
+        // The response replaces the request in the frame buffer, the MBAP header (TID) is kept by the TCP slave.
+        // The scheduler of the master shares the bus with the poll task, the busy bus is ESP_ERR_NOT_FINISHED
+        err = mbc_master_send_raw_request(handle, uid, frame, req_len,
+                                          frame, MODBUS_RTU_PDU_SIZE_MAX, &rsp_len);
+        modbus_rtu_bus_release(bus);
+    }
+
+    int64_t latency_us = esp_timer_get_time() - start_us;
+    portENTER_CRITICAL(&rtu_stats_mux);
+    modbus_rtu_stats_update(&rtu_stats, err, req_len, rsp_len, latency_us);
+    if (bus) {
+        modbus_rtu_stats_update(&bus->stats, err, req_len, rsp_len, latency_us);
+    }
+    portEXIT_CRITICAL(&rtu_stats_mux);
+
+    if (err == ESP_OK) {
+        *len = rsp_len;
+        return MB_EX_NONE;
+    }
+    ESP_LOGD(TAG, "Forward to unit %u failed: %s", (unsigned)uid, esp_err_to_name(err));
+    if (err == ESP_ERR_NOT_FINISHED) {
+        // Hàng đợi của bus RS-485 đầy, client TCP nên thử lại sau
+        return MB_EX_SLAVE_BUSY;
+    }
+    return (err == ESP_ERR_TIMEOUT) ? MB_EX_GATEWAY_TGT_FAILED : MB_EX_GATEWAY_PATH_FAILED;
+}
+
+esp_err_t modbus_rtu_set_scan_table(const modbus_rtu_scan_t *table, uint16_t count, void *slave_handle)
+{
+    if ((table && (!count || (count > MODBUS_RTU_SCAN_MAX))) || (!table && count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        const modbus_rtu_scan_t *entry = &table[i];
+        if (!entry->unit || !entry->mirror || !entry->reg_size
+            || (entry->period_ms < MODBUS_RTU_SCAN_PERIOD_MIN_MS)
+            || (entry->type >= MB_PARAM_COUNT)
+            || (modbus_rtu_scan_data_size(entry) > (MODBUS_RTU_PDU_SIZE_MAX - 3))) {
+            ESP_LOGE(TAG, "Scan entry %u is incorrect", (unsigned)i);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (modbus_rtu_any_poll_task()) {
+        ESP_LOGW(TAG, "Stop the gateway before changing the scan table");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&scan_mux);
+    memset(scan_status, 0, sizeof(scan_status));
+    for (uint16_t i = 0; i < MODBUS_RTU_SCAN_MAX; i++) {
+        scan_status[i].last_error = ESP_ERR_NOT_FINISHED;
+    }
+    portEXIT_CRITICAL(&scan_mux);
+    scan_table = table;
+    scan_count = count;
+    scan_slave = slave_handle;
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_get_scan_status(uint16_t index, modbus_rtu_scan_status_t *status)
+{
+    if (!status || (index >= scan_count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&scan_mux);
+    *status = scan_status[index];
+    portEXIT_CRITICAL(&scan_mux);
+    if (status->last_update_us) {
+        int64_t age_ms = (esp_timer_get_time() - status->last_update_us) / 1000;
+        status->age_ms = (age_ms > UINT32_MAX) ? UINT32_MAX : (uint32_t)age_ms;
+    } else {
+        status->age_ms = UINT32_MAX;
+    }
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_get_stats(modbus_rtu_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&rtu_stats_mux);
+    *stats = rtu_stats;
+    portEXIT_CRITICAL(&rtu_stats_mux);
+    return ESP_OK;
+}
+
+esp_err_t modbus_rtu_get_segment_stats(uint8_t index, modbus_rtu_stats_t *stats)
+{
+    if (!stats || (index >= rtu_bus_count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&rtu_stats_mux);
+    *stats = rtu_buses[index].stats;
+    portEXIT_CRITICAL(&rtu_stats_mux);
+    return ESP_OK;
+}
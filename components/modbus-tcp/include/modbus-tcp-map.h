@@ -62,6 +62,14 @@
 #define REG_SCAN_STATUS              3001
 #define REG_AP_COUNT                 3002
 
+/* Mirror of the RTU slave (input registers updated by the poll engine) */
+#define REG_RTU_MIRROR_START         1000   // 31001
+#define RTU_MIRROR_HOLD_REGS         16     // 40001–40016 của slave RTU
+#define RTU_MIRROR_INPUT_REGS        16     // 30001–30016 của slave RTU
+#define RTU_MIRROR_SCAN_COUNT        2
+#define RTU_MIRROR_PERIOD_MS         1000
+#define RTU_MIRROR_AGE_UNKNOWN       0xFFFF // chưa đọc được hoặc quá cũ
+
 /* ==============================================
  *  DEFAULTS
  * ============================================== */
@@ -135,8 +143,21 @@ typedef struct {
     uint16_t connected_clients;   // 30007
     uint16_t rtu_tx_count;        // 30008
     uint16_t rtu_rx_count;        // 30009
+    uint16_t task_wakeups_per_sec; // 30010
+    uint16_t rtu_err_count;       // 30011 (request gateway không có phản hồi)
+    uint16_t rtu_tx_bytes_per_sec; // 30012 (TCP → RTU)
+    uint16_t rtu_rx_bytes_per_sec; // 30013 (RTU → TCP)
+    uint16_t rtu_latency_last_ms; // 30014
+    uint16_t rtu_latency_avg_ms;  // 30015
+    uint16_t rtu_latency_max_ms;  // 30016
 } input_reg_params_t;
 
+typedef struct {
+    uint16_t hold[RTU_MIRROR_HOLD_REGS];    // 31001–31016 (FC03 của slave RTU)
+    uint16_t input[RTU_MIRROR_INPUT_REGS];  // 31017–31032 (FC04 của slave RTU)
+    uint16_t age_100ms[RTU_MIRROR_SCAN_COUNT]; // 31033–31034 (tuổi dữ liệu của từng dòng scan)
+} rtu_mirror_regs_t;
+
 typedef struct {
     uint16_t wifi_mode;                 // 40001
     uint16_t sta_ssid[MAX_SSID_LENGTH / 2]; // 40002–40017 (UTF-16 modbus mapping)
@@ -158,8 +179,9 @@ typedef struct {
  *  EXTERNAL VARIABLES
  * ============================================== */
 extern holding_reg_params_t holding_reg_params;
-extern input_reg_params_t input_reg_params;
+extern input_reg_params_t input_reg_params;     // initial values, then updated through the register image
 extern coil_reg_params_t coil_reg_params;
 extern discrete_reg_params_t discrete_reg_params;
+extern rtu_mirror_regs_t rtu_mirror_regs;        // written by the RTU poll engine
 
 #endif /* MODBUS_TCP_MAP_INCLUDE */
\ No newline at end of file
@@ -29,7 +29,21 @@ input_reg_params_t input_reg_params = {
     .ap_ip_addr = 0,
     .connected_clients = 0,
     .rtu_tx_count = 0,
-    .rtu_rx_count = 0
+    .rtu_rx_count = 0,
+    .task_wakeups_per_sec = 0,
+    .rtu_err_count = 0,
+    .rtu_tx_bytes_per_sec = 0,
+    .rtu_rx_bytes_per_sec = 0,
+    .rtu_latency_last_ms = 0,
+    .rtu_latency_avg_ms = 0,
+    .rtu_latency_max_ms = 0
+};
+
+/* Mirror of the RTU slave (Read-Only) */
+rtu_mirror_regs_t rtu_mirror_regs = {
+    .hold = {0},
+    .input = {0},
+    .age_100ms = {RTU_MIRROR_AGE_UNKNOWN, RTU_MIRROR_AGE_UNKNOWN}
 };
 
 /* Holding Registers (Read/Write) */
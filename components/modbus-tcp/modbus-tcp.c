@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -15,6 +16,7 @@
 
 #include "modbus-tcp-map.h"
 #include "esp_modbus_slave.h"
+#include "modbus-rtu.h"
 #include "app_events.h"
 
 // Tag
@@ -30,21 +32,56 @@ static EventGroupHandle_t modbus_event_group = NULL;
 #define MODBUS_STOP_BIT     BIT1
 #define MODBUS_RUNNING_BIT  BIT2
 
+// Task notification bits: the task sleeps until one of the sources notifies it
+#define MODBUS_NOTIFY_ACCESS_MASK (MB_EVENT_HOLDING_REG_WR | MB_EVENT_HOLDING_REG_RD | MB_EVENT_INPUT_REG_RD | \
+                                   MB_EVENT_COILS_WR | MB_EVENT_COILS_RD | MB_EVENT_DISCRETE_RD) // từ Modbus stack
+#define MODBUS_NOTIFY_WIFI_BIT    BIT29     // WiFi state thay đổi (app_events_update)
+#define MODBUS_NOTIFY_STOP_BIT    BIT30     // modbus_tcp_stop()
+
 // Modbus slave handle
 static void *slave_handle = NULL;
 
+// Input registers are published through the double buffered image,
+// the stack reads the front buffer without lock while the back buffer is updated
+static input_reg_params_t input_reg_back;
+static mb_reg_image_t input_reg_image;
+
+// Scan table of the RTU poll engine, the unit is taken from rtu_slave_addr when the gateway starts
+static modbus_rtu_scan_t rtu_scan_table[RTU_MIRROR_SCAN_COUNT] = {
+    {
+        .type = MB_PARAM_HOLDING,
+        .reg_start = 0,
+        .reg_size = RTU_MIRROR_HOLD_REGS,
+        .period_ms = RTU_MIRROR_PERIOD_MS,
+        .mirror = rtu_mirror_regs.hold
+    },
+    {
+        .type = MB_PARAM_INPUT,
+        .reg_start = 0,
+        .reg_size = RTU_MIRROR_INPUT_REGS,
+        .period_ms = RTU_MIRROR_PERIOD_MS,
+        .mirror = rtu_mirror_regs.input
+    }
+};
+
 // Config
 #define MODBUS_TASK_STACK_SIZE    (4096)
 #define MODBUS_TASK_PRIORITY      (6)  // Tăng từ 5 lên 6 để ưu tiên cao hơn WiFi task
 #define MODBUS_POLL_TIMEOUT_MS    (100)
 #define MODBUS_UPDATE_INTERVAL_MS (1000)
-#define MODBUS_LOOP_DELAY_MS      (1)  // Giảm từ 10ms xuống 1ms để responsive hơn
+#define MODBUS_CHANGES_MAX        (8)     // Số vùng thay đổi đọc trong một lần
+#define MODBUS_COIL_RTU_BRIDGE    (2)     // Vị trí coil rtu_bridge_enable trong coil_reg_params_t
+#define MODBUS_HOLD_RTU_FIRST     (offsetof(holding_reg_params_t, rtu_slave_addr) / sizeof(uint16_t))
+#define MODBUS_HOLD_RTU_LAST      (offsetof(holding_reg_params_t, rtu_parity) / sizeof(uint16_t))
 
 // Forward declarations
 static void modbus_task(void *pvParameters);
 static esp_err_t modbus_slave_init_tcp(void);
-static void modbus_update_input_registers(void);
+static void modbus_update_input_registers(uint16_t wakeups_per_sec, uint32_t elapsed_ms);
+static void modbus_handle_changes(void);
+static void modbus_update_rtu_bridge(bool config_changed);
 static void modbus_update_discrete_inputs(void);
+static void modbus_update_rtu_mirror_age(void);
 
 /* ==================================================================
  *  PUBLIC API
@@ -89,6 +126,7 @@ esp_err_t modbus_tcp_stop(void)
     if (!modbus_task_handle) return ESP_OK;
 
     xEventGroupSetBits(modbus_event_group, MODBUS_STOP_BIT);
+    xTaskNotify(modbus_task_handle, MODBUS_NOTIFY_STOP_BIT, eSetBits);
 
     // Wait up to 5s for task to finish
     vTaskDelay(pdMS_TO_TICKS(5000));
@@ -118,9 +156,13 @@ static void modbus_task(void *pvParameters)
     EventBits_t bits;
     EventBits_t wifi_bits;
     TickType_t last_update = 0;
-    mb_event_group_t event;
+    uint32_t notified = 0;
+    uint32_t wakeup_count = 0;
+    uint16_t wakeups_per_sec = 0;
 
     ESP_LOGI(TAG, "Modbus TCP task đã khởi động");
+    // Nhận thông báo khi WiFi state thay đổi
+    app_events_subscribe(xTaskGetCurrentTaskHandle(), MODBUS_NOTIFY_WIFI_BIT);
     ESP_LOGI(TAG, "→ Đang chờ WiFi kết nối (STA hoặc AP)...");
 
     while (1) {
@@ -167,13 +209,40 @@ static void modbus_task(void *pvParameters)
         xEventGroupSetBits(modbus_event_group, MODBUS_RUNNING_BIT);
         ESP_LOGI(TAG, "✓ Modbus TCP Slave đang chạy");
 
-        // === BƯỚC 3: Main Loop - Poll Modbus & Monitor WiFi ===
-        uint32_t wifi_check_counter = 0;
+        // Gateway TCP→RTU chạy nếu coil rtu_bridge_enable đã bật
+        modbus_update_rtu_bridge(false);
+
+        // === BƯỚC 3: Main Loop - Chờ thông báo từ Modbus stack, WiFi hoặc timer cập nhật ===
+        // Stack access events được gửi trực tiếp tới task (task notification)
+        (void)mbc_slave_set_event_notify(slave_handle, xTaskGetCurrentTaskHandle());
+        last_update = xTaskGetTickCount();
+        wakeup_count = 0;
         while (!(xEventGroupGetBits(modbus_event_group) & MODBUS_STOP_BIT)) {
-            
-            // Kiểm tra WiFi mỗi 100 lần loop (giảm overhead)
-            if (++wifi_check_counter >= 100) {
-                wifi_check_counter = 0;
+
+            // Periodic update of input registers and discrete inputs
+            TickType_t now = xTaskGetTickCount();
+            TickType_t elapsed = now - last_update;
+            if (elapsed >= pdMS_TO_TICKS(MODBUS_UPDATE_INTERVAL_MS)) {
+                uint32_t elapsed_ms = pdTICKS_TO_MS(elapsed);
+                wakeups_per_sec = (uint16_t)((wakeup_count * 1000UL + (elapsed_ms / 2)) / elapsed_ms);
+                wakeup_count = 0;
+                modbus_update_input_registers(wakeups_per_sec, elapsed_ms);
+                modbus_update_discrete_inputs();
+                modbus_update_rtu_mirror_age();
+                last_update = now;
+                elapsed = 0;
+            }
+
+            // Ngủ cho tới khi có thông báo hoặc tới lần cập nhật tiếp theo
+            notified = 0;
+            (void)xTaskNotifyWait(0, UINT32_MAX, &notified, pdMS_TO_TICKS(MODBUS_UPDATE_INTERVAL_MS) - elapsed);
+            wakeup_count++;
+
+            if (notified & MODBUS_NOTIFY_STOP_BIT) {
+                break;
+            }
+
+            if (notified & MODBUS_NOTIFY_WIFI_BIT) {
                 wifi_bits = xEventGroupGetBits(app_event_group);
                 if (wifi_bits & WIFI_DISCONNECTED_BIT) {
                     ESP_LOGW(TAG, "⚠ WiFi bị ngắt kết nối, dừng Modbus và chờ kết nối lại...");
@@ -181,41 +250,21 @@ static void modbus_task(void *pvParameters)
                 }
             }
 
-            // Check for Modbus events
-            TickType_t event_start = xTaskGetTickCount();
-            event = mbc_slave_check_event(slave_handle, MB_EVENT_HOLDING_REG_WR | MB_EVENT_INPUT_REG_RD | 
-                                          MB_EVENT_HOLDING_REG_RD | MB_EVENT_COILS_WR | 
-                                          MB_EVENT_COILS_RD | MB_EVENT_DISCRETE_RD);
-            
-            if (event) {
-                TickType_t event_duration = xTaskGetTickCount() - event_start;
-                if (event_duration > pdMS_TO_TICKS(50)) {
-                    ESP_LOGW(TAG, "⚠ Event processing took %d ms", (int)pdTICKS_TO_MS(event_duration));
-                }
-                
-                ESP_LOGD(TAG, "Modbus event: 0x%x", (int)event);
-                
+            if (notified & MODBUS_NOTIFY_ACCESS_MASK) {
+                ESP_LOGD(TAG, "Modbus event: 0x%x", (int)(notified & MODBUS_NOTIFY_ACCESS_MASK));
+
                 // Handle specific events if needed
-                if (event & MB_EVENT_HOLDING_REG_WR) {
-                    ESP_LOGD(TAG, "Holding register được ghi");
-                    // TODO: Handle configuration changes
+                if (notified & (MB_EVENT_HOLDING_REG_WR | MB_EVENT_COILS_WR)) {
+                    modbus_handle_changes();
                 }
             }
-
-            // Periodic update of input registers and discrete inputs
-            TickType_t now = xTaskGetTickCount();
-            if ((now - last_update) >= pdMS_TO_TICKS(MODBUS_UPDATE_INTERVAL_MS)) {
-                modbus_update_input_registers();
-                modbus_update_discrete_inputs();
-                last_update = now;
-            }
-
-            vTaskDelay(pdMS_TO_TICKS(MODBUS_LOOP_DELAY_MS));
         }
 
         // === BƯỚC 4: Cleanup ===
         ESP_LOGI(TAG, "Dừng Modbus TCP Slave...");
+        (void)mbc_slave_set_event_notify(slave_handle, NULL);
         mbc_slave_stop(slave_handle);
+        (void)modbus_rtu_stop();
         mbc_slave_delete(slave_handle);
         slave_handle = NULL;
         xEventGroupClearBits(modbus_event_group, MODBUS_RUNNING_BIT);
@@ -228,6 +277,7 @@ static void modbus_task(void *pvParameters)
     }
 
     ESP_LOGI(TAG, "Modbus task thoát");
+    app_events_subscribe(NULL, 0);
     modbus_task_handle = NULL;
     vTaskDelete(NULL);
 }
@@ -283,6 +333,32 @@ static esp_err_t modbus_slave_init_tcp(void)
         return err;
     }
 
+    // The image keeps the published values when the slave is restarted
+    if (!input_reg_image.size) {
+        (void)mbc_slave_reg_image_init(&input_reg_image, &input_reg_params, &input_reg_back, sizeof(input_reg_params_t));
+    }
+    err = mbc_slave_set_reg_image(slave_handle, MB_PARAM_INPUT, reg_area.start_offset, &input_reg_image);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "mbc_slave_set_reg_image INPUT failed: %s", esp_err_to_name(err));
+        mbc_slave_delete(slave_handle);
+        slave_handle = NULL;
+        return err;
+    }
+
+    // Register RTU mirror area, the poll engine writes it under mbc_slave_lock()
+    reg_area.type = MB_PARAM_INPUT;
+    reg_area.start_offset = REG_RTU_MIRROR_START;  // Start from address 31001
+    reg_area.address = (void*)&rtu_mirror_regs;
+    reg_area.size = sizeof(rtu_mirror_regs_t);
+    reg_area.access = MB_ACCESS_RO;
+    err = mbc_slave_set_descriptor(slave_handle, reg_area);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "mbc_slave_set_descriptor RTU MIRROR failed: %s", esp_err_to_name(err));
+        mbc_slave_delete(slave_handle);
+        slave_handle = NULL;
+        return err;
+    }
+
     // Register Coils area
     reg_area.type = MB_PARAM_COIL;
     reg_area.start_offset = 0;  // Start from address 00001
@@ -311,6 +387,15 @@ static esp_err_t modbus_slave_init_tcp(void)
         return err;
     }
 
+    // Request với unit ID khác được chuyển tới slave RTU (gateway), trả về exception 0x0A nếu gateway tắt
+    err = mbc_slave_set_forward_handler(slave_handle, modbus_rtu_forward, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "mbc_slave_set_forward_handler failed: %s", esp_err_to_name(err));
+        mbc_slave_delete(slave_handle);
+        slave_handle = NULL;
+        return err;
+    }
+
     // Start Modbus slave
     err = mbc_slave_start(slave_handle);
     if (err != ESP_OK) {
@@ -328,19 +413,158 @@ static esp_err_t modbus_slave_init_tcp(void)
  *  REGISTER UPDATE FUNCTIONS
  * ================================================================== */
 
-static void modbus_update_input_registers(void)
+// Đọc tất cả vùng holding/coil bị master ghi từ change log của slave (không mất khi queue đầy)
+static void modbus_handle_changes(void)
+{
+    mb_param_change_t changes[MODBUS_CHANGES_MAX];
+    size_t count = 0;
+    bool bridge_changed = false;
+    bool rtu_config_changed = false;
+
+    do {
+        if (mbc_slave_get_changes(slave_handle, changes, MODBUS_CHANGES_MAX, &count) != ESP_OK) {
+            break;
+        }
+        for (size_t i = 0; i < count; i++) {
+            ESP_LOGD(TAG, "%s được ghi: offset %u, size %u",
+                     (changes[i].type == MB_PARAM_HOLDING) ? "Holding register" : "Coil",
+                     (unsigned)changes[i].mb_offset, (unsigned)changes[i].size);
+            size_t first = changes[i].mb_offset;
+            size_t last = first + changes[i].size - 1;
+            if (changes[i].type == MB_PARAM_COIL) {
+                bridge_changed |= ((first <= MODBUS_COIL_RTU_BRIDGE) && (last >= MODBUS_COIL_RTU_BRIDGE));
+            } else {
+                rtu_config_changed |= ((first <= MODBUS_HOLD_RTU_LAST) && (last >= MODBUS_HOLD_RTU_FIRST));
+            }
+            // TODO: Handle other configuration changes
+        }
+    } while (count == MODBUS_CHANGES_MAX);
+
+    if (bridge_changed || rtu_config_changed) {
+        modbus_update_rtu_bridge(rtu_config_changed);
+    }
+}
+
+static uint32_t modbus_rtu_baudrate_bps(uint16_t baudrate)
+{
+    switch (baudrate) {
+        case RTU_BAUD_9600:   return 9600;
+        case RTU_BAUD_19200:  return 19200;
+        case RTU_BAUD_38400:  return 38400;
+        case RTU_BAUD_57600:  return 57600;
+        case RTU_BAUD_115200: return 115200;
+        default:              return 0;
+    }
+}
+
+// Bật/tắt gateway TCP→RTU theo coil rtu_bridge_enable, khởi động lại khi cấu hình RS-485 thay đổi
+static void modbus_update_rtu_bridge(bool config_changed)
+{
+    (void)mbc_slave_lock(slave_handle);
+    bool enable = coil_reg_params.rtu_bridge_enable;
+    uint16_t baudrate = holding_reg_params.rtu_baudrate;
+    uint16_t parity = holding_reg_params.rtu_parity;
+    uint16_t unit = holding_reg_params.rtu_slave_addr;
+    (void)mbc_slave_unlock(slave_handle);
+
+    if (!enable) {
+        (void)modbus_rtu_stop();
+        return;
+    }
+    if (modbus_rtu_is_running() && !config_changed) {
+        return;
+    }
+
+    modbus_rtu_config_t rtu_config = {
+        .baudrate = modbus_rtu_baudrate_bps(baudrate),
+        .parity = (parity == RTU_PARITY_ODD) ? UART_PARITY_ODD :
+                  (parity == RTU_PARITY_EVEN) ? UART_PARITY_EVEN : UART_PARITY_DISABLE
+    };
+    if ((parity > RTU_PARITY_EVEN) || (modbus_rtu_set_config(&rtu_config) != ESP_OK)) {
+        ESP_LOGW(TAG, "⚠ Cấu hình RTU không hợp lệ (baudrate %u, parity %u)", (unsigned)baudrate, (unsigned)parity);
+        return;
+    }
+    (void)modbus_rtu_stop();
+    // Poll engine mirror slave RTU vào vùng input 31001
+    if ((unit >= MIN_RTU_SLAVE_ADDR) && (unit <= MAX_RTU_SLAVE_ADDR)) {
+        for (int i = 0; i < RTU_MIRROR_SCAN_COUNT; i++) {
+            rtu_scan_table[i].unit = (uint8_t)unit;
+        }
+        (void)modbus_rtu_set_scan_table(rtu_scan_table, RTU_MIRROR_SCAN_COUNT, slave_handle);
+    } else {
+        ESP_LOGW(TAG, "⚠ Địa chỉ slave RTU không hợp lệ (%u), tắt mirror", (unsigned)unit);
+        (void)modbus_rtu_set_scan_table(NULL, 0, NULL);
+    }
+    esp_err_t err = modbus_rtu_start();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "✗ Không thể khởi động Modbus RTU gateway: %s", esp_err_to_name(err));
+    }
+}
+
+// Tốc độ byte/s từ hiệu của bộ đếm trong khoảng cập nhật
+static uint16_t modbus_rate_per_sec(uint32_t delta, uint32_t elapsed_ms)
+{
+    uint32_t rate = elapsed_ms ? (uint32_t)(((uint64_t)delta * 1000U + (elapsed_ms / 2)) / elapsed_ms) : 0;
+    return (rate > UINT16_MAX) ? UINT16_MAX : (uint16_t)rate;
+}
+
+static uint16_t modbus_latency_ms(uint64_t latency_us)
+{
+    uint64_t ms = (latency_us + 500U) / 1000U;
+    return (ms > UINT16_MAX) ? UINT16_MAX : (uint16_t)ms;
+}
+
+static void modbus_update_input_registers(uint16_t wakeups_per_sec, uint32_t elapsed_ms)
 {
     static uint32_t uptime_counter = 0;
+    static modbus_rtu_stats_t rtu_prev = {0};
+    modbus_rtu_stats_t rtu = {0};
+    input_reg_params_t *regs = (input_reg_params_t *)mbc_slave_reg_image_begin(&input_reg_image);
+    if (!regs) {
+        return;
+    }
     uptime_counter++;
-    input_reg_params.sys_uptime_sec = (uint16_t)(uptime_counter & 0xFFFF);
+    regs->sys_uptime_sec = (uint16_t)(uptime_counter & 0xFFFF);
+    regs->task_wakeups_per_sec = wakeups_per_sec;
+
+    // Bộ đếm của gateway TCP→RTU (TX) và RTU→TCP (RX)
+    if (modbus_rtu_get_stats(&rtu) == ESP_OK) {
+        regs->rtu_tx_count = (uint16_t)rtu.tx_frames;
+        regs->rtu_rx_count = (uint16_t)rtu.rx_frames;
+        regs->rtu_err_count = (uint16_t)rtu.errors;
+        regs->rtu_tx_bytes_per_sec = modbus_rate_per_sec(rtu.tx_bytes - rtu_prev.tx_bytes, elapsed_ms);
+        regs->rtu_rx_bytes_per_sec = modbus_rate_per_sec(rtu.rx_bytes - rtu_prev.rx_bytes, elapsed_ms);
+        regs->rtu_latency_last_ms = modbus_latency_ms(rtu.last_latency_us);
+        regs->rtu_latency_avg_ms = rtu.rx_frames ? modbus_latency_ms(rtu.total_latency_us / rtu.rx_frames) : 0;
+        regs->rtu_latency_max_ms = modbus_latency_ms(rtu.max_latency_us);
+        rtu_prev = rtu;
+    }
 
     // TODO: Update real values from system
-    // input_reg_params.wifi_rssi = get_wifi_rssi();
-    // input_reg_params.sta_ip_addr = get_sta_ip();
-    // input_reg_params.ap_ip_addr = get_ap_ip();
-    // input_reg_params.connected_clients = get_connected_clients();
-    // input_reg_params.rtu_tx_count = get_rtu_tx_count();
-    // input_reg_params.rtu_rx_count = get_rtu_rx_count();
+    // regs->wifi_rssi = get_wifi_rssi();
+    // regs->sta_ip_addr = get_sta_ip();
+    // regs->ap_ip_addr = get_ap_ip();
+    // regs->connected_clients = get_connected_clients();
+
+    // All updated values become visible to the masters at once
+    (void)mbc_slave_reg_image_publish(&input_reg_image);
+}
+
+// Tuổi dữ liệu mirror theo đơn vị 100 ms, RTU_MIRROR_AGE_UNKNOWN nếu chưa đọc được hoặc gateway tắt
+static void modbus_update_rtu_mirror_age(void)
+{
+    uint16_t age[RTU_MIRROR_SCAN_COUNT];
+    for (int i = 0; i < RTU_MIRROR_SCAN_COUNT; i++) {
+        modbus_rtu_scan_status_t status;
+        age[i] = RTU_MIRROR_AGE_UNKNOWN;
+        if (modbus_rtu_is_running() && (modbus_rtu_get_scan_status(i, &status) == ESP_OK)
+            && (status.age_ms < ((uint32_t)RTU_MIRROR_AGE_UNKNOWN * 100U))) {
+            age[i] = (uint16_t)(status.age_ms / 100U);
+        }
+    }
+    (void)mbc_slave_lock(slave_handle);
+    memcpy(rtu_mirror_regs.age_100ms, age, sizeof(age));
+    (void)mbc_slave_unlock(slave_handle);
 }
 
 static void modbus_update_discrete_inputs(void)
@@ -348,5 +572,7 @@ static void modbus_update_discrete_inputs(void)
     // TODO: Update real status
     // discrete_reg_params.wifi_sta_connected = wifi_is_sta_connected();
     // discrete_reg_params.wifi_ap_active = wifi_is_ap_active();
-    // discrete_reg_params.rtu_link_active = rtu_is_link_active();
+    (void)mbc_slave_lock(slave_handle);
+    discrete_reg_params.rtu_link_active = modbus_rtu_is_running();
+    (void)mbc_slave_unlock(slave_handle);
 }
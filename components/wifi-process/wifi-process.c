@@ -30,8 +30,7 @@ void cb_connection_ok(void *pvParameter){
     
     // Set event để báo cho Modbus Task biết WiFi đã kết nối
     if (app_event_group != NULL) {
-        xEventGroupClearBits(app_event_group, WIFI_DISCONNECTED_BIT);
-        xEventGroupSetBits(app_event_group, WIFI_STA_CONNECTED_BIT);
+        app_events_update(WIFI_STA_CONNECTED_BIT, WIFI_DISCONNECTED_BIT);
         ESP_LOGI(TAG, "→ Event WIFI_STA_CONNECTED_BIT đã được set");
     }
 }
@@ -48,8 +47,7 @@ void cb_connection_lost(void *pvParameter){
     
     // Set event để báo cho Modbus Task biết WiFi bị ngắt
     if (app_event_group != NULL) {
-        xEventGroupClearBits(app_event_group, WIFI_STA_CONNECTED_BIT);
-        xEventGroupSetBits(app_event_group, WIFI_DISCONNECTED_BIT);
+        app_events_update(WIFI_DISCONNECTED_BIT, WIFI_STA_CONNECTED_BIT);
         ESP_LOGW(TAG, "→ Event WIFI_DISCONNECTED_BIT đã được set");
     }
 }
@@ -62,7 +60,7 @@ void cb_ap_started(void *pvParameter){
     
     // Set event để báo cho Modbus Task biết AP đã sẵn sàng
     if (app_event_group != NULL) {
-        xEventGroupSetBits(app_event_group, WIFI_AP_STARTED_BIT);
+        app_events_update(WIFI_AP_STARTED_BIT, 0);
         ESP_LOGI(TAG, "→ Event WIFI_AP_STARTED_BIT đã được set");
     }
 }
@@ -3,6 +3,7 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/task.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +17,20 @@ extern "C" {
 // Global Event Group handle
 extern EventGroupHandle_t app_event_group;
 
+/**
+ * @brief Đăng ký task nhận thông báo khi event bits thay đổi
+ * @param task Task được thông báo (NULL - hủy đăng ký)
+ * @param notify_bits Bits được set vào notification value của task (eSetBits)
+ */
+void app_events_subscribe(TaskHandle_t task, uint32_t notify_bits);
+
+/**
+ * @brief Clear và set event bits, sau đó thông báo cho task đã đăng ký
+ * @param set_bits Bits cần set
+ * @param clear_bits Bits cần clear (clear trước khi set)
+ */
+void app_events_update(EventBits_t set_bits, EventBits_t clear_bits);
+
 #ifdef __cplusplus
 }
 #endif
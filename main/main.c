@@ -18,6 +18,33 @@ static const char *TAG = "APP_MAIN";
 // Global Event Group để đồng bộ giữa WiFi và Modbus tasks
 EventGroupHandle_t app_event_group = NULL;
 
+// Task được thông báo khi event bits thay đổi
+static TaskHandle_t app_events_task = NULL;
+static uint32_t app_events_notify_bits = 0;
+
+void app_events_subscribe(TaskHandle_t task, uint32_t notify_bits)
+{
+    app_events_notify_bits = notify_bits;
+    app_events_task = task;
+}
+
+void app_events_update(EventBits_t set_bits, EventBits_t clear_bits)
+{
+    if (app_event_group == NULL) {
+        return;
+    }
+    if (clear_bits) {
+        xEventGroupClearBits(app_event_group, clear_bits);
+    }
+    if (set_bits) {
+        xEventGroupSetBits(app_event_group, set_bits);
+    }
+    TaskHandle_t task = app_events_task;
+    if (task != NULL) {
+        xTaskNotify(task, app_events_notify_bits, eSetBits);
+    }
+}
+
 /**
  * @brief Khởi tạo NVS Flash
  */